@@ -28,8 +28,21 @@ list(APPEND QV2RAY_FULL_SOURCES
     ${CMAKE_SOURCE_DIR}/src/plugins/PluginsCommon/V2RayModels.hpp
     ${CMAKE_SOURCE_DIR}/src/ui/WidgetUIBase.hpp
     ${CMAKE_SOURCE_DIR}/src/ui/windows/w_MainWindow_extra.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/AutoFailover/FailoverPolicy.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeoIPMatcher.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeoIPMatcher.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeositeMatcher.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeositeMatcher.hpp
     ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/picoproto.h
     ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/picoproto.cc
+    ${CMAKE_SOURCE_DIR}/src/components/LatencyHistory/LatencyHistoryTable.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/LatencyHistory/LatencyHistoryTable.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/LatencyScheduler/LatencyTestQueue.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/LatencyScheduler/LatencyTestQueue.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/SubscriptionUpdater/ConditionalRequest.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/SubscriptionUpdater/ConditionalRequest.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/SubscriptionUpdater/SubscriptionDelta.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/SubscriptionUpdater/SubscriptionDelta.hpp
     ${CMAKE_SOURCE_DIR}/src/plugins/internal/InternalPlugin.cpp
     ${CMAKE_SOURCE_DIR}/src/plugins/internal/InternalPlugin.hpp
     ${CMAKE_SOURCE_DIR}/src/plugins/internal/InternalProfilePreprocessor.cpp
@@ -44,22 +57,34 @@ qv2ray_add_class(ui/node/models/RuleNodeModel)
 qv2ray_add_class(ui/node/NodeBase)
 qv2ray_add_class(ui/node/NodeDispatcher)
 qv2ray_add_class(ui/widgets/AutoCompleteTextEdit)
+qv2ray_add_class(ui/widgets/ConnectionItemDelegate)
+qv2ray_add_class(ui/widgets/LogItemDelegate)
 
 
+qv2ray_add_component(AutoFailover)
 qv2ray_add_component(AutoLaunchHelper)
 qv2ray_add_component(ConnectionModelHelper)
+qv2ray_add_component(ConnectionSearch)
 qv2ray_add_component(DarkmodeDetector)
 qv2ray_add_component(GeositeReader)
 qv2ray_add_component(GuiPluginHost)
+qv2ray_add_component(KeywordFilter)
+qv2ray_add_component(LatencyHistory)
+qv2ray_add_component(LatencyScheduler)
+qv2ray_add_component(LinkDeserializer)
 qv2ray_add_component(LogHighlighter)
+qv2ray_add_component(LogListModel)
 qv2ray_add_component(MessageBus)
 qv2ray_add_component(PortDetector)
 qv2ray_add_component(ProxyConfigurator)
 qv2ray_add_component(QJsonModel)
 qv2ray_add_component(QRCodeHelper)
 qv2ray_add_component(RouteSchemeIO)
+qv2ray_add_component(RouteSimulator)
 qv2ray_add_component(SpeedWidget)
 qv2ray_add_component(StyleManager)
+qv2ray_add_component(SubscriptionUpdater)
+qv2ray_add_component(UpdateScheduler)
 
 qv2ray_add_window(w_AboutWindow)
 qv2ray_add_window(w_GroupManager)
@@ -77,7 +102,6 @@ qv2ray_add_window(editors/w_RoutesEditor)
 qv2ray_add_widget(widgets/complex/ChainEditorWidget)
 qv2ray_add_widget(widgets/complex/RoutingEditorWidget)
 qv2ray_add_widget(widgets/ConnectionInfoWidget)
-qv2ray_add_widget(widgets/ConnectionItemWidget)
 #qv2ray_add_widget(widgets/editors/CertificateItemWidget)
 qv2ray_add_widget(widgets/editors/DnsSettingsWidget)
 qv2ray_add_widget(widgets/editors/RouteSettingsMatrix)
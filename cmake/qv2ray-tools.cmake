@@ -0,0 +1,25 @@
+# ==================================================================================
+# qv2ray-route-simulator, predicts routing decisions of a v2ray configuration file
+# ==================================================================================
+qt6_add_executable(qv2ray-route-simulator
+    ${CMAKE_SOURCE_DIR}/src/tools/RouteSimulatorTool.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/RouteSimulator/RouteSimulator.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/RouteSimulator/RouteSimulator.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeoIPMatcher.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeoIPMatcher.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeositeMatcher.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeositeMatcher.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeositeReader.cpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/GeositeReader.hpp
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/picoproto.cc
+    ${CMAKE_SOURCE_DIR}/src/components/GeositeReader/picoproto.h)
+
+target_include_directories(qv2ray-route-simulator PRIVATE ${CMAKE_SOURCE_DIR}/src)
+target_include_directories(qv2ray-route-simulator PRIVATE ${CMAKE_SOURCE_DIR}/src/components)
+
+target_link_libraries(qv2ray-route-simulator PRIVATE
+    Qt::Concurrent
+    Qt::Network
+    Qv2ray::Qv2rayBase
+    Qv2ray::QvPluginInterface
+    )
@@ -1,12 +1,18 @@
 #include "Qv2rayApplication.hpp"
 
+#include "AutoFailover/AutoFailover.hpp"
 #include "DarkmodeDetector/DarkmodeDetector.hpp"
+#include "GeositeReader/GeositeReader.hpp"
 #include "GuiPluginHost/GuiPluginHost.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Interfaces/IStorageProvider.hpp"
 #include "Qv2rayBase/Profile/KernelManager.hpp"
 #include "Qv2rayBase/Profile/ProfileManager.hpp"
 #include "StyleManager/StyleManager.hpp"
+#include "LatencyHistory/LatencyHistory.hpp"
+#include "LatencyScheduler/LatencyScheduler.hpp"
+#include "SubscriptionUpdater/SubscriptionUpdater.hpp"
+#include "UpdateScheduler/UpdateScheduler.hpp"
 #include "models/SettingsModels.hpp"
 #include "ui/windows/w_MainWindow.hpp"
 
@@ -142,6 +148,15 @@ Qv2rayExitReason Qv2rayApplication::RunQv2ray()
 
     StyleManager->ApplyStyle(GlobalConfig->appearanceConfig->UITheme);
 
+    // Warm up the geo data caches, so the route and DNS editors don't have to wait for them.
+    GeositeReader::ReadGeoSiteFromFileAsync(GlobalConfig->behaviorConfig->GeoSitePath);
+    GeositeReader::ReadGeoSiteFromFileAsync(GlobalConfig->behaviorConfig->GeoIPPath);
+
+    SubscriptionUpdater = new QvSubscriptionUpdater::QvSubscriptionUpdater;
+    UpdateScheduler = new QvUpdateScheduler::QvUpdateScheduler;
+    LatencyScheduler = new QvLatencyScheduler::QvLatencyScheduler;
+    LatencyHistory = new QvLatencyHistory::QvLatencyHistory;
+    AutoFailover = new QvAutoFailover::QvAutoFailover;
     hTray = new QSystemTrayIcon();
     mainWindow = new MainWindow();
 
@@ -193,6 +208,11 @@ void Qv2rayApplication::quitInternal()
 {
     delete mainWindow;
     delete hTray;
+    delete AutoFailover;
+    delete LatencyHistory;
+    delete LatencyScheduler;
+    delete UpdateScheduler;
+    delete SubscriptionUpdater;
     delete StyleManager;
     delete GUIPluginHost;
     SaveQv2raySettings();
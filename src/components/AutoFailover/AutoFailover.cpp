@@ -0,0 +1,102 @@
+#include "AutoFailover.hpp"
+
+#include "FailoverPolicy.hpp"
+#include "LatencyHistory/LatencyHistory.hpp"
+#include "LatencyScheduler/LatencyScheduler.hpp"
+#include "Qv2rayBase/Common/ProfileHelpers.hpp"
+#include "Qv2rayBase/Profile/KernelManager.hpp"
+#include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
+
+#define QV_MODULE_NAME "AutoFailover"
+
+namespace Qv2ray::components::QvAutoFailover
+{
+    QvAutoFailover::QvAutoFailover(QObject *parent) : QObject(parent)
+    {
+        testTimer.setInterval(TEST_INTERVAL_MSECS);
+        currentTestTimer.setInterval(CURRENT_TEST_INTERVAL_MSECS);
+        evaluateTimer.setSingleShot(true);
+        evaluateTimer.setInterval(EVALUATE_DELAY_MSECS);
+        connect(&testTimer, &QTimer::timeout, this, &QvAutoFailover::testGroup);
+        connect(&currentTestTimer, &QTimer::timeout, this, &QvAutoFailover::testCurrent);
+        connect(&evaluateTimer, &QTimer::timeout, this, &QvAutoFailover::evaluate);
+        // A group test reports one result after another, the decision waits for them to pause.
+        connect(LatencyHistory, &QvLatencyHistory::QvLatencyHistory::OnStatsUpdated, this,
+                [this](const ConnectionId &id)
+                {
+                    if (IsActive() && QvBaselib->ProfileManager()->GetGroups(id).contains(groupId))
+                        evaluateTimer.start();
+                });
+    }
+
+    void QvAutoFailover::Start(const GroupId &id, const LatencyTestEngineId &engine)
+    {
+        this->engine = engine;
+        if (IsActive() && groupId == id)
+            return;
+
+        QvLog() << "Following the fastest connection of group:" << id.toString();
+        const auto sameGroup = groupId == id;
+        groupId = id;
+        testTimer.start();
+        currentTestTimer.start();
+        if (!sameGroup || !lastTest.isValid() || lastTest.hasExpired(TEST_INTERVAL_MSECS))
+            testGroup();
+    }
+
+    void QvAutoFailover::Stop()
+    {
+        testTimer.stop();
+        currentTestTimer.stop();
+        evaluateTimer.stop();
+    }
+
+    ConnectionId QvAutoFailover::PickConnection(const GroupId &id, const ConnectionId &preferred)
+    {
+        if (const auto best = LatencyHistory->BestConnection(id); !best.isNull())
+            return best;
+        const auto connections = QvBaselib->ProfileManager()->GetConnections(id);
+        if (connections.contains(preferred))
+            return preferred;
+        return connections.isEmpty() ? ConnectionId{} : connections.first();
+    }
+
+    void QvAutoFailover::testGroup()
+    {
+        lastTest.start();
+        LatencyScheduler->Enqueue(groupId, engine);
+    }
+
+    void QvAutoFailover::testCurrent()
+    {
+        const auto current = QvBaselib->KernelManager()->CurrentConnection();
+        if (current.isNull() || current.groupId != groupId)
+            return;
+        // The group test has just covered it.
+        if (lastTest.isValid() && !lastTest.hasExpired(CURRENT_TEST_INTERVAL_MSECS))
+            return;
+        LatencyScheduler->Enqueue(QList{ current.connectionId }, engine);
+    }
+
+    void QvAutoFailover::evaluate()
+    {
+        const auto current = QvBaselib->KernelManager()->CurrentConnection();
+        if (current.isNull() || current.groupId != groupId)
+            return;
+
+        const auto best = LatencyHistory->BestConnection(groupId);
+        if (best.isNull() || best == current.connectionId)
+            return;
+
+        const auto currentScore = LatencyHistory->Score(current.connectionId);
+        const auto bestScore = LatencyHistory->Score(best);
+        const auto sinceSwitch = lastSwitch.isValid() ? lastSwitch.elapsed() : -1;
+        if (!FailoverPolicy::ShouldSwitch(LatencyHistory->Stats(current.connectionId), currentScore, bestScore, sinceSwitch))
+            return;
+
+        QvLog() << "Switching from" << GetDisplayName(current.connectionId) << "(" << currentScore << ") to" << GetDisplayName(best) << "(" << bestScore << ")";
+        lastSwitch.start();
+        QvBaselib->ProfileManager()->StartConnection({ best, groupId });
+    }
+} // namespace Qv2ray::components::QvAutoFailover
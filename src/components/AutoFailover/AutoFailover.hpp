@@ -0,0 +1,52 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+namespace Qv2ray::components::QvAutoFailover
+{
+    // Keeps the connection on the best server of a group.
+    //
+    // While started, the connections of the group are tested every TEST_INTERVAL_MSECS through LatencyScheduler, and the
+    // current connection every CURRENT_TEST_INTERVAL_MSECS, so that a failing one is noticed within a minute or so. Once
+    // the results settle the current connection is compared against the best one of LatencyHistory, and switched as
+    // FailoverPolicy decides.
+    class QvAutoFailover : public QObject
+    {
+        Q_OBJECT
+      public:
+        static constexpr auto TEST_INTERVAL_MSECS = 5 * 60 * 1000;
+        static constexpr auto CURRENT_TEST_INTERVAL_MSECS = 30 * 1000;
+        static constexpr auto EVALUATE_DELAY_MSECS = 2000;
+
+        explicit QvAutoFailover(QObject *parent = nullptr);
+        // Starting again for the same group keeps the test schedule.
+        void Start(const GroupId &id, const LatencyTestEngineId &engine);
+        void Stop();
+        bool IsActive() const
+        {
+            return testTimer.isActive();
+        }
+
+        // The connection to start for the group, the best scored one, or the first one when none has been tested.
+        static ConnectionId PickConnection(const GroupId &id, const ConnectionId &preferred = {});
+
+      private:
+        void testGroup();
+        void testCurrent();
+        void evaluate();
+
+        GroupId groupId;
+        LatencyTestEngineId engine;
+        QTimer testTimer;
+        QTimer currentTestTimer;
+        QTimer evaluateTimer;
+        QElapsedTimer lastTest;
+        QElapsedTimer lastSwitch;
+    };
+} // namespace Qv2ray::components::QvAutoFailover
+
+inline Qv2ray::components::QvAutoFailover::QvAutoFailover *AutoFailover = nullptr;
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "LatencyHistory/LatencyHistoryTable.hpp"
+
+namespace Qv2ray::components::QvAutoFailover
+{
+    // When QvAutoFailover leaves the current connection for the best scored one of its group.
+    //
+    // The current connection is left when it is failing: its last MAX_CONSECUTIVE_FAILURES tests failed, or its success
+    // rate is below MIN_SUCCESS_RATE. Otherwise it is left when the best one scores at least SWITCH_THRESHOLD better.
+    // Either way, never more often than every MIN_SWITCH_INTERVAL_MSECS, so that two servers of similar latency don't
+    // take turns.
+    namespace FailoverPolicy
+    {
+        constexpr auto MIN_SWITCH_INTERVAL_MSECS = 2 * 60 * 1000;
+        constexpr auto SWITCH_THRESHOLD = 0.3;
+        constexpr auto MIN_SUCCESS_RATE = 0.5;
+        constexpr auto MAX_CONSECUTIVE_FAILURES = 2;
+
+        inline bool IsFailing(const QvLatencyHistory::LatencyStats &stats)
+        {
+            return stats.consecutiveFailures >= MAX_CONSECUTIVE_FAILURES || (stats.samples > 0 && stats.successRate < MIN_SUCCESS_RATE);
+        }
+
+        // msecsSinceSwitch is negative when no switch has happened yet.
+        inline bool ShouldSwitch(const QvLatencyHistory::LatencyStats &current, double currentScore, double bestScore, qint64 msecsSinceSwitch)
+        {
+            if (msecsSinceSwitch >= 0 && msecsSinceSwitch < MIN_SWITCH_INTERVAL_MSECS)
+                return false;
+            return IsFailing(current) || bestScore * (1 + SWITCH_THRESHOLD) < currentScore;
+        }
+    } // namespace FailoverPolicy
+} // namespace Qv2ray::components::QvAutoFailover
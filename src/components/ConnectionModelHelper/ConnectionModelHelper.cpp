@@ -1,169 +1,589 @@
 #include "ConnectionModelHelper.hpp"
 
+#include "LatencyScheduler/LatencyScheduler.hpp"
 #include "Qv2rayBase/Common/ProfileHelpers.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Profile/KernelManager.hpp"
 #include "Qv2rayBase/Profile/ProfileManager.hpp"
 #include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
-#include "ui/widgets/ConnectionItemWidget.hpp"
+#include "UpdateScheduler/UpdateScheduler.hpp"
+#include "ui/widgets/ConnectionItemDelegate.hpp"
 
-const auto NumericString = [](auto i) { return QString("%1").arg(i, 30, 10, QLatin1Char('0')); };
+ConnectionListModel::ConnectionListModel(QObject *parent) : QAbstractItemModel(parent)
+{
+    flushUpdate = UpdateScheduler->AddUpdate(this, [this]() { flushUpdates(); });
+}
 
-ConnectionListHelper::ConnectionListHelper(QTreeView *view, QObject *parent) : QObject(parent)
+ConnectionListModel::~ConnectionListModel()
 {
-    parentView = view;
-    model = new QStandardItemModel();
-    view->setModel(model);
-    for (const auto &group : QvBaselib->ProfileManager()->GetGroups())
+    qDeleteAll(groups);
+}
+
+ConnectionListModel::GroupNode *ConnectionListModel::groupOf(const QModelIndex &index) const
+{
+    // Connection rows point to their group, group rows don't point to anything.
+    return static_cast<GroupNode *>(index.internalPointer());
+}
+
+int ConnectionListModel::groupRow(const GroupNode *group) const
+{
+    return groups.indexOf(const_cast<GroupNode *>(group));
+}
+
+void ConnectionListModel::reindex(GroupNode *group, int from)
+{
+    for (auto row = from; row < group->connections.size(); row++)
+        group->rows[group->connections[row].id] = row;
+}
+
+QModelIndex ConnectionListModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0)
+        return {};
+    if (!parent.isValid())
+        return row < groups.size() ? createIndex(row, 0, nullptr) : QModelIndex{};
+    if (groupOf(parent) || parent.row() >= groups.size())
+        return {};
+
+    const auto group = groups[parent.row()];
+    return row < group->connections.size() ? createIndex(row, 0, group) : QModelIndex{};
+}
+
+QModelIndex ConnectionListModel::parent(const QModelIndex &child) const
+{
+    const auto group = child.isValid() ? groupOf(child) : nullptr;
+    return group ? createIndex(groupRow(group), 0, nullptr) : QModelIndex{};
+}
+
+int ConnectionListModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+        return groups.size();
+    if (groupOf(parent) || parent.row() >= groups.size())
+        return 0;
+    return groups[parent.row()]->connections.size();
+}
+
+int ConnectionListModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+QVariant ConnectionListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return {};
+
+    if (const auto group = groupOf(index); group)
     {
-        addGroupItem(group);
-        for (const auto &connection : QvBaselib->ProfileManager()->GetConnections(group))
+        const auto &node = group->connections[index.row()];
+        switch (role)
         {
-            addConnectionItem({ connection, group });
+            case Qt::DisplayRole:
+                return (QvBaselib->ProfileManager()->IsConnected({ node.id, group->id }) ? QStringLiteral("● ") : QString{}) + node.name;
+            case Qt::EditRole:
+            case ROLE_DISPLAYNAME: return node.name;
+            case ROLE_LATENCY: return node.latency;
+            case ROLE_DATA_USAGE: return QVariant::fromValue(node.uplink + node.downlink);
+            case ROLE_IS_GROUP: return false;
+            case ROLE_STATUS_TEXT:
+            {
+                if (node.latencyTesting)
+                    return tr("Testing...");
+                if (node.latency == LATENCY_TEST_VALUE_NODATA)
+                    return tr("Not Tested");
+                if (node.latency == LATENCY_TEST_VALUE_ERROR)
+                    return tr("Error");
+                return QString::number(node.latency) + " ms";
+            }
+            case ROLE_DETAIL_TEXT:
+            {
+                if (node.protocol.isEmpty())
+                    node.protocol = GetConnectionProtocolDescription(node.id).toUpper();
+                return node.protocol;
+            }
+            case ROLE_USAGE_TEXT: return FormatBytes(node.uplink) + " / " + FormatBytes(node.downlink);
+            case Qt::ToolTipRole:
+            {
+                const auto conn = QvBaselib->ProfileManager()->GetConnectionObject(node.id);
+                return node.name + NEWLINE + tr("Last Connected: ") + TimeToString(conn.last_connected) + NEWLINE + tr("Last Updated: ") + TimeToString(conn.updated);
+            }
+            default: return {};
         }
     }
 
-    const auto renamedLambda = [&](const ConnectionId &id, const QString &, const QString &newName) {
-        for (const auto &gid : QvBaselib->ProfileManager()->GetGroups(id))
+    if (index.row() >= groups.size())
+        return {};
+    const auto group = groups[index.row()];
+    switch (role)
+    {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+        case ROLE_DISPLAYNAME: return group->name;
+        case ROLE_IS_GROUP: return true;
+        case ROLE_STATUS_TEXT:
         {
-            ProfileId pair{ id, gid };
-            if (pairs.contains(pair))
-                pairs[pair]->setData(newName, ROLE_DISPLAYNAME);
+            const auto connectionCount = group->connections.size();
+            return QString::number(connectionCount) + " " + (connectionCount < 2 ? tr("connection") : tr("connections"));
         }
-    };
-
-    const auto latencyLambda = [&](const ConnectionId &id, const int avg) {
-        for (const auto &gid : QvBaselib->ProfileManager()->GetGroups(id))
+        case Qt::ToolTipRole:
         {
-            ProfileId pair{ id, gid };
-            if (pairs.contains(pair))
-                pairs[pair]->setData(NumericString(avg), ROLE_LATENCY);
+            const auto grp = QvBaselib->ProfileManager()->GetGroupObject(group->id);
+            return group->name + NEWLINE +                                                               //
+                   (grp.subscription_config.isSubscription ? (tr("Subscription") + NEWLINE) : QString{}) + //
+                   tr("Last Updated: ") + TimeToString(grp.updated);
         }
-    };
+        default: return {};
+    }
+}
+
+bool ConnectionListModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    const auto group = index.isValid() ? groupOf(index) : nullptr;
+    const auto name = value.toString().trimmed();
+    if (!group || role != Qt::EditRole || name.isEmpty())
+        return false;
+    // The row is updated by the rename signal.
+    QvBaselib->ProfileManager()->RenameConnection(group->connections[index.row()].id, name);
+    return true;
+}
 
-    const auto statsLambda = [&](const ProfileId &id, const StatisticsObject &) {
-        if (connections.contains(id.connectionId))
+Qt::ItemFlags ConnectionListModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    const auto flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    return groupOf(index) ? flags | Qt::ItemIsEditable : flags;
+}
+
+void ConnectionListModel::sort(int, Qt::SortOrder order)
+{
+    // Nothing has been asked for yet, the view sorts once when it is attached.
+    if (sortRole == 0)
+        return;
+
+    const auto lessThan = [this](const ConnectionNode &a, const ConnectionNode &b)
+    {
+        switch (sortRole)
         {
-            for (const auto &index : connections[id.connectionId])
-                index->setData(NumericString(GetConnectionTotalUsage(id.connectionId, StatisticsObject::PROXY)), ROLE_DATA_USAGE);
+            case ROLE_LATENCY: return a.latency < b.latency;
+            case ROLE_DATA_USAGE: return a.uplink + a.downlink < b.uplink + b.downlink;
+            default: return QString::localeAwareCompare(a.name, b.name) < 0;
         }
     };
 
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnConnectionRemovedFromGroup, this, &ConnectionListHelper::OnConnectionDeleted);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnConnectionCreated, this, &ConnectionListHelper::OnConnectionCreated);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnConnectionLinkedWithGroup, this, &ConnectionListHelper::OnConnectionLinkedWithGroup);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnGroupCreated, this, &ConnectionListHelper::OnGroupCreated);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnGroupDeleted, this, &ConnectionListHelper::OnGroupDeleted);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnConnectionRenamed, renamedLambda);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnLatencyTestFinished, latencyLambda);
-    connect(QvBaselib->KernelManager(), &Qv2rayBase::Profile::KernelManager::OnStatsDataAvailable, statsLambda);
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    const auto persistentIndexes = persistentIndexList();
+    QList<ConnectionId> persistentConnections;
+    for (const auto &index : persistentIndexes)
+        persistentConnections << (groupOf(index) ? groupOf(index)->connections[index.row()].id : ConnectionId{});
+
+    for (const auto group : groups)
+    {
+        std::stable_sort(group->connections.begin(), group->connections.end(),
+                         [&](const ConnectionNode &a, const ConnectionNode &b) { return order == Qt::AscendingOrder ? lessThan(a, b) : lessThan(b, a); });
+        reindex(group);
+    }
+
+    QModelIndexList sortedIndexes;
+    for (auto i = 0; i < persistentIndexes.size(); i++)
+    {
+        const auto group = groupOf(persistentIndexes[i]);
+        sortedIndexes << (group ? createIndex(group->rows.value(persistentConnections[i]), 0, group) : persistentIndexes[i]);
+    }
+    changePersistentIndexList(persistentIndexes, sortedIndexes);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
 }
 
-ConnectionListHelper::~ConnectionListHelper()
+ProfileId ConnectionListModel::Identifier(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return {};
+    if (const auto group = groupOf(index); group)
+        return { group->connections[index.row()].id, group->id };
+    return index.row() < groups.size() ? ProfileId{ ConnectionId{}, groups[index.row()]->id } : ProfileId{};
+}
+
+QModelIndex ConnectionListModel::GroupIndex(const GroupId &id) const
 {
-    delete model;
+    const auto group = groupNodes.value(id);
+    return group ? createIndex(groupRow(group), 0, nullptr) : QModelIndex{};
 }
 
-void ConnectionListHelper::Sort(ConnectionInfoRole role, Qt::SortOrder order)
+QModelIndex ConnectionListModel::ConnectionIndex(const ProfileId &id) const
 {
-    model->setSortRole(role);
-    model->sort(0, order);
+    const auto group = groupNodes.value(id.groupId);
+    if (!group || !group->rows.contains(id.connectionId))
+        return {};
+    return createIndex(group->rows.value(id.connectionId), 0, group);
 }
 
-void ConnectionListHelper::Filter(const QString &key)
+bool ConnectionListModel::ContainsConnection(const ProfileId &id) const
+{
+    const auto group = groupNodes.value(id.groupId);
+    return group && group->rows.contains(id.connectionId);
+}
+
+void ConnectionListModel::AddGroup(const GroupId &id)
 {
-    for (const auto &groupId : QvBaselib->ProfileManager()->GetGroups())
+    if (groupNodes.contains(id))
+        return;
+    beginInsertRows({}, groups.size(), groups.size());
+    const auto group = new GroupNode{ id, GetDisplayName(id), {}, {} };
+    groups << group;
+    groupNodes.insert(id, group);
+    endInsertRows();
+}
+
+void ConnectionListModel::RemoveGroup(const GroupId &id)
+{
+    const auto group = groupNodes.value(id);
+    if (!group)
+        return;
+
+    const auto row = groupRow(group);
+    beginRemoveRows({}, row, row);
+    for (const auto &connection : group->connections)
+        connectionGroups[connection.id].removeAll(group);
+    groups.removeAt(row);
+    groupNodes.remove(id);
+    endRemoveRows();
+    delete group;
+}
+
+void ConnectionListModel::AddConnection(const ProfileId &id)
+{
+    if (ContainsConnection(id))
+        return;
+    AddGroup(id.groupId);
+
+    const auto group = groupNodes.value(id.groupId);
+    const auto groupIndex = GroupIndex(id.groupId);
+    const auto row = group->connections.size();
+    const auto [uplink, downlink] = GetConnectionUsageAmount(id.connectionId, StatisticsObject::PROXY);
+
+    beginInsertRows(groupIndex, row, row);
+    group->connections << ConnectionNode{ id.connectionId, GetDisplayName(id.connectionId), GetConnectionLatency(id.connectionId), false, uplink, downlink, {} };
+    group->rows.insert(id.connectionId, row);
+    connectionGroups[id.connectionId] << group;
+    endInsertRows();
+    emit dataChanged(groupIndex, groupIndex, { ROLE_STATUS_TEXT });
+}
+
+void ConnectionListModel::RemoveConnection(const ProfileId &id)
+{
+    const auto group = groupNodes.value(id.groupId);
+    if (!group || !group->rows.contains(id.connectionId))
+        return;
+
+    const auto groupIndex = GroupIndex(id.groupId);
+    const auto row = group->rows.value(id.connectionId);
+    beginRemoveRows(groupIndex, row, row);
+    group->connections.removeAt(row);
+    group->rows.remove(id.connectionId);
+    reindex(group, row);
+    connectionGroups[id.connectionId].removeAll(group);
+    if (connectionGroups[id.connectionId].isEmpty())
+        connectionGroups.remove(id.connectionId);
+    endRemoveRows();
+    emit dataChanged(groupIndex, groupIndex, { ROLE_STATUS_TEXT });
+}
+
+void ConnectionListModel::SyncGroup(const GroupId &id)
+{
+    AddGroup(id);
+    const auto group = groupNodes.value(id);
+    const auto groupIndex = GroupIndex(id);
+    const auto current = QvBaselib->ProfileManager()->GetConnections(id);
+    const QSet<ConnectionId> currentSet{ current.begin(), current.end() };
+
+    // Removed rows are taken out one contiguous run at a time, from the end so that the rows before stay valid.
+    for (auto last = group->connections.size() - 1; last >= 0; last--)
     {
-        const auto groupItem = model->indexFromItem(groups[groupId]);
-        bool isTotallyHide = true;
-        for (const auto &connectionId : QvBaselib->ProfileManager()->GetConnections(groupId))
+        if (currentSet.contains(group->connections[last].id))
+            continue;
+        auto first = last;
+        while (first > 0 && !currentSet.contains(group->connections[first - 1].id))
+            first--;
+
+        beginRemoveRows(groupIndex, first, last);
+        for (auto row = first; row <= last; row++)
         {
-            const auto connectionItem = model->indexFromItem(pairs[{ connectionId, groupId }]);
-            const auto willTotallyHide = static_cast<ConnectionItemWidget *>(parentView->indexWidget(connectionItem))->NameMatched(key);
-            parentView->setRowHidden(connectionItem.row(), connectionItem.parent(), !willTotallyHide);
-            isTotallyHide &= willTotallyHide;
+            const auto &connectionId = group->connections[row].id;
+            group->rows.remove(connectionId);
+            connectionGroups[connectionId].removeAll(group);
+            if (connectionGroups[connectionId].isEmpty())
+                connectionGroups.remove(connectionId);
         }
-        parentView->indexWidget(groupItem)->setHidden(isTotallyHide);
-        if (!isTotallyHide)
-            parentView->expand(groupItem);
+        group->connections.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first;
     }
+    reindex(group);
+
+    QList<ConnectionId> added;
+    for (const auto &connectionId : current)
+        if (!group->rows.contains(connectionId))
+            added << connectionId;
+
+    if (!added.isEmpty())
+    {
+        const auto first = group->connections.size();
+        beginInsertRows(groupIndex, first, first + added.size() - 1);
+        for (const auto &connectionId : added)
+        {
+            const auto [uplink, downlink] = GetConnectionUsageAmount(connectionId, StatisticsObject::PROXY);
+            group->connections << ConnectionNode{ connectionId, GetDisplayName(connectionId), GetConnectionLatency(connectionId), false, uplink, downlink, {} };
+            connectionGroups[connectionId] << group;
+        }
+        reindex(group, first);
+        endInsertRows();
+    }
+    emit dataChanged(groupIndex, groupIndex, { ROLE_STATUS_TEXT });
 }
 
-QStandardItem *ConnectionListHelper::addConnectionItem(const ProfileId &id)
-{
-    // Create Standard Item
-    auto connectionItem = new QStandardItem();
-    connectionItem->setData(GetDisplayName(id.connectionId), ConnectionInfoRole::ROLE_DISPLAYNAME);
-    connectionItem->setData(NumericString(GetConnectionLatency(id.connectionId)), ConnectionInfoRole::ROLE_LATENCY);
-    connectionItem->setData(NumericString(GetConnectionTotalUsage(id.connectionId, StatisticsObject::PROXY)), ConnectionInfoRole::ROLE_DATA_USAGE);
-    //
-    // Find groups
-    const auto groupIndex = groups.contains(id.groupId) ? groups[id.groupId] : addGroupItem(id.groupId);
-    // Append into model
-    groupIndex->appendRow(connectionItem);
-    const auto connectionIndex = connectionItem->index();
-    //
-    auto widget = new ConnectionItemWidget(id);
-    connect(widget, &ConnectionItemWidget::RequestWidgetFocus, [this, connectionIndex]() {
-        parentView->setCurrentIndex(connectionIndex);
-        parentView->scrollTo(connectionIndex);
-        emit parentView->clicked(connectionIndex);
-    });
-
-    parentView->setIndexWidget(connectionIndex, widget);
-    pairs[id] = connectionItem;
-    connections[id.connectionId].append(connectionItem);
-    return connectionItem;
-}
-
-QStandardItem *ConnectionListHelper::addGroupItem(const GroupId &groupId)
-{
-    // Create Item
-    const auto item = new QStandardItem();
-    // Set item into model
-    model->appendRow(item);
-    // Get item index
-    const auto index = item->index();
-    parentView->setIndexWidget(index, new ConnectionItemWidget(groupId, parentView));
-    groups[groupId] = item;
-    return item;
+template<typename F>
+void ConnectionListModel::applyToConnection(const ConnectionId &id, const QList<int> &roles, F func)
+{
+    for (const auto group : connectionGroups.value(id))
+    {
+        if (const auto row = group->rows.value(id, -1); row >= 0)
+            func(group->connections[row]);
+    }
+
+    auto &changedRoles = changedConnections[id];
+    for (const auto role : roles)
+        if (!changedRoles.contains(role))
+            changedRoles << role;
 }
 
-void ConnectionListHelper::OnConnectionCreated(const ProfileId &id, const QString &)
+template<typename F>
+void ConnectionListModel::updateConnection(const ConnectionId &id, const QList<int> &roles, F func)
 {
-    addConnectionItem(id);
+    applyToConnection(id, roles, func);
+    UpdateScheduler->MarkDirty(flushUpdate);
 }
 
-void ConnectionListHelper::OnConnectionDeleted(const ProfileId &id)
+void ConnectionListModel::emitConnectionChanged(const ConnectionId &id, const QList<int> &roles)
 {
-    auto item = pairs.take(id);
-    const auto index = model->indexFromItem(item);
-    if (!index.isValid())
+    // The rows are looked up now, they may have moved since the change was recorded.
+    for (const auto group : connectionGroups.value(id))
+    {
+        const auto row = group->rows.value(id, -1);
+        if (row < 0)
+            continue;
+        const auto index = createIndex(row, 0, group);
+        emit dataChanged(index, index, roles);
+    }
+}
+
+void ConnectionListModel::flushUpdates()
+{
+    // Each connection is read once, however many stats arrived for it since the last flush.
+    for (const auto &id : std::exchange(staleUsages, {}))
+    {
+        const auto [uplink, downlink] = GetConnectionUsageAmount(id, StatisticsObject::PROXY);
+        applyToConnection(id, { ROLE_DATA_USAGE, ROLE_USAGE_TEXT },
+                          [uplink = uplink, downlink = downlink](ConnectionNode &node)
+                          {
+                              node.uplink = uplink;
+                              node.downlink = downlink;
+                          });
+    }
+
+    const auto changed = std::exchange(changedConnections, {});
+    for (auto it = changed.constBegin(); it != changed.constEnd(); it++)
+        emitConnectionChanged(it.key(), it.value());
+}
+
+void ConnectionListModel::SetConnectionName(const ConnectionId &id, const QString &name)
+{
+    // Shown right away, the name was usually just edited in place.
+    applyToConnection(id, { Qt::DisplayRole, Qt::EditRole, ROLE_DISPLAYNAME, Qt::ToolTipRole }, [&name](ConnectionNode &node) { node.name = name; });
+    emitConnectionChanged(id, changedConnections.take(id));
+}
+
+void ConnectionListModel::SetGroupName(const GroupId &id, const QString &name)
+{
+    const auto group = groupNodes.value(id);
+    if (!group)
         return;
-    model->removeRow(index.row(), index.parent());
-    connections[id.connectionId].removeAll(item);
+    group->name = name;
+    const auto index = GroupIndex(id);
+    emit dataChanged(index, index, { Qt::DisplayRole, Qt::EditRole, ROLE_DISPLAYNAME, Qt::ToolTipRole });
+}
+
+void ConnectionListModel::SetLatency(const ConnectionId &id, int latency)
+{
+    updateConnection(id, { ROLE_LATENCY, ROLE_STATUS_TEXT },
+                     [latency](ConnectionNode &node)
+                     {
+                         node.latency = latency;
+                         node.latencyTesting = false;
+                     });
+}
+
+void ConnectionListModel::SetLatencyTesting(const ConnectionId &id)
+{
+    updateConnection(id, { ROLE_STATUS_TEXT }, [](ConnectionNode &node) { node.latencyTesting = true; });
+}
+
+void ConnectionListModel::InvalidateUsage(const ConnectionId &id)
+{
+    staleUsages.insert(id);
+    UpdateScheduler->MarkDirty(flushUpdate);
+}
+
+void ConnectionListModel::InvalidateConnection(const ConnectionId &id)
+{
+    updateConnection(id, { ROLE_DETAIL_TEXT }, [](ConnectionNode &node) { node.protocol.clear(); });
+}
+
+void ConnectionListModel::RefreshConnection(const ProfileId &id)
+{
+    const auto index = ConnectionIndex(id);
+    if (index.isValid())
+        emit dataChanged(index, index, { Qt::DisplayRole });
+}
+
+ConnectionFilterProxyModel::ConnectionFilterProxyModel(QObject *parent) : QSortFilterProxyModel(parent)
+{
+    setRecursiveFilteringEnabled(true);
+}
+
+void ConnectionFilterProxyModel::SetSearchResult(const SearchResult &searchResult)
+{
+    result = searchResult;
+    invalidateFilter();
+}
+
+void ConnectionFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+    sourceModel()->sort(column, order);
+}
+
+bool ConnectionFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (result.matchesAll)
+        return true;
+    const auto model = static_cast<ConnectionListModel *>(sourceModel());
+    const auto id = model->Identifier(model->index(sourceRow, 0, sourceParent));
+    // All connections of a group whose name matches are shown.
+    return result.groups.contains(id.groupId) || (!id.connectionId.isNull() && result.connections.contains(id.connectionId));
+}
+
+ConnectionListHelper::ConnectionListHelper(QTreeView *view, QObject *parent) : QObject(parent)
+{
+    parentView = view;
+    model = new ConnectionListModel(this);
+    // Filled before being attached, so that no view sees the rows one at a time.
+    for (const auto &group : QvBaselib->ProfileManager()->GetGroups())
+    {
+        model->AddGroup(group);
+        for (const auto &connection : QvBaselib->ProfileManager()->GetConnections(group))
+            model->AddConnection({ connection, group });
+    }
+    proxyModel = new ConnectionFilterProxyModel(this);
+    proxyModel->setSourceModel(model);
+    view->setModel(proxyModel);
+    view->setItemDelegate(new ConnectionItemDelegate(view));
+    // Every row has the same height, the view doesn't have to measure all of them to lay out the scroll bar.
+    view->setUniformRowHeights(true);
+
+    const auto profileManager = QvBaselib->ProfileManager();
+    const auto kernelManager = QvBaselib->KernelManager();
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionRemovedFromGroup, this, &ConnectionListHelper::OnConnectionDeleted);
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionCreated, this, &ConnectionListHelper::OnConnectionCreated);
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionLinkedWithGroup, this, &ConnectionListHelper::OnConnectionLinkedWithGroup);
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnGroupCreated, model, [this](const GroupId &id) { model->AddGroup(id); });
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnGroupDeleted, model, [this](const GroupId &id) { model->RemoveGroup(id); });
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionRenamed, model,
+            [this](const ConnectionId &id, const QString &, const QString &newName) { model->SetConnectionName(id, newName); });
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnGroupRenamed, model,
+            [this](const GroupId &id, const QString &, const QString &newName) { model->SetGroupName(id, newName); });
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionModified, model, [this](const ConnectionId &id) { model->InvalidateConnection(id); });
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnLatencyTestStarted, model, [this](const ConnectionId &id) { model->SetLatencyTesting(id); });
+    connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnLatencyTestFinished, model,
+            [this](const ConnectionId &id, const int average) { model->SetLatency(id, average); });
+    connect(LatencyScheduler, &Qv2ray::components::QvLatencyScheduler::QvLatencyScheduler::OnTestAbandoned, model,
+            [this](const ConnectionId &id) { model->SetLatency(id, LATENCY_TEST_VALUE_ERROR); });
+    connect(kernelManager, &Qv2rayBase::Profile::KernelManager::OnStatsDataAvailable, model, [this](const ProfileId &id) { model->InvalidateUsage(id.connectionId); });
+    connect(kernelManager, &Qv2rayBase::Profile::KernelManager::OnConnected, model, [this](const ProfileId &id) { model->RefreshConnection(id); });
+    connect(kernelManager, &Qv2rayBase::Profile::KernelManager::OnDisconnected, model, [this](const ProfileId &id) { model->RefreshConnection(id); });
+
+    searcher = new ConnectionSearcher(this);
+    connect(searcher, &ConnectionSearcher::OnSearchFinished, this, &ConnectionListHelper::OnSearchFinished);
+}
+
+ConnectionListHelper::~ConnectionListHelper()
+{
 }
 
-void ConnectionListHelper::OnConnectionLinkedWithGroup(const ProfileId &pairId)
+void ConnectionListHelper::Sort(ConnectionInfoRole role, Qt::SortOrder order)
 {
-    addConnectionItem(pairId);
+    model->setSortRole(role);
+    model->sort(0, order);
 }
 
-void ConnectionListHelper::OnGroupCreated(const GroupId &id, const QString &)
+void ConnectionListHelper::Filter(const QString &key)
 {
-    addGroupItem(id);
+    searcher->Search(key);
 }
 
-void ConnectionListHelper::OnGroupDeleted(const GroupId &id, const QList<ConnectionId> &connections)
+void ConnectionListHelper::OnSearchFinished(const SearchResult &result)
 {
-    for (const auto &conn : connections)
+    proxyModel->SetSearchResult(result);
+    // Searching again after the connections changed keeps the groups the user collapsed since.
+    if (result.query != appliedQuery)
+        parentView->expandAll();
+    appliedQuery = result.query;
+}
+
+QList<ConnectionId> ConnectionListHelper::GetVisibleConnections() const
+{
+    QList<ConnectionId> connections;
+    const auto viewportRect = parentView->viewport()->rect();
+    for (auto index = parentView->indexAt(viewportRect.topLeft()); index.isValid(); index = parentView->indexBelow(index))
     {
-        const ProfileId pair{ conn, id };
-        OnConnectionDeleted(pair);
+        if (parentView->visualRect(index).top() > viewportRect.bottom())
+            break;
+        if (const auto id = GetIdentifier(index); !id.connectionId.isNull())
+            connections << id.connectionId;
     }
-    const auto item = groups.take(id);
-    const auto index = model->indexFromItem(item);
-    if (!index.isValid())
+    return connections;
+}
+
+void ConnectionListHelper::BeginGroupUpdate(const GroupId &id)
+{
+    updatingGroups.insert(id);
+}
+
+void ConnectionListHelper::EndGroupUpdate(const GroupId &id)
+{
+    if (!updatingGroups.remove(id))
+        return;
+    model->SyncGroup(id);
+}
+
+void ConnectionListHelper::OnConnectionCreated(const ProfileId &id, const QString &)
+{
+    if (updatingGroups.contains(id.groupId))
+        return;
+    model->AddConnection(id);
+}
+
+void ConnectionListHelper::OnConnectionDeleted(const ProfileId &id)
+{
+    if (updatingGroups.contains(id.groupId))
+        return;
+    model->RemoveConnection(id);
+}
+
+void ConnectionListHelper::OnConnectionLinkedWithGroup(const ProfileId &id)
+{
+    if (updatingGroups.contains(id.groupId))
         return;
-    model->removeRow(index.row(), index.parent());
+    model->AddConnection(id);
 }
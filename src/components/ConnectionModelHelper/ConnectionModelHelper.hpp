@@ -1,9 +1,10 @@
 #pragma once
 
+#include "ConnectionSearch/ConnectionSearch.hpp"
 #include "QvPlugin/PluginInterface.hpp"
 
-#include <QStandardItem>
-#include <QStandardItemModel>
+#include <QAbstractItemModel>
+#include <QSortFilterProxyModel>
 #include <QTreeView>
 
 namespace Qv2ray::ui::widgets::models
@@ -15,7 +16,125 @@ namespace Qv2ray::ui::widgets::models
         ROLE_LATENCY,
         ROLE_IMPORTTIME,
         ROLE_LAST_CONNECTED_TIME,
-        ROLE_DATA_USAGE
+        ROLE_DATA_USAGE,
+        // Texts painted by ConnectionItemDelegate, only computed for visible rows.
+        ROLE_STATUS_TEXT,
+        ROLE_DETAIL_TEXT,
+        ROLE_USAGE_TEXT,
+        ROLE_IS_GROUP
+    };
+
+    // Groups and their connections, as a two level tree.
+    //
+    // Each row is a small value in its group's list, everything else (protocol descriptions, formatted texts, tooltips)
+    // is computed when a view asks for it, which a delegate only does for the rows it paints.
+    //
+    // Latency and usage changes are only recorded, the rows are announced as changed by the next flush of UpdateScheduler.
+    class ConnectionListModel : public QAbstractItemModel
+    {
+        Q_OBJECT
+      public:
+        explicit ConnectionListModel(QObject *parent = nullptr);
+        ~ConnectionListModel();
+
+        QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+        QModelIndex parent(const QModelIndex &child) const override;
+        int rowCount(const QModelIndex &parent = {}) const override;
+        int columnCount(const QModelIndex &parent = {}) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+        Qt::ItemFlags flags(const QModelIndex &index) const override;
+        // Sorts the connections of each group by sortRole, groups keep their order.
+        void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+        void setSortRole(int role)
+        {
+            sortRole = role;
+        }
+
+        // The identifier of a row, the connection ID is null for groups.
+        ProfileId Identifier(const QModelIndex &index) const;
+        QModelIndex GroupIndex(const GroupId &id) const;
+        QModelIndex ConnectionIndex(const ProfileId &id) const;
+        bool ContainsConnection(const ProfileId &id) const;
+
+        void AddGroup(const GroupId &id);
+        void RemoveGroup(const GroupId &id);
+        void AddConnection(const ProfileId &id);
+        void RemoveConnection(const ProfileId &id);
+        // Adds and removes rows of the group so that they match the connections of the group.
+        void SyncGroup(const GroupId &id);
+
+        void SetConnectionName(const ConnectionId &id, const QString &name);
+        void SetGroupName(const GroupId &id, const QString &name);
+        void SetLatency(const ConnectionId &id, int latency);
+        void SetLatencyTesting(const ConnectionId &id);
+        // The usage is read again by the next flush.
+        void InvalidateUsage(const ConnectionId &id);
+        // Drops cached texts of the connection, after its content changed.
+        void InvalidateConnection(const ConnectionId &id);
+        // Repaints the rows of a connection, after it was connected or disconnected.
+        void RefreshConnection(const ProfileId &id);
+
+      private:
+        struct ConnectionNode
+        {
+            ConnectionId id;
+            QString name;
+            int latency;
+            bool latencyTesting = false;
+            quint64 uplink = 0;
+            quint64 downlink = 0;
+            // Filled when first painted.
+            mutable QString protocol;
+        };
+
+        struct GroupNode
+        {
+            GroupId id;
+            QString name;
+            QList<ConnectionNode> connections;
+            QHash<ConnectionId, int> rows;
+        };
+
+        GroupNode *groupOf(const QModelIndex &index) const;
+        int groupRow(const GroupNode *group) const;
+        void reindex(GroupNode *group, int from = 0);
+        // Calls func for each row of a connection, and records the roles as changed.
+        template<typename F>
+        void applyToConnection(const ConnectionId &id, const QList<int> &roles, F func);
+        // The same, then asks for a flush.
+        template<typename F>
+        void updateConnection(const ConnectionId &id, const QList<int> &roles, F func);
+        void emitConnectionChanged(const ConnectionId &id, const QList<int> &roles);
+        void flushUpdates();
+
+        QList<GroupNode *> groups;
+        QHash<GroupId, GroupNode *> groupNodes;
+        // Groups a connection has rows in.
+        QHash<ConnectionId, QList<GroupNode *>> connectionGroups;
+        int sortRole = 0;
+
+        int flushUpdate;
+        QHash<ConnectionId, QList<int>> changedConnections;
+        QSet<ConnectionId> staleUsages;
+    };
+
+    // Hides the rows not in the latest search result, a group stays visible as long as one of its connections does.
+    class ConnectionFilterProxyModel : public QSortFilterProxyModel
+    {
+        Q_OBJECT
+      public:
+        explicit ConnectionFilterProxyModel(QObject *parent = nullptr);
+        // Filters all rows again, once.
+        void SetSearchResult(const SearchResult &result);
+        // ConnectionListModel sorts itself, the proxy keeps its order.
+        void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+      protected:
+        bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+      private:
+        SearchResult result;
     };
 
     class ConnectionListHelper : public QObject
@@ -25,34 +144,45 @@ namespace Qv2ray::ui::widgets::models
         ConnectionListHelper(QTreeView *parentView, QObject *parent = nullptr);
         ~ConnectionListHelper();
         void Sort(ConnectionInfoRole, Qt::SortOrder);
+        // Searches on a worker thread, the rows are filtered once the result arrives.
         void Filter(const QString &);
 
+        // Connections created in or removed from the group are ignored until EndGroupUpdate, which then syncs all rows
+        // of the group at once.
+        void BeginGroupUpdate(const GroupId &id);
+        void EndGroupUpdate(const GroupId &id);
+
         inline QModelIndex GetConnectionPairIndex(const ProfileId &id) const
         {
-            return model->indexFromItem(pairs.value(id));
+            return proxyModel->mapFromSource(model->ConnectionIndex(id));
         }
 
         inline QModelIndex GetGroupIndex(const GroupId &id) const
         {
-            return model->indexFromItem(groups[id]);
+            return proxyModel->mapFromSource(model->GroupIndex(id));
+        }
+
+        // Connections of the rows currently on screen, from top to bottom.
+        QList<ConnectionId> GetVisibleConnections() const;
+
+        inline ProfileId GetIdentifier(const QModelIndex &index) const
+        {
+            return model->Identifier(proxyModel->mapToSource(index));
         }
 
       private:
-        QStandardItem *addConnectionItem(const ProfileId &id);
-        QStandardItem *addGroupItem(const GroupId &groupId);
-        void OnGroupCreated(const GroupId &id, const QString &displayName);
-        void OnGroupDeleted(const GroupId &id, const QList<ConnectionId> &connections);
         void OnConnectionCreated(const ProfileId &Id, const QString &displayName);
         void OnConnectionDeleted(const ProfileId &Id);
         void OnConnectionLinkedWithGroup(const ProfileId &id);
+        void OnSearchFinished(const SearchResult &result);
 
       private:
         QTreeView *parentView;
-        QStandardItemModel *model;
-
-        QHash<GroupId, QStandardItem *> groups;
-        QHash<ProfileId, QStandardItem *> pairs;
-        QHash<ConnectionId, QList<QStandardItem *>> connections;
+        ConnectionListModel *model;
+        ConnectionFilterProxyModel *proxyModel;
+        ConnectionSearcher *searcher;
+        QString appliedQuery;
+        QSet<GroupId> updatingGroups;
     };
 
 } // namespace Qv2ray::ui::widgets::models
@@ -0,0 +1,223 @@
+#include "ConnectionSearch.hpp"
+
+#include "Qv2rayBase/Common/ProfileHelpers.hpp"
+#include "Qv2rayBase/Common/Utils.hpp"
+#include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
+
+#include <QRegularExpression>
+#include <QtConcurrent>
+#include <vector>
+
+#define QV_MODULE_NAME "ConnectionSearch"
+
+namespace Qv2ray::components::QvConnectionSearch
+{
+    constexpr auto REFRESH_DELAY_MSECS = 300;
+
+    QList<quint64> DistinctTrigrams(const QString &text)
+    {
+        QList<quint64> trigrams;
+        for (auto i = 0; i + 3 <= text.size(); i++)
+            trigrams << (quint64(text[i].unicode()) << 32 | quint64(text[i + 1].unicode()) << 16 | text[i + 2].unicode());
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        return trigrams;
+    }
+
+    ConnectionSearchIndex::ConnectionSearchIndex(QList<SearchDocument> documents) : documents(std::move(documents))
+    {
+        texts.reserve(this->documents.size());
+        for (const auto &document : this->documents)
+        {
+            // Terms can't contain a newline, so they never match across two fields.
+            texts << document.name.toCaseFolded() + '\n' + document.host.toCaseFolded() + '\n' + document.protocol.toCaseFolded();
+            for (const auto trigram : DistinctTrigrams(texts.last()))
+                postings[trigram] << texts.size() - 1;
+        }
+    }
+
+    SearchResult ConnectionSearchIndex::Query(const QString &query) const
+    {
+        SearchResult result;
+        result.query = query;
+        // Split on any whitespace, so that a pasted newline never makes a term spanning two fields.
+        const auto terms = query.toCaseFolded().split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+        if (terms.isEmpty())
+            return result;
+        result.matchesAll = false;
+
+        std::vector<bool> candidates(texts.size(), true);
+        std::vector<int> counts(texts.size());
+        for (const auto &term : terms)
+        {
+            const auto trigrams = DistinctTrigrams(term);
+            std::fill(counts.begin(), counts.end(), 0);
+            for (const auto trigram : trigrams)
+                for (const auto document : postings.value(trigram))
+                    counts[document]++;
+
+            // Containing every trigram of the term is necessary, but the term still has to be found in the text.
+            std::vector<bool> matched(texts.size(), false);
+            auto hasExactMatch = false;
+            for (size_t i = 0; i < matched.size(); i++)
+            {
+                if (candidates[i] && counts[i] == trigrams.size() && texts[i].contains(term))
+                    matched[i] = hasExactMatch = true;
+            }
+
+            if (!hasExactMatch && term.size() >= FUZZY_MIN_LENGTH)
+            {
+                const auto required = (trigrams.size() + 1) / 2;
+                for (size_t i = 0; i < matched.size(); i++)
+                    matched[i] = candidates[i] && counts[i] >= required;
+            }
+            candidates = std::move(matched);
+        }
+
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            if (!candidates[i])
+                continue;
+            if (documents[i].connectionId.isNull())
+                result.groups << documents[i].groupId;
+            else
+                result.connections << documents[i].connectionId;
+        }
+        return result;
+    }
+
+    ConnectionSearcher::ConnectionSearcher(QObject *parent) : QObject(parent)
+    {
+        refreshTimer.setSingleShot(true);
+        refreshTimer.setInterval(REFRESH_DELAY_MSECS);
+        connect(&refreshTimer, &QTimer::timeout, this, &ConnectionSearcher::startSearch);
+
+        connect(&watcher, &QFutureWatcher<SearchTask>::finished, this,
+                [this]()
+                {
+                    const auto [builtIndex, result] = watcher.result();
+                    if (runningVersion == documentsVersion)
+                        index = builtIndex;
+                    // A result for an older query would only be replaced right away.
+                    if (result.query == currentQuery)
+                        emit OnSearchFinished(result);
+                    if (hasPendingSearch)
+                        startSearch();
+                });
+
+        const auto profileManager = QvBaselib->ProfileManager();
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionCreated, this, [this](const ProfileId &id) { updateConnection(id.connectionId); });
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionLinkedWithGroup, this, [this](const ProfileId &id) { updateConnection(id.connectionId); });
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionRenamed, this, &ConnectionSearcher::updateConnection);
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionModified, this, &ConnectionSearcher::updateConnection);
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnConnectionRemovedFromGroup, this,
+                [this](const ProfileId &id)
+                {
+                    if (!documentsLoaded || !QvBaselib->ProfileManager()->GetGroups(id.connectionId).isEmpty())
+                        return;
+                    connectionDocuments.remove(id.connectionId);
+                    invalidate();
+                });
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnGroupCreated, this, &ConnectionSearcher::updateGroup);
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnGroupRenamed, this, &ConnectionSearcher::updateGroup);
+        connect(profileManager, &Qv2rayBase::Profile::ProfileManager::OnGroupDeleted, this,
+                [this](const GroupId &id)
+                {
+                    if (!documentsLoaded)
+                        return;
+                    groupDocuments.remove(id);
+                    invalidate();
+                });
+    }
+
+    void ConnectionSearcher::Search(const QString &query)
+    {
+        currentQuery = query;
+        if (query.trimmed().isEmpty())
+        {
+            // Nothing to look up, any search still running is for an older query.
+            SearchResult result;
+            result.query = query;
+            emit OnSearchFinished(result);
+            return;
+        }
+        loadDocuments();
+        startSearch();
+    }
+
+    void ConnectionSearcher::loadDocuments()
+    {
+        if (documentsLoaded)
+            return;
+        documentsLoaded = true;
+        for (const auto &group : QvBaselib->ProfileManager()->GetGroups())
+        {
+            updateGroup(group);
+            for (const auto &connection : QvBaselib->ProfileManager()->GetConnections(group))
+                if (!connectionDocuments.contains(connection))
+                    updateConnection(connection);
+        }
+        QvLog() << "Loaded" << connectionDocuments.size() << "connections and" << groupDocuments.size() << "groups for searching.";
+    }
+
+    void ConnectionSearcher::updateConnection(const ConnectionId &id)
+    {
+        if (!documentsLoaded)
+            return;
+
+        SearchDocument document;
+        document.connectionId = id;
+        document.name = GetDisplayName(id);
+        document.protocol = GetConnectionProtocolDescription(id);
+        const auto root = QvBaselib->ProfileManager()->GetConnection(id);
+        if (!root.outbounds.isEmpty())
+            document.host = std::get<1>(GetOutboundInfo(root.outbounds.first()));
+        connectionDocuments.insert(id, document);
+        invalidate();
+    }
+
+    void ConnectionSearcher::updateGroup(const GroupId &id)
+    {
+        if (!documentsLoaded)
+            return;
+
+        SearchDocument document;
+        document.groupId = id;
+        document.name = GetDisplayName(id);
+        groupDocuments.insert(id, document);
+        invalidate();
+    }
+
+    void ConnectionSearcher::invalidate()
+    {
+        documentsVersion++;
+        index.reset();
+        if (!currentQuery.trimmed().isEmpty())
+            refreshTimer.start();
+    }
+
+    void ConnectionSearcher::startSearch()
+    {
+        if (watcher.isRunning())
+        {
+            hasPendingSearch = true;
+            return;
+        }
+        hasPendingSearch = false;
+        refreshTimer.stop();
+
+        // Without an index, the worker builds one from a copy of the documents, which only shares their strings.
+        QList<SearchDocument> documents;
+        if (!index)
+            documents = connectionDocuments.values() + groupDocuments.values();
+
+        runningVersion = documentsVersion;
+        watcher.setFuture(QtConcurrent::run(
+            [documents, searchIndex = index, query = currentQuery]() -> SearchTask
+            {
+                const auto builtIndex = searchIndex ? searchIndex : std::make_shared<const ConnectionSearchIndex>(documents);
+                return { builtIndex, builtIndex->Query(query) };
+            }));
+    }
+} // namespace Qv2ray::components::QvConnectionSearch
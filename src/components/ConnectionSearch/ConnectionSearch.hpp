@@ -0,0 +1,91 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <memory>
+
+namespace Qv2ray::components::QvConnectionSearch
+{
+    // A connection or a group, as seen by the search. Only one of the IDs is set.
+    struct SearchDocument
+    {
+        ConnectionId connectionId;
+        GroupId groupId;
+        QString name;
+        QString host;
+        QString protocol;
+    };
+
+    struct SearchResult
+    {
+        QString query;
+        // An empty query matches everything, the sets are left empty then.
+        bool matchesAll = true;
+        QSet<ConnectionId> connections;
+        QSet<GroupId> groups;
+    };
+
+    // An immutable index over the case folded names, hosts and protocols of documents, with the documents containing
+    // each trigram.
+    //
+    // A query is split on whitespace into terms, each of which must match. A term matches the documents containing it.
+    // If none does, a term of at least FUZZY_MIN_LENGTH characters matches the documents sharing at least half of its
+    // trigrams, which tolerates a typo or a missing character.
+    class ConnectionSearchIndex
+    {
+      public:
+        static constexpr auto FUZZY_MIN_LENGTH = 4;
+
+        explicit ConnectionSearchIndex(QList<SearchDocument> documents);
+        SearchResult Query(const QString &query) const;
+
+      private:
+        QList<SearchDocument> documents;
+        QList<QString> texts;
+        QHash<quint64, QList<int>> postings;
+    };
+
+    // Keeps a document for every connection and group, and runs queries on a worker thread.
+    //
+    // Documents are only loaded by the first search, and the index is rebuilt by the next query after they changed.
+    // Only one query runs at a time, queries made meanwhile replace each other and only the latest one is run next.
+    class ConnectionSearcher : public QObject
+    {
+        Q_OBJECT
+      public:
+        explicit ConnectionSearcher(QObject *parent = nullptr);
+        void Search(const QString &query);
+
+      signals:
+        void OnSearchFinished(const SearchResult &result);
+
+      private:
+        void loadDocuments();
+        void updateConnection(const ConnectionId &id);
+        void updateGroup(const GroupId &id);
+        void invalidate();
+        void startSearch();
+
+        using SearchTask = std::pair<std::shared_ptr<const ConnectionSearchIndex>, SearchResult>;
+        QFutureWatcher<SearchTask> watcher;
+        // Delays searching again after the documents changed, subscription updates change a lot of them at once.
+        QTimer refreshTimer;
+
+        bool documentsLoaded = false;
+        QHash<ConnectionId, SearchDocument> connectionDocuments;
+        QHash<GroupId, SearchDocument> groupDocuments;
+        // Incremented on each change of the documents, so that an index built from older documents isn't kept.
+        quint64 documentsVersion = 0;
+        quint64 runningVersion = 0;
+        std::shared_ptr<const ConnectionSearchIndex> index;
+
+        QString currentQuery;
+        bool hasPendingSearch = false;
+    };
+} // namespace Qv2ray::components::QvConnectionSearch
+
+using namespace Qv2ray::components::QvConnectionSearch;
@@ -0,0 +1,496 @@
+#include "GeoIPMatcher.hpp"
+
+#include "GeositeReader.hpp"
+#include "Qv2rayBase/Common/Utils.hpp"
+#include "Qv2rayBase/Qv2rayBaseFeatures.hpp"
+#include "picoproto.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#define QV_MODULE_NAME "GeoIPMatcher"
+
+namespace Qv2ray::components::GeositeReader
+{
+    constexpr quint32 COMPILED_GEOIP_MAGIC = 0x49475651; // "QVGI"
+    constexpr quint32 COMPILED_GEOIP_VERSION = 2;
+
+    // Layout of the compiled file, every section starts at a multiple of 8 bytes:
+    // header | category names, separated by '\n' | set offsets | set members | v4 starts | v4 sets | v6 starts | v6 sets
+    struct CompiledGeoIPHeader
+    {
+        quint32 magic;
+        quint32 version;
+        qint64 sourceSize;
+        qint64 sourceMtime;
+        quint64 sourceHash;
+        quint32 namesSize;
+        quint32 setCount;
+        quint32 setMemberCount;
+        quint32 v4Count;
+        quint32 v6Count;
+        quint32 categoryCount;
+    };
+
+    struct IPv6Key
+    {
+        quint64 hi = 0;
+        quint64 lo = 0;
+        bool operator<(const IPv6Key &o) const
+        {
+            return hi < o.hi || (hi == o.hi && lo < o.lo);
+        }
+        bool operator==(const IPv6Key &o) const
+        {
+            return hi == o.hi && lo == o.lo;
+        }
+    };
+    static_assert(sizeof(IPv6Key) == 2 * sizeof(quint64));
+
+    bool IsMaxAddress(quint32 v)
+    {
+        return v == std::numeric_limits<quint32>::max();
+    }
+
+    bool IsMaxAddress(const IPv6Key &v)
+    {
+        return v.hi == std::numeric_limits<quint64>::max() && v.lo == std::numeric_limits<quint64>::max();
+    }
+
+    quint32 NextAddress(quint32 v)
+    {
+        return v + 1;
+    }
+
+    IPv6Key NextAddress(IPv6Key v)
+    {
+        v.lo++;
+        if (v.lo == 0)
+            v.hi++;
+        return v;
+    }
+
+    quint32 PrevAddress(quint32 v)
+    {
+        return v - 1;
+    }
+
+    IPv6Key PrevAddress(IPv6Key v)
+    {
+        if (v.lo == 0)
+            v.hi--;
+        v.lo--;
+        return v;
+    }
+
+    quint64 ReadBigEndian64(const uchar *bytes)
+    {
+        quint64 result = 0;
+        for (auto i = 0; i < 8; i++)
+            result = (result << 8) | bytes[i];
+        return result;
+    }
+
+    template<typename T>
+    struct AddressRange
+    {
+        T start;
+        T end;
+        quint32 category;
+    };
+
+    // Sets of categories are stored once, intervals refer to them by index.
+    class CategorySetTable
+    {
+      public:
+        CategorySetTable()
+        {
+            Intern({});
+        }
+
+        quint32 Intern(const std::vector<quint32> &members)
+        {
+            if (const auto it = ids.find(members); it != ids.end())
+                return it->second;
+            const quint32 id = offsets.size() - 1;
+            this->members.insert(this->members.end(), members.begin(), members.end());
+            offsets.push_back(this->members.size());
+            ids.emplace(members, id);
+            return id;
+        }
+
+        std::vector<quint32> offsets{ 0 };
+        std::vector<quint32> members;
+
+      private:
+        std::map<std::vector<quint32>, quint32> ids;
+    };
+
+    // An inverse_match entry contains every address that is not in its CIDR list.
+    template<typename T>
+    std::vector<AddressRange<T>> InvertRanges(std::vector<AddressRange<T>> ranges, quint32 category)
+    {
+        std::sort(ranges.begin(), ranges.end(), [](const auto &a, const auto &b) { return a.start < b.start; });
+
+        std::vector<AddressRange<T>> result;
+        T next{};
+        bool reachedEnd = false;
+        for (const auto &range : ranges)
+        {
+            if (reachedEnd)
+                break;
+            if (next < range.start)
+                result.push_back({ next, PrevAddress(range.start), category });
+            if (next < range.end || next == range.end)
+            {
+                reachedEnd = IsMaxAddress(range.end);
+                next = NextAddress(range.end);
+            }
+        }
+        if (!reachedEnd)
+            result.push_back({ next, PrevAddress(T{}), category });
+        return result;
+    }
+
+    // Splits possibly overlapping ranges into sorted, non-overlapping intervals, covering the whole address space.
+    template<typename T>
+    void BuildIntervals(const std::vector<AddressRange<T>> &ranges, CategorySetTable &sets, std::vector<T> &starts, std::vector<quint32> &setIds)
+    {
+        struct Event
+        {
+            T at;
+            quint32 category;
+            int delta;
+        };
+
+        std::vector<Event> events;
+        events.reserve(ranges.size() * 2);
+        for (const auto &range : ranges)
+        {
+            events.push_back({ range.start, range.category, 1 });
+            if (!IsMaxAddress(range.end))
+                events.push_back({ NextAddress(range.end), range.category, -1 });
+        }
+        std::sort(events.begin(), events.end(), [](const auto &a, const auto &b) { return a.at < b.at; });
+
+        std::map<quint32, int> active;
+        starts.push_back(T{});
+        setIds.push_back(0);
+        for (size_t i = 0; i < events.size();)
+        {
+            const auto at = events[i].at;
+            for (; i < events.size() && events[i].at == at; i++)
+            {
+                if ((active[events[i].category] += events[i].delta) == 0)
+                    active.erase(events[i].category);
+            }
+
+            std::vector<quint32> members;
+            members.reserve(active.size());
+            for (const auto &[category, _] : active)
+                members.push_back(category);
+
+            const auto id = sets.Intern(members);
+            if (id == setIds.back())
+                continue;
+
+            if (starts.back() == at)
+            {
+                setIds.back() = id;
+                if (setIds.size() > 1 && setIds[setIds.size() - 2] == id)
+                {
+                    starts.pop_back();
+                    setIds.pop_back();
+                }
+            }
+            else
+            {
+                starts.push_back(at);
+                setIds.push_back(id);
+            }
+        }
+    }
+
+    QByteArray CompileGeoIP(const uchar *data, qint64 size, const DataFileKey &key)
+    {
+        QStringList categories;
+        std::vector<AddressRange<quint32>> v4Ranges;
+        std::vector<AddressRange<IPv6Key>> v6Ranges;
+
+        picoproto::FieldScanner root(data, size);
+        while (root.Next())
+        {
+            if (root.GetFieldNumber() != 1 || root.GetWireType() != picoproto::WIRETYPE_LENGTH_DELIMITED)
+                continue;
+
+            const quint32 category = categories.size();
+            categories << QString();
+            std::vector<AddressRange<quint32>> entryV4;
+            std::vector<AddressRange<IPv6Key>> entryV6;
+            bool inverse = false;
+
+            const auto [entry, entrySize] = root.GetBytes();
+            picoproto::FieldScanner fields(entry, entrySize);
+            while (fields.Next())
+            {
+                if (fields.GetFieldNumber() == 3 && fields.GetWireType() == picoproto::WIRETYPE_VARINT)
+                {
+                    inverse = fields.GetValue() != 0;
+                    continue;
+                }
+                if (fields.GetWireType() != picoproto::WIRETYPE_LENGTH_DELIMITED)
+                    continue;
+
+                const auto [bytes, bytesSize] = fields.GetBytes();
+                if (fields.GetFieldNumber() == 1)
+                {
+                    categories[category] = QString::fromUtf8(reinterpret_cast<const char *>(bytes), bytesSize);
+                    continue;
+                }
+                if (fields.GetFieldNumber() != 2)
+                    continue;
+
+                // message CIDR { bytes ip = 1; uint32 prefix = 2; }
+                const uchar *ip = nullptr;
+                size_t ipSize = 0;
+                uint64_t prefix = 0;
+                picoproto::FieldScanner cidr(bytes, bytesSize);
+                while (cidr.Next())
+                {
+                    if (cidr.GetFieldNumber() == 1 && cidr.GetWireType() == picoproto::WIRETYPE_LENGTH_DELIMITED)
+                        std::tie(ip, ipSize) = cidr.GetBytes();
+                    else if (cidr.GetFieldNumber() == 2 && cidr.GetWireType() == picoproto::WIRETYPE_VARINT)
+                        prefix = cidr.GetValue();
+                }
+
+                if (ipSize == 4 && prefix <= 32)
+                {
+                    const quint32 address = (quint32(ip[0]) << 24) | (quint32(ip[1]) << 16) | (quint32(ip[2]) << 8) | quint32(ip[3]);
+                    const quint32 mask = prefix == 0 ? 0 : ~quint32(0) << (32 - prefix);
+                    entryV4.push_back({ address & mask, (address & mask) | ~mask, category });
+                }
+                else if (ipSize == 16 && prefix <= 128)
+                {
+                    const quint64 hiMask = prefix >= 64 ? ~quint64(0) : prefix == 0 ? 0 : ~quint64(0) << (64 - prefix);
+                    const quint64 loMask = prefix <= 64 ? 0 : ~quint64(0) << (128 - prefix);
+                    const IPv6Key address{ ReadBigEndian64(ip), ReadBigEndian64(ip + 8) };
+                    const IPv6Key start{ address.hi & hiMask, address.lo & loMask };
+                    entryV6.push_back({ start, { start.hi | ~hiMask, start.lo | ~loMask }, category });
+                }
+            }
+
+            if (inverse)
+            {
+                entryV4 = InvertRanges(std::move(entryV4), category);
+                entryV6 = InvertRanges(std::move(entryV6), category);
+            }
+            v4Ranges.insert(v4Ranges.end(), entryV4.begin(), entryV4.end());
+            v6Ranges.insert(v6Ranges.end(), entryV6.begin(), entryV6.end());
+        }
+
+        if (root.Failed())
+            QvLog() << "Data file is malformed, some CIDRs may be missing.";
+
+        CategorySetTable sets;
+        std::vector<quint32> v4Starts, v4Sets, v6Sets;
+        std::vector<IPv6Key> v6Starts;
+        BuildIntervals(v4Ranges, sets, v4Starts, v4Sets);
+        BuildIntervals(v6Ranges, sets, v6Starts, v6Sets);
+
+        const auto names = categories.join(QLatin1Char('\n')).toUtf8();
+
+        CompiledGeoIPHeader header{};
+        header.magic = COMPILED_GEOIP_MAGIC;
+        header.version = COMPILED_GEOIP_VERSION;
+        header.sourceSize = key.size;
+        header.sourceMtime = key.mtime;
+        header.sourceHash = key.hash;
+        header.namesSize = names.size();
+        header.categoryCount = categories.size();
+        header.setCount = sets.offsets.size() - 1;
+        header.setMemberCount = sets.members.size();
+        header.v4Count = v4Starts.size();
+        header.v6Count = v6Starts.size();
+
+        QByteArray result;
+        const auto append = [&result](const void *p, size_t n) { result.append(reinterpret_cast<const char *>(p), n); };
+        const auto align = [&result] { result.append((8 - result.size() % 8) % 8, '\0'); };
+
+        append(&header, sizeof(header));
+        append(names.constData(), names.size());
+        align();
+        append(sets.offsets.data(), sets.offsets.size() * sizeof(quint32));
+        append(sets.members.data(), sets.members.size() * sizeof(quint32));
+        align();
+        append(v4Starts.data(), v4Starts.size() * sizeof(quint32));
+        append(v4Sets.data(), v4Sets.size() * sizeof(quint32));
+        align();
+        append(v6Starts.data(), v6Starts.size() * sizeof(IPv6Key));
+        append(v6Sets.data(), v6Sets.size() * sizeof(quint32));
+
+        QvLog() << "Compiled" << categories.size() << "geoip categories into" << header.v4Count << "IPv4 intervals," << header.v6Count << "IPv6 intervals.";
+        return result;
+    }
+
+    GeoIPMatcher::GeoIPMatcher(const QString &filepath)
+    {
+        QFile source(filepath);
+        if (!source.open(QFile::OpenModeFlag::ReadOnly))
+        {
+            QvLog() << "File cannot be opened:" << filepath;
+            return;
+        }
+        const auto key = GetDataFileKey(source);
+
+        const auto compiledPath = GetDataCacheFilePath(filepath, QStringLiteral(".geoip"));
+        compiledFile.setFileName(compiledPath);
+        if (compiledFile.open(QFile::OpenModeFlag::ReadOnly))
+        {
+            const auto data = compiledFile.map(0, compiledFile.size());
+            if (data && Attach(data, compiledFile.size(), key))
+            {
+                mappedData = data;
+                return;
+            }
+            QvLog() << "Compiled geoip file is outdated or invalid:" << compiledPath;
+            compiledFile.close();
+        }
+
+        QvLog() << "Compiling geoip file:" << filepath;
+        {
+            const DataFileView view(source);
+            compiledData = CompileGeoIP(view.data(), view.size(), key);
+        }
+
+        QDir().mkpath(QFileInfo(compiledPath).absolutePath());
+        WriteFile(compiledData, compiledPath);
+
+        if (!Attach(reinterpret_cast<const uchar *>(compiledData.constData()), compiledData.size(), key))
+            QvLog() << "Failed to load compiled geoip data.";
+    }
+
+    GeoIPMatcher::~GeoIPMatcher()
+    {
+        if (mappedData)
+            compiledFile.unmap(const_cast<uchar *>(mappedData));
+    }
+
+    bool GeoIPMatcher::Attach(const uchar *data, qint64 size, const DataFileKey &key)
+    {
+        qint64 offset = 0;
+        const auto take = [&](qint64 bytes) -> const uchar * {
+            if (bytes < 0 || offset + bytes > size)
+                return nullptr;
+            const auto p = data + offset;
+            offset += bytes;
+            return p;
+        };
+        const auto align = [&] { offset += (8 - offset % 8) % 8; };
+
+        CompiledGeoIPHeader header;
+        const auto headerData = take(sizeof(header));
+        if (!headerData)
+            return false;
+        std::memcpy(&header, headerData, sizeof(header));
+
+        if (header.magic != COMPILED_GEOIP_MAGIC || header.version != COMPILED_GEOIP_VERSION)
+            return false;
+        if (!(DataFileKey{ header.sourceSize, header.sourceMtime, header.sourceHash } == key))
+            return false;
+
+        const auto names = take(header.namesSize);
+        align();
+        const auto offsetsData = take((qint64(header.setCount) + 1) * sizeof(quint32));
+        const auto membersData = take(qint64(header.setMemberCount) * sizeof(quint32));
+        align();
+        const auto v4StartsData = take(qint64(header.v4Count) * sizeof(quint32));
+        const auto v4SetsData = take(qint64(header.v4Count) * sizeof(quint32));
+        align();
+        const auto v6StartsData = take(qint64(header.v6Count) * sizeof(IPv6Key));
+        const auto v6SetsData = take(qint64(header.v6Count) * sizeof(quint32));
+        if (!names || !offsetsData || !membersData || !v4StartsData || !v4SetsData || !v6StartsData || !v6SetsData || offset != size)
+            return false;
+
+        QStringList categoryNames;
+        if (header.categoryCount > 0)
+            categoryNames = QString::fromUtf8(reinterpret_cast<const char *>(names), header.namesSize).split(QLatin1Char('\n'));
+        if (quint32(categoryNames.size()) != header.categoryCount)
+            return false;
+
+        // The file may be truncated, stale or corrupted in ways the sizes above don't show, Match must not be able to
+        // read out of the tables whatever their content is.
+        const auto offsets = reinterpret_cast<const quint32 *>(offsetsData);
+        const auto members = reinterpret_cast<const quint32 *>(membersData);
+        if (header.setCount == 0 || offsets[0] != 0 || offsets[header.setCount] != header.setMemberCount)
+            return false;
+        for (quint32 i = 0; i < header.setCount; i++)
+            if (offsets[i] > offsets[i + 1])
+                return false;
+        if (std::any_of(members, members + header.setMemberCount, [&](quint32 member) { return member >= quint32(categoryNames.size()); }))
+            return false;
+
+        // Lookups take the interval before the upper bound, so the first one must start at the lowest address.
+        const auto validSets = [&](const quint32 *sets, quint32 count) {
+            return std::all_of(sets, sets + count, [&](quint32 set) { return set < header.setCount; });
+        };
+        const auto v4StartsTable = reinterpret_cast<const quint32 *>(v4StartsData);
+        const auto v6StartsTable = reinterpret_cast<const IPv6Key *>(v6StartsData);
+        if (header.v4Count > 0 && (v4StartsTable[0] != 0 || !std::is_sorted(v4StartsTable, v4StartsTable + header.v4Count)))
+            return false;
+        if (header.v6Count > 0 && (!(v6StartsTable[0] == IPv6Key{}) || !std::is_sorted(v6StartsTable, v6StartsTable + header.v6Count)))
+            return false;
+        if (!validSets(reinterpret_cast<const quint32 *>(v4SetsData), header.v4Count) || !validSets(reinterpret_cast<const quint32 *>(v6SetsData), header.v6Count))
+            return false;
+
+        categories = categoryNames;
+        setOffsets = offsets;
+        setMembers = members;
+        v4Count = header.v4Count;
+        v4Starts = v4StartsTable;
+        v4Sets = reinterpret_cast<const quint32 *>(v4SetsData);
+        v6Count = header.v6Count;
+        v6Starts = reinterpret_cast<const quint64 *>(v6StartsData);
+        v6Sets = reinterpret_cast<const quint32 *>(v6SetsData);
+        return true;
+    }
+
+    QStringList GeoIPMatcher::Match(const QHostAddress &address) const
+    {
+        quint32 set = 0;
+        const auto v6 = address.toIPv6Address();
+        const IPv6Key key{ ReadBigEndian64(v6.c), ReadBigEndian64(v6.c + 8) };
+        // IPv4-mapped addresses, ::ffff:a.b.c.d, are looked up as IPv4. toIPv4Address would also turn :: into 0.0.0.0.
+        const auto isMapped = address.protocol() == QAbstractSocket::IPv6Protocol && key.hi == 0 && (key.lo >> 32) == 0xFFFF;
+        if ((address.protocol() == QAbstractSocket::IPv4Protocol || isMapped) && v4Count > 0)
+        {
+            const quint32 v4 = isMapped ? quint32(key.lo) : address.toIPv4Address();
+            const auto it = std::upper_bound(v4Starts, v4Starts + v4Count, v4);
+            set = v4Sets[it - v4Starts - 1];
+        }
+        else if (address.protocol() == QAbstractSocket::IPv6Protocol && !isMapped && v6Count > 0)
+        {
+            const auto starts = reinterpret_cast<const IPv6Key *>(v6Starts);
+            const auto it = std::upper_bound(starts, starts + v6Count, key);
+            set = v6Sets[it - starts - 1];
+        }
+
+        if (!setOffsets)
+            return {};
+
+        QStringList result;
+        for (auto i = setOffsets[set]; i < setOffsets[set + 1]; i++)
+            result << categories.value(setMembers[i]);
+        return result;
+    }
+
+    QStringList GeoIPMatcher::Match(const QString &address) const
+    {
+        return Match(QHostAddress(address));
+    }
+} // namespace Qv2ray::components::GeositeReader
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QFile>
+#include <QHostAddress>
+#include <QStringList>
+
+namespace Qv2ray::components::GeositeReader
+{
+    struct DataFileKey;
+
+    // Answers "which geoip categories contain this address".
+    //
+    // geoip.dat is compiled into sorted, non-overlapping interval tables, one for IPv4 and one for IPv6, each interval
+    // maps to a set of categories, lookups are binary searches. The compiled tables are saved in the application cache
+    // directory, later runs map them into memory directly, until geoip.dat is changed.
+    class GeoIPMatcher
+    {
+      public:
+        explicit GeoIPMatcher(const QString &filepath);
+        ~GeoIPMatcher();
+        Q_DISABLE_COPY_MOVE(GeoIPMatcher)
+
+        int CategoryCount() const
+        {
+            return categories.size();
+        }
+
+        // Both functions are thread-safe.
+        QStringList Match(const QHostAddress &address) const;
+        QStringList Match(const QString &address) const;
+
+      private:
+        bool Attach(const uchar *data, qint64 size, const DataFileKey &key);
+
+        QFile compiledFile;
+        QByteArray compiledData;
+        const uchar *mappedData = nullptr;
+
+        QStringList categories;
+
+        // Members of set i are setMembers[setOffsets[i]] .. setMembers[setOffsets[i + 1]], set 0 is the empty set.
+        const quint32 *setOffsets = nullptr;
+        const quint32 *setMembers = nullptr;
+
+        // Interval i starts at starts[i] and ends right before starts[i + 1].
+        quint32 v4Count = 0;
+        const quint32 *v4Starts = nullptr;
+        const quint32 *v4Sets = nullptr;
+
+        // IPv6 starts are stored as pairs of the high and low 64 bits.
+        quint32 v6Count = 0;
+        const quint64 *v6Starts = nullptr;
+        const quint32 *v6Sets = nullptr;
+    };
+} // namespace Qv2ray::components::GeositeReader
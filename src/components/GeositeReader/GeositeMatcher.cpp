@@ -0,0 +1,299 @@
+#include "GeositeMatcher.hpp"
+
+#include "GeositeReader.hpp"
+#include "Qv2rayBase/Qv2rayBaseFeatures.hpp"
+#include "picoproto.h"
+
+#include <QFile>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cctype>
+#include <queue>
+
+#define QV_MODULE_NAME "GeositeMatcher"
+
+namespace Qv2ray::components::GeositeReader
+{
+    // Values of the Domain.Type enum in geosite.dat
+    enum GeositeDomainType
+    {
+        GEOSITE_PLAIN = 0,
+        GEOSITE_REGEX = 1,
+        GEOSITE_DOMAIN = 2,
+        GEOSITE_FULL = 3
+    };
+
+    constexpr int KeywordSymbol(char c)
+    {
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 1;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 27;
+        switch (c)
+        {
+            case '-': return 37;
+            case '.': return 38;
+            case '_': return 39;
+            default: return 0;
+        }
+    }
+
+    static void ToLower(std::string &value)
+    {
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    }
+
+    GeositeMatcher::GeositeMatcher(const QString &filepath)
+    {
+        keywordNodes.emplace_back();
+
+        QFile f(filepath);
+        if (!f.open(QFile::OpenModeFlag::ReadOnly))
+        {
+            QvLog() << "File cannot be opened:" << filepath;
+            return;
+        }
+
+        const DataFileView view(f);
+        picoproto::FieldScanner root(view.data(), view.size());
+        while (root.Next())
+        {
+            if (root.GetFieldNumber() != 1 || root.GetWireType() != picoproto::WIRETYPE_LENGTH_DELIMITED)
+                continue;
+
+            const uint32_t category = categories.size();
+            categories << QString();
+
+            const auto [entry, entrySize] = root.GetBytes();
+            picoproto::FieldScanner fields(entry, entrySize);
+            while (fields.Next())
+            {
+                if (fields.GetWireType() != picoproto::WIRETYPE_LENGTH_DELIMITED)
+                    continue;
+
+                const auto [bytes, size] = fields.GetBytes();
+                if (fields.GetFieldNumber() == 1)
+                {
+                    categories[category] = QString::fromUtf8(reinterpret_cast<const char *>(bytes), size);
+                }
+                else if (fields.GetFieldNumber() == 2)
+                {
+                    // message Domain { Type type = 1; string value = 2; repeated Attribute attribute = 3; }
+                    uint64_t type = GEOSITE_PLAIN;
+                    std::string_view value;
+                    std::vector<std::string> attributes;
+                    picoproto::FieldScanner domain(bytes, size);
+                    while (domain.Next())
+                    {
+                        if (domain.GetFieldNumber() == 1 && domain.GetWireType() == picoproto::WIRETYPE_VARINT)
+                            type = domain.GetValue();
+                        else if (domain.GetFieldNumber() == 2 && domain.GetWireType() == picoproto::WIRETYPE_LENGTH_DELIMITED)
+                            value = { reinterpret_cast<const char *>(domain.GetBytes().first), domain.GetBytes().second };
+                        else if (domain.GetFieldNumber() == 3 && domain.GetWireType() == picoproto::WIRETYPE_LENGTH_DELIMITED)
+                        {
+                            // message Attribute { string key = 1; oneof typed_value { bool bool_value = 2; int64 int_value = 3; } }
+                            // v2ray only compares the keys.
+                            const auto [attributeBytes, attributeSize] = domain.GetBytes();
+                            picoproto::FieldScanner attribute(attributeBytes, attributeSize);
+                            while (attribute.Next())
+                            {
+                                if (attribute.GetFieldNumber() != 1 || attribute.GetWireType() != picoproto::WIRETYPE_LENGTH_DELIMITED)
+                                    continue;
+                                attributes.emplace_back(reinterpret_cast<const char *>(attribute.GetBytes().first), attribute.GetBytes().second);
+                                ToLower(attributes.back());
+                            }
+                        }
+                    }
+                    AddRule(type, value, { category, AddAttributeSet(std::move(attributes)) });
+                }
+            }
+        }
+
+        if (root.Failed())
+            QvLog() << "Data file is malformed, some rules may be missing:" << filepath;
+
+        BuildKeywordAutomaton();
+        attributeSetIndex.clear();
+        QvLog() << "Indexed" << categories.size() << "geosite categories," << fullRules.size() << "full rules," << domainRules.size() << "domain rules,"
+                << regexRules.size() << "regex rules.";
+    }
+
+    uint32_t GeositeMatcher::AddAttributeSet(std::vector<std::string> &&attributes)
+    {
+        if (attributes.empty())
+            return 0;
+
+        std::sort(attributes.begin(), attributes.end());
+        attributes.erase(std::unique(attributes.begin(), attributes.end()), attributes.end());
+        const auto [it, inserted] = attributeSetIndex.emplace(attributes, attributeSets.size());
+        if (inserted)
+            attributeSets.push_back(std::move(attributes));
+        return it->second;
+    }
+
+    void GeositeMatcher::AddRule(uint64_t type, std::string_view value, RuleRef rule)
+    {
+        if (value.empty())
+            return;
+
+        auto lower = std::string(value);
+        ToLower(lower);
+
+        switch (type)
+        {
+            case GEOSITE_PLAIN:
+            {
+                AddKeyword(lower, rule);
+                break;
+            }
+            case GEOSITE_REGEX:
+            {
+                QRegularExpression regex(QString::fromUtf8(value.data(), value.size()));
+                if (!regex.isValid())
+                {
+                    QvLog() << "Skipped invalid regex rule:" << regex.pattern();
+                    break;
+                }
+                regex.optimize();
+                regexRules.emplace_back(regex, rule);
+                break;
+            }
+            case GEOSITE_DOMAIN:
+            case GEOSITE_FULL:
+            {
+                auto &table = type == GEOSITE_DOMAIN ? domainRules : fullRules;
+                auto it = table.find(lower);
+                if (it == table.end())
+                    it = table.emplace(stringPool.emplace_back(std::move(lower)), std::vector<RuleRef>{}).first;
+                if (it->second.empty() || !(it->second.back() == rule))
+                    it->second.push_back(rule);
+                break;
+            }
+            default: break;
+        }
+    }
+
+    void GeositeMatcher::AddKeyword(std::string_view keyword, RuleRef rule)
+    {
+        if (std::any_of(keyword.begin(), keyword.end(), [](char c) { return KeywordSymbol(c) == 0; }))
+        {
+            extraKeywords.emplace_back(keyword, rule);
+            return;
+        }
+
+        int32_t node = 0;
+        for (const auto c : keyword)
+        {
+            const auto symbol = KeywordSymbol(c);
+            if (keywordNodes[node].next[symbol] == 0)
+            {
+                keywordNodes[node].next[symbol] = keywordNodes.size();
+                keywordNodes.emplace_back();
+            }
+            node = keywordNodes[node].next[symbol];
+        }
+        keywordNodes[node].rules.push_back(rule);
+    }
+
+    void GeositeMatcher::BuildKeywordAutomaton()
+    {
+        // Turn the trie into a DFA: missing transitions are replaced by those of the failure link,
+        // and every node inherits the matches of its failure link, so matching never backtracks.
+        std::queue<int32_t> queue;
+        for (const auto child : keywordNodes[0].next)
+            if (child != 0)
+                queue.push(child);
+
+        while (!queue.empty())
+        {
+            const auto node = queue.front();
+            queue.pop();
+
+            const auto fail = keywordNodes[node].fail;
+            keywordNodes[node].rules.insert(keywordNodes[node].rules.end(), keywordNodes[fail].rules.begin(), keywordNodes[fail].rules.end());
+
+            for (auto symbol = 1; symbol < KEYWORD_ALPHABET_SIZE; symbol++)
+            {
+                const auto child = keywordNodes[node].next[symbol];
+                if (child == 0)
+                {
+                    keywordNodes[node].next[symbol] = keywordNodes[fail].next[symbol];
+                    continue;
+                }
+                keywordNodes[child].fail = keywordNodes[fail].next[symbol];
+                queue.push(child);
+            }
+        }
+    }
+
+    void GeositeMatcher::MatchKeywords(std::string_view domain, std::vector<RuleRef> &result) const
+    {
+        int32_t node = 0;
+        for (const auto c : domain)
+        {
+            node = keywordNodes[node].next[KeywordSymbol(c)];
+            const auto &rules = keywordNodes[node].rules;
+            result.insert(result.end(), rules.begin(), rules.end());
+        }
+
+        for (const auto &[keyword, rule] : extraKeywords)
+            if (domain.find(keyword) != std::string_view::npos)
+                result.push_back(rule);
+    }
+
+    QStringList GeositeMatcher::Match(const QString &domain, const QStringList &attributes) const
+    {
+        const auto lowerDomain = domain.toLower();
+        const auto utf8 = lowerDomain.toUtf8();
+        const std::string_view view{ utf8.constData(), (size_t) utf8.size() };
+
+        std::vector<RuleRef> result;
+        if (const auto it = fullRules.find(view); it != fullRules.end())
+            result.insert(result.end(), it->second.begin(), it->second.end());
+
+        // A Domain rule matches the domain itself and all of its subdomains, so every suffix starting at a label is looked up.
+        for (size_t pos = 0; pos < view.size();)
+        {
+            if (const auto it = domainRules.find(view.substr(pos)); it != domainRules.end())
+                result.insert(result.end(), it->second.begin(), it->second.end());
+
+            const auto dot = view.find('.', pos);
+            if (dot == std::string_view::npos)
+                break;
+            pos = dot + 1;
+        }
+
+        MatchKeywords(view, result);
+
+        for (const auto &[regex, rule] : regexRules)
+            if (regex.match(lowerDomain).hasMatch())
+                result.push_back(rule);
+
+        std::vector<std::string> wanted;
+        for (const auto &attribute : attributes)
+            wanted.push_back(attribute.toLower().toStdString());
+        std::sort(wanted.begin(), wanted.end());
+        wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+        std::vector<uint32_t> matched;
+        for (const auto &rule : result)
+        {
+            const auto &ruleAttributes = attributeSets[rule.attributes];
+            if (std::includes(ruleAttributes.begin(), ruleAttributes.end(), wanted.begin(), wanted.end()))
+                matched.push_back(rule.category);
+        }
+        std::sort(matched.begin(), matched.end());
+        matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+
+        QStringList names;
+        names.reserve(matched.size());
+        for (const auto category : matched)
+            names << categories[category];
+        return names;
+    }
+
+    QList<QStringList> GeositeMatcher::MatchBatch(const QStringList &domains) const
+    {
+        return QtConcurrent::blockingMapped<QList<QStringList>>(domains, [this](const QString &domain) { return Match(domain); });
+    }
+} // namespace Qv2ray::components::GeositeReader
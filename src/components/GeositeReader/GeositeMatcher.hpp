@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QList>
+#include <QRegularExpression>
+#include <QStringList>
+#include <array>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Qv2ray::components::GeositeReader
+{
+    // Answers "which geosite categories contain this domain", following the matching rules of v2ray:
+    // Plain rules are keywords, Domain rules match the domain and its subdomains, Full rules match exactly.
+    // Rules may carry attributes, "geosite:google@cn" only uses the rules of google with the attribute cn.
+    class GeositeMatcher
+    {
+      public:
+        explicit GeositeMatcher(const QString &filepath);
+        int CategoryCount() const
+        {
+            return categories.size();
+        }
+
+        // Both functions are thread-safe. With attributes, only the rules carrying all of them count.
+        QStringList Match(const QString &domain, const QStringList &attributes = {}) const;
+        QList<QStringList> MatchBatch(const QStringList &domains) const;
+
+      private:
+        struct RuleRef
+        {
+            uint32_t category;
+            // Index into attributeSets, 0 for rules without attributes.
+            uint32_t attributes;
+
+            bool operator==(const RuleRef &other) const
+            {
+                return category == other.category && attributes == other.attributes;
+            }
+        };
+
+        // Lowercase letters, digits, '-', '.' and '_', everything else shares symbol 0.
+        static constexpr auto KEYWORD_ALPHABET_SIZE = 40;
+
+        struct KeywordNode
+        {
+            std::array<int32_t, KEYWORD_ALPHABET_SIZE> next{};
+            int32_t fail = 0;
+            std::vector<RuleRef> rules;
+        };
+
+        void AddRule(uint64_t type, std::string_view value, RuleRef rule);
+        void AddKeyword(std::string_view keyword, RuleRef rule);
+        uint32_t AddAttributeSet(std::vector<std::string> &&attributes);
+        void BuildKeywordAutomaton();
+        void MatchKeywords(std::string_view domain, std::vector<RuleRef> &result) const;
+
+        QStringList categories;
+
+        // The keys of both tables point into stringPool, so lookups don't need to allocate.
+        std::deque<std::string> stringPool;
+        std::unordered_map<std::string_view, std::vector<RuleRef>> fullRules;
+        std::unordered_map<std::string_view, std::vector<RuleRef>> domainRules;
+
+        // Sorted, lowercase attribute keys. Rules share the sets, there are only a few distinct ones.
+        std::vector<std::vector<std::string>> attributeSets{ {} };
+        std::map<std::vector<std::string>, uint32_t> attributeSetIndex;
+
+        // A single Aho-Corasick automaton for all Plain rules.
+        std::vector<KeywordNode> keywordNodes;
+        // Keywords with characters outside the alphabet are rare, they are searched one by one.
+        std::vector<std::pair<std::string, RuleRef>> extraKeywords;
+
+        std::vector<std::pair<QRegularExpression, RuleRef>> regexRules;
+    };
+} // namespace Qv2ray::components::GeositeReader
@@ -1,23 +1,186 @@
 #include "GeositeReader.hpp"
 
+#include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Qv2rayBaseFeatures.hpp"
 #include "picoproto.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QMap>
+#include <QMutex>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <optional>
 
 #define QV_MODULE_NAME "GeositeReader"
 
 namespace Qv2ray::components::GeositeReader
 {
-    QMap<QString, QStringList> GeositeEntries;
+    constexpr auto INDEX_FORMAT_VERSION = 2;
+    constexpr qint64 INDEX_HASH_SAMPLE_SIZE = 64 * 1024;
 
-    QStringList ReadGeoSiteFromFile(const QString &filepath, bool allowCache)
+    struct CachedIndex
     {
-        if (GeositeEntries.contains(filepath) && allowCache)
-            return GeositeEntries.value(filepath);
+        DataFileKey key;
+        QList<GeositeEntry> entries;
+        QStringList names;
+    };
+
+    // Held for the whole load, so that a file requested by several threads at once is only scanned once.
+    QMutex GeositeEntriesMutex;
+    QMap<QString, CachedIndex> GeositeEntries;
+
+    // Hashing the whole file would cost as much as parsing it, so only the head and the tail are hashed,
+    // together with size and mtime this is enough to notice a replaced data file.
+    DataFileKey GetDataFileKey(QFile &f)
+    {
+        const QFileInfo info(f);
+        DataFileKey key;
+        key.size = info.size();
+        key.mtime = info.lastModified().toMSecsSinceEpoch();
+
+        f.seek(0);
+        auto sample = f.read(INDEX_HASH_SAMPLE_SIZE);
+        if (key.size > INDEX_HASH_SAMPLE_SIZE)
+        {
+            f.seek(std::max(INDEX_HASH_SAMPLE_SIZE, key.size - INDEX_HASH_SAMPLE_SIZE));
+            sample += f.read(INDEX_HASH_SAMPLE_SIZE);
+        }
+        // qHash differs between Qt versions and CPUs, the key is stored on disk so it must not.
+        const auto digest = QCryptographicHash::hash(sample, QCryptographicHash::Sha1);
+        key.hash = qFromBigEndian<quint64>(digest.constData());
+        return key;
+    }
+
+    QString GetDataCacheFilePath(const QString &filepath, const QString &extension)
+    {
+        const auto dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/geodata/");
+        const auto name = QCryptographicHash::hash(filepath.toUtf8(), QCryptographicHash::Sha1).toHex();
+        return dir + QString::fromLatin1(name) + extension;
+    }
+
+    DataFileView::DataFileView(QFile &f) : file(f), length(f.size())
+    {
+        mapped = f.map(0, length);
+        if (mapped)
+        {
+            bytes = mapped;
+            return;
+        }
+        f.seek(0);
+        content = f.readAll();
+        bytes = reinterpret_cast<const uchar *>(content.constData());
+        length = content.size();
+    }
+
+    DataFileView::~DataFileView()
+    {
+        if (mapped)
+            file.unmap(const_cast<uchar *>(mapped));
+    }
+
+    std::optional<QList<GeositeEntry>> LoadIndexFile(const QString &filepath, const DataFileKey &key)
+    {
+        const auto indexPath = GetDataCacheFilePath(filepath, QStringLiteral(".json"));
+        if (!QFile::exists(indexPath))
+            return std::nullopt;
+
+        const auto root = JsonFromString(ReadFile(indexPath));
+        if (root[QStringLiteral("version")].toInt() != INDEX_FORMAT_VERSION || root[QStringLiteral("path")].toString() != filepath)
+            return std::nullopt;
+
+        DataFileKey indexedKey;
+        indexedKey.size = root[QStringLiteral("size")].toInteger(-1);
+        indexedKey.mtime = root[QStringLiteral("mtime")].toInteger(-1);
+        indexedKey.hash = root[QStringLiteral("hash")].toString().toULongLong(nullptr, 16);
+        if (!(indexedKey == key))
+        {
+            QvLog() << "Index of" << filepath << "is outdated.";
+            return std::nullopt;
+        }
+
+        QList<GeositeEntry> entries;
+        const auto array = root[QStringLiteral("entries")].toArray();
+        entries.reserve(array.size());
+        for (const auto &val : array)
+        {
+            const auto entry = val.toArray();
+            entries.append({ entry[0].toString(), entry[1].toInteger(), entry[2].toInteger() });
+        }
+        return entries;
+    }
+
+    void SaveIndexFile(const QString &filepath, const DataFileKey &key, const QList<GeositeEntry> &entries)
+    {
+        QJsonArray array;
+        for (const auto &entry : entries)
+            array.append(QJsonArray{ entry.name, entry.offset, entry.size });
+
+        QJsonObject root;
+        root[QStringLiteral("version")] = INDEX_FORMAT_VERSION;
+        root[QStringLiteral("path")] = filepath;
+        root[QStringLiteral("size")] = key.size;
+        root[QStringLiteral("mtime")] = key.mtime;
+        root[QStringLiteral("hash")] = QString::number(key.hash, 16);
+        root[QStringLiteral("entries")] = array;
+
+        const auto indexPath = GetDataCacheFilePath(filepath, QStringLiteral(".json"));
+        QDir().mkpath(QFileInfo(indexPath).absolutePath());
+        WriteFile(QJsonDocument(root).toJson(QJsonDocument::Compact), indexPath);
+    }
+
+    QList<GeositeEntry> ScanDataFile(QFile &f)
+    {
+        QList<GeositeEntry> entries;
+
+        // Map the file instead of reading it, we only touch a few bytes of each entry.
+        const DataFileView view(f);
+
+        // Both GeoSiteList and GeoIPList are "repeated entry = 1", where each entry has
+        // "string country_code = 1". Only those two strings are read, the domain and CIDR
+        // lists that make up the rest of the file are skipped by their length prefixes.
+        picoproto::FieldScanner root(view.data(), view.size());
+        while (root.Next())
+        {
+            if (root.GetFieldNumber() != 1 || root.GetWireType() != picoproto::WIRETYPE_LENGTH_DELIMITED)
+                continue;
+
+            const auto [entry, entrySize] = root.GetBytes();
+            picoproto::FieldScanner fields(entry, entrySize);
+            while (fields.Next())
+            {
+                if (fields.GetFieldNumber() == 1 && fields.GetWireType() == picoproto::WIRETYPE_LENGTH_DELIMITED)
+                {
+                    const auto [name, nameSize] = fields.GetBytes();
+                    entries.append({ QString::fromUtf8(reinterpret_cast<const char *>(name), nameSize), (qint64) root.GetPayloadOffset(), (qint64) entrySize });
+                    break;
+                }
+            }
+        }
+
+        if (root.Failed())
+            QvLog() << "Data file is malformed, the list may be incomplete:" << f.fileName();
+        return entries;
+    }
+
+    // Must be called with GeositeEntriesMutex held.
+    CachedIndex LoadIndex(const QString &filepath, bool allowCache)
+    {
+        const QFileInfo info(filepath);
+        if (allowCache && GeositeEntries.contains(filepath))
+        {
+            // A stat() is cheap enough to be done every time.
+            const auto &cached = GeositeEntries[filepath];
+            if (cached.key.size == info.size() && cached.key.mtime == info.lastModified().toMSecsSinceEpoch())
+                return cached;
+        }
 
-        QStringList list;
         QvLog() << "Reading geosites from:" << filepath;
         QFile f(filepath);
         bool opened = f.open(QFile::OpenModeFlag::ReadOnly);
@@ -25,23 +188,50 @@ namespace Qv2ray::components::GeositeReader
         if (!opened)
         {
             QvLog() << "File cannot be opened:" << filepath;
-            return list;
+            return {};
         }
 
-        const auto content = f.readAll();
-        f.close();
-        {
-            picoproto::Message root;
-            root.ParseFromBytes((unsigned char *) content.data(), content.size());
+        CachedIndex index;
+        index.key = GetDataFileKey(f);
 
-            list.reserve(root.GetMessageArray(1).size());
-            for (const auto &geosite : root.GetMessageArray(1))
-                list << QString::fromStdString(geosite->GetString(1));
+        std::optional<QList<GeositeEntry>> indexed;
+        if (allowCache)
+            indexed = LoadIndexFile(filepath, index.key);
+
+        if (indexed)
+        {
+            index.entries = *indexed;
+        }
+        else
+        {
+            index.entries = ScanDataFile(f);
+            SaveIndexFile(filepath, index.key, index.entries);
         }
+        f.close();
+
+        for (const auto &entry : index.entries)
+            index.names << entry.name;
+        index.names.sort();
+
+        QvLog() << "Loaded" << index.entries.count() << "geosite entries from data file.";
+        GeositeEntries[filepath] = index;
+        return index;
+    }
 
-        QvLog() << "Loaded" << list.count() << "geosite entries from data file.";
-        list.sort();
-        GeositeEntries[filepath] = list;
-        return list;
+    QList<GeositeEntry> ReadGeoSiteIndex(const QString &filepath, bool allowCache)
+    {
+        QMutexLocker locker(&GeositeEntriesMutex);
+        return LoadIndex(filepath, allowCache).entries;
+    }
+
+    QStringList ReadGeoSiteFromFile(const QString &filepath, bool allowCache)
+    {
+        QMutexLocker locker(&GeositeEntriesMutex);
+        return LoadIndex(filepath, allowCache).names;
+    }
+
+    QFuture<QStringList> ReadGeoSiteFromFileAsync(const QString &filepath)
+    {
+        return QtConcurrent::run([filepath] { return ReadGeoSiteFromFile(filepath); });
     }
 } // namespace Qv2ray::components::geosite
@@ -1,8 +1,68 @@
 #pragma once
 
+#include <QByteArray>
+#include <QFuture>
+#include <QList>
 #include <QString>
 
+class QFile;
+
 namespace Qv2ray::components::GeositeReader
 {
+    // Identifies one version of a data file, caches derived from the file store it to detect changes.
+    struct DataFileKey
+    {
+        qint64 size = -1;
+        qint64 mtime = -1;
+        quint64 hash = 0;
+        bool operator==(const DataFileKey &o) const
+        {
+            return size == o.size && mtime == o.mtime && hash == o.hash;
+        }
+    };
+
+    DataFileKey GetDataFileKey(QFile &f);
+    QString GetDataCacheFilePath(const QString &filepath, const QString &extension);
+
+    // The whole content of an opened file, mapped into memory when possible, read otherwise.
+    class DataFileView
+    {
+      public:
+        explicit DataFileView(QFile &f);
+        ~DataFileView();
+        Q_DISABLE_COPY_MOVE(DataFileView)
+
+        const uchar *data() const
+        {
+            return bytes;
+        }
+        qint64 size() const
+        {
+            return length;
+        }
+
+      private:
+        QFile &file;
+        QByteArray content;
+        const uchar *mapped = nullptr;
+        const uchar *bytes = nullptr;
+        qint64 length = 0;
+    };
+
+    struct GeositeEntry
+    {
+        QString name;
+        // Position of the serialized GeoSite / GeoIP message inside the data file.
+        qint64 offset = 0;
+        qint64 size = 0;
+    };
+
+    // Lists all entries of a geosite.dat / geoip.dat file. The result is cached in memory, and as a
+    // sidecar index in the application cache directory, both are refreshed once the file changes.
+    // These functions are thread-safe.
+    QList<GeositeEntry> ReadGeoSiteIndex(const QString &filepath, bool allowCache = true);
     QStringList ReadGeoSiteFromFile(const QString &filepath, bool allowCache = true);
+
+    // Same as ReadGeoSiteFromFile, but runs on the global thread pool.
+    QFuture<QStringList> ReadGeoSiteFromFileAsync(const QString &filepath);
 } // namespace Qv2ray::components::GeositeReader
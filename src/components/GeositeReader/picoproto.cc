@@ -15,6 +15,10 @@
 
 #include "picoproto.h"
 
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
 namespace picoproto
 {
 
@@ -33,18 +37,6 @@ namespace picoproto
             return dest;
         }
 
-        // These are defined in:
-        // https://developers.google.com/protocol-buffers/docs/encoding
-        enum WireType
-        {
-            WIRETYPE_VARINT = 0,
-            WIRETYPE_64BIT = 1,
-            WIRETYPE_LENGTH_DELIMITED = 2,
-            WIRETYPE_GROUP_START = 3,
-            WIRETYPE_GROUP_END = 4,
-            WIRETYPE_32BIT = 5,
-        };
-
         // Pull bytes from the stream, updating the state.
         bool ConsumeBytes(uint8_t **current, size_t how_many, size_t *remaining)
         {
@@ -67,18 +59,84 @@ namespace picoproto
             return result;
         }
 
+        inline int CountTrailingZeros(uint64_t value)
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctzll(value);
+#endif
+        }
+
+        // The byte by byte decoder, used for the tail of a buffer, and for the rare
+        // varints longer than 8 bytes.
+        bool ReadVarIntScalar(const uint8_t **current, const uint8_t *end, uint64_t *result)
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64 && *current < end; shift += 7)
+            {
+                const uint8_t next_number = *((*current)++);
+                value |= (uint64_t)(next_number & 0x7f) << shift;
+                if (next_number < 128)
+                {
+                    *result = value;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Decodes a varint of `length` (1 to 8) bytes that starts in the low bytes of
+        // a little-endian word: the continuation bits are dropped and the 7-bit
+        // groups are packed together in three steps, without a loop or a branch.
+        inline uint64_t DecodeVarIntWord(uint64_t word, size_t length)
+        {
+            if (length < 8)
+                word &= (uint64_t(1) << (8 * length)) - 1;
+            word &= 0x7f7f7f7f7f7f7f7fULL;
+            word = (word & 0x007f007f007f007fULL) | ((word & 0x7f007f007f007f00ULL) >> 1);
+            word = (word & 0x00003fff00003fffULL) | ((word & 0x3fff00003fff0000ULL) >> 2);
+            word = (word & 0x000000000fffffffULL) | ((word & 0x0fffffff00000000ULL) >> 4);
+            return word;
+        }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        constexpr bool kWordDecoding = false;
+#else
+        constexpr bool kWordDecoding = true;
+#endif
+
+        // Never reads past `end`, which matters when scanning data we haven't
+        // validated yet. With 8 readable bytes, the terminating byte is found with a
+        // single mask instead of a branch per byte.
+        inline bool ReadVarIntChecked(const uint8_t **current, const uint8_t *end, uint64_t *result)
+        {
+            if (kWordDecoding && end - *current >= 8)
+            {
+                uint64_t word;
+                memcpy(&word, *current, sizeof(word));
+                const uint64_t stops = ~word & 0x8080808080808080ULL;
+                if (stops)
+                {
+                    const size_t length = CountTrailingZeros(stops) / 8 + 1;
+                    *result = DecodeVarIntWord(word, length);
+                    *current += length;
+                    return true;
+                }
+            }
+            return ReadVarIntScalar(current, end, result);
+        }
+
         uint64_t ReadVarInt(uint8_t **current, size_t *remaining)
         {
+            const uint8_t *position = *current;
             uint64_t result = 0;
-            bool keep_going;
-            int shift = 0;
-            do
-            {
-                const uint8_t next_number = ReadFromBytes<uint8_t>(current, remaining);
-                keep_going = (next_number >= 128);
-                result += (uint64_t)(next_number & 0x7f) << shift;
-                shift += 7;
-            } while (keep_going);
+            if (!ReadVarIntChecked(&position, *current + *remaining, &result))
+                PP_LOG(ERROR) << "ReadVarInt overrun!";
+            *remaining -= position - *current;
+            *current = const_cast<uint8_t *>(position);
             return result;
         }
 
@@ -661,4 +719,75 @@ namespace picoproto
         return result;
     }
 
+    FieldScanner::FieldScanner(const uint8_t *bytes, size_t bytes_size) : begin(bytes), current(bytes), end(bytes + bytes_size){};
+
+    bool FieldScanner::Fail()
+    {
+        PP_LOG(ERROR) << "Malformed data at offset " << (current - begin);
+        failed = true;
+        return false;
+    }
+
+    bool FieldScanner::Next()
+    {
+        if (failed || current >= end)
+            return false;
+
+        uint64_t wire_type_and_field_number;
+        if (!ReadVarIntChecked(&current, end, &wire_type_and_field_number))
+            return Fail();
+
+        wire_type = static_cast<enum WireType>(wire_type_and_field_number & 0x07);
+        field_number = static_cast<uint32_t>(wire_type_and_field_number >> 3);
+        value = 0;
+        data = nullptr;
+        data_size = 0;
+
+        switch (wire_type)
+        {
+            case WIRETYPE_VARINT:
+            {
+                if (!ReadVarIntChecked(&current, end, &value))
+                    return Fail();
+                break;
+            }
+            case WIRETYPE_64BIT:
+            {
+                if (end - current < 8)
+                    return Fail();
+                uint64_t fixed;
+                memcpy(&fixed, current, sizeof(fixed));
+                value = fixed;
+                current += 8;
+                break;
+            }
+            case WIRETYPE_32BIT:
+            {
+                if (end - current < 4)
+                    return Fail();
+                uint32_t fixed;
+                memcpy(&fixed, current, sizeof(fixed));
+                value = fixed;
+                current += 4;
+                break;
+            }
+            case WIRETYPE_LENGTH_DELIMITED:
+            {
+                uint64_t size;
+                if (!ReadVarIntChecked(&current, end, &size) || size > static_cast<uint64_t>(end - current))
+                    return Fail();
+                data = current;
+                data_size = size;
+                current += size;
+                break;
+            }
+            default:
+            {
+                // Groups are deprecated and unhandled by Message as well.
+                return Fail();
+            }
+        }
+        return true;
+    }
+
 } // namespace picoproto
@@ -90,6 +90,18 @@ namespace picoproto
         FIELD_BYTES,
     };
 
+    // These are defined in:
+    // https://developers.google.com/protocol-buffers/docs/encoding
+    enum WireType
+    {
+        WIRETYPE_VARINT = 0,
+        WIRETYPE_64BIT = 1,
+        WIRETYPE_LENGTH_DELIMITED = 2,
+        WIRETYPE_GROUP_START = 3,
+        WIRETYPE_GROUP_END = 4,
+        WIRETYPE_32BIT = 5,
+    };
+
     // Gives a readable name for the field type for logging purposes.
     std::string FieldTypeDebugString(enum FieldType type);
 
@@ -208,6 +220,71 @@ namespace picoproto
         bool copy_arrays;
     };
 
+    // A forward-only cursor over the top level fields of a serialized message.
+    // Unlike Message, this never builds a tree or copies anything: length-delimited
+    // values are handed out as pointers into the original buffer, so any payload the
+    // caller isn't interested in is skipped by its length prefix without being looked
+    // at. Nested messages can be walked by constructing another scanner over GetBytes().
+    //
+    // Example, reading field 1 of every entry in a repeated message field 1:
+    //
+    // FieldScanner root(bytes, bytes_size);
+    // while (root.Next())
+    //   if (root.GetFieldNumber() == 1 && root.GetWireType() == WIRETYPE_LENGTH_DELIMITED)
+    //     ...FieldScanner(root.GetBytes().first, root.GetBytes().second)...
+    class FieldScanner
+    {
+      public:
+        FieldScanner(const uint8_t *bytes, size_t bytes_size);
+
+        // Moves to the next field. Returns false once the end of the buffer is
+        // reached, or if the data is malformed, in which case Failed() is set.
+        bool Next();
+        bool Failed() const
+        {
+            return failed;
+        }
+
+        uint32_t GetFieldNumber() const
+        {
+            return field_number;
+        }
+        enum WireType GetWireType() const
+        {
+            return wire_type;
+        }
+        // The raw value of a VARINT, 64BIT or 32BIT field.
+        uint64_t GetValue() const
+        {
+            return value;
+        }
+        // The payload of a LENGTH_DELIMITED field, pointing into the scanned buffer.
+        std::pair<const uint8_t *, size_t> GetBytes() const
+        {
+            return { data, data_size };
+        }
+        // Offset of the current payload, relative to the start of the scanned buffer.
+        // Only LENGTH_DELIMITED fields have a payload, this is 0 for the others.
+        size_t GetPayloadOffset() const
+        {
+            return data ? static_cast<size_t>(data - begin) : 0;
+        }
+
+      private:
+        bool Fail();
+
+        const uint8_t *begin;
+        const uint8_t *current;
+        const uint8_t *end;
+        bool failed = false;
+
+        uint32_t field_number = 0;
+        enum WireType wire_type = WIRETYPE_VARINT;
+        uint64_t value = 0;
+        const uint8_t *data = nullptr;
+        size_t data_size = 0;
+    };
+
 } // namespace picoproto
 
 #endif // INCLUDE_PICOPROTO_H
@@ -0,0 +1,156 @@
+#include "KeywordFilter.hpp"
+
+#include <QSet>
+#include <QVarLengthArray>
+#include <queue>
+
+namespace Qv2ray::components::QvKeywordFilter
+{
+    static inline char16_t Fold(char16_t c)
+    {
+        if (c < 128)
+            return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+        return QChar(c).toCaseFolded().unicode();
+    }
+
+    static QStringList FoldedKeywords(const QStringList &keywords)
+    {
+        QStringList result;
+        QSet<QString> seen;
+        for (const auto &keyword : keywords)
+        {
+            QString folded;
+            for (const auto c : keyword.trimmed())
+                folded += QChar(Fold(c.unicode()));
+            if (!folded.isEmpty() && !seen.contains(folded))
+            {
+                seen.insert(folded);
+                result << folded;
+            }
+        }
+        return result;
+    }
+
+    KeywordFilter::KeywordFilter() : transitions(1, 0), outputBegin(2, 0)
+    {
+    }
+
+    KeywordFilter::KeywordFilter(const QStringList &includeKeywords, Relation includeRelation, const QStringList &excludeKeywords, Relation excludeRelation)
+    {
+        const auto included = FoldedKeywords(includeKeywords);
+        const auto excluded = FoldedKeywords(excludeKeywords);
+        const auto keywords = included + excluded;
+        includeCount = included.size();
+        excludeCount = excluded.size();
+        includeAll = includeRelation == SubscriptionConfigObject::RELATION_AND;
+        excludeAll = excludeRelation == SubscriptionConfigObject::RELATION_AND;
+
+        for (const auto &keyword : keywords)
+        {
+            for (const auto c : keyword)
+            {
+                const auto u = c.unicode();
+                if (symbolOf(u) != 0)
+                    continue;
+                if (u < 128)
+                    asciiSymbols[u] = symbolCount++;
+                else
+                    otherSymbols.insert(u, symbolCount++);
+            }
+        }
+
+        // The trie, with -1 for missing edges.
+        std::vector<std::vector<int>> keywordsAt(1);
+        transitions.assign(symbolCount, -1);
+        for (auto index = 0; index < keywords.size(); index++)
+        {
+            auto state = 0;
+            for (const auto c : keywords[index])
+            {
+                const auto edge = state * symbolCount + symbolOf(c.unicode());
+                if (transitions[edge] < 0)
+                {
+                    transitions[edge] = int(keywordsAt.size());
+                    keywordsAt.emplace_back();
+                    transitions.resize(transitions.size() + symbolCount, -1);
+                }
+                state = transitions[edge];
+            }
+            keywordsAt[state].push_back(index);
+        }
+
+        // Breadth first, the failure state of each state is complete before its children are visited, missing edges are
+        // replaced by the edges of the failure state, which turns the trie into a complete automaton.
+        std::vector<int> failure(keywordsAt.size(), 0);
+        std::queue<int> pending;
+        for (auto symbol = 0; symbol < symbolCount; symbol++)
+        {
+            auto &next = transitions[symbol];
+            if (next < 0)
+                next = 0;
+            else
+                pending.push(next);
+        }
+
+        while (!pending.empty())
+        {
+            const auto state = pending.front();
+            pending.pop();
+            const auto &inherited = keywordsAt[failure[state]];
+            keywordsAt[state].insert(keywordsAt[state].end(), inherited.begin(), inherited.end());
+
+            for (auto symbol = 0; symbol < symbolCount; symbol++)
+            {
+                auto &next = transitions[state * symbolCount + symbol];
+                const auto fallback = transitions[failure[state] * symbolCount + symbol];
+                if (next < 0)
+                {
+                    next = fallback;
+                    continue;
+                }
+                failure[next] = fallback;
+                pending.push(next);
+            }
+        }
+
+        outputBegin.reserve(keywordsAt.size() + 1);
+        for (const auto &stateKeywords : keywordsAt)
+        {
+            outputBegin.push_back(int(outputs.size()));
+            outputs.insert(outputs.end(), stateKeywords.begin(), stateKeywords.end());
+        }
+        outputBegin.push_back(int(outputs.size()));
+    }
+
+    bool KeywordFilter::Accepts(QStringView name) const
+    {
+        if (IsEmpty())
+            return true;
+
+        const auto isExcluded = [this](int found) { return found > 0 && (!excludeAll || found == excludeCount); };
+
+        QVarLengthArray<quint64, 4> found((includeCount + excludeCount + 63) / 64, 0);
+        auto includedFound = 0;
+        auto excludedFound = 0;
+        auto state = 0;
+        for (const auto c : name)
+        {
+            state = transitions[state * symbolCount + symbolOf(Fold(c.unicode()))];
+            for (auto i = outputBegin[state]; i < outputBegin[state + 1]; i++)
+            {
+                const auto keyword = outputs[i];
+                auto &word = found[keyword / 64];
+                const auto bit = quint64(1) << (keyword % 64);
+                if (word & bit)
+                    continue;
+                word |= bit;
+                if (keyword < includeCount)
+                    includedFound++;
+                else if (isExcluded(++excludedFound))
+                    return false;
+            }
+        }
+
+        return includeCount == 0 || (includeAll ? includedFound == includeCount : includedFound > 0);
+    }
+} // namespace Qv2ray::components::QvKeywordFilter
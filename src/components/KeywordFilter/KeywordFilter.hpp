@@ -0,0 +1,61 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+#include <QHash>
+#include <QStringView>
+#include <array>
+#include <vector>
+
+namespace Qv2ray::components::QvKeywordFilter
+{
+    // The include and exclude keywords of a subscription, compiled into one Aho-Corasick automaton.
+    //
+    // Keywords are trimmed and case folded, empty and duplicated ones are ignored. A name is scanned once, whatever the
+    // number of keywords, and both relations are evaluated from the set of keywords found in it:
+    //   - with RELATION_AND, all keywords of the list must be found, with RELATION_OR at least one of them.
+    //   - an empty include list includes everything, an empty exclude list excludes nothing.
+    // Compiled filters are immutable, Accepts can be called from several threads at the same time.
+    class KeywordFilter
+    {
+      public:
+        using Relation = SubscriptionConfigObject::SubscriptionFilterRelation;
+
+        // A filter accepting everything.
+        KeywordFilter();
+        KeywordFilter(const QStringList &includeKeywords, Relation includeRelation, const QStringList &excludeKeywords, Relation excludeRelation);
+        explicit KeywordFilter(const SubscriptionConfigObject &config)
+            : KeywordFilter(config.includeKeywords, config.includeRelation, config.excludeKeywords, config.excludeRelation){};
+
+        bool Accepts(QStringView name) const;
+        bool IsEmpty() const
+        {
+            return includeCount == 0 && excludeCount == 0;
+        }
+
+      private:
+        int symbolOf(char16_t folded) const
+        {
+            return folded < 128 ? asciiSymbols[folded] : otherSymbols.value(folded, 0);
+        }
+
+        // The alphabet is made of the folded characters present in the keywords, 0 is everything else.
+        std::array<quint16, 128> asciiSymbols{};
+        QHash<char16_t, int> otherSymbols;
+        int symbolCount = 1;
+
+        // Transition table of the complete automaton: state * symbolCount + symbol -> state, state 0 being the root.
+        std::vector<int> transitions;
+        // Keywords ending at each state, including those of its failure links: outputs[outputBegin[s]] ... outputs[outputBegin[s + 1] - 1].
+        // Included keywords are numbered [0, includeCount), excluded ones follow.
+        std::vector<int> outputBegin;
+        std::vector<int> outputs;
+
+        int includeCount = 0;
+        int excludeCount = 0;
+        bool includeAll = true;
+        bool excludeAll = true;
+    };
+} // namespace Qv2ray::components::QvKeywordFilter
+
+using namespace Qv2ray::components::QvKeywordFilter;
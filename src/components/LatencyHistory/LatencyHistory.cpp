@@ -0,0 +1,57 @@
+#include "LatencyHistory.hpp"
+
+#include "LatencyScheduler/LatencyScheduler.hpp"
+#include "Qv2rayBase/Common/ProfileHelpers.hpp"
+#include "Qv2rayBase/Interfaces/IStorageProvider.hpp"
+#include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
+
+#define QV_MODULE_NAME "LatencyHistory"
+
+namespace Qv2ray::components::QvLatencyHistory
+{
+    constexpr auto HISTORY_SETTINGS_KEY = "latency-history";
+
+    QvLatencyHistory::QvLatencyHistory(QObject *parent) : QObject(parent)
+    {
+        load();
+        connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnLatencyTestFinished, this,
+                [this](const ConnectionId &id, const int average)
+                {
+                    if (average != LATENCY_TEST_VALUE_NODATA)
+                        AddResult(id, average);
+                });
+        connect(LatencyScheduler, &QvLatencyScheduler::QvLatencyScheduler::OnTestAbandoned, this,
+                [this](const ConnectionId &id) { AddResult(id, LATENCY_TEST_VALUE_ERROR); });
+    }
+
+    QvLatencyHistory::~QvLatencyHistory()
+    {
+        save();
+    }
+
+    void QvLatencyHistory::AddResult(const ConnectionId &id, int latency)
+    {
+        table.AddResult(id, latency);
+        emit OnStatsUpdated(id);
+    }
+
+    ConnectionId QvLatencyHistory::BestConnection(const GroupId &id) const
+    {
+        return table.BestConnection(QvBaselib->ProfileManager()->GetConnections(id));
+    }
+
+    void QvLatencyHistory::load()
+    {
+        table.LoadJson(QvBaselib->StorageProvider()->GetExtraSettings(QString::fromUtf8(HISTORY_SETTINGS_KEY)));
+    }
+
+    void QvLatencyHistory::save()
+    {
+        // Connections deleted since have no use for their history.
+        for (const auto &id : table.Connections())
+            if (QvBaselib->ProfileManager()->GetGroups(id).isEmpty())
+                table.Remove(id);
+        QvBaselib->StorageProvider()->StoreExtraSettings(QString::fromUtf8(HISTORY_SETTINGS_KEY), table.ToJson());
+    }
+} // namespace Qv2ray::components::QvLatencyHistory
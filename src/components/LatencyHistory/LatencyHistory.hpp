@@ -0,0 +1,43 @@
+#pragma once
+
+#include "LatencyHistoryTable.hpp"
+
+#include <QObject>
+
+namespace Qv2ray::components::QvLatencyHistory
+{
+    // The last LatencyHistoryTable::HISTORY_SIZE latency test results of each connection, instead of only the last one
+    // that ProfileManager keeps, from which a connection can be compared with the others of its group.
+    class QvLatencyHistory : public QObject
+    {
+        Q_OBJECT
+      public:
+        explicit QvLatencyHistory(QObject *parent = nullptr);
+        ~QvLatencyHistory();
+
+        // LATENCY_TEST_VALUE_ERROR is recorded as a failure.
+        void AddResult(const ConnectionId &id, int latency);
+        LatencyStats Stats(const ConnectionId &id) const
+        {
+            return table.Stats(id);
+        }
+        // See LatencyHistoryTable::Score, lower is better.
+        double Score(const ConnectionId &id) const
+        {
+            return table.Score(id);
+        }
+        // The connection of the group with the lowest score, null if none has succeeded yet.
+        ConnectionId BestConnection(const GroupId &id) const;
+
+      signals:
+        void OnStatsUpdated(const ConnectionId &id);
+
+      private:
+        void load();
+        void save();
+
+        LatencyHistoryTable table;
+    };
+} // namespace Qv2ray::components::QvLatencyHistory
+
+inline Qv2ray::components::QvLatencyHistory::QvLatencyHistory *LatencyHistory = nullptr;
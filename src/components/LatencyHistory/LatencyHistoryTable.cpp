@@ -0,0 +1,117 @@
+#include "LatencyHistoryTable.hpp"
+
+#include <QJsonArray>
+#include <algorithm>
+#include <limits>
+
+namespace Qv2ray::components::QvLatencyHistory
+{
+    void LatencyHistoryTable::AddResult(const ConnectionId &id, int latency)
+    {
+        auto &history = histories[id];
+        const auto failed = latency == LATENCY_TEST_VALUE_ERROR || latency < 0;
+        const auto sample = failed ? FAILED_SAMPLE : quint16(std::min(latency, FAILED_SAMPLE - 1));
+
+        if (!failed)
+        {
+            const auto hasSuccess = std::any_of(history.samples.begin(), history.samples.begin() + history.count, [](quint16 s) { return s != FAILED_SAMPLE; });
+            if (hasSuccess)
+            {
+                history.jitter += EWMA_WEIGHT * (std::abs(int(sample) - int(history.lastSuccess)) - history.jitter);
+                history.average += EWMA_WEIGHT * (sample - history.average);
+            }
+            else
+            {
+                history.jitter = 0;
+                history.average = sample;
+            }
+            history.lastSuccess = sample;
+        }
+
+        history.samples[history.next] = sample;
+        history.next = (history.next + 1) % HISTORY_SIZE;
+        history.count = std::min(history.count + 1, HISTORY_SIZE);
+    }
+
+    LatencyStats LatencyHistoryTable::Stats(const ConnectionId &id) const
+    {
+        LatencyStats stats;
+        const auto it = histories.constFind(id);
+        if (it == histories.constEnd() || it->count == 0)
+            return stats;
+
+        stats.samples = it->count;
+        stats.average = it->average;
+        stats.jitter = it->jitter;
+        const auto successes = std::count_if(it->samples.begin(), it->samples.begin() + it->count, [](quint16 s) { return s != FAILED_SAMPLE; });
+        stats.successRate = double(successes) / it->count;
+        // Newest first.
+        while (stats.consecutiveFailures < it->count && it->samples[(it->next + HISTORY_SIZE - 1 - stats.consecutiveFailures) % HISTORY_SIZE] == FAILED_SAMPLE)
+            stats.consecutiveFailures++;
+        return stats;
+    }
+
+    double LatencyHistoryTable::Score(const ConnectionId &id) const
+    {
+        const auto stats = Stats(id);
+        if (stats.successRate == 0)
+            return std::numeric_limits<double>::infinity();
+        return (stats.average + JITTER_WEIGHT * stats.jitter) / stats.successRate;
+    }
+
+    ConnectionId LatencyHistoryTable::BestConnection(const QList<ConnectionId> &connections) const
+    {
+        ConnectionId best;
+        auto bestScore = std::numeric_limits<double>::infinity();
+        for (const auto &connection : connections)
+        {
+            if (const auto score = Score(connection); score < bestScore)
+            {
+                best = connection;
+                bestScore = score;
+            }
+        }
+        return best;
+    }
+
+    QJsonObject LatencyHistoryTable::ToJson() const
+    {
+        QJsonObject root;
+        for (auto it = histories.constBegin(); it != histories.constEnd(); it++)
+        {
+            QJsonArray samples;
+            const auto first = (it->next + HISTORY_SIZE - it->count) % HISTORY_SIZE;
+            for (auto i = 0; i < it->count; i++)
+                samples << it->samples[(first + i) % HISTORY_SIZE];
+            root[it.key().toString()] = QJsonObject{
+                { QStringLiteral("samples"), samples },
+                { QStringLiteral("average"), it->average },
+                { QStringLiteral("jitter"), it->jitter },
+                { QStringLiteral("last"), it->lastSuccess },
+            };
+        }
+        return root;
+    }
+
+    void LatencyHistoryTable::LoadJson(const QJsonObject &root)
+    {
+        for (auto it = root.constBegin(); it != root.constEnd(); it++)
+        {
+            const auto object = it.value().toObject();
+            const auto samples = object[QStringLiteral("samples")].toArray();
+            History history;
+            // Oldest first, which is the order they are saved in.
+            for (const auto &sample : samples)
+            {
+                history.samples[history.next] = quint16(sample.toInt(FAILED_SAMPLE));
+                history.next = (history.next + 1) % HISTORY_SIZE;
+                history.count = std::min(history.count + 1, HISTORY_SIZE);
+            }
+            history.average = object[QStringLiteral("average")].toDouble();
+            history.jitter = object[QStringLiteral("jitter")].toDouble();
+            history.lastSuccess = object[QStringLiteral("last")].toInt();
+            if (history.count > 0)
+                histories.insert(ConnectionId{ it.key() }, history);
+        }
+    }
+} // namespace Qv2ray::components::QvLatencyHistory
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+#include <QJsonObject>
+#include <array>
+
+namespace Qv2ray::components::QvLatencyHistory
+{
+    struct LatencyStats
+    {
+        // Number of recent results, successful or not.
+        int samples = 0;
+        // Failed results since the last successful one.
+        int consecutiveFailures = 0;
+        // Exponentially weighted moving average of the successful results, in milliseconds.
+        double average = 0;
+        // Exponentially weighted moving average of the difference between two successive successful results.
+        double jitter = 0;
+        double successRate = 0;
+    };
+
+    // The histories kept by QvLatencyHistory, without the signals and the storage, so that they can be used on their own.
+    class LatencyHistoryTable
+    {
+      public:
+        static constexpr auto HISTORY_SIZE = 16;
+        // Weight of a new result in the moving averages.
+        static constexpr auto EWMA_WEIGHT = 0.25;
+        // How many milliseconds of average latency a millisecond of jitter costs in Score.
+        static constexpr auto JITTER_WEIGHT = 2.0;
+
+        // LATENCY_TEST_VALUE_ERROR and negative values are recorded as failures.
+        void AddResult(const ConnectionId &id, int latency);
+        LatencyStats Stats(const ConnectionId &id) const;
+        // Lower is better: the average latency plus the jitter, divided by the success rate. Infinity for connections
+        // without any successful result.
+        double Score(const ConnectionId &id) const;
+        // The connection with the lowest score, null if none has succeeded yet.
+        ConnectionId BestConnection(const QList<ConnectionId> &connections) const;
+
+        QList<ConnectionId> Connections() const
+        {
+            return histories.keys();
+        }
+        void Remove(const ConnectionId &id)
+        {
+            histories.remove(id);
+        }
+
+        // The samples of each connection are saved oldest first.
+        QJsonObject ToJson() const;
+        void LoadJson(const QJsonObject &root);
+
+      private:
+        struct History
+        {
+            // Milliseconds, FAILED_SAMPLE for failures.
+            std::array<quint16, HISTORY_SIZE> samples{};
+            quint8 next = 0;
+            quint8 count = 0;
+            float average = 0;
+            float jitter = 0;
+            // The last successful result, for the jitter.
+            quint16 lastSuccess = 0;
+        };
+        static constexpr quint16 FAILED_SAMPLE = 0xFFFF;
+
+        QHash<ConnectionId, History> histories;
+    };
+} // namespace Qv2ray::components::QvLatencyHistory
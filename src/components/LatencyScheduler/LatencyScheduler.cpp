@@ -0,0 +1,62 @@
+#include "LatencyScheduler.hpp"
+
+#include "Qv2rayBase/Common/ProfileHelpers.hpp"
+#include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
+
+#define QV_MODULE_NAME "LatencyScheduler"
+
+namespace Qv2ray::components::QvLatencyScheduler
+{
+    QvLatencyScheduler::QvLatencyScheduler(QObject *parent)
+        : QObject(parent), queue([](const LatencyTest &test) { QvBaselib->ProfileManager()->StartLatencyTest(test.id, test.engine); })
+    {
+        connect(&queue, &LatencyTestQueue::OnQueueChanged, this, &QvLatencyScheduler::OnQueueChanged);
+        connect(&queue, &LatencyTestQueue::OnTestOverdue, this,
+                [](const ConnectionId &id) { QvLog() << "Latency test of" << GetDisplayName(id) << "timed out, still waiting for its result."; });
+        connect(&queue, &LatencyTestQueue::OnTestAbandoned, this,
+                [this](const ConnectionId &id)
+                {
+                    QvLog() << "Latency test of" << GetDisplayName(id) << "never reported a result, giving up.";
+                    emit OnTestAbandoned(id);
+                });
+        connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnLatencyTestFinished, this,
+                [this](const ConnectionId &id) { queue.Finish(id); });
+    }
+
+    void QvLatencyScheduler::Enqueue(const QList<ConnectionId> &ids, const LatencyTestEngineId &engine)
+    {
+        QList<LatencyTest> tests;
+        for (const auto &id : ids)
+        {
+            if (queue.Contains(id))
+                continue;
+
+            LatencyTest test;
+            test.id = id;
+            test.engine = engine;
+            const auto root = QvBaselib->ProfileManager()->GetConnection(id);
+            if (!IsComplexConfig(id) && !root.outbounds.isEmpty())
+                test.host = std::get<1>(GetOutboundInfo(root.outbounds.first()));
+            tests << test;
+        }
+        queue.Enqueue(tests);
+        QvLog() << queue.QueuedCount() << "latency tests queued," << queue.RunningCount() << "running.";
+    }
+
+    void QvLatencyScheduler::Enqueue(const GroupId &id, const LatencyTestEngineId &engine)
+    {
+        Enqueue(QvBaselib->ProfileManager()->GetConnections(id), engine);
+    }
+
+    void QvLatencyScheduler::Prioritize(const QList<ConnectionId> &ids)
+    {
+        queue.Prioritize(ids);
+    }
+
+    void QvLatencyScheduler::CancelQueued()
+    {
+        QvLog() << "Cancelled" << queue.QueuedCount() << "queued and" << queue.OverdueCount() << "overdue latency tests.";
+        queue.CancelQueued();
+    }
+} // namespace Qv2ray::components::QvLatencyScheduler
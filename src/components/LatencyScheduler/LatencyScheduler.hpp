@@ -0,0 +1,50 @@
+#pragma once
+
+#include "LatencyTestQueue.hpp"
+
+namespace Qv2ray::components::QvLatencyScheduler
+{
+    // Runs latency tests through ProfileManager without starting all of them at once.
+    //
+    // Tests are queued, and only LatencyTestQueue::MAX_RUNNING_TESTS of them wait for a result at the same time, with at
+    // most LatencyTestQueue::MAX_RUNNING_TESTS_PER_HOST for the same server address. Testing a large group thus doesn't
+    // flood the network, nor a server hosting many of its connections. Queued tests of the rows on screen can be moved to
+    // the front. A test keeps counting against the limits until ProfileManager reports its result, or until it is abandoned
+    // past the deadline of LatencyTestQueue. An abandoned test counts as failed.
+    class QvLatencyScheduler : public QObject
+    {
+        Q_OBJECT
+      public:
+        explicit QvLatencyScheduler(QObject *parent = nullptr);
+        // Connections already queued or running are skipped.
+        void Enqueue(const QList<ConnectionId> &ids, const LatencyTestEngineId &engine);
+        void Enqueue(const GroupId &id, const LatencyTestEngineId &engine);
+        // Moves the queued tests of these connections to the front.
+        void Prioritize(const QList<ConnectionId> &ids);
+        // Drops the queued tests and abandons the overdue ones, the others still report their results.
+        void CancelQueued();
+
+        qsizetype QueuedCount() const
+        {
+            return queue.QueuedCount();
+        }
+        qsizetype RunningCount() const
+        {
+            return queue.RunningCount();
+        }
+        qsizetype OverdueCount() const
+        {
+            return queue.OverdueCount();
+        }
+
+      signals:
+        void OnQueueChanged(qsizetype queued, qsizetype running);
+        // No result came for the test, record it as LATENCY_TEST_VALUE_ERROR.
+        void OnTestAbandoned(const ConnectionId &id);
+
+      private:
+        LatencyTestQueue queue;
+    };
+} // namespace Qv2ray::components::QvLatencyScheduler
+
+inline Qv2ray::components::QvLatencyScheduler::QvLatencyScheduler *LatencyScheduler = nullptr;
@@ -0,0 +1,127 @@
+#include "LatencyTestQueue.hpp"
+
+#include <algorithm>
+
+namespace Qv2ray::components::QvLatencyScheduler
+{
+    // Tests of saturated hosts are skipped when looking for the next ones to start, but only this far into the queue.
+    constexpr auto MAX_QUEUE_SCAN = 256;
+
+    LatencyTestQueue::LatencyTestQueue(StartFunction start, int timeoutMsecs, QObject *parent)
+        : QObject(parent), start(std::move(start)), timeoutMsecs(timeoutMsecs)
+    {
+        timeoutTimer.setInterval(std::min(1000, timeoutMsecs));
+        connect(&timeoutTimer, &QTimer::timeout, this, &LatencyTestQueue::checkOverdueTests);
+    }
+
+    void LatencyTestQueue::Enqueue(const QList<LatencyTest> &tests)
+    {
+        for (const auto &test : tests)
+        {
+            if (Contains(test.id))
+                continue;
+            queue << test;
+            queuedIds << test.id;
+        }
+        startTests();
+    }
+
+    void LatencyTestQueue::Prioritize(const QList<ConnectionId> &ids)
+    {
+        const QSet<ConnectionId> prioritized{ ids.begin(), ids.end() };
+        std::stable_partition(queue.begin(), queue.end(), [&prioritized](const LatencyTest &test) { return prioritized.contains(test.id); });
+    }
+
+    void LatencyTestQueue::CancelQueued()
+    {
+        queue.clear();
+        queuedIds.clear();
+
+        QList<ConnectionId> overdue;
+        for (const auto &test : running)
+            if (test.overdue)
+                overdue << test.id;
+        abandonTests(overdue);
+        emit OnQueueChanged(queue.size(), running.size());
+    }
+
+    void LatencyTestQueue::Finish(const ConnectionId &id)
+    {
+        if (!running.contains(id))
+            return;
+
+        release(id);
+        startTests();
+    }
+
+    void LatencyTestQueue::release(const ConnectionId &id)
+    {
+        const auto test = running.take(id);
+        if (!test.host.isEmpty() && --runningPerHost[test.host] <= 0)
+            runningPerHost.remove(test.host);
+    }
+
+    void LatencyTestQueue::abandonTests(const QList<ConnectionId> &ids)
+    {
+        for (const auto &id : ids)
+            release(id);
+        // Emitted once all are released, receivers may enqueue tests again.
+        for (const auto &id : ids)
+            emit OnTestAbandoned(id);
+    }
+
+    void LatencyTestQueue::startTests()
+    {
+        for (auto i = 0; i < queue.size() && i < MAX_QUEUE_SCAN && running.size() < MAX_RUNNING_TESTS;)
+        {
+            const auto &host = queue[i].host;
+            if (!host.isEmpty() && runningPerHost.value(host) >= MAX_RUNNING_TESTS_PER_HOST)
+            {
+                i++;
+                continue;
+            }
+
+            auto test = queue.takeAt(i);
+            queuedIds.remove(test.id);
+            if (!test.host.isEmpty())
+                runningPerHost[test.host]++;
+            test.started.start();
+            running.insert(test.id, test);
+            // The start function may finish the test right away, which comes back here.
+            start(test);
+        }
+
+        if (running.isEmpty())
+            timeoutTimer.stop();
+        else if (!timeoutTimer.isActive())
+            timeoutTimer.start();
+        emit OnQueueChanged(queue.size(), running.size());
+    }
+
+    void LatencyTestQueue::checkOverdueTests()
+    {
+        QList<ConnectionId> overdue;
+        QList<ConnectionId> expired;
+        for (auto &test : running)
+        {
+            if (test.started.hasExpired(qint64(timeoutMsecs) * TEST_DEADLINE_FACTOR))
+                expired << test.id;
+            else if (!test.overdue && test.started.hasExpired(timeoutMsecs))
+            {
+                test.overdue = true;
+                overdue << test.id;
+            }
+        }
+
+        // Emitted after the loop, receivers may finish tests.
+        for (const auto &id : overdue)
+            emit OnTestOverdue(id);
+
+        if (expired.isEmpty())
+            return;
+        // Finished in the meantime by a receiver of OnTestOverdue.
+        expired.erase(std::remove_if(expired.begin(), expired.end(), [this](const ConnectionId &id) { return !running.contains(id); }), expired.end());
+        abandonTests(expired);
+        startTests();
+    }
+} // namespace Qv2ray::components::QvLatencyScheduler
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+
+namespace Qv2ray::components::QvLatencyScheduler
+{
+    struct LatencyTest
+    {
+        ConnectionId id;
+        // Empty for complex connections, which aren't limited per host.
+        QString host;
+        LatencyTestEngineId engine;
+        QElapsedTimer started;
+        // The result should have arrived by now.
+        bool overdue = false;
+    };
+
+    // The queue and the limits of QvLatencyScheduler, starting tests through a function rather than through ProfileManager.
+    //
+    // Only MAX_RUNNING_TESTS tests wait for a result at the same time, with at most MAX_RUNNING_TESTS_PER_HOST for the same
+    // host. A test is running from the call to the start function until Finish is called for it. One whose result is
+    // overdue still counts against the limits, its engine may hold a connection to a server that doesn't answer. Past
+    // TEST_DEADLINE_FACTOR times the timeout the test is abandoned: some engines never report, and their tests would
+    // otherwise keep the slots forever.
+    class LatencyTestQueue : public QObject
+    {
+        Q_OBJECT
+      public:
+        static constexpr auto MAX_RUNNING_TESTS = 16;
+        static constexpr auto MAX_RUNNING_TESTS_PER_HOST = 2;
+        static constexpr auto TEST_TIMEOUT_MSECS = 15000;
+        static constexpr auto TEST_DEADLINE_FACTOR = 4;
+
+        using StartFunction = std::function<void(const LatencyTest &)>;
+
+        explicit LatencyTestQueue(StartFunction start, int timeoutMsecs = TEST_TIMEOUT_MSECS, QObject *parent = nullptr);
+        // Tests of connections already queued or running are skipped.
+        void Enqueue(const QList<LatencyTest> &tests);
+        // Moves the queued tests of these connections to the front.
+        void Prioritize(const QList<ConnectionId> &ids);
+        // Drops the queued tests and abandons the overdue ones, the others still report their results.
+        void CancelQueued();
+        // The result of a running test has arrived.
+        void Finish(const ConnectionId &id);
+
+        bool Contains(const ConnectionId &id) const
+        {
+            return queuedIds.contains(id) || running.contains(id);
+        }
+        qsizetype QueuedCount() const
+        {
+            return queue.size();
+        }
+        qsizetype RunningCount() const
+        {
+            return running.size();
+        }
+        qsizetype OverdueCount() const
+        {
+            return std::count_if(running.begin(), running.end(), [](const LatencyTest &test) { return test.overdue; });
+        }
+
+      signals:
+        void OnQueueChanged(qsizetype queued, qsizetype running);
+        // Emitted once per test whose result is overdue.
+        void OnTestOverdue(const ConnectionId &id);
+        // The test no longer counts against the limits, and a result arriving later is ignored.
+        void OnTestAbandoned(const ConnectionId &id);
+
+      private:
+        void startTests();
+        void checkOverdueTests();
+        void abandonTests(const QList<ConnectionId> &ids);
+        void release(const ConnectionId &id);
+
+        StartFunction start;
+        int timeoutMsecs;
+        QList<LatencyTest> queue;
+        QSet<ConnectionId> queuedIds;
+        QHash<ConnectionId, LatencyTest> running;
+        QHash<QString, int> runningPerHost;
+        QTimer timeoutTimer;
+    };
+} // namespace Qv2ray::components::QvLatencyScheduler
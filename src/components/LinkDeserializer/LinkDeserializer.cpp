@@ -0,0 +1,159 @@
+#include "LinkDeserializer.hpp"
+
+#include "Qv2rayBase/Plugin/PluginAPIHost.hpp"
+#include "Qv2rayBase/Plugin/PluginManagerCore.hpp"
+#include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
+
+#include <QtConcurrent>
+
+#define QV_MODULE_NAME "LinkDeserializer"
+
+namespace Qv2ray::components::LinkDeserializer
+{
+    using LinkShard = std::pair<int, QStringList>;
+
+    const auto BUILTIN_PROTOCOL_PLUGIN = PluginId(QStringLiteral("qv2ray_builtin_protocol"));
+
+    ThreadSafeLinkDeserializer::ThreadSafeLinkDeserializer()
+    {
+        QSet<QString> otherPrefixes;
+        for (const auto &plugin : QvBaselib->PluginManagerCore()->GetPlugins(Qv2rayPlugin::COMPONENT_OUTBOUND_HANDLER))
+        {
+            const auto processor = plugin->pinterface->OutboundHandler();
+            if (!processor)
+                continue;
+
+            const auto supported = processor->SupportedLinkPrefixes();
+            const auto prefixes = QSet<QString>{ supported.begin(), supported.end() };
+            if (plugin->metadata().InternalID == BUILTIN_PROTOCOL_PLUGIN)
+            {
+                builtinProcessor = processor;
+                builtinPrefixes = prefixes;
+            }
+            else
+            {
+                otherPrefixes += prefixes;
+            }
+        }
+        // Which plugin PluginAPIHost would pick for a scheme claimed twice is up to it.
+        builtinPrefixes -= otherPrefixes;
+    }
+
+    bool ThreadSafeLinkDeserializer::CanDeserialize(const QString &link) const
+    {
+        return builtinProcessor && builtinPrefixes.contains(link.section(QStringLiteral("://"), 0, 0).toLower());
+    }
+
+    std::optional<std::pair<QString, IOConnectionSettings>> ThreadSafeLinkDeserializer::Deserialize(const QString &link) const
+    {
+        return builtinProcessor->Deserialize(link);
+    }
+
+    static DeserializedLink MakeResult(int index, const QString &link, const std::optional<std::pair<QString, IOConnectionSettings>> &outbound)
+    {
+        DeserializedLink result;
+        result.index = index;
+        result.link = link;
+        result.outbound = outbound;
+        if (!result.outbound)
+            result.error = QObject::tr("Unsupported or malformed link.");
+        return result;
+    }
+
+    // Links the deserializer can't read are left without an outbound and without an error, see DeserializePluginLinks.
+    static QList<DeserializedLink> DeserializeShard(const ThreadSafeLinkDeserializer &deserializer, const LinkShard &shard)
+    {
+        const auto &[start, links] = shard;
+        QList<DeserializedLink> results;
+        results.reserve(links.size());
+        for (auto i = 0; i < links.size(); i++)
+        {
+            if (deserializer.CanDeserialize(links[i]))
+                results << MakeResult(start + i, links[i], deserializer.Deserialize(links[i]));
+            else
+                results << DeserializedLink{ start + i, links[i], std::nullopt, QString{} };
+        }
+        return results;
+    }
+
+    // Called on the GUI thread, for the links only another plugin can read.
+    static void DeserializePluginLinks(QList<DeserializedLink> &shard)
+    {
+        for (auto &result : shard)
+            if (!result.outbound && result.error.isEmpty())
+                result = MakeResult(result.index, result.link, QvBaselib->PluginAPIHost()->Outbound_Deserialize(result.link));
+    }
+
+    BatchLinkDeserializer::BatchLinkDeserializer(QObject *parent) : QObject(parent)
+    {
+        connect(&watcher, &QFutureWatcher<QList<DeserializedLink>>::resultsReadyAt, this, &BatchLinkDeserializer::onShardReady);
+        connect(&watcher, &QFutureWatcher<QList<DeserializedLink>>::finished, this,
+                [this]()
+                {
+                    if (!running)
+                        return;
+                    onShardReady();
+                    running = false;
+                    QvLog() << "Deserialized" << total << "links.";
+                    emit OnFinished(false);
+                });
+    }
+
+    BatchLinkDeserializer::~BatchLinkDeserializer()
+    {
+        watcher.cancel();
+        watcher.waitForFinished();
+    }
+
+    void BatchLinkDeserializer::Start(const QStringList &links)
+    {
+        Cancel();
+
+        total = links.size();
+        nextShard = 0;
+        delivered = 0;
+        running = true;
+
+        QList<LinkShard> shards;
+        shards.reserve(links.size() / SHARD_SIZE + 1);
+        for (auto i = 0; i < links.size(); i += SHARD_SIZE)
+            shards << LinkShard{ i, links.mid(i, SHARD_SIZE) };
+
+        const auto deserializer = std::make_shared<ThreadSafeLinkDeserializer>();
+        watcher.setFuture(QtConcurrent::mapped(shards, [deserializer](const LinkShard &shard) { return DeserializeShard(*deserializer, shard); }));
+    }
+
+    void BatchLinkDeserializer::Cancel()
+    {
+        if (!running)
+            return;
+        running = false;
+        watcher.cancel();
+        emit OnFinished(true);
+    }
+
+    bool BatchLinkDeserializer::IsRunning() const
+    {
+        return running;
+    }
+
+    void BatchLinkDeserializer::onShardReady()
+    {
+        if (!running)
+            return;
+
+        // Shards finish in any order, only the continuous ones from the beginning are delivered.
+        const auto future = watcher.future();
+        const auto previous = delivered;
+        while (nextShard < future.resultCount())
+        {
+            auto shard = future.resultAt(nextShard++);
+            DeserializePluginLinks(shard);
+            delivered += shard.size();
+            emit OnLinksDeserialized(shard);
+        }
+
+        if (delivered != previous)
+            emit OnProgress(delivered, total);
+    }
+} // namespace Qv2ray::components::LinkDeserializer
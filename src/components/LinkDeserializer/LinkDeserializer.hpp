@@ -0,0 +1,78 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSet>
+#include <memory>
+#include <optional>
+
+namespace Qv2ray::components::LinkDeserializer
+{
+    struct DeserializedLink
+    {
+        // Position of the link in the input list.
+        int index = -1;
+        QString link;
+        // The name embedded in the link, and the outbound, when deserialization succeeded.
+        std::optional<std::pair<QString, IOConnectionSettings>> outbound;
+        QString error;
+    };
+
+    // Plugins are free to keep state in their outbound processors, so PluginAPIHost is only used from the GUI thread.
+    // The serializer of the builtin protocol plugin keeps none: links of the schemes no other plugin claims are read
+    // with it directly, and this may be done from any thread.
+    class ThreadSafeLinkDeserializer
+    {
+      public:
+        // Must be created on the GUI thread, the processors of the loaded plugins are looked up here.
+        ThreadSafeLinkDeserializer();
+
+        // Whether Deserialize can read the link, the others have to go through PluginAPIHost on the GUI thread.
+        bool CanDeserialize(const QString &link) const;
+        std::optional<std::pair<QString, IOConnectionSettings>> Deserialize(const QString &link) const;
+
+      private:
+        std::shared_ptr<Qv2rayPlugin::Outbound::IOutboundProcessor> builtinProcessor;
+        QSet<QString> builtinPrefixes;
+    };
+
+    // Deserializes a batch of share links on the global thread pool.
+    //
+    // The links are split into shards of SHARD_SIZE, results are delivered on the thread owning this object, one shard
+    // at a time and in input order, so that callers can insert them as they arrive while the UI keeps running. Links that
+    // only another plugin can read are deserialized when their shard is delivered, on the thread owning this object.
+    class BatchLinkDeserializer : public QObject
+    {
+        Q_OBJECT
+      public:
+        static constexpr int SHARD_SIZE = 256;
+
+        explicit BatchLinkDeserializer(QObject *parent = nullptr);
+        ~BatchLinkDeserializer();
+
+        // Starts a new batch, a running batch is cancelled first.
+        void Start(const QStringList &links);
+        // Results not yet delivered are dropped, OnFinished is emitted with cancelled = true.
+        void Cancel();
+        bool IsRunning() const;
+
+      signals:
+        void OnLinksDeserialized(const QList<Qv2ray::components::LinkDeserializer::DeserializedLink> &results);
+        void OnProgress(int finished, int total);
+        void OnFinished(bool cancelled);
+
+      private slots:
+        void onShardReady();
+
+      private:
+        QFutureWatcher<QList<DeserializedLink>> watcher;
+        bool running = false;
+        int total = 0;
+        int nextShard = 0;
+        int delivered = 0;
+    };
+} // namespace Qv2ray::components::LinkDeserializer
+
+using namespace Qv2ray::components::LinkDeserializer;
@@ -1,22 +1,245 @@
 #include "LogHighlighter.hpp"
 
-#define REGEX_IPV6_ADDR                                                                                                                                                  \
-    R"(\[\s*((([0-9A-Fa-f]{1,4}:){7}([0-9A-Fa-f]{1,4}|:))|(([0-9A-Fa-f]{1,4}:){6}(:[0-9A-Fa-f]{1,4}|((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3})|:))|(([0-9A-Fa-f]{1,4}:){5}(((:[0-9A-Fa-f]{1,4}){1,2})|:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3})|:))|(([0-9A-Fa-f]{1,4}:){4}(((:[0-9A-Fa-f]{1,4}){1,3})|((:[0-9A-Fa-f]{1,4})?:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(([0-9A-Fa-f]{1,4}:){3}(((:[0-9A-Fa-f]{1,4}){1,4})|((:[0-9A-Fa-f]{1,4}){0,2}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(([0-9A-Fa-f]{1,4}:){2}(((:[0-9A-Fa-f]{1,4}){1,5})|((:[0-9A-Fa-f]{1,4}){0,3}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(([0-9A-Fa-f]{1,4}:){1}(((:[0-9A-Fa-f]{1,4}){1,6})|((:[0-9A-Fa-f]{1,4}){0,4}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(:(((:[0-9A-Fa-f]{1,4}){1,7})|((:[0-9A-Fa-f]{1,4}){0,5}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:)))(%.+)?\s*\])"
-#define REGEX_IPV4_ADDR R"((\d{1,2}|1\d\d|2[0-4]\d|25[0-5])\.(\d{1,2}|1\d\d|2[0-4]\d|25[0-5])\.(\d{1,2}|1\d\d|2[0-4]\d|25[0-5])\.(\d{1,2}|1\d\d|2[0-4]\d|25[0-5]))"
-#define REGEX_PORT_NUMBER R"(([0-9]|[1-9]\d{1,3}|[1-5]\d{4}|6[0-5]{2}[0-3][0-5])*)"
-#define TO_EOL "(([\\s\\S]*)|([\\d\\D]*)|([\\w\\W]*))$"
+#include <algorithm>
 
-namespace Qv2ray::components::LogHighlighter
+namespace
 {
-    LogHighlighter::LogHighlighter(QTextDocument *parent) : QSyntaxHighlighter(parent)
+    // Character classes are ASCII only, as \d, \w and \s were in the regular expressions.
+    bool IsDigit(QChar c)
+    {
+        return c >= u'0' && c <= u'9';
+    }
+
+    bool IsLetter(QChar c)
+    {
+        return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z');
+    }
+
+    bool IsAlnum(QChar c)
+    {
+        return IsDigit(c) || IsLetter(c);
+    }
+
+    bool IsWord(QChar c)
+    {
+        return IsAlnum(c) || c == u'_';
+    }
+
+    bool IsHostChar(QChar c)
+    {
+        return IsAlnum(c) || c == u'-' || c == u'.';
+    }
+
+    bool IsHex(QChar c)
+    {
+        return IsDigit(c) || (c >= u'a' && c <= u'f') || (c >= u'A' && c <= u'F');
+    }
+
+    bool IsSpace(QChar c)
+    {
+        return c == u' ' || (c >= u'\t' && c <= u'\r');
+    }
+
+    bool IsSpaceAt(QStringView text, qsizetype i)
+    {
+        return i < text.size() && IsSpace(text[i]);
+    }
+
+    bool HasAt(QStringView text, qsizetype i, QStringView token)
+    {
+        return text.sliced(std::min(i, text.size())).startsWith(token);
+    }
+
+    bool HasDigitsAt(QStringView text, qsizetype i, qsizetype count)
+    {
+        if (i + count > text.size())
+            return false;
+        return std::all_of(text.begin() + i, text.begin() + i + count, IsDigit);
+    }
+
+    // After the digits of a port starting at i, which may be empty. The port pattern repeated a single digit without
+    // bound, so any number of digits is taken.
+    qsizetype PortEnd(QStringView text, qsizetype i)
+    {
+        while (i < text.size() && IsDigit(text[i]))
+            i++;
+        return i;
+    }
+
+    // An octet of IPv4 hosts: one or two digits, or 100 to 255.
+    bool IsOctet(QStringView octet)
+    {
+        if (octet.isEmpty() || octet.size() > 3 || !std::all_of(octet.begin(), octet.end(), IsDigit))
+            return false;
+        return octet.size() < 3 || octet[0] == u'1' || (octet[0] == u'2' && (octet[1] < u'5' || (octet[1] == u'5' && octet[2] <= u'5')));
+    }
+
+    // An octet of an IPv4 address inside an IPv6 one, without leading zeros.
+    bool IsStrictOctet(QStringView octet)
     {
+        return IsOctet(octet) && (octet.size() == 1 || octet[0] != u'0');
     }
 
+    // The number of groups, with an IPv4 address at the end counting as two, -1 if one of them is invalid.
+    qsizetype CountGroups(QStringView groups, bool allowIPv4)
+    {
+        if (groups.isEmpty())
+            return 0;
+
+        const auto items = groups.split(u':');
+        qsizetype count = 0;
+        for (auto i = 0; i < items.size(); i++)
+        {
+            const auto &item = items[i];
+            if (allowIPv4 && i == items.size() - 1 && item.contains(u'.'))
+            {
+                const auto octets = item.split(u'.');
+                if (octets.size() != 4 || !std::all_of(octets.begin(), octets.end(), IsStrictOctet))
+                    return -1;
+                count += 2;
+            }
+            else if (!item.isEmpty() && item.size() <= 4 && std::all_of(item.begin(), item.end(), IsHex))
+                count++;
+            else
+                return -1;
+        }
+        return count;
+    }
+
+    bool IsIPv6(QStringView address)
+    {
+        const auto gap = address.indexOf(u"::");
+        if (gap < 0)
+            return CountGroups(address, true) == 8;
+        if (address.indexOf(u"::", gap + 1) >= 0)
+            return false;
+        // "::" stands for one group at least.
+        const auto left = CountGroups(address.first(gap), false);
+        const auto right = CountGroups(address.sliced(gap + 2), true);
+        return left >= 0 && right >= 0 && left + right <= 7;
+    }
+
+    // After "a.b.c.d:port" starting at i, 0 if there is none. The first octet may start in the middle of a number.
+    qsizetype IPv4End(QStringView text, qsizetype i)
+    {
+        auto j = i;
+        for (auto octet = 0; octet < 4; octet++)
+        {
+            const auto start = j;
+            while (j < text.size() && j - start < 4 && IsDigit(text[j]))
+                j++;
+            if (!IsOctet(text.sliced(start, j - start)) || !HasAt(text, j, octet < 3 ? u"." : u":"))
+                return 0;
+            j++;
+        }
+        return PortEnd(text, j);
+    }
+
+    // After "[address]:port" starting on the bracket at i, 0 if there is none. A zone index "%..." reaches the last "]:"
+    // it can, but doesn't cross a line feed.
+    qsizetype IPv6End(QStringView text, qsizetype i)
+    {
+        const auto size = text.size();
+        auto j = i + 1;
+        while (j < size && IsSpace(text[j]))
+            j++;
+        const auto start = j;
+        while (j < size && (IsHex(text[j]) || text[j] == u':' || text[j] == u'.'))
+            j++;
+        if (!IsIPv6(text.sliced(start, j - start)))
+            return 0;
+
+        if (j < size && text[j] == u'%')
+        {
+            auto lineEnd = j + 1;
+            while (lineEnd < size && text[lineEnd] != u'\n')
+                lineEnd++;
+            for (auto zoneEnd = lineEnd; zoneEnd >= j + 2; zoneEnd--)
+            {
+                auto k = zoneEnd;
+                while (k < size && IsSpace(text[k]))
+                    k++;
+                if (HasAt(text, k, u"]:"))
+                    return PortEnd(text, k + 2);
+            }
+            return 0;
+        }
+
+        while (j < size && IsSpace(text[j]))
+            j++;
+        return HasAt(text, j, u"]:") ? PortEnd(text, j + 2) : 0;
+    }
+
+    // After "domain.tld:port" or "domain.tld/:port" starting at i, 0 if there is none, where runEnd is the end of the host
+    // characters from i. The first label may start in the middle of a word.
+    qsizetype DomainEnd(QStringView text, qsizetype i, qsizetype runEnd)
+    {
+        auto j = runEnd;
+        if (HasAt(text, j, u"/"))
+            j++;
+        if (!HasAt(text, j, u":"))
+            return 0;
+
+        const auto labels = text.sliced(i, runEnd - i).split(u'.');
+        if (labels.size() < 2)
+            return 0;
+        const auto &tld = labels.last();
+        if (tld.size() < 2 || tld.size() > 6 || !std::all_of(tld.begin(), tld.end(), IsLetter))
+            return 0;
+        const auto validLabels = std::all_of(labels.begin(), labels.end() - 1,
+                                             [](QStringView label)
+                                             {
+                                                 return !label.isEmpty() && label.size() <= 63 && IsAlnum(label.front()) && IsAlnum(label.back()) &&
+                                                        std::all_of(label.begin(), label.end(), IsHostChar);
+                                             });
+        return validLabels ? PortEnd(text, j + 1) : 0;
+    }
+
+    // After " a/b/c: " starting on the space at i, 0 if there is none.
+    qsizetype ComponentEnd(QStringView text, qsizetype i)
+    {
+        auto j = i + 1;
+        auto slashes = 0;
+        while (j < text.size())
+        {
+            const auto wordStart = j;
+            while (j < text.size() && IsWord(text[j]))
+                j++;
+            if (j == wordStart)
+                return 0;
+            if (j < text.size() && text[j] == u'/')
+            {
+                slashes++;
+                j++;
+                continue;
+            }
+            break;
+        }
+        return slashes > 0 && HasAt(text, j, u": ") ? j + 2 : 0;
+    }
+
+    // "[level]" on the bracket at i, with either case for the first letter.
+    bool IsLevelAt(QStringView text, qsizetype i, QStringView level)
+    {
+        if (i + level.size() + 2 > text.size())
+            return false;
+        const auto first = text[i + 1];
+        if (first != level.front() && first != level.front().toUpper())
+            return false;
+        return HasAt(text, i + 2, level.sliced(1)) && text[i + level.size() + 1] == u']';
+    }
+} // namespace
+
+namespace Qv2ray::components::LogHighlighter
+{
     void LogHighlighter::loadRules(bool darkMode)
     {
-        highlightingRules.clear();
-        HighlightingRule rule;
+        formats.fill({});
+        const static QColor darkGreenColor(10, 180, 0);
 
+        auto &tcpudpFormat = formats[TOKEN_TCPUDP];
+        auto &ipHostFormat = formats[TOKEN_IPHOST];
+        auto &warningFormat = formats[TOKEN_WARNING];
         if (darkMode)
         {
             tcpudpFormat.setForeground(QColor(0, 200, 230));
@@ -31,114 +254,165 @@ namespace Qv2ray::components::LogHighlighter
             tcpudpFormat.setForeground(QColor(0, 52, 130));
             warningFormat.setBackground(QColor(255, 160, 15));
         }
+        tcpudpFormat.setFontWeight(QFont::Bold);
+        warningFormat.setFontWeight(QFont::Bold);
 
-        for (const auto &pattern : { "tcp", "udp" })
-        {
-            tcpudpFormat.setFontWeight(QFont::Bold);
-            rule.pattern = QRegularExpression(pattern);
-            rule.format = tcpudpFormat;
-            highlightingRules.append(rule);
-        }
-
-        dateFormat.setForeground(darkMode ? Qt::cyan : Qt::darkCyan);
-        rule.pattern = QRegularExpression(QStringLiteral("\\d\\d\\d\\d/\\d\\d/\\d\\d"));
-        rule.format = dateFormat;
-        highlightingRules.append(rule);
-        //
-        timeFormat.setForeground(darkMode ? Qt::cyan : Qt::darkCyan);
-        rule.pattern = QRegularExpression(QStringLiteral("\\d\\d:\\d\\d:\\d\\d"));
-        rule.format = timeFormat;
-        highlightingRules.append(rule);
-        //
-        debugFormat.setForeground(Qt::darkGray);
-        rule.pattern = QRegularExpression("\\[[Dd]ebug\\]" TO_EOL);
-        rule.format = debugFormat;
-        highlightingRules.append(rule);
-        //
-        infoFormat.setForeground(darkMode ? Qt::lightGray : Qt::darkCyan);
-        rule.pattern = QRegularExpression("\\[[Ii]nfo\\]" TO_EOL);
-        rule.format = infoFormat;
-        highlightingRules.append(rule);
-        //
-        //
-        {
-            // IP IPv6 Host;
-            rule.pattern = QRegularExpression(REGEX_IPV4_ADDR ":" REGEX_PORT_NUMBER);
-            rule.pattern.setPatternOptions(QRegularExpression::ExtendedPatternSyntaxOption);
-            rule.format = ipHostFormat;
-            highlightingRules.append(rule);
-            //
-            rule.pattern = QRegularExpression(REGEX_IPV6_ADDR ":" REGEX_PORT_NUMBER);
-            rule.pattern.setPatternOptions(QRegularExpression::ExtendedPatternSyntaxOption);
-            rule.format = ipHostFormat;
-            highlightingRules.append(rule);
-            //
-            rule.pattern = QRegularExpression("([a-zA-Z0-9]([a-zA-Z0-9\\-]{0,61}[a-zA-Z0-9])?\\.)+[a-zA-Z]{2,6}(/|):" REGEX_PORT_NUMBER);
-            rule.pattern.setPatternOptions(QRegularExpression::PatternOption::ExtendedPatternSyntaxOption);
-            rule.format = ipHostFormat;
-            highlightingRules.append(rule);
-        }
+        formats[TOKEN_DATE].setForeground(darkMode ? Qt::cyan : Qt::darkCyan);
+        formats[TOKEN_TIME].setForeground(darkMode ? Qt::cyan : Qt::darkCyan);
+        formats[TOKEN_DEBUG].setForeground(Qt::darkGray);
+        formats[TOKEN_INFO].setForeground(darkMode ? Qt::lightGray : Qt::darkCyan);
 
-        const static QColor darkGreenColor(10, 180, 0);
-        //
-        //
+        auto &acceptedFormat = formats[TOKEN_ACCEPTED];
         acceptedFormat.setForeground(darkGreenColor);
         acceptedFormat.setFontItalic(true);
         acceptedFormat.setFontWeight(QFont::Bold);
-        rule.pattern = QRegularExpression(QStringLiteral("\\saccepted\\s"));
-        rule.format = acceptedFormat;
-        highlightingRules.append(rule);
-        //
-        rejectedFormat.setFontWeight(QFont::Bold);
+
+        auto &rejectedFormat = formats[TOKEN_REJECTED];
         rejectedFormat.setBackground(Qt::red);
         rejectedFormat.setForeground(Qt::white);
         rejectedFormat.setFontItalic(true);
         rejectedFormat.setFontWeight(QFont::Bold);
-        rule.pattern = QRegularExpression("\\srejected\\s" TO_EOL);
-        rule.format = rejectedFormat;
-        highlightingRules.append(rule);
-        //
-        v2rayComponentFormat.setForeground(darkMode ? darkGreenColor : Qt::darkYellow);
-        rule.pattern = QRegularExpression(QStringLiteral(R"( (\w+\/)+\w+: )"));
-        rule.format = v2rayComponentFormat;
-        highlightingRules.append(rule);
-        //
-        warningFormat.setFontWeight(QFont::Bold);
-        rule.pattern = QRegularExpression("\\[[Ww]arning\\]" TO_EOL);
-        rule.format = warningFormat;
-        highlightingRules.append(rule);
-        //
+
+        formats[TOKEN_COMPONENT].setForeground(darkMode ? darkGreenColor : Qt::darkYellow);
+
+        auto &failedFormat = formats[TOKEN_FAILED];
         failedFormat.setFontWeight(QFont::Bold);
         failedFormat.setBackground(Qt::red);
         failedFormat.setForeground(Qt::white);
-        rule.pattern = QRegularExpression(QStringLiteral("failed"));
-        rule.format = failedFormat;
-        highlightingRules.append(rule);
-        //
-        qvAppLogFormat.setForeground(darkMode ? Qt::cyan : Qt::darkCyan);
-        rule.pattern = QRegularExpression(QStringLiteral("\\[[A-Z]*\\]:"));
-        rule.format = qvAppLogFormat;
-        highlightingRules.append(rule);
-        //
-        qvAppDebugLogFormat.setForeground(darkMode ? Qt::yellow : Qt::darkYellow);
-        rule.pattern = QRegularExpression(QStringLiteral(R"( \[\w+\] )"));
-        rule.format = qvAppDebugLogFormat;
-        highlightingRules.append(rule);
-    }
-
-    void LogHighlighter::highlightBlock(const QString &text)
-    {
-        for (const HighlightingRule &rule : qAsConst(highlightingRules))
+
+        formats[TOKEN_APPLOG].setForeground(darkMode ? Qt::cyan : Qt::darkCyan);
+        formats[TOKEN_APPDEBUG].setForeground(darkMode ? Qt::yellow : Qt::darkYellow);
+    }
+
+    QList<QTextLayout::FormatRange> LogHighlighter::Highlight(const QString &line) const
+    {
+        const auto kindOf = Classify(line);
+        const auto size = kindOf.size();
+
+        QList<QTextLayout::FormatRange> ranges;
+        for (qsizetype start = 0; start < size;)
+        {
+            auto end = start + 1;
+            while (end < size && kindOf[end] == kindOf[start])
+                end++;
+            if (kindOf[start] != TOKEN_NONE)
+                ranges << QTextLayout::FormatRange{ int(start), int(end - start), formats[kindOf[start]] };
+            start = end;
+        }
+        return ranges;
+    }
+
+    QVector<qint8> LogHighlighter::Classify(QStringView text)
+    {
+        const auto size = text.size();
+        QVector<qint8> kindOf(size, TOKEN_NONE);
+        const auto mark = [&kindOf](qsizetype start, qsizetype end, TokenKind kind)
         {
-            auto matchIterator = rule.pattern.globalMatch(text);
+            for (auto i = start; i < end; i++)
+                kindOf[i] = std::max<qint8>(kindOf[i], kind);
+        };
 
-            while (matchIterator.hasNext())
+        // Each regular expression matched from where its previous match ended, a token can't start inside the previous
+        // token of the same kind.
+        qsizetype dateEnd = 0, timeEnd = 0, ipv4End = 0, ipv6End = 0, domainEnd = 0, acceptedEnd = 0, componentEnd = 0, appDebugEnd = 0;
+        // The end of the host characters around i, for the domains starting in them.
+        qsizetype hostRunEnd = 0;
+
+        for (qsizetype i = 0; i < size; i++)
+        {
+            const auto c = text[i];
+
+            // These are found anywhere, even inside words.
+            if (HasAt(text, i, u"tcp") || HasAt(text, i, u"udp"))
+                mark(i, i + 3, TOKEN_TCPUDP);
+            else if (HasAt(text, i, u"failed"))
+                mark(i, i + 6, TOKEN_FAILED);
+
+            if (IsSpace(c))
             {
-                QRegularExpressionMatch match = matchIterator.next();
-                setFormat(match.capturedStart(), match.capturedLength(), rule.format);
+                if (i >= acceptedEnd && HasAt(text, i + 1, u"accepted") && IsSpaceAt(text, i + 9))
+                {
+                    mark(i, i + 10, TOKEN_ACCEPTED);
+                    acceptedEnd = i + 10;
+                }
+                else if (HasAt(text, i + 1, u"rejected") && IsSpaceAt(text, i + 9))
+                    mark(i, size, TOKEN_REJECTED);
+
+                if (c != u' ')
+                    continue;
+                if (const auto end = i >= componentEnd ? ComponentEnd(text, i) : 0; end > 0)
+                {
+                    mark(i, end, TOKEN_COMPONENT);
+                    componentEnd = end;
+                }
+                if (i >= appDebugEnd && HasAt(text, i + 1, u"["))
+                {
+                    auto j = i + 2;
+                    while (j < size && IsWord(text[j]))
+                        j++;
+                    if (j > i + 2 && HasAt(text, j, u"] "))
+                    {
+                        mark(i, j + 2, TOKEN_APPDEBUG);
+                        appDebugEnd = j + 2;
+                    }
+                }
             }
-        }
+            else if (c == u'[')
+            {
+                if (IsLevelAt(text, i, u"debug"))
+                    mark(i, size, TOKEN_DEBUG);
+                else if (IsLevelAt(text, i, u"info"))
+                    mark(i, size, TOKEN_INFO);
+                else if (IsLevelAt(text, i, u"warning"))
+                    mark(i, size, TOKEN_WARNING);
 
-        setCurrentBlockState(0);
+                // "[MODULE]:" of Qv2ray's own log.
+                auto j = i + 1;
+                while (j < size && text[j] >= u'A' && text[j] <= u'Z')
+                    j++;
+                if (HasAt(text, j, u"]:"))
+                    mark(i, j + 2, TOKEN_APPLOG);
+
+                if (const auto end = i >= ipv6End ? IPv6End(text, i) : 0; end > 0)
+                {
+                    mark(i, end, TOKEN_IPHOST);
+                    ipv6End = end;
+                }
+            }
+            else if (IsAlnum(c))
+            {
+                if (i >= dateEnd && HasDigitsAt(text, i, 4) && HasAt(text, i + 4, u"/") && HasDigitsAt(text, i + 5, 2) && HasAt(text, i + 7, u"/") &&
+                    HasDigitsAt(text, i + 8, 2))
+                {
+                    mark(i, i + 10, TOKEN_DATE);
+                    dateEnd = i + 10;
+                }
+                if (i >= timeEnd && HasDigitsAt(text, i, 2) && HasAt(text, i + 2, u":") && HasDigitsAt(text, i + 3, 2) && HasAt(text, i + 5, u":") &&
+                    HasDigitsAt(text, i + 6, 2))
+                {
+                    mark(i, i + 8, TOKEN_TIME);
+                    timeEnd = i + 8;
+                }
+
+                if (const auto end = i >= ipv4End && IsDigit(c) ? IPv4End(text, i) : 0; end > 0)
+                {
+                    mark(i, end, TOKEN_IPHOST);
+                    ipv4End = end;
+                }
+
+                if (i >= hostRunEnd)
+                {
+                    hostRunEnd = i;
+                    while (hostRunEnd < size && IsHostChar(text[hostRunEnd]))
+                        hostRunEnd++;
+                }
+                if (const auto end = i >= domainEnd ? DomainEnd(text, i, hostRunEnd) : 0; end > 0)
+                {
+                    mark(i, end, TOKEN_IPHOST);
+                    domainEnd = end;
+                }
+            }
+        }
+        return kindOf;
     }
 } // namespace Qv2ray::components::LogHighlighter
@@ -49,45 +49,48 @@
 ****************************************************************************/
 
 #pragma once
-#include <QRegularExpression>
-#include <QSyntaxHighlighter>
 #include <QTextCharFormat>
-#include <QTextDocument>
+#include <QTextLayout>
+#include <array>
 
 namespace Qv2ray::components::LogHighlighter
 {
-    class LogHighlighter : public QSyntaxHighlighter
+    // Formats of the parts of a log line, for LogItemDelegate to lay the line out with.
+    //
+    // A line is classified in one left to right scan: dates, times, levels, tcp/udp, addresses with a port and the
+    // other tokens are recognized from their first character, instead of running one regular expression per kind of
+    // token over the whole line. The tokens are the matches those regular expressions had, tests/auto/tst_LogHighlighter
+    // compares both.
+    class LogHighlighter
     {
-        Q_OBJECT
-
       public:
-        explicit LogHighlighter(QTextDocument *parent = nullptr);
         void loadRules(bool darkMode);
+        // When tokens overlap, the format of the later kind wins, character by character.
+        QList<QTextLayout::FormatRange> Highlight(const QString &text) const;
+        // The kind of each character of the line, TOKEN_NONE outside of tokens.
+        static QVector<qint8> Classify(QStringView text);
 
-      protected:
-        void highlightBlock(const QString &text) override;
-
-      private:
-        struct HighlightingRule
+        // In increasing precedence.
+        enum TokenKind : qint8
         {
-            QRegularExpression pattern;
-            QTextCharFormat format;
+            TOKEN_NONE = -1,
+            TOKEN_TCPUDP,
+            TOKEN_DATE,
+            TOKEN_TIME,
+            TOKEN_DEBUG,
+            TOKEN_INFO,
+            TOKEN_IPHOST,
+            TOKEN_ACCEPTED,
+            TOKEN_REJECTED,
+            TOKEN_COMPONENT,
+            TOKEN_WARNING,
+            TOKEN_FAILED,
+            TOKEN_APPLOG,
+            TOKEN_APPDEBUG,
+            TOKEN_KIND_COUNT
         };
-        QVector<HighlightingRule> highlightingRules;
 
-        QTextCharFormat tcpudpFormat;
-        QTextCharFormat dateFormat;
-        QTextCharFormat acceptedFormat;
-        QTextCharFormat rejectedFormat;
-        QTextCharFormat failedFormat;
-        QTextCharFormat warningFormat;
-        QTextCharFormat infoFormat;
-        QTextCharFormat debugFormat;
-        QTextCharFormat timeFormat;
-        QTextCharFormat ipHostFormat;
-        QTextCharFormat v2rayComponentFormat;
-
-        QTextCharFormat qvAppLogFormat;
-        QTextCharFormat qvAppDebugLogFormat;
+      private:
+        std::array<QTextCharFormat, TOKEN_KIND_COUNT> formats;
     };
 } // namespace Qv2ray::components::LogHighlighter
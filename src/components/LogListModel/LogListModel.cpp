@@ -0,0 +1,130 @@
+#include "LogListModel.hpp"
+
+#include "UpdateScheduler/UpdateScheduler.hpp"
+
+namespace Qv2ray::ui::widgets::models
+{
+    LogRing::LogRing(qsizetype capacity) : lines(std::max(capacity, qsizetype(1)))
+    {
+    }
+
+    void LogRing::SetCapacity(qsizetype capacity)
+    {
+        capacity = std::max(capacity, qsizetype(1));
+        if (capacity == qsizetype(lines.size()))
+            return;
+
+        std::vector<QString> resized(capacity);
+        const auto kept = std::min(count, capacity);
+        for (auto line = nextLine - kept; line < nextLine; line++)
+            resized[line % capacity] = std::move(lines[line % lines.size()]);
+        lines = std::move(resized);
+        count = kept;
+    }
+
+    void LogRing::Append(const QString &line)
+    {
+        lines[nextLine % lines.size()] = line;
+        nextLine++;
+        count = std::min(count + 1, qsizetype(lines.size()));
+        longestLine = std::max(longestLine, line.size());
+    }
+
+    void LogRing::Clear()
+    {
+        // The numbering goes on, so that line numbers are never reused.
+        for (auto line = FirstLine(); line < EndLine(); line++)
+            lines[line % lines.size()].clear();
+        count = 0;
+        longestLine = 0;
+    }
+
+    QStringList LogRing::Tail(qsizetype n) const
+    {
+        QStringList result;
+        const auto taken = std::min(std::max(n, qsizetype(0)), count);
+        result.reserve(taken);
+        for (auto line = nextLine - taken; line < nextLine; line++)
+            result << Line(line);
+        return result;
+    }
+
+    LogListModel::LogListModel(qsizetype capacity, QObject *parent) : QAbstractListModel(parent), ring(capacity)
+    {
+        flushUpdate = UpdateScheduler->AddUpdate(this, [this]() { flushUpdates(); });
+    }
+
+    int LogListModel::rowCount(const QModelIndex &parent) const
+    {
+        return parent.isValid() ? 0 : int(endRow - firstRow);
+    }
+
+    QVariant LogListModel::data(const QModelIndex &index, int role) const
+    {
+        if (!index.isValid() || role != Qt::DisplayRole)
+            return {};
+        // Rows of lines overwritten since the last flush stay empty until they are removed.
+        const auto line = firstRow + index.row();
+        return ring.Contains(line) ? ring.Line(line) : QString{};
+    }
+
+    void LogListModel::Append(const QString &text)
+    {
+        for (auto line : text.split(u'\n'))
+        {
+            if (line.endsWith(u'\r'))
+                line.chop(1);
+            ring.Append(line);
+        }
+        UpdateScheduler->MarkDirty(flushUpdate);
+    }
+
+    void LogListModel::SetCapacity(qsizetype capacity)
+    {
+        ring.SetCapacity(capacity);
+        UpdateScheduler->MarkDirty(flushUpdate);
+    }
+
+    void LogListModel::Clear()
+    {
+        ring.Clear();
+        beginResetModel();
+        firstRow = endRow = ring.EndLine();
+        endResetModel();
+        longestLine = 0;
+        emit OnLongestLineChanged(longestLine);
+    }
+
+    void LogListModel::flushUpdates()
+    {
+        if (ring.FirstLine() >= endRow)
+        {
+            // None of the rows is left, resetting is cheaper than removing them all.
+            beginResetModel();
+            firstRow = ring.FirstLine();
+            endRow = ring.EndLine();
+            endResetModel();
+        }
+        else
+        {
+            if (ring.FirstLine() > firstRow)
+            {
+                beginRemoveRows({}, 0, int(ring.FirstLine() - firstRow - 1));
+                firstRow = ring.FirstLine();
+                endRemoveRows();
+            }
+            if (ring.EndLine() > endRow)
+            {
+                beginInsertRows({}, int(endRow - firstRow), int(ring.EndLine() - firstRow - 1));
+                endRow = ring.EndLine();
+                endInsertRows();
+            }
+        }
+
+        if (ring.LongestLine() > longestLine)
+        {
+            longestLine = ring.LongestLine();
+            emit OnLongestLineChanged(longestLine);
+        }
+    }
+} // namespace Qv2ray::ui::widgets::models
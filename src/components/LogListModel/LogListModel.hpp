@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <vector>
+
+namespace Qv2ray::ui::widgets::models
+{
+    // The last lines of a log, in a fixed number of slots that the newest lines overwrite.
+    //
+    // Lines are numbered from the first one ever appended, a line keeps its number until it is overwritten.
+    class LogRing
+    {
+      public:
+        explicit LogRing(qsizetype capacity);
+        // Keeps the newest lines that still fit.
+        void SetCapacity(qsizetype capacity);
+        void Append(const QString &line);
+        void Clear();
+
+        quint64 FirstLine() const
+        {
+            return nextLine - count;
+        }
+        quint64 EndLine() const
+        {
+            return nextLine;
+        }
+        bool Contains(quint64 line) const
+        {
+            return line >= FirstLine() && line < EndLine();
+        }
+        const QString &Line(quint64 line) const
+        {
+            return lines[line % lines.size()];
+        }
+        // Up to n of the newest lines, oldest first.
+        QStringList Tail(qsizetype n) const;
+        // Length of the longest line appended since the last Clear.
+        qsizetype LongestLine() const
+        {
+            return longestLine;
+        }
+
+      private:
+        std::vector<QString> lines;
+        quint64 nextLine = 0;
+        qsizetype count = 0;
+        qsizetype longestLine = 0;
+    };
+
+    // A log as a flat list of lines for a view with uniform row heights, which only asks for the lines on screen.
+    //
+    // Lines are stored in the ring as they arrive, the rows of the lines overwritten meanwhile are removed and the new
+    // ones inserted by the next flush of UpdateScheduler.
+    class LogListModel : public QAbstractListModel
+    {
+        Q_OBJECT
+      public:
+        explicit LogListModel(qsizetype capacity, QObject *parent = nullptr);
+        int rowCount(const QModelIndex &parent = {}) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+        // Each line of the text becomes a row.
+        void Append(const QString &text);
+        void SetCapacity(qsizetype capacity);
+        void Clear();
+        QStringList Tail(qsizetype n) const
+        {
+            return ring.Tail(n);
+        }
+        qsizetype LongestLine() const
+        {
+            return longestLine;
+        }
+
+      signals:
+        // In characters, to size the column of the view.
+        void OnLongestLineChanged(qsizetype length);
+
+      private:
+        void flushUpdates();
+
+        LogRing ring;
+        // The line numbers of the first row, and after the last row.
+        quint64 firstRow = 0;
+        quint64 endRow = 0;
+        qsizetype longestLine = 0;
+        int flushUpdate;
+    };
+} // namespace Qv2ray::ui::widgets::models
+
+using namespace Qv2ray::ui::widgets::models;
@@ -0,0 +1,470 @@
+#include "RouteSimulator.hpp"
+
+#include "GeositeReader/GeoIPMatcher.hpp"
+#include "GeositeReader/GeositeMatcher.hpp"
+#include "Qv2rayBase/Qv2rayBaseFeatures.hpp"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtConcurrent>
+#include <algorithm>
+#include <limits>
+
+#define QV_MODULE_NAME "RouteSimulator"
+
+namespace Qv2ray::components::RouteSimulator
+{
+    constexpr auto SIMULATION_CHUNK_SIZE = 64 * 1024;
+
+    std::optional<SimulatedRequest> SimulatedRequest::FromString(const QString &line)
+    {
+        const auto tokens = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        if (tokens.isEmpty() || tokens.first().startsWith(QLatin1Char('#')))
+            return std::nullopt;
+
+        SimulatedRequest request;
+        auto host = tokens.first();
+        if (host.startsWith(QLatin1Char('[')))
+        {
+            // [IPv6]:port
+            const auto end = host.indexOf(QLatin1Char(']'));
+            if (end < 0)
+                return std::nullopt;
+            if (host.mid(end + 1).startsWith(QLatin1Char(':')))
+                request.port = host.mid(end + 2).toInt();
+            host = host.mid(1, end - 1);
+        }
+        else if (host.count(QLatin1Char(':')) == 1)
+        {
+            request.port = host.section(QLatin1Char(':'), 1).toInt();
+            host = host.section(QLatin1Char(':'), 0, 0);
+        }
+
+        if (!request.address.setAddress(host))
+            request.domain = host;
+
+        for (auto i = 1; i < tokens.size(); i++)
+        {
+            const auto key = tokens[i].section(QLatin1Char('='), 0, 0);
+            const auto value = tokens[i].section(QLatin1Char('='), 1);
+            if (key == QStringLiteral("network"))
+                request.network = value.toLower();
+            else if (key == QStringLiteral("inbound"))
+                request.inboundTag = value;
+            else if (key == QStringLiteral("protocol"))
+                request.protocol = value.toLower();
+            else if (key == QStringLiteral("ip"))
+                request.address.setAddress(value);
+            else
+                return std::nullopt;
+        }
+        return request;
+    }
+
+    RouteSimulator::RouteSimulator(const ProfileContent &profile, const QString &geositePath, const QString &geoipPath)
+    {
+        if (!profile.outbounds.isEmpty())
+            defaultOutboundTag = profile.outbounds.first().name;
+
+        QSet<QString> balancerTags;
+        for (const auto &outbound : profile.outbounds)
+            if (outbound.objectType == OutboundObject::BALANCER)
+                balancerTags << outbound.name;
+
+        bool needGeosite = false;
+        bool needGeoIP = false;
+        for (const auto &rule : profile.routing.rules)
+        {
+            const auto compiled = CompileRule(rule, balancerTags);
+            needGeosite |= !compiled.geositeCategories.isEmpty() || !compiled.geositeAttributeCategories.isEmpty();
+            needGeoIP |= !compiled.geoipCategories.isEmpty() || !compiled.notGeoipCategories.isEmpty();
+            rules << compiled;
+        }
+
+        if (needGeosite)
+            geositeMatcher = std::make_unique<GeositeReader::GeositeMatcher>(geositePath);
+        if (needGeoIP)
+            geoipMatcher = std::make_unique<GeositeReader::GeoIPMatcher>(geoipPath);
+    }
+
+    RouteSimulator::~RouteSimulator()
+    {
+    }
+
+    // "80", "1000-2000" or "53,443,1000-2000", as v2ray accepts in the port field.
+    QList<std::pair<int, int>> ParsePortList(const QString &ports)
+    {
+        QList<std::pair<int, int>> result;
+        for (const auto &part : ports.split(QLatin1Char(','), Qt::SkipEmptyParts))
+        {
+            bool fromOk = false, toOk = false;
+            const auto from = part.section(QLatin1Char('-'), 0, 0).trimmed().toInt(&fromOk);
+            const auto to = part.contains(QLatin1Char('-')) ? part.section(QLatin1Char('-'), 1).trimmed().toInt(&toOk) : from;
+            if (fromOk && (toOk || !part.contains(QLatin1Char('-'))))
+                result.append({ from, to });
+            else
+                QvLog() << "Invalid port in routing rule:" << part;
+        }
+        return result;
+    }
+
+    QStringList ToStringList(const QJsonValue &value)
+    {
+        if (value.isString())
+            return { value.toString() };
+        QStringList result;
+        for (const auto &item : value.toArray())
+            result << item.toString();
+        return result;
+    }
+
+    ProfileContent RouteSimulator::ProfileFromV2RayConfig(const QJsonObject &config)
+    {
+        ProfileContent profile;
+        for (const auto &value : config[QStringLiteral("outbounds")].toArray())
+        {
+            OutboundObject outbound;
+            outbound.name = value.toObject()[QStringLiteral("tag")].toString();
+            profile.outbounds << outbound;
+        }
+
+        const auto routing = config[QStringLiteral("routing")].toObject();
+        for (const auto &value : routing[QStringLiteral("balancers")].toArray())
+        {
+            OutboundObject balancer;
+            balancer.name = value.toObject()[QStringLiteral("tag")].toString();
+            balancer.objectType = OutboundObject::BALANCER;
+            profile.outbounds << balancer;
+        }
+
+        for (const auto &value : routing[QStringLiteral("rules")].toArray())
+        {
+            const auto object = value.toObject();
+            RuleObject rule;
+            rule.targetDomains = ToStringList(object[QStringLiteral("domain")]) + ToStringList(object[QStringLiteral("domains")]);
+            rule.targetIPs = ToStringList(object[QStringLiteral("ip")]);
+            rule.sourceAddresses = ToStringList(object[QStringLiteral("source")]);
+            rule.networks = ToStringList(object[QStringLiteral("network")]);
+            rule.inboundTags = ToStringList(object[QStringLiteral("inboundTag")]);
+            rule.protocols = ToStringList(object[QStringLiteral("protocol")]);
+            rule.outboundTag = object[QStringLiteral("outboundTag")].toString();
+
+            for (const auto &key : { QStringLiteral("port"), QStringLiteral("sourcePort") })
+            {
+                const auto ports = object[key].isDouble() ? QString::number(object[key].toInt()) : object[key].toString();
+                if (!ports.isEmpty())
+                    rule.extraSettings[key] = ports;
+            }
+            for (const auto &key : { QStringLiteral("balancerTag"), QStringLiteral("user") })
+                if (object.contains(key))
+                    rule.extraSettings[key] = object[key];
+
+            profile.routing.rules << rule;
+        }
+        return profile;
+    }
+
+    RouteSimulator::CompiledRule RouteSimulator::CompileRule(const RuleObject &rule, const QSet<QString> &balancerTags)
+    {
+        CompiledRule result;
+        result.outboundTag = rule.outboundTag;
+        if (result.outboundTag.isEmpty())
+        {
+            // Rules read from a v2ray configuration file keep their balancerTag in extraSettings.
+            result.outboundTag = rule.extraSettings.value(QStringLiteral("balancerTag")).toString();
+            result.isBalancer = !result.outboundTag.isEmpty();
+        }
+        else
+        {
+            result.isBalancer = balancerTags.contains(result.outboundTag);
+        }
+
+        result.hasDomainCondition = !rule.targetDomains.isEmpty();
+        for (const auto &d : rule.targetDomains)
+        {
+            const auto value = d.section(QLatin1Char(':'), 1);
+            if (d.startsWith(QStringLiteral("domain:")))
+                result.domainSuffixes << value.toLower();
+            else if (d.startsWith(QStringLiteral("full:")))
+                result.fullDomains << value.toLower();
+            else if (d.startsWith(QStringLiteral("keyword:")))
+                result.keywords << value.toLower();
+            else if (d.startsWith(QStringLiteral("regexp:")))
+            {
+                QRegularExpression regex(value);
+                regex.optimize();
+                result.regexes << regex;
+            }
+            else if (d.startsWith(QStringLiteral("geosite:")))
+            {
+                auto attributes = value.split(QLatin1Char('@'), Qt::SkipEmptyParts);
+                const auto category = attributes.isEmpty() ? QString{} : attributes.takeFirst().toLower();
+                if (attributes.isEmpty())
+                    result.geositeCategories << category;
+                else
+                    result.geositeAttributeCategories.append({ category, attributes });
+            }
+            else if (d.startsWith(QStringLiteral("ext:")))
+                result.unsupported = true;
+            else
+                result.keywords << d.toLower();
+        }
+
+        result.hasIPCondition = !rule.targetIPs.isEmpty();
+        for (const auto &ip : rule.targetIPs)
+        {
+            if (ip.startsWith(QStringLiteral("geoip:!")))
+                result.notGeoipCategories << ip.mid(7).toLower();
+            else if (ip.startsWith(QStringLiteral("geoip:")))
+                result.geoipCategories << ip.mid(6).toLower();
+            else if (ip.startsWith(QStringLiteral("ext:")))
+                result.unsupported = true;
+            else
+            {
+                auto subnet = QHostAddress::parseSubnet(ip.contains(QLatin1Char('/')) ? ip : ip + (ip.contains(QLatin1Char(':')) ? QStringLiteral("/128") : QStringLiteral("/32")));
+                if (subnet.first.protocol() == QAbstractSocket::IPv4Protocol)
+                {
+                    const quint32 mask = subnet.second == 0 ? 0 : ~quint32(0) << (32 - subnet.second);
+                    const auto start = subnet.first.toIPv4Address() & mask;
+                    result.ipv4Ranges.push_back({ start, start | ~mask });
+                }
+                else if (subnet.first.protocol() == QAbstractSocket::IPv6Protocol)
+                    result.ipv6Subnets << subnet;
+                else
+                    QvLog() << "Invalid IP in routing rule:" << ip;
+            }
+        }
+
+        // Merge the ranges so a lookup is a single binary search.
+        std::sort(result.ipv4Ranges.begin(), result.ipv4Ranges.end());
+        std::vector<std::pair<quint32, quint32>> merged;
+        for (const auto &range : result.ipv4Ranges)
+        {
+            if (!merged.empty() && range.first <= merged.back().second + quint64(1))
+                merged.back().second = std::max(merged.back().second, range.second);
+            else
+                merged.push_back(range);
+        }
+        result.ipv4Ranges = merged;
+
+        if (rule.targetPort.from != 0 && rule.targetPort.to != 0)
+            result.ports.append({ rule.targetPort.from, rule.targetPort.to });
+        else if (const auto ports = rule.extraSettings.value(QStringLiteral("port")).toString(); !ports.isEmpty())
+        {
+            result.ports = ParsePortList(ports);
+            // A port condition that couldn't be read must not turn into "any port".
+            result.unsupported |= result.ports.isEmpty();
+        }
+
+        for (const auto &network : rule.networks)
+            for (const auto &n : network.split(QLatin1Char(','), Qt::SkipEmptyParts))
+                result.networks << n.trimmed().toLower();
+
+        for (const auto &tag : rule.inboundTags)
+            result.inboundTags << tag;
+        for (const auto &protocol : rule.protocols)
+            result.protocols << protocol.toLower();
+
+        if (!rule.sourceAddresses.isEmpty() || (rule.sourcePort.from != 0 && rule.sourcePort.to != 0) || rule.extraSettings.contains(QStringLiteral("sourcePort")) ||
+            !rule.extraSettings.value(QStringLiteral("user")).toArray().isEmpty())
+            result.unsupported = true;
+
+        return result;
+    }
+
+    bool RouteSimulator::MatchRule(const CompiledRule &rule, const SimulatedRequest &request, const QString &domain, std::optional<QSet<QString>> &geosites,
+                                   std::optional<QSet<QString>> &geoips) const
+    {
+        if (rule.unsupported)
+            return false;
+
+        // Cheap conditions first.
+        if (!rule.inboundTags.isEmpty() && !rule.inboundTags.contains(request.inboundTag))
+            return false;
+        if (!rule.networks.isEmpty() && !rule.networks.contains(request.network))
+            return false;
+        if (!rule.protocols.isEmpty() && !rule.protocols.contains(request.protocol))
+            return false;
+        if (!rule.ports.isEmpty() &&
+            std::none_of(rule.ports.begin(), rule.ports.end(), [&](const auto &range) { return request.port >= range.first && request.port <= range.second; }))
+            return false;
+
+        if (rule.hasDomainCondition)
+        {
+            if (domain.isEmpty())
+                return false;
+
+            const auto domainMatched = [&]() {
+                if (rule.fullDomains.contains(domain))
+                    return true;
+
+                for (auto pos = 0; pos < domain.size();)
+                {
+                    if (rule.domainSuffixes.contains(domain.mid(pos)))
+                        return true;
+                    const auto dot = domain.indexOf(QLatin1Char('.'), pos);
+                    if (dot < 0)
+                        break;
+                    pos = dot + 1;
+                }
+
+                for (const auto &keyword : rule.keywords)
+                    if (domain.contains(keyword))
+                        return true;
+
+                for (const auto &regex : rule.regexes)
+                    if (regex.match(domain).hasMatch())
+                        return true;
+
+                if (!rule.geositeCategories.isEmpty() && geositeMatcher)
+                {
+                    if (!geosites)
+                    {
+                        geosites.emplace();
+                        for (const auto &category : geositeMatcher->Match(domain))
+                            geosites->insert(category.toLower());
+                    }
+                    if (geosites->intersects(rule.geositeCategories))
+                        return true;
+                }
+
+                if (geositeMatcher)
+                {
+                    for (const auto &[category, attributes] : rule.geositeAttributeCategories)
+                        if (geositeMatcher->Match(domain, attributes).contains(category, Qt::CaseInsensitive))
+                            return true;
+                }
+                return false;
+            }();
+
+            if (!domainMatched)
+                return false;
+        }
+
+        if (rule.hasIPCondition)
+        {
+            if (request.address.isNull())
+                return false;
+
+            const auto ipMatched = [&]() {
+                bool isIPv4 = false;
+                const auto v4 = request.address.toIPv4Address(&isIPv4);
+                if (isIPv4)
+                {
+                    const auto it = std::upper_bound(rule.ipv4Ranges.begin(), rule.ipv4Ranges.end(), std::make_pair(v4, std::numeric_limits<quint32>::max()));
+                    if (it != rule.ipv4Ranges.begin() && std::prev(it)->second >= v4)
+                        return true;
+                }
+                else
+                {
+                    for (const auto &subnet : rule.ipv6Subnets)
+                        if (request.address.isInSubnet(subnet))
+                            return true;
+                }
+
+                if ((!rule.geoipCategories.isEmpty() || !rule.notGeoipCategories.isEmpty()) && geoipMatcher)
+                {
+                    if (!geoips)
+                    {
+                        geoips.emplace();
+                        for (const auto &category : geoipMatcher->Match(request.address))
+                            geoips->insert(category.toLower());
+                    }
+                    if (geoips->intersects(rule.geoipCategories))
+                        return true;
+                    for (const auto &category : rule.notGeoipCategories)
+                        if (!geoips->contains(category))
+                            return true;
+                }
+                return false;
+            }();
+
+            if (!ipMatched)
+                return false;
+        }
+
+        return true;
+    }
+
+    SimulationResult RouteSimulator::Simulate(const SimulatedRequest &request) const
+    {
+        auto domain = request.domain.toLower();
+        if (domain.endsWith(QLatin1Char('.')))
+            domain.chop(1);
+
+        // Geo lookups are done at most once per request, and only if a rule asks for them.
+        std::optional<QSet<QString>> geosites;
+        std::optional<QSet<QString>> geoips;
+
+        SimulationResult result;
+        for (auto i = 0; i < rules.size(); i++)
+        {
+            result.rulesEvaluated++;
+            if (MatchRule(rules[i], request, domain, geosites, geoips))
+            {
+                result.ruleIndex = i;
+                result.outboundTag = rules[i].outboundTag;
+                result.isBalancer = rules[i].isBalancer;
+                return result;
+            }
+        }
+        result.outboundTag = defaultOutboundTag;
+        return result;
+    }
+
+    QList<SimulationResult> RouteSimulator::Simulate(const QList<SimulatedRequest> &requests) const
+    {
+        return QtConcurrent::blockingMapped<QList<SimulationResult>>(requests, [this](const SimulatedRequest &request) { return Simulate(request); });
+    }
+
+    std::optional<SimulationSummary> RouteSimulator::SimulateFile(const QString &inputPath, const QString &outputPath) const
+    {
+        QFile input(inputPath);
+        QFile output(outputPath);
+        if (!input.open(QFile::ReadOnly) || !output.open(QFile::WriteOnly | QFile::Truncate))
+        {
+            QvLog() << "Cannot open simulation files:" << inputPath << outputPath;
+            return std::nullopt;
+        }
+
+        SimulationSummary summary;
+        summary.ruleHits.fill(0, rules.size());
+
+        QStringList lines;
+        lines.reserve(SIMULATION_CHUNK_SIZE);
+        while (!input.atEnd())
+        {
+            lines.clear();
+            while (lines.size() < SIMULATION_CHUNK_SIZE && !input.atEnd())
+                lines << QString::fromUtf8(input.readLine()).trimmed();
+
+            const auto results = QtConcurrent::blockingMapped<QList<std::optional<SimulationResult>>>(lines, [this](const QString &line) {
+                const auto request = SimulatedRequest::FromString(line);
+                return request ? std::optional{ Simulate(*request) } : std::nullopt;
+            });
+
+            QByteArray buffer;
+            for (auto i = 0; i < lines.size(); i++)
+            {
+                if (!results[i])
+                    continue;
+
+                const auto &result = *results[i];
+                summary.requests++;
+                summary.rulesEvaluated += result.rulesEvaluated;
+                if (result.ruleIndex < 0)
+                    summary.unmatched++;
+                else
+                    summary.ruleHits[result.ruleIndex]++;
+
+                buffer += lines[i].toUtf8() + '\t' + QByteArray::number(result.ruleIndex) + '\t' + result.outboundTag.toUtf8() + '\n';
+            }
+            output.write(buffer);
+        }
+
+        QvLog() << "Simulated" << summary.requests << "requests," << summary.unmatched << "unmatched,"
+                << (summary.requests ? double(summary.rulesEvaluated) / summary.requests : 0) << "rules evaluated per request.";
+        return summary;
+    }
+} // namespace Qv2ray::components::RouteSimulator
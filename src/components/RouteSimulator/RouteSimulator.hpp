@@ -0,0 +1,116 @@
+#pragma once
+
+#include "QvPlugin/Common/CommonTypes.hpp"
+
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <memory>
+#include <optional>
+
+namespace Qv2ray::components::GeositeReader
+{
+    class GeositeMatcher;
+    class GeoIPMatcher;
+} // namespace Qv2ray::components::GeositeReader
+
+namespace Qv2ray::components::RouteSimulator
+{
+    struct SimulatedRequest
+    {
+        QString domain;
+        // The destination address, or the resolved address of the domain.
+        QHostAddress address;
+        int port = 0;
+        QString network = QStringLiteral("tcp");
+        QString inboundTag;
+        // The sniffed protocol, such as "http", "tls" or "bittorrent".
+        QString protocol;
+
+        // Parses one line of a request file, blank lines and lines starting with '#' are ignored:
+        // <domain|ip>[:port] [network=tcp|udp] [inbound=<tag>] [protocol=<name>] [ip=<resolved address>]
+        static std::optional<SimulatedRequest> FromString(const QString &line);
+    };
+
+    struct SimulationResult
+    {
+        // Index into routing.rules, or -1 if no rule has matched and the first outbound is used.
+        int ruleIndex = -1;
+        // The number of rules evaluated before the decision has been made.
+        int rulesEvaluated = 0;
+        // The tag of the outbound, or of the balancer if isBalancer is set.
+        QString outboundTag;
+        bool isBalancer = false;
+    };
+
+    struct SimulationSummary
+    {
+        qint64 requests = 0;
+        qint64 rulesEvaluated = 0;
+        qint64 unmatched = 0;
+        QList<qint64> ruleHits;
+    };
+
+    // Predicts the outbound chosen by v2ray for a request, without starting the kernel.
+    //
+    // The profile should already be preprocessed, rules are evaluated in order and all conditions of a rule must match,
+    // as v2ray does. Since there is no DNS resolution, IP conditions only match when the request carries an address.
+    // Rules with source, user or external file conditions never match.
+    class RouteSimulator
+    {
+      public:
+        RouteSimulator(const ProfileContent &profile, const QString &geositePath, const QString &geoipPath);
+        ~RouteSimulator();
+
+        // Reads the outbounds, balancers and routing rules of a v2ray configuration file. Settings the profile has no
+        // field for, such as balancerTag or a list of ports, are kept in the extraSettings of the rule.
+        static ProfileContent ProfileFromV2RayConfig(const QJsonObject &config);
+
+        // All of the functions are thread-safe, the batch versions run on the global thread pool.
+        SimulationResult Simulate(const SimulatedRequest &request) const;
+        QList<SimulationResult> Simulate(const QList<SimulatedRequest> &requests) const;
+
+        // Simulates every request in inputPath, and writes "<request>\t<rule index>\t<outbound>" lines to outputPath.
+        // The input is processed in chunks, so files with millions of lines don't need to fit into memory.
+        std::optional<SimulationSummary> SimulateFile(const QString &inputPath, const QString &outputPath) const;
+
+      private:
+        struct CompiledRule
+        {
+            bool hasDomainCondition = false;
+            QSet<QString> fullDomains;
+            QSet<QString> domainSuffixes;
+            QStringList keywords;
+            QList<QRegularExpression> regexes;
+            QSet<QString> geositeCategories;
+            // "geosite:google@cn", the category and the attributes its rules must carry.
+            QList<QPair<QString, QStringList>> geositeAttributeCategories;
+
+            bool hasIPCondition = false;
+            // Merged, sorted IPv4 ranges.
+            std::vector<std::pair<quint32, quint32>> ipv4Ranges;
+            QList<QPair<QHostAddress, int>> ipv6Subnets;
+            QSet<QString> geoipCategories;
+            QSet<QString> notGeoipCategories;
+
+            QList<std::pair<int, int>> ports;
+            QSet<QString> networks;
+            QSet<QString> inboundTags;
+            QSet<QString> protocols;
+
+            bool unsupported = false;
+            QString outboundTag;
+            bool isBalancer = false;
+        };
+
+        CompiledRule CompileRule(const RuleObject &rule, const QSet<QString> &balancerTags);
+        bool MatchRule(const CompiledRule &rule, const SimulatedRequest &request, const QString &domain, std::optional<QSet<QString>> &geosites,
+                       std::optional<QSet<QString>> &geoips) const;
+
+        QList<CompiledRule> rules;
+        QString defaultOutboundTag;
+        std::unique_ptr<GeositeReader::GeositeMatcher> geositeMatcher;
+        std::unique_ptr<GeositeReader::GeoIPMatcher> geoipMatcher;
+    };
+} // namespace Qv2ray::components::RouteSimulator
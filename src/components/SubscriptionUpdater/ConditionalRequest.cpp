@@ -0,0 +1,36 @@
+#include "ConditionalRequest.hpp"
+
+namespace Qv2ray::components::QvSubscriptionUpdater
+{
+    QJsonObject CacheValidators::toJson() const
+    {
+        return QJsonObject{ { "address", address },                               //
+                            { "etag", QString::fromUtf8(etag) },                  //
+                            { "lastModified", QString::fromUtf8(lastModified) } };
+    }
+
+    CacheValidators CacheValidators::fromJson(const QJsonObject &object)
+    {
+        return { object["address"].toString(), object["etag"].toString().toUtf8(), object["lastModified"].toString().toUtf8() };
+    }
+
+    void SetConditionalHeaders(QNetworkRequest &request, const QString &address, const CacheValidators &validators)
+    {
+        if (validators.address != address)
+            return;
+        if (!validators.etag.isEmpty())
+            request.setRawHeader("If-None-Match", validators.etag);
+        if (!validators.lastModified.isEmpty())
+            request.setRawHeader("If-Modified-Since", validators.lastModified);
+    }
+
+    CacheValidators ReceivedValidators(const QString &address, const QNetworkReply &reply)
+    {
+        return { address, reply.rawHeader("ETag"), reply.rawHeader("Last-Modified") };
+    }
+
+    bool IsNotModified(const QNetworkReply &reply)
+    {
+        return reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304;
+    }
+} // namespace Qv2ray::components::QvSubscriptionUpdater
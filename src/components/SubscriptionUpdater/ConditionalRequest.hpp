@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+namespace Qv2ray::components::QvSubscriptionUpdater
+{
+    // The ETag and Last-Modified of the last response of a subscription. Scheduled updates send them back, and the server
+    // answers 304 Not Modified, without a body, if the subscription hasn't changed since.
+    struct CacheValidators
+    {
+        // Where they were received from, they are not sent to another address.
+        QString address;
+        QByteArray etag;
+        QByteArray lastModified;
+
+        bool IsEmpty() const
+        {
+            return etag.isEmpty() && lastModified.isEmpty();
+        }
+
+        QJsonObject toJson() const;
+        static CacheValidators fromJson(const QJsonObject &object);
+    };
+
+    // Adds If-None-Match and If-Modified-Since to the request of address, if the validators came from there.
+    void SetConditionalHeaders(QNetworkRequest &request, const QString &address, const CacheValidators &validators);
+    CacheValidators ReceivedValidators(const QString &address, const QNetworkReply &reply);
+    // Nothing is to be decoded then, the reply has no body.
+    bool IsNotModified(const QNetworkReply &reply);
+} // namespace Qv2ray::components::QvSubscriptionUpdater
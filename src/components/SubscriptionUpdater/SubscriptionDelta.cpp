@@ -0,0 +1,71 @@
+#include "SubscriptionDelta.hpp"
+
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace Qv2ray::components::QvSubscriptionUpdater
+{
+    QByteArray ContentHash(const ProfileContent &content)
+    {
+        const auto outbounds = content.toJson()[QStringLiteral("outbounds")].toArray();
+        return QCryptographicHash::hash(QJsonDocument(outbounds).toJson(QJsonDocument::Compact), QCryptographicHash::Sha1);
+    }
+
+    SubscriptionDelta ComputeDelta(const QList<std::pair<ConnectionId, SubscriptionEntry>> &existing, const QList<SubscriptionEntry> &entries)
+    {
+        QHash<QByteArray, QList<int>> existingByHash;
+        QHash<QString, QList<int>> existingByName;
+        for (auto i = 0; i < existing.size(); i++)
+        {
+            existingByHash[existing[i].second.hash] << i;
+            existingByName[existing[i].second.name] << i;
+        }
+
+        // Takes the first existing connection of the list which has not been paired yet.
+        QList<bool> paired(existing.size(), false);
+        const auto takeUnpaired = [&paired](const QList<int> &candidates) -> int
+        {
+            for (const auto index : candidates)
+            {
+                if (!paired[index])
+                {
+                    paired[index] = true;
+                    return index;
+                }
+            }
+            return -1;
+        };
+
+        SubscriptionDelta delta;
+        QList<const SubscriptionEntry *> changedEntries;
+        for (const auto &entry : entries)
+        {
+            const auto index = takeUnpaired(existingByHash.value(entry.hash));
+            if (index < 0)
+            {
+                changedEntries << &entry;
+                continue;
+            }
+            const auto &[id, current] = existing[index];
+            delta.kept << id;
+            if (current.name != entry.name)
+                delta.renamed << std::pair{ id, entry.name };
+        }
+
+        for (const auto entry : changedEntries)
+        {
+            const auto index = takeUnpaired(existingByName.value(entry->name));
+            if (index < 0)
+                delta.added << *entry;
+            else
+                delta.updated << std::pair{ existing[index].first, entry->content };
+        }
+
+        for (auto i = 0; i < existing.size(); i++)
+            if (!paired[i])
+                delta.removed << existing[i].first;
+
+        return delta;
+    }
+} // namespace Qv2ray::components::QvSubscriptionUpdater
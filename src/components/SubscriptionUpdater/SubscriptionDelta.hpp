@@ -0,0 +1,32 @@
+#pragma once
+
+#include "QvPlugin/PluginInterface.hpp"
+
+namespace Qv2ray::components::QvSubscriptionUpdater
+{
+    struct SubscriptionEntry
+    {
+        QString name;
+        ProfileContent content;
+        // See ContentHash
+        QByteArray hash;
+    };
+
+    // What has to be done to a group to make it match a new version of its subscription.
+    struct SubscriptionDelta
+    {
+        // Connections whose content is unchanged, only renamed ones are listed in renamed as well.
+        QList<ConnectionId> kept;
+        QList<std::pair<ConnectionId, QString>> renamed;
+        // Connections with a changed content but the same name, updated in place.
+        QList<std::pair<ConnectionId, ProfileContent>> updated;
+        QList<SubscriptionEntry> added;
+        QList<ConnectionId> removed;
+    };
+
+    // A hash of the canonical JSON of the outbounds of a connection, the keys of QJsonObject are already sorted.
+    QByteArray ContentHash(const ProfileContent &content);
+
+    // Pairs the new entries with the existing connections: first by identical content, then by identical names.
+    SubscriptionDelta ComputeDelta(const QList<std::pair<ConnectionId, SubscriptionEntry>> &existing, const QList<SubscriptionEntry> &entries);
+} // namespace Qv2ray::components::QvSubscriptionUpdater
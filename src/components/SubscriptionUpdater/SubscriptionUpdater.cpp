@@ -0,0 +1,382 @@
+#include "SubscriptionUpdater.hpp"
+
+#include "KeywordFilter/KeywordFilter.hpp"
+#include "LinkDeserializer/LinkDeserializer.hpp"
+#include "Qv2rayBase/Common/ProfileHelpers.hpp"
+#include "Qv2rayBase/Interfaces/IStorageProvider.hpp"
+#include "Qv2rayBase/Plugin/PluginAPIHost.hpp"
+#include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "Qv2rayBase/Qv2rayBaseLibrary.hpp"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#define QV_MODULE_NAME "SubscriptionUpdater"
+
+namespace Qv2ray::components::QvSubscriptionUpdater
+{
+    using ExistingConnections = QList<std::pair<ConnectionId, SubscriptionEntry>>;
+
+    constexpr auto VALIDATORS_SETTINGS_KEY = "subscription-validators";
+
+    struct DecodedSubscription
+    {
+        QString error;
+        qint64 decodeTime = 0;
+        QStringList links;
+        // One for each link. Those of the links in pluginLinks are only filled in on the GUI thread, see FinishEntries.
+        QList<std::optional<SubscriptionEntry>> entries;
+        QList<int> pluginLinks;
+    };
+
+    static std::optional<SubscriptionEntry> MakeEntry(const std::optional<std::pair<QString, IOConnectionSettings>> &outbound)
+    {
+        if (!outbound)
+            return std::nullopt;
+
+        // Unnamed links are named in FinishEntries, GetOutboundInfo asks the plugins.
+        SubscriptionEntry entry;
+        entry.name = outbound->first;
+        entry.content = ProfileContent{ outbound->second };
+        entry.hash = ContentHash(entry.content);
+        return entry;
+    }
+
+    static DecodedSubscription DecodeEntries(std::shared_ptr<SubscriptionDecoder> decoder, const QByteArray &data,
+                                             std::shared_ptr<ThreadSafeLinkDeserializer> deserializer)
+    {
+        DecodedSubscription result;
+        result.links = decoder->DecodeData(data).links;
+        if (result.links.isEmpty())
+        {
+            result.error = QObject::tr("The subscription contains no links.");
+            return result;
+        }
+
+        // Links of other plugins are left empty here, plugins are only called from the GUI thread.
+        const auto deserialize = [deserializer](const QString &link) -> std::optional<SubscriptionEntry>
+        {
+            if (!deserializer->CanDeserialize(link))
+                return std::nullopt;
+            return MakeEntry(deserializer->Deserialize(link));
+        };
+        result.entries = QtConcurrent::blockingMapped<QList<std::optional<SubscriptionEntry>>>(result.links, deserialize);
+        for (auto i = 0; i < result.links.size(); i++)
+            if (!deserializer->CanDeserialize(result.links[i]))
+                result.pluginLinks << i;
+        return result;
+    }
+
+    // Runs on the GUI thread: deserializes the links only another plugin can read, then filters the entries. The names of
+    // all of them, filtered out or not, are appended to names.
+    static QList<SubscriptionEntry> FinishEntries(const DecodedSubscription &result, const SubscriptionConfigObject &config, QStringList *names)
+    {
+        auto entries = result.entries;
+        for (const auto index : result.pluginLinks)
+            entries[index] = MakeEntry(QvBaselib->PluginAPIHost()->Outbound_Deserialize(result.links[index]));
+
+        const KeywordFilter filter{ config };
+        QList<SubscriptionEntry> accepted;
+        QHash<QString, int> generatedNames;
+        for (auto &entry : entries)
+        {
+            if (!entry)
+                continue;
+            if (entry->name.isEmpty())
+            {
+                // Names without a random part, so that the next update can still find the connection. Links to the same
+                // server are told apart by their position among them, which stays the same as long as the order does.
+                const auto [protocol, host, port] = GetOutboundInfo(entry->content.outbounds.first());
+                entry->name = protocol + "/" + host + ":" + port;
+                if (const auto index = generatedNames[entry->name]++; index > 0)
+                    entry->name += " #" + QString::number(index + 1);
+            }
+            *names << entry->name;
+            if (filter.Accepts(entry->name))
+                accepted << *entry;
+        }
+        return accepted;
+    }
+
+    static DecodedSubscription DecodeSubscription(std::shared_ptr<SubscriptionDecoder> decoder, const QByteArray &data,
+                                                  std::shared_ptr<ThreadSafeLinkDeserializer> deserializer)
+    {
+        QElapsedTimer clock;
+        clock.start();
+        auto result = DecodeEntries(decoder, data, deserializer);
+        result.decodeTime = clock.elapsed();
+        return result;
+    }
+
+    // qHash is seeded per process, a jitter based on it would change at every start. SHA-1 is the same everywhere.
+    static qint64 JitterSeconds(const GroupId &id)
+    {
+        const auto digest = QCryptographicHash::hash(id.toString().toUtf8(), QCryptographicHash::Sha1);
+        return qFromBigEndian<quint32>(digest.constData()) % QvSubscriptionUpdater::MAX_JITTER_SECS;
+    }
+
+    // Read when the update finishes, the user may have changed the group while the subscription was being decoded.
+    static ExistingConnections GetExistingConnections(const GroupId &id)
+    {
+        ExistingConnections existing;
+        for (const auto &connectionId : QvBaselib->ProfileManager()->GetConnections(id))
+        {
+            SubscriptionEntry connection{ GetDisplayName(connectionId), QvBaselib->ProfileManager()->GetConnection(connectionId), {} };
+            connection.hash = ContentHash(connection.content);
+            existing << std::pair{ connectionId, connection };
+        }
+        return existing;
+    }
+
+    // The proxy and User-Agent set in the preferences, read for each request as they may have been changed since.
+    static void ApplyNetworkConfig(QNetworkAccessManager &networkManager, QNetworkRequest &request)
+    {
+        using Qv2rayBase::Models::NetworkProxyConfig;
+        const auto &config = QvBaselib->GetConfig()->network_config;
+        switch (config.type)
+        {
+            case NetworkProxyConfig::PROXY_HTTP:
+                networkManager.setProxy(QNetworkProxy{ QNetworkProxy::HttpProxy, config.address, static_cast<quint16>(config.port) });
+                break;
+            case NetworkProxyConfig::PROXY_SOCKS5:
+                networkManager.setProxy(QNetworkProxy{ QNetworkProxy::Socks5Proxy, config.address, static_cast<quint16>(config.port) });
+                break;
+            case NetworkProxyConfig::PROXY_SYSTEM:
+                networkManager.setProxy(QNetworkProxyFactory::systemProxyForQuery(QNetworkProxyQuery{ request.url() }).constFirst());
+                break;
+            default: networkManager.setProxy(QNetworkProxy::NoProxy); break;
+        }
+
+        auto userAgent = config.ua;
+        if (!userAgent.isEmpty())
+            request.setHeader(QNetworkRequest::UserAgentHeader, userAgent.replace(QStringLiteral("$VERSION"), QCoreApplication::applicationVersion()));
+    }
+
+    QvSubscriptionUpdater::QvSubscriptionUpdater(QObject *parent) : QObject(parent)
+    {
+        const auto cache = QvBaselib->StorageProvider()->GetExtraSettings(QString::fromUtf8(VALIDATORS_SETTINGS_KEY));
+        for (auto it = cache.constBegin(); it != cache.constEnd(); it++)
+        {
+            validators.insert(GroupId{ it.key() }, CacheValidators::fromJson(it.value().toObject()));
+        }
+        connect(&schedulerTimer, &QTimer::timeout, this,
+                [this]()
+                {
+                    for (const auto &id : DueSubscriptions())
+                        UpdateSubscription(id, false);
+                });
+    }
+
+    void QvSubscriptionUpdater::saveValidators() const
+    {
+        QJsonObject cache;
+        for (auto it = validators.constBegin(); it != validators.constEnd(); it++)
+            cache[it.key().toString()] = it->toJson();
+        QvBaselib->StorageProvider()->StoreExtraSettings(QString::fromUtf8(VALIDATORS_SETTINGS_KEY), cache);
+    }
+
+    QList<GroupId> QvSubscriptionUpdater::DueSubscriptions() const
+    {
+        using namespace std::chrono;
+        QList<GroupId> result;
+        for (const auto &id : QvBaselib->ProfileManager()->GetGroups())
+        {
+            const auto group = QvBaselib->ProfileManager()->GetGroupObject(id);
+            const auto &config = group.subscription_config;
+            // An interval of zero means the subscription is never updated automatically.
+            if (!config.isSubscription || config.updateInterval <= 0 || postponedGroups.contains(id) || updatingGroups.contains(id))
+                continue;
+
+            // The interval is in days, the jitter only depends on the group so that it stays the same across restarts.
+            const auto interval = duration_cast<seconds>(duration<double, std::ratio<86400>>(config.updateInterval));
+            const auto jitter = seconds(JitterSeconds(id));
+            if (group.updated + interval + jitter <= system_clock::now())
+                result << id;
+        }
+        return result;
+    }
+
+    void QvSubscriptionUpdater::StartScheduler()
+    {
+        schedulerTimer.start(SCHEDULER_INTERVAL_MSECS);
+    }
+
+    void QvSubscriptionUpdater::UpdateSubscription(const GroupId &id, bool userRequested)
+    {
+        const auto queued = std::find_if(pendingUpdates.begin(), pendingUpdates.end(), [&id](const auto &update) { return update.first == id; });
+        if (queued != pendingUpdates.end())
+        {
+            // A request of the user takes over a queued scheduled update.
+            if (!userRequested)
+                return;
+            pendingUpdates.erase(queued);
+        }
+        else if (updatingGroups.contains(id))
+        {
+            return;
+        }
+
+        updatingGroups.insert(id);
+        if (userRequested)
+            pendingUpdates.prepend({ id, false });
+        else
+            pendingUpdates.append({ id, true });
+        startPendingUpdates();
+    }
+
+    void QvSubscriptionUpdater::startPendingUpdates()
+    {
+        while (runningUpdates < MAX_CONCURRENT_UPDATES && !pendingUpdates.isEmpty())
+        {
+            const auto [id, conditional] = pendingUpdates.takeFirst();
+            runningUpdates++;
+            fetch(id, conditional);
+        }
+    }
+
+    void QvSubscriptionUpdater::finishUpdate(const GroupId &id)
+    {
+        updatingGroups.remove(id);
+        runningUpdates--;
+        startPendingUpdates();
+    }
+
+    void QvSubscriptionUpdater::failUpdate(const GroupId &id, const QString &error)
+    {
+        finishUpdate(id);
+        QvLog() << "Failed to update subscription" << GetDisplayName(id) << ":" << error;
+        emit OnSubscriptionUpdateFailed(id, error);
+    }
+
+    void QvSubscriptionUpdater::fetch(const GroupId &id, bool conditional)
+    {
+        const auto address = QvBaselib->ProfileManager()->GetGroupObject(id).subscription_config.address;
+        QvLog() << "Updating subscription:" << GetDisplayName(id) << "from" << address;
+
+        QNetworkRequest request{ QUrl{ address } };
+        if (conditional)
+            SetConditionalHeaders(request, address, validators.value(id));
+        ApplyNetworkConfig(networkManager, request);
+
+        QElapsedTimer clock;
+        clock.start();
+        const auto reply = networkManager.get(request);
+        connect(reply, &QNetworkReply::finished, this,
+                [this, id, address, reply, clock]()
+                {
+                    reply->deleteLater();
+                    UpdateTimings timing;
+                    timing.fetch = clock.elapsed();
+
+                    if (IsNotModified(*reply))
+                    {
+                        timing.notModified = true;
+                        timings[id] = timing;
+                        // Records the update time of the group, which is all that ignoring an update does.
+                        QvBaselib->ProfileManager()->IgnoreSubscriptionUpdate(id);
+                        finishUpdate(id);
+                        QvLog() << "Subscription" << GetDisplayName(id) << "not modified, checked in" << timing.fetch << "ms.";
+                        emit OnSubscriptionNotModified(id);
+                        return;
+                    }
+
+                    if (reply->error() != QNetworkReply::NoError)
+                    {
+                        failUpdate(id, reply->errorString());
+                        return;
+                    }
+
+                    const auto config = QvBaselib->ProfileManager()->GetGroupObject(id).subscription_config;
+                    std::shared_ptr<SubscriptionDecoder> decoder;
+                    for (const auto &[pluginInfo, info] : QvBaselib->PluginAPIHost()->Subscription_GetAllAdapters())
+                        if (info.type == config.type)
+                            decoder = info.Creator();
+
+                    if (!decoder)
+                    {
+                        failUpdate(id, tr("Unknown subscription type \"%1\", a plugin may be missing.").arg(config.type.toString()));
+                        return;
+                    }
+
+                    // Only stored once the subscription has been applied, so that a failed update is retried in full.
+                    const auto received = ReceivedValidators(address, *reply);
+
+                    const auto watcher = new QFutureWatcher<DecodedSubscription>(this);
+                    connect(watcher, &QFutureWatcher<DecodedSubscription>::finished, this,
+                            [this, id, watcher, timing, received, config]() mutable
+                            {
+                                watcher->deleteLater();
+                                const auto result = watcher->result();
+                                timing.decode = result.decodeTime;
+                                if (!result.error.isEmpty())
+                                {
+                                    timings[id] = timing;
+                                    failUpdate(id, result.error);
+                                    return;
+                                }
+
+                                QElapsedTimer clock;
+                                clock.start();
+                                QStringList names;
+                                const auto entries = FinishEntries(result, config, &names);
+                                decodedNames[id] = names;
+                                if (entries.isEmpty())
+                                {
+                                    timings[id] = timing;
+                                    failUpdate(id, tr("None of the %n link(s) in the subscription can be imported.", nullptr, result.links.size()));
+                                    return;
+                                }
+
+                                const auto delta = ComputeDelta(GetExistingConnections(id), entries);
+                                applyDelta(id, delta);
+                                timing.apply = clock.elapsed();
+                                timings[id] = timing;
+
+                                if (received.IsEmpty())
+                                    validators.remove(id);
+                                else
+                                    validators[id] = received;
+                                saveValidators();
+
+                                finishUpdate(id);
+                                QvLog() << "Subscription" << GetDisplayName(id) << "updated:" << delta.kept.size() << "kept," << delta.renamed.size() << "renamed,"
+                                        << delta.updated.size() << "updated," << delta.added.size() << "added," << delta.removed.size() << "removed, in"
+                                        << timing.fetch << "+" << timing.decode << "+" << timing.apply << "ms.";
+                                emit OnSubscriptionUpdated(id, delta);
+                            });
+                    watcher->setFuture(QtConcurrent::run(DecodeSubscription, decoder, reply->readAll(), std::make_shared<ThreadSafeLinkDeserializer>()));
+                });
+    }
+
+    void QvSubscriptionUpdater::applyDelta(const GroupId &id, const SubscriptionDelta &delta)
+    {
+        const auto profileManager = QvBaselib->ProfileManager();
+
+        emit OnGroupUpdateStarted(id);
+        for (const auto &[connectionId, name] : delta.renamed)
+            profileManager->RenameConnection(connectionId, name);
+        for (const auto &[connectionId, content] : delta.updated)
+            profileManager->UpdateConnection(connectionId, content);
+        for (const auto &entry : delta.added)
+            profileManager->CreateConnection(entry.content, entry.name, id);
+        for (const auto &connectionId : delta.removed)
+        {
+            // A connection only found in this group is deleted, as when the user deletes it, which must not leave it
+            // running. Those also linked to other groups are only unlinked from this one.
+            const auto groups = profileManager->GetGroups(connectionId);
+            if (groups.size() == 1 && groups.first() == id && profileManager->IsConnected({ connectionId, id }))
+                profileManager->StopConnection();
+            profileManager->RemoveFromGroup(connectionId, id);
+        }
+        // Records the update time of the group, which is all that ignoring an update does.
+        profileManager->IgnoreSubscriptionUpdate(id);
+        emit OnGroupUpdateFinished(id);
+    }
+} // namespace Qv2ray::components::QvSubscriptionUpdater
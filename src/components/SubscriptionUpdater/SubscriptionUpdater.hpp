@@ -0,0 +1,105 @@
+#pragma once
+
+#include "ConditionalRequest.hpp"
+#include "QvPlugin/PluginInterface.hpp"
+#include "SubscriptionDelta.hpp"
+
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <optional>
+
+namespace Qv2ray::components::QvSubscriptionUpdater
+{
+    // How long the last update of a group took, in milliseconds.
+    struct UpdateTimings
+    {
+        qint64 fetch = 0;
+        // Zero when the server answered 304 Not Modified, nothing was decoded then.
+        qint64 decode = 0;
+        qint64 apply = 0;
+        bool notModified = false;
+    };
+
+    // Fetches, decodes and filters subscriptions, and applies them to their groups as deltas, so that connections which
+    // didn't change keep their IDs, latency and usage.
+    //
+    // At most MAX_CONCURRENT_UPDATES subscriptions are fetched at the same time, the others wait in a queue where updates
+    // requested by the user go first. Once started, the scheduler refreshes subscriptions in the background when their
+    // update interval, plus a jitter derived from the group, has elapsed. These scheduled updates are conditional requests, using the
+    // ETag and Last-Modified of the last response, so that unchanged subscriptions are neither downloaded nor decoded.
+    // Requests use the proxy and User-Agent of the network settings in the preferences.
+    class QvSubscriptionUpdater : public QObject
+    {
+        Q_OBJECT
+      public:
+        static constexpr int MAX_CONCURRENT_UPDATES = 3;
+        static constexpr int SCHEDULER_INTERVAL_MSECS = 5 * 60 * 1000;
+        // Keeps subscriptions sharing an interval from being refreshed all at once.
+        static constexpr int MAX_JITTER_SECS = 15 * 60;
+
+        explicit QvSubscriptionUpdater(QObject *parent = nullptr);
+
+        // Updates requested by the user always download the whole subscription, so that changed filters are applied.
+        void UpdateSubscription(const GroupId &id, bool userRequested = true);
+        bool IsUpdating(const GroupId &id) const
+        {
+            return updatingGroups.contains(id);
+        }
+
+        // Subscriptions whose update interval has elapsed, excluding postponed ones.
+        QList<GroupId> DueSubscriptions() const;
+        // The scheduler won't update the subscription again until the application restarts.
+        void Postpone(const GroupId &id)
+        {
+            postponedGroups.insert(id);
+        }
+        void StartScheduler();
+
+        std::optional<UpdateTimings> LastUpdateTimings(const GroupId &id) const
+        {
+            return timings.contains(id) ? std::optional{ timings.value(id) } : std::nullopt;
+        }
+
+        // The names of all links decoded by the last update of the group in this session, before filtering. Empty if
+        // it wasn't updated since the application started, or found nothing it could import.
+        QStringList LastDecodedNames(const GroupId &id) const
+        {
+            return decodedNames.value(id);
+        }
+
+      signals:
+        // Connections of the group are changed between these two signals, views should refresh the group once at the end.
+        void OnGroupUpdateStarted(const GroupId &id);
+        void OnGroupUpdateFinished(const GroupId &id);
+
+        void OnSubscriptionUpdated(const GroupId &id, const Qv2ray::components::QvSubscriptionUpdater::SubscriptionDelta &delta);
+        void OnSubscriptionUpdateFailed(const GroupId &id, const QString &error);
+        // A scheduled update found the subscription unchanged.
+        void OnSubscriptionNotModified(const GroupId &id);
+
+      private:
+        void startPendingUpdates();
+        void fetch(const GroupId &id, bool conditional);
+        void finishUpdate(const GroupId &id);
+        void failUpdate(const GroupId &id, const QString &error);
+        void applyDelta(const GroupId &id, const SubscriptionDelta &delta);
+        void saveValidators() const;
+
+        QNetworkAccessManager networkManager;
+        QTimer schedulerTimer;
+        // Queued updates, with whether they are conditional.
+        QList<std::pair<GroupId, bool>> pendingUpdates;
+        // Both queued and running ones.
+        QSet<GroupId> updatingGroups;
+        int runningUpdates = 0;
+
+        QSet<GroupId> postponedGroups;
+        QHash<GroupId, CacheValidators> validators;
+        QHash<GroupId, UpdateTimings> timings;
+        QHash<GroupId, QStringList> decodedNames;
+    };
+} // namespace Qv2ray::components::QvSubscriptionUpdater
+
+inline Qv2ray::components::QvSubscriptionUpdater::QvSubscriptionUpdater *SubscriptionUpdater = nullptr;
@@ -0,0 +1,55 @@
+#include "UpdateScheduler.hpp"
+
+namespace Qv2ray::components::QvUpdateScheduler
+{
+    QvUpdateScheduler::QvUpdateScheduler(QObject *parent) : QObject(parent)
+    {
+        // The first mark starts the timer, so that a single update waits at most one interval.
+        flushTimer.setSingleShot(true);
+        flushTimer.setInterval(1000 / MAX_FLUSHES_PER_SECOND);
+        connect(&flushTimer, &QTimer::timeout, this, &QvUpdateScheduler::flush);
+    }
+
+    int QvUpdateScheduler::AddUpdate(QObject *context, std::function<void()> flush, bool whileSuspended)
+    {
+        updates << Update{ context, std::move(flush), whileSuspended };
+        return updates.size() - 1;
+    }
+
+    void QvUpdateScheduler::MarkDirty(int update)
+    {
+        auto &entry = updates[update];
+        if (entry.dirty)
+            return;
+        entry.dirty = true;
+        if ((!suspended || entry.whileSuspended) && !flushTimer.isActive())
+            flushTimer.start();
+    }
+
+    void QvUpdateScheduler::SetSuspended(bool isSuspended)
+    {
+        if (suspended == isSuspended)
+            return;
+        suspended = isSuspended;
+        if (!suspended)
+            flush();
+    }
+
+    void QvUpdateScheduler::flush()
+    {
+        flushTimer.stop();
+        // Indexes, since a flush function may add an update.
+        for (auto i = 0; i < updates.size(); i++)
+        {
+            if (!updates[i].dirty || (suspended && !updates[i].whileSuspended))
+                continue;
+            updates[i].dirty = false;
+            // Contexts that are gone keep their index, so that the other indexes stay valid.
+            if (!updates[i].context)
+                continue;
+            // A copy, the list may grow while it runs.
+            const auto updateFunction = updates[i].flush;
+            updateFunction();
+        }
+    }
+} // namespace Qv2ray::components::QvUpdateScheduler
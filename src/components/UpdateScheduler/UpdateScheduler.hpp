@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+
+namespace Qv2ray::components::QvUpdateScheduler
+{
+    // Coalesces UI updates which would otherwise happen on every stats tick or latency result.
+    //
+    // Each kind of update is added once with a flush function. Marking it dirty only records that it has to run, the
+    // flush functions of the dirty updates run together at most MAX_FLUSHES_PER_SECOND times per second. While
+    // suspended (the main window is hidden), only the updates added with whileSuspended run, the others are flushed
+    // once on resume.
+    class QvUpdateScheduler : public QObject
+    {
+        Q_OBJECT
+      public:
+        static constexpr auto MAX_FLUSHES_PER_SECOND = 5;
+
+        explicit QvUpdateScheduler(QObject *parent = nullptr);
+        // The update is dropped with its context.
+        int AddUpdate(QObject *context, std::function<void()> flush, bool whileSuspended = false);
+        void MarkDirty(int update);
+        void SetSuspended(bool suspended);
+
+      private:
+        struct Update
+        {
+            QPointer<QObject> context;
+            std::function<void()> flush;
+            bool whileSuspended;
+            bool dirty = false;
+        };
+
+        void flush();
+
+        QTimer flushTimer;
+        QList<Update> updates;
+        bool suspended = false;
+    };
+} // namespace Qv2ray::components::QvUpdateScheduler
+
+inline Qv2ray::components::QvUpdateScheduler::QvUpdateScheduler *UpdateScheduler = nullptr;
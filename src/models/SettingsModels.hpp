@@ -33,7 +33,9 @@ namespace Qv2ray::Models
         {
             AUTOCONNECT_NONE = 0,
             AUTOCONNECT_FIXED = 1,
-            AUTOCONNECT_LAST_CONNECTED = 2
+            AUTOCONNECT_LAST_CONNECTED = 2,
+            // The connection of the AutoConnectProfileId group with the best latency history, see AutoFailover.
+            AUTOCONNECT_FASTEST = 3
         };
         Bindable<LatencyTestEngineId> DefaultLatencyTestEngine;
         Bindable<AutoConnectBehavior> AutoConnectBehavior;
@@ -1,6 +1,7 @@
 #include "OutboundHandler.hpp"
 
 #include "QvPlugin/Utils/QJsonIO.hpp"
+#include "ShareLinkParser.hpp"
 #include "V2RayModels.hpp"
 
 #include <QUrl>
@@ -15,14 +16,6 @@ QString SafeBase64Decode(QString string)
 using namespace Qv2rayPlugin;
 using namespace Qv2ray::Models;
 
-QString SerializeVLESS(const QString &name, const IOConnectionSettings &connection);
-QString SerializeVMess(const QString &name, const IOConnectionSettings &connection);
-QString SerializeSS(const QString &name, const IOConnectionSettings &connection);
-
-std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVLESS(const QString &link);
-std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVMess(const QString &link);
-std::optional<std::pair<QString, IOConnectionSettings>> DeserializeSS(const QString &link);
-
 std::optional<QString> BuiltinSerializer::Serialize(const QString &name, const IOConnectionSettings &outbound) const
 {
     const auto protocol = outbound.protocol;
@@ -35,11 +28,13 @@ std::optional<QString> BuiltinSerializer::Serialize(const QString &name, const I
         url.setScheme(protocol);
         url.setHost(outbound.address);
         url.setPort(outbound.port.from);
-        if (out.contains(QStringLiteral("user")))
-            url.setUserName(out[QStringLiteral("user")].toString());
-        if (out.contains(QStringLiteral("pass")))
-            url.setUserName(out[QStringLiteral("pass")].toString());
-        return url.toString();
+        if (const auto user = out[QStringLiteral("user")].toString(); !user.isEmpty())
+            url.setUserName(user);
+        if (const auto pass = out[QStringLiteral("pass")].toString(); !pass.isEmpty())
+            url.setPassword(pass);
+        if (!name.isEmpty())
+            url.setFragment(name, QUrl::DecodedMode);
+        return url.toString(QUrl::FullyEncoded);
     }
     if (protocol == QStringLiteral("vless"))
     {
@@ -61,14 +56,16 @@ std::optional<std::pair<QString, IOConnectionSettings>> BuiltinSerializer::Deser
 {
     if (link.startsWith(QStringLiteral("http://")) || link.startsWith(QStringLiteral("socks://")))
     {
-        const QUrl url{ link };
+        const auto url = ShareLink::Parse(link);
+        if (!url)
+            return std::nullopt;
         IOConnectionSettings out;
-        out.protocol = url.scheme();
-        out.address = url.host();
-        out.port = url.port();
-        out.protocolSettings["user"] = url.userName();
-        out.protocolSettings["pass"] = url.password();
-        return std::make_pair(url.fragment(), out);
+        out.protocol = url->scheme.toString();
+        out.address = url->host.toString();
+        out.port = url->port;
+        out.protocolSettings["user"] = ShareLink::PercentDecoded(url->userName);
+        out.protocolSettings["pass"] = ShareLink::PercentDecoded(url->password);
+        return std::make_pair(ShareLink::PercentDecoded(url->fragment), out);
     }
 
     if (link.startsWith(QStringLiteral("ss://")))
@@ -88,7 +85,8 @@ QString SerializeVLESS(const QString &name, const IOConnectionSettings &conn)
     const auto out = conn.protocolSettings;
     const auto stream = conn.streamSettings;
     QUrl url;
-    url.setFragment(QUrl::toPercentEncoding(name));
+    if (!name.isEmpty())
+        url.setFragment(name, QUrl::DecodedMode);
     url.setScheme(QStringLiteral("vless"));
     url.setHost(conn.address);
     url.setPort(conn.port.from);
@@ -121,10 +119,10 @@ QString SerializeVLESS(const QString &name, const IOConnectionSettings &conn)
     }
     else if (network == QStringLiteral("http"))
     {
-        const auto path = QJsonIO::GetValue(stream, { "HTTPConfig", "path" }).toString(QStringLiteral("/"));
+        const auto path = QJsonIO::GetValue(stream, { "httpSettings", "path" }).toString(QStringLiteral("/"));
         query.addQueryItem(QStringLiteral("path"), QUrl::toPercentEncoding(path));
 
-        const auto hosts = QJsonIO::GetValue(stream, { "HTTPConfig", "host" }).toArray();
+        const auto hosts = QJsonIO::GetValue(stream, { "httpSettings", "host" }).toArray();
         QStringList hostList;
         for (const auto item : hosts)
         {
@@ -132,7 +130,8 @@ QString SerializeVLESS(const QString &name, const IOConnectionSettings &conn)
             if (!host.isEmpty())
                 hostList << host;
         }
-        query.addQueryItem(QStringLiteral("host"), QUrl::toPercentEncoding(hostList.join(QStringLiteral(","))));
+        if (!hostList.isEmpty())
+            query.addQueryItem(QStringLiteral("host"), QUrl::toPercentEncoding(hostList.join(QStringLiteral(","))));
     }
     else if (network == QStringLiteral("ws"))
     {
@@ -140,7 +139,8 @@ QString SerializeVLESS(const QString &name, const IOConnectionSettings &conn)
         query.addQueryItem(QStringLiteral("path"), QUrl::toPercentEncoding(path));
 
         const auto host = QJsonIO::GetValue(stream, { "wsSettings", "headers", "Host" }).toString();
-        query.addQueryItem(QStringLiteral("host"), host);
+        if (!host.isEmpty())
+            query.addQueryItem(QStringLiteral("host"), QUrl::toPercentEncoding(host));
     }
     else if (network == QStringLiteral("quic"))
     {
@@ -179,13 +179,15 @@ QString SerializeVLESS(const QString &name, const IOConnectionSettings &conn)
         if (!alpn.isEmpty())
             alpnList << alpn;
     }
-    query.addQueryItem(QStringLiteral("alpn"), QUrl::toPercentEncoding(alpnList.join(QStringLiteral(","))));
+    if (!alpnList.isEmpty())
+        query.addQueryItem(QStringLiteral("alpn"), QUrl::toPercentEncoding(alpnList.join(QStringLiteral(","))));
 
     // -------- XTLS Flow --------
     if (security == QStringLiteral("xtls"))
     {
         const auto flow = out[QStringLiteral("flow")].toString();
-        query.addQueryItem(QStringLiteral("flow"), flow);
+        if (!flow.isEmpty())
+            query.addQueryItem(QStringLiteral("flow"), QUrl::toPercentEncoding(flow));
     }
 
     // ======== END OF QUERY ========
@@ -203,7 +205,8 @@ QString SerializeVMess(const QString &alias, const IOConnectionSettings &connect
 
     QUrl url;
     QUrlQuery query;
-    url.setFragment(alias, QUrl::StrictMode);
+    if (!alias.isEmpty())
+        url.setFragment(alias, QUrl::DecodedMode);
 
     if (stream.network == QStringLiteral("tcp"))
     {
@@ -212,7 +215,7 @@ QString SerializeVMess(const QString &alias, const IOConnectionSettings &connect
     }
     else if (stream.network == QStringLiteral("http"))
     {
-        if (!stream.httpSettings->host->isEmpty())
+        if (!stream.httpSettings->host->isEmpty() && !stream.httpSettings->host->first().isEmpty())
             query.addQueryItem(QStringLiteral("host"), stream.httpSettings->host->first());
         query.addQueryItem(QStringLiteral("path"), stream.httpSettings->path->isEmpty() ? QStringLiteral("/") : *stream.httpSettings->path);
     }
@@ -237,7 +240,7 @@ QString SerializeVMess(const QString &alias, const IOConnectionSettings &connect
         if (!stream.quicSettings->key->isEmpty())
             query.addQueryItem(QStringLiteral("key"), stream.quicSettings->key);
         if (!stream.quicSettings->header->type->isEmpty() && stream.quicSettings->header->type != QStringLiteral("none"))
-            query.addQueryItem(QStringLiteral("headers"), stream.quicSettings->header->type);
+            query.addQueryItem(QStringLiteral("type"), stream.quicSettings->header->type);
     }
     else
     {
@@ -260,7 +263,7 @@ QString SerializeVMess(const QString &alias, const IOConnectionSettings &connect
     url.setPort(connection.port.from);
     url.setUserName(protocol);
     url.setQuery(query);
-    return url.toString();
+    return url.toString(QUrl::FullyEncoded);
 }
 
 QString SerializeSS(const QString &name, const IOConnectionSettings &connection)
@@ -274,7 +277,8 @@ QString SerializeSS(const QString &name, const IOConnectionSettings &connection)
     url.setScheme(QStringLiteral("ss"));
     url.setHost(connection.address);
     url.setPort(connection.port.from);
-    url.setFragment(name);
+    if (!name.isEmpty())
+        url.setFragment(name, QUrl::DecodedMode);
     return url.toString(QUrl::ComponentFormattingOption::FullyEncoded);
 }
 
@@ -285,28 +289,26 @@ const static QStringList FalseTypes{ "false", "False", "No", "Off", "0" };
 
 std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVLESS(const QString &link)
 {
-    // parse url
-    QUrl url(link);
-    if (!url.isValid())
+    // parse url, brackets of IPv6 hosts are removed by the parser
+    const auto url = ShareLink::Parse(link);
+    if (!url)
         return std::nullopt;
 
     // fetch host
-    const auto hostRaw = url.host();
-    if (hostRaw.isEmpty())
+    const auto host = url->host.toString();
+    if (host.isEmpty())
         return std::nullopt;
 
-    const auto host = (hostRaw.startsWith('[') && hostRaw.endsWith(']')) ? hostRaw.mid(1, hostRaw.length() - 2) : hostRaw;
-
     // fetch port
-    const auto port = url.port();
+    const auto port = url->port;
     if (port == -1)
         return std::nullopt;
 
     // fetch remarks
-    const auto remarks = url.fragment();
+    const auto remarks = ShareLink::PercentDecoded(url->fragment);
 
     // fetch uuid
-    const auto uuid = url.userInfo();
+    const auto uuid = ShareLink::PercentDecoded(url->userInfo);
     if (uuid.isEmpty())
         return std::nullopt;
 
@@ -316,85 +318,75 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVLESS(const Q
 
     outbound[QStringLiteral("id")] = uuid;
 
-    // parse query
-    QUrlQuery query(url.query());
-
     // handle type
-    const auto hasType = query.hasQueryItem(QStringLiteral("type"));
-    const auto type = hasType ? query.queryItemValue(QStringLiteral("type")) : QStringLiteral("tcp");
+    const auto type = url->QueryItemValue(u"type", QStringLiteral("tcp"));
     if (type != QStringLiteral("tcp"))
         QJsonIO::SetValue(stream, type, QStringLiteral("network"));
 
     // handle encryption
-    const auto hasEncryption = query.hasQueryItem(QStringLiteral("encryption"));
-    const auto encryption = hasEncryption ? query.queryItemValue(QStringLiteral("encryption")) : QStringLiteral("none");
+    const auto encryption = url->QueryItemValue(u"encryption", QStringLiteral("none"));
     outbound[QStringLiteral("encryption")] = encryption;
 
+    // only sent with xtls
+    if (url->HasQueryItem(u"flow"))
+        outbound[QStringLiteral("flow")] = url->QueryItemValue(u"flow");
+
     // type-wise settings
     if (type == QStringLiteral("kcp"))
     {
-        const auto hasSeed = query.hasQueryItem(QStringLiteral("seed"));
-        if (hasSeed)
-            QJsonIO::SetValue(stream, query.queryItemValue(QStringLiteral("seed")), { QStringLiteral("kcpSettings"), QStringLiteral("seed") });
+        if (url->HasQueryItem(u"seed"))
+            QJsonIO::SetValue(stream, url->QueryItemValue(u"seed"), { QStringLiteral("kcpSettings"), QStringLiteral("seed") });
 
-        const auto hasHeaderType = query.hasQueryItem(QStringLiteral("headerType"));
-        const auto headerType = hasHeaderType ? query.queryItemValue(QStringLiteral("headerType")) : QStringLiteral("none");
+        const auto headerType = url->QueryItemValue(u"headerType", QStringLiteral("none"));
         if (headerType != QStringLiteral("none"))
             QJsonIO::SetValue(stream, headerType, { QStringLiteral("kcpSettings"), QStringLiteral("header"), QStringLiteral("type") });
     }
     else if (type == QStringLiteral("http"))
     {
-        const auto hasPath = query.hasQueryItem(QStringLiteral("path"));
-        const auto path = hasPath ? QUrl::fromPercentEncoding(query.queryItemValue(QStringLiteral("path")).toUtf8()) : QStringLiteral("/");
+        const auto path = url->QueryItemValue(u"path", QStringLiteral("/"));
         if (path != QStringLiteral("/"))
             QJsonIO::SetValue(stream, path, { QStringLiteral("httpSettings"), QStringLiteral("path") });
 
-        const auto hasHost = query.hasQueryItem(QStringLiteral("host"));
-        if (hasHost)
+        if (url->HasQueryItem(u"host"))
         {
-            const auto hosts = QJsonArray::fromStringList(query.queryItemValue(QStringLiteral("host")).split(','));
+            const auto hosts = QJsonArray::fromStringList(url->QueryItemValue(u"host").split(','));
             QJsonIO::SetValue(stream, hosts, { QStringLiteral("httpSettings"), QStringLiteral("host") });
         }
     }
     else if (type == QStringLiteral("ws"))
     {
-        const auto hasPath = query.hasQueryItem(QStringLiteral("path"));
-        const auto path = hasPath ? QUrl::fromPercentEncoding(query.queryItemValue(QStringLiteral("path")).toUtf8()) : QStringLiteral("/");
+        const auto path = url->QueryItemValue(u"path", QStringLiteral("/"));
         if (path != QStringLiteral("/"))
             QJsonIO::SetValue(stream, path, { QStringLiteral("wsSettings"), QStringLiteral("path") });
 
-        const auto hasHost = query.hasQueryItem(QStringLiteral("host"));
-        if (hasHost)
+        if (url->HasQueryItem(u"host"))
         {
-            QJsonIO::SetValue(stream, query.queryItemValue(QStringLiteral("host")), { QStringLiteral("wsSettings"), QStringLiteral("headers"), QStringLiteral("Host") });
+            QJsonIO::SetValue(stream, url->QueryItemValue(u"host"), { QStringLiteral("wsSettings"), QStringLiteral("headers"), QStringLiteral("Host") });
         }
     }
     else if (type == QStringLiteral("quic"))
     {
-        const auto hasQuicSecurity = query.hasQueryItem(QStringLiteral("quicSecurity"));
-        if (hasQuicSecurity)
+        if (url->HasQueryItem(u"quicSecurity"))
         {
-            const auto quicSecurity = query.queryItemValue(QStringLiteral("quicSecurity"));
+            const auto quicSecurity = url->QueryItemValue(u"quicSecurity");
             QJsonIO::SetValue(stream, quicSecurity, { QStringLiteral("quicSettings"), QStringLiteral("security") });
 
             if (quicSecurity != QStringLiteral("none"))
             {
-                const auto key = query.queryItemValue(QStringLiteral("key"));
+                const auto key = url->QueryItemValue(u"key");
                 QJsonIO::SetValue(stream, key, { QStringLiteral("quicSettings"), QStringLiteral("key") });
             }
 
-            const auto hasHeaderType = query.hasQueryItem(QStringLiteral("headerType"));
-            const auto headerType = hasHeaderType ? query.queryItemValue(QStringLiteral("headerType")) : QStringLiteral("none");
+            const auto headerType = url->QueryItemValue(u"headerType", QStringLiteral("none"));
             if (headerType != QStringLiteral("none"))
                 QJsonIO::SetValue(stream, headerType, { QStringLiteral("quicSettings"), QStringLiteral("header"), QStringLiteral("type") });
         }
     }
     else if (type == QStringLiteral("grpc"))
     {
-        const auto hasServiceName = query.hasQueryItem(QStringLiteral("serviceName"));
-        if (hasServiceName)
+        if (url->HasQueryItem(u"serviceName"))
         {
-            const auto serviceName = QUrl::fromPercentEncoding(query.queryItemValue(QStringLiteral("serviceName")).toUtf8());
+            const auto serviceName = url->QueryItemValue(u"serviceName");
             if (serviceName != QStringLiteral("GunService"))
             {
                 QJsonIO::SetValue(stream, serviceName, { QStringLiteral("grpcSettings"), QStringLiteral("serviceName") });
@@ -403,25 +395,22 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVLESS(const Q
     }
 
     // tls-wise settings
-    const auto hasSecurity = query.hasQueryItem(QStringLiteral("security"));
-    const auto security = hasSecurity ? query.queryItemValue(QStringLiteral("security")) : QStringLiteral("none");
+    const auto security = url->QueryItemValue(u"security", QStringLiteral("none"));
     const auto tlsKey = security == QStringLiteral("xtls") ? QStringLiteral("xtlsSettings") : QStringLiteral("tlsSettings");
     if (security != QStringLiteral("none"))
     {
         QJsonIO::SetValue(stream, security, QStringLiteral("security"));
     }
     // sni
-    const auto hasSNI = query.hasQueryItem(QStringLiteral("sni"));
-    if (hasSNI)
+    if (url->HasQueryItem(u"sni"))
     {
-        const auto sni = query.queryItemValue(QStringLiteral("sni"));
+        const auto sni = url->QueryItemValue(u"sni");
         QJsonIO::SetValue(stream, sni, { tlsKey, QStringLiteral("serverName") });
     }
     // alpn
-    const auto hasALPN = query.hasQueryItem(QStringLiteral("alpn"));
-    if (hasALPN)
+    if (url->HasQueryItem(u"alpn"))
     {
-        const auto alpnRaw = QUrl::fromPercentEncoding(query.queryItemValue(QStringLiteral("alpn")).toUtf8());
+        const auto alpnRaw = url->QueryItemValue(u"alpn");
         const auto alpnArray = QJsonArray::fromStringList(alpnRaw.split(','));
         QJsonIO::SetValue(stream, alpnArray, { tlsKey, QStringLiteral("alpn") });
     }
@@ -439,13 +428,12 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVMess(const Q
 {
     IOConnectionSettings conn;
     conn.protocol = QStringLiteral("vmess");
-    QUrl url{ link };
-    QUrlQuery query{ url };
-    if (!url.isValid())
+    const auto url = ShareLink::Parse(link);
+    if (!url)
         return std::nullopt;
 
     // If previous alias is empty, just the PS is needed, else, append a "_"
-    const auto name = url.fragment(QUrl::FullyDecoded).trimmed();
+    const auto name = ShareLink::PercentDecoded(url->fragment).trimmed();
 
     VMessClientObject client;
 
@@ -454,7 +442,7 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVMess(const Q
     bool tls = false;
     // Check streamSettings
     {
-        for (const auto &_protocol : url.userName().split('+'))
+        for (const auto &_protocol : ShareLink::PercentDecoded(url->userName).split('+'))
         {
             if (_protocol == QStringLiteral("tls"))
                 tls = true;
@@ -472,12 +460,12 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVMess(const Q
     }
     // Host Port UUID AlterID
     {
-        const auto host = url.host();
-        int port = url.port();
+        const auto host = url->host.toString();
+        int port = url->port;
         QString uuid;
         int aid;
         {
-            const auto pswd = url.password();
+            const auto pswd = ShareLink::PercentDecoded(url->password);
             const auto index = pswd.lastIndexOf('-');
             uuid = pswd.mid(0, index);
             aid = pswd.right(pswd.length() - index - 1).toInt();
@@ -490,12 +478,7 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVMess(const Q
         client.security = QStringLiteral("auto");
     }
 
-    const static auto getQueryValue = [&query](const QString &key, const QString &defaultValue) {
-        if (query.hasQueryItem(key))
-            return query.queryItemValue(key, QUrl::FullyDecoded);
-        else
-            return defaultValue;
-    };
+    const auto getQueryValue = [&url](QStringView key, const QString &defaultValue) { return url->QueryItemValue(key, defaultValue); };
 
     //
     // Begin transport settings parser
@@ -544,14 +527,14 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeSS(const QStr
     ShadowSocksClientObject server;
     QString d_name;
 
-    auto uri = link.mid(5);
+    auto uri = QStringView{ link }.sliced(5);
     auto hashPos = uri.lastIndexOf('#');
     //    DEBUG("Hash sign position: " + QSTRN(hashPos));
 
     if (hashPos >= 0)
     {
         // Get the name/remark
-        d_name = uri.mid(uri.lastIndexOf('#') + 1);
+        d_name = ShareLink::PercentDecoded(uri.sliced(hashPos + 1));
         uri.truncate(hashPos);
     }
 
@@ -597,10 +580,12 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeSS(const QStr
     else
     {
         // SIP002 URI scheme
-        auto x = QUrl::fromUserInput(uri);
-        conn.address = x.host();
-        conn.port = x.port();
-        const auto userInfo = SafeBase64Decode(x.userName());
+        const auto x = ShareLink::Parse(QStringView{ link }.first(5 + uri.size()));
+        if (!x)
+            return std::nullopt;
+        conn.address = x->host.toString();
+        conn.port = x->port;
+        const auto userInfo = SafeBase64Decode(ShareLink::PercentDecoded(x->userName));
         const auto userInfoSp = userInfo.indexOf(':');
         //
         //        DEBUG("Userinfo splitter position: " + QSTRN(userInfoSp));
@@ -615,7 +600,6 @@ std::optional<std::pair<QString, IOConnectionSettings>> DeserializeSS(const QStr
         server.password = userInfo.mid(userInfoSp + 1);
     }
 
-    d_name = QUrl::fromPercentEncoding(d_name.toUtf8());
     conn.protocol = QStringLiteral("shadowsocks");
     conn.protocolSettings = IOProtocolSettings{ server.toJson() };
     return std::make_pair(d_name, conn);
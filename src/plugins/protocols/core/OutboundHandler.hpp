@@ -2,6 +2,15 @@
 
 #include "QvPlugin/Handlers/OutboundHandler.hpp"
 
+// The codecs of each scheme, also usable on their own, without going through BuiltinSerializer.
+QString SerializeVLESS(const QString &name, const IOConnectionSettings &connection);
+QString SerializeVMess(const QString &name, const IOConnectionSettings &connection);
+QString SerializeSS(const QString &name, const IOConnectionSettings &connection);
+
+std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVLESS(const QString &link);
+std::optional<std::pair<QString, IOConnectionSettings>> DeserializeVMess(const QString &link);
+std::optional<std::pair<QString, IOConnectionSettings>> DeserializeSS(const QString &link);
+
 class BuiltinSerializer : public Qv2rayPlugin::Outbound::IOutboundProcessor
 {
   public:
@@ -0,0 +1,161 @@
+#include "ShareLinkParser.hpp"
+
+#include <QByteArray>
+
+namespace
+{
+    constexpr bool IsSchemeChar(char16_t c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.';
+    }
+
+    constexpr int HexValue(char16_t c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // Returns the index of the first character in [from, end) that is one of the delimiters, or end.
+    template<typename... Delimiters>
+    qsizetype FindFirst(QStringView view, qsizetype from, qsizetype end, Delimiters... delimiters)
+    {
+        for (auto i = from; i < end; i++)
+        {
+            const auto c = view[i].unicode();
+            if (((c == delimiters) || ...))
+                return i;
+        }
+        return end;
+    }
+} // namespace
+
+std::optional<ShareLink> ShareLink::Parse(QStringView link)
+{
+    ShareLink result;
+    const auto size = link.size();
+
+    qsizetype schemeEnd = 0;
+    while (schemeEnd < size && IsSchemeChar(link[schemeEnd].unicode()))
+        schemeEnd++;
+    if (schemeEnd == 0 || schemeEnd + 3 > size || link[schemeEnd] != u':' || link[schemeEnd + 1] != u'/' || link[schemeEnd + 2] != u'/')
+        return std::nullopt;
+    result.scheme = link.first(schemeEnd);
+
+    const auto authorityBegin = schemeEnd + 3;
+    const auto authorityEnd = FindFirst(link, authorityBegin, size, u'/', u'?', u'#');
+    const auto queryBegin = FindFirst(link, authorityEnd, size, u'?', u'#');
+    const auto fragmentBegin = FindFirst(link, queryBegin, size, u'#');
+
+    result.path = link.sliced(authorityEnd, queryBegin - authorityEnd);
+    if (queryBegin < fragmentBegin)
+        result.query = link.sliced(queryBegin + 1, fragmentBegin - queryBegin - 1);
+    if (fragmentBegin < size)
+        result.fragment = link.sliced(fragmentBegin + 1);
+
+    // The user info ends at the last '@', so that an unencoded '@' in a password still works.
+    auto hostBegin = authorityBegin;
+    for (auto i = authorityEnd - 1; i >= authorityBegin; i--)
+    {
+        if (link[i] == u'@')
+        {
+            result.userInfo = link.sliced(authorityBegin, i - authorityBegin);
+            const auto colon = FindFirst(result.userInfo, 0, result.userInfo.size(), u':');
+            result.userName = result.userInfo.first(colon);
+            if (colon < result.userInfo.size())
+                result.password = result.userInfo.sliced(colon + 1);
+            hostBegin = i + 1;
+            break;
+        }
+    }
+
+    auto portBegin = authorityEnd;
+    if (hostBegin < authorityEnd && link[hostBegin] == u'[')
+    {
+        const auto bracket = FindFirst(link, hostBegin, authorityEnd, u']');
+        if (bracket == authorityEnd)
+            return std::nullopt;
+        result.host = link.sliced(hostBegin + 1, bracket - hostBegin - 1);
+        if (bracket + 1 < authorityEnd)
+        {
+            if (link[bracket + 1] != u':')
+                return std::nullopt;
+            portBegin = bracket + 2;
+        }
+    }
+    else
+    {
+        const auto colon = FindFirst(link, hostBegin, authorityEnd, u':');
+        result.host = link.sliced(hostBegin, colon - hostBegin);
+        portBegin = colon == authorityEnd ? authorityEnd : colon + 1;
+    }
+
+    if (portBegin < authorityEnd)
+    {
+        int port = 0;
+        for (auto i = portBegin; i < authorityEnd; i++)
+        {
+            const auto c = link[i].unicode();
+            if (c < '0' || c > '9')
+                return std::nullopt;
+            port = port * 10 + (c - '0');
+            if (port > 65535)
+                return std::nullopt;
+        }
+        result.port = port;
+    }
+
+    return result;
+}
+
+std::optional<QStringView> ShareLink::RawQueryItem(QStringView key) const
+{
+    if (query.isEmpty())
+        return std::nullopt;
+
+    for (qsizetype begin = 0; begin <= query.size();)
+    {
+        const auto end = FindFirst(query, begin, query.size(), u'&');
+        const auto item = query.sliced(begin, end - begin);
+        const auto equal = FindFirst(item, 0, item.size(), u'=');
+        if (item.first(equal) == key)
+            return equal < item.size() ? item.sliced(equal + 1) : QStringView{};
+        begin = end + 1;
+    }
+    return std::nullopt;
+}
+
+QString ShareLink::PercentDecoded(QStringView view)
+{
+    if (FindFirst(view, 0, view.size(), u'%') == view.size())
+        return view.toString();
+
+    // Encoded bytes are collected as UTF-8, together with the UTF-8 of what is around them.
+    QByteArray bytes;
+    bytes.reserve(view.size());
+    for (qsizetype i = 0; i < view.size(); i++)
+    {
+        if (view[i] == u'%' && i + 2 < view.size() && HexValue(view[i + 1].unicode()) >= 0 && HexValue(view[i + 2].unicode()) >= 0)
+        {
+            bytes += char(HexValue(view[i + 1].unicode()) << 4 | HexValue(view[i + 2].unicode()));
+            i += 2;
+            continue;
+        }
+
+        const auto c = view[i].unicode();
+        if (c < 0x80)
+        {
+            bytes += char(c);
+            continue;
+        }
+        // Non-ASCII text, up to the next percent sign, is converted as a whole to keep surrogate pairs together.
+        const auto next = FindFirst(view, i, view.size(), u'%');
+        bytes += view.sliced(i, next - i).toUtf8();
+        i = next - 1;
+    }
+    return QString::fromUtf8(bytes);
+}
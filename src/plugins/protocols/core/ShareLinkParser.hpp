@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <optional>
+
+// The components of a share link, split in a single pass without allocating.
+//
+// scheme://[user[:password]@]host[:port][/path][?query][#fragment]
+//
+// All of the views point into the parsed link, which must outlive this object. The host of an IPv6 literal is given
+// without brackets. Percent-encoding is left as is, it is only decoded when a value is asked for.
+struct ShareLink
+{
+    QStringView scheme;
+    QStringView userInfo;
+    QStringView userName;
+    QStringView password;
+    QStringView host;
+    // -1 if the link has no port.
+    int port = -1;
+    QStringView path;
+    QStringView query;
+    QStringView fragment;
+
+    // Returns std::nullopt if there is no scheme, the brackets of an IPv6 host don't match, or the port is invalid.
+    static std::optional<ShareLink> Parse(QStringView link);
+
+    // The raw, still percent-encoded, value of the first query item named key.
+    std::optional<QStringView> RawQueryItem(QStringView key) const;
+
+    bool HasQueryItem(QStringView key) const
+    {
+        return RawQueryItem(key).has_value();
+    }
+
+    QString QueryItemValue(QStringView key, const QString &defaultValue = {}) const
+    {
+        const auto value = RawQueryItem(key);
+        return value ? PercentDecoded(*value) : defaultValue;
+    }
+
+    // Decodes %XX sequences as UTF-8, views without any are copied directly.
+    static QString PercentDecoded(QStringView view);
+};
@@ -31,6 +31,8 @@ add_library(${PROTOCOL_PLUGIN_TARGET} SHARED
     ${CMAKE_CURRENT_LIST_DIR}/BuiltinProtocolPlugin.cpp
     ${CMAKE_CURRENT_LIST_DIR}/core/OutboundHandler.cpp
     ${CMAKE_CURRENT_LIST_DIR}/core/OutboundHandler.hpp
+    ${CMAKE_CURRENT_LIST_DIR}/core/ShareLinkParser.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/core/ShareLinkParser.hpp
     ${CMAKE_CURRENT_LIST_DIR}/ui/Interface.hpp
     ${CMAKE_CURRENT_LIST_DIR}/ui/PluginSettingsWidget.cpp
     ${CMAKE_CURRENT_LIST_DIR}/ui/PluginSettingsWidget.hpp
@@ -0,0 +1,321 @@
+#include "JsonPullReader.hpp"
+
+#include <QByteArray>
+#include <cstring>
+
+namespace
+{
+    int HexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    bool IsDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+} // namespace
+
+bool JsonPullReader::fail()
+{
+    error = true;
+    return false;
+}
+
+void JsonPullReader::skipWhitespace()
+{
+    while (position < data.size())
+    {
+        const auto c = data[position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            break;
+        position++;
+    }
+}
+
+char JsonPullReader::peek()
+{
+    skipWhitespace();
+    return position < data.size() ? data[position] : '\0';
+}
+
+bool JsonPullReader::expect(char c)
+{
+    if (error || peek() != c)
+        return fail();
+    position++;
+    return true;
+}
+
+bool JsonPullReader::beginContainer(char open)
+{
+    if (containers.size() >= MAX_DEPTH || !expect(open))
+        return fail();
+    containers.push_back(false);
+    return true;
+}
+
+bool JsonPullReader::nextItem(char close)
+{
+    if (error || containers.empty())
+        return fail();
+
+    if (peek() == close)
+    {
+        position++;
+        containers.pop_back();
+        return false;
+    }
+    if (containers.back() && !expect(','))
+        return false;
+    containers.back() = true;
+    return true;
+}
+
+bool JsonPullReader::BeginObject()
+{
+    return beginContainer('{');
+}
+
+bool JsonPullReader::BeginArray()
+{
+    return beginContainer('[');
+}
+
+bool JsonPullReader::NextElement()
+{
+    return nextItem(']');
+}
+
+bool JsonPullReader::NextKey(QString &key)
+{
+    if (!nextItem('}'))
+        return false;
+    const auto name = ReadString();
+    if (!name || !expect(':'))
+        return fail();
+    key = *name;
+    return true;
+}
+
+std::optional<QString> JsonPullReader::ReadString()
+{
+    if (!expect('"'))
+        return std::nullopt;
+
+    // Unescaped runs are copied in one go, most strings don't have any escape at all.
+    QByteArray utf8;
+    auto runBegin = position;
+    while (position < data.size())
+    {
+        const auto c = data[position];
+        if (c == '"')
+        {
+            utf8 += data.sliced(runBegin, position - runBegin);
+            position++;
+            return QString::fromUtf8(utf8);
+        }
+        if (static_cast<unsigned char>(c) < 0x20)
+            break;
+        if (c != '\\')
+        {
+            position++;
+            continue;
+        }
+
+        utf8 += data.sliced(runBegin, position - runBegin);
+        if (++position >= data.size())
+            break;
+        const auto escaped = data[position++];
+        switch (escaped)
+        {
+            case '"': utf8 += '"'; break;
+            case '\\': utf8 += '\\'; break;
+            case '/': utf8 += '/'; break;
+            case 'b': utf8 += '\b'; break;
+            case 'f': utf8 += '\f'; break;
+            case 'n': utf8 += '\n'; break;
+            case 'r': utf8 += '\r'; break;
+            case 't': utf8 += '\t'; break;
+            case 'u':
+            {
+                const auto readUnit = [this]() -> int
+                {
+                    if (position + 4 > data.size())
+                        return -1;
+                    auto unit = 0;
+                    for (auto i = 0; i < 4; i++)
+                    {
+                        const auto digit = HexValue(data[position + i]);
+                        if (digit < 0)
+                            return -1;
+                        unit = unit << 4 | digit;
+                    }
+                    position += 4;
+                    return unit;
+                };
+
+                auto unit = readUnit();
+                if (unit < 0)
+                {
+                    fail();
+                    return std::nullopt;
+                }
+                char32_t codePoint = unit;
+                if (unit >= 0xD800 && unit < 0xDC00 && position + 2 <= data.size() && data[position] == '\\' && data[position + 1] == 'u')
+                {
+                    const auto resume = position;
+                    position += 2;
+                    const auto low = readUnit();
+                    if (low >= 0xDC00 && low < 0xE000)
+                        codePoint = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                    else
+                        position = resume;
+                }
+                // Lone surrogates are kept as U+FFFD, as QString::fromUtf8 would do.
+                if (codePoint >= 0xD800 && codePoint < 0xE000)
+                    codePoint = 0xFFFD;
+                utf8 += QString::fromUcs4(&codePoint, 1).toUtf8();
+                break;
+            }
+            default: fail(); return std::nullopt;
+        }
+        runBegin = position;
+    }
+    fail();
+    return std::nullopt;
+}
+
+std::optional<double> JsonPullReader::ReadNumber()
+{
+    if (error)
+        return std::nullopt;
+    skipWhitespace();
+    const auto begin = position;
+    const auto accept = [this](auto predicate)
+    {
+        const auto accepted = position < data.size() && predicate(data[position]);
+        position += accepted;
+        return accepted;
+    };
+    const auto acceptDigits = [&]()
+    {
+        auto count = 0;
+        while (accept(IsDigit))
+            count++;
+        return count;
+    };
+
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?, toDouble alone would also take "1.", ".5" or "00".
+    accept([](char c) { return c == '-'; });
+    auto valid = accept([](char c) { return c == '0'; }) || acceptDigits() > 0;
+    if (valid && accept([](char c) { return c == '.'; }))
+        valid = acceptDigits() > 0;
+    if (valid && accept([](char c) { return c == 'e' || c == 'E'; }))
+    {
+        accept([](char c) { return c == '+' || c == '-'; });
+        valid = acceptDigits() > 0;
+    }
+
+    bool ok = valid;
+    const auto value = ok ? data.sliced(begin, position - begin).toByteArray().toDouble(&ok) : 0;
+    if (!ok)
+    {
+        fail();
+        return std::nullopt;
+    }
+    return value;
+}
+
+JsonPullReader::ValueType JsonPullReader::PeekType()
+{
+    if (error)
+        return TYPE_INVALID;
+    switch (const auto c = peek())
+    {
+        case '{': return TYPE_OBJECT;
+        case '[': return TYPE_ARRAY;
+        case '"': return TYPE_STRING;
+        case 't':
+        case 'f': return TYPE_BOOL;
+        case 'n': return TYPE_NULL;
+        default: return (c >= '0' && c <= '9') || c == '-' ? TYPE_NUMBER : TYPE_INVALID;
+    }
+}
+
+bool JsonPullReader::skipLiteral(const char *literal)
+{
+    const auto size = qsizetype(std::strlen(literal));
+    if (data.sliced(position).startsWith(QByteArrayView(literal, size)))
+    {
+        position += size;
+        return true;
+    }
+    return fail();
+}
+
+bool JsonPullReader::skipString()
+{
+    if (!expect('"'))
+        return false;
+    // Escapes are validated but not decoded.
+    while (position < data.size())
+    {
+        const auto c = data[position++];
+        if (c == '"')
+            return true;
+        if (static_cast<unsigned char>(c) < 0x20)
+            break;
+        if (c != '\\')
+            continue;
+        if (position >= data.size())
+            break;
+        const auto escaped = data[position++];
+        if (escaped == 'u')
+        {
+            for (auto i = 0; i < 4; i++, position++)
+                if (position >= data.size() || HexValue(data[position]) < 0)
+                    return fail();
+        }
+        else if (!std::strchr("\"\\/bfnrt", escaped) || escaped == '\0')
+            break;
+    }
+    return fail();
+}
+
+bool JsonPullReader::SkipValue()
+{
+    if (error)
+        return false;
+
+    QString key;
+    switch (peek())
+    {
+        case '{':
+            BeginObject();
+            while (NextKey(key))
+                SkipValue();
+            return !error;
+        case '[':
+            BeginArray();
+            while (NextElement())
+                SkipValue();
+            return !error;
+        case '"': return skipString();
+        case 't': return skipLiteral("true");
+        case 'f': return skipLiteral("false");
+        case 'n': return skipLiteral("null");
+        default: return ReadNumber().has_value();
+    }
+}
+
+bool JsonPullReader::AtEnd()
+{
+    return !error && containers.empty() && peek() == '\0' && position == data.size();
+}
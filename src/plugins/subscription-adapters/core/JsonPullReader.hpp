@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QString>
+#include <optional>
+#include <vector>
+
+// A pull reader for JSON, the caller walks the document one token at a time instead of building a QJsonDocument.
+//
+// Objects and arrays are iterated with NextKey / NextElement, which return false (and consume the closing bracket) once
+// the container is exhausted. Values the caller isn't interested in are skipped with SkipValue. Any syntax error, or a
+// value of an unexpected type, puts the reader in the error state, after which every call fails.
+class JsonPullReader
+{
+  public:
+    enum ValueType
+    {
+        TYPE_INVALID,
+        TYPE_NULL,
+        TYPE_BOOL,
+        TYPE_NUMBER,
+        TYPE_STRING,
+        TYPE_ARRAY,
+        TYPE_OBJECT
+    };
+
+    // Deeper documents are rejected, SkipValue recurses once per level.
+    static constexpr size_t MAX_DEPTH = 128;
+
+    // The data must outlive the reader.
+    explicit JsonPullReader(QByteArrayView data) : data(data){};
+
+    bool BeginObject();
+    bool NextKey(QString &key);
+    bool BeginArray();
+    bool NextElement();
+
+    // The type of the next value, which isn't consumed.
+    ValueType PeekType();
+
+    std::optional<QString> ReadString();
+    std::optional<double> ReadNumber();
+    bool SkipValue();
+
+    bool HasError() const
+    {
+        return error;
+    }
+    // True once the root value has been read entirely, and only whitespace follows it.
+    bool AtEnd();
+
+  private:
+    bool beginContainer(char open);
+    bool nextItem(char close);
+    bool expect(char c);
+    bool skipString();
+    bool skipLiteral(const char *literal);
+    bool fail();
+    void skipWhitespace();
+    char peek();
+
+    QByteArrayView data;
+    qsizetype position = 0;
+    // For each open container, whether an item has been read, so that the next one must be preceded by a comma.
+    std::vector<bool> containers;
+    bool error = false;
+};
@@ -0,0 +1,280 @@
+#include "StreamingLinkDecoder.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define QV_BASE64_HAS_SSSE3
+    #include <immintrin.h>
+#endif
+
+namespace
+{
+    // Plain links have a scheme, so "://" shows up early in the line, base64 never contains a colon.
+    constexpr qsizetype MAX_UNDECIDED_SIZE = 256;
+    // Comments and blank lines before the first link are skipped while deciding, up to this size.
+    constexpr qsizetype MAX_SKIPPED_SIZE = 64 * 1024;
+    constexpr char SCHEME_SEPARATOR[] = "://";
+
+    constexpr quint8 BASE64_SKIP = 0x80;
+    constexpr quint8 BASE64_PADDING = 0x81;
+
+    struct Base64Table
+    {
+        quint8 values[256];
+    };
+
+    // Accepts both the standard and the URL-safe alphabet, anything else is skipped.
+    constexpr Base64Table MakeBase64Table()
+    {
+        Base64Table table{};
+        for (auto &value : table.values)
+            value = BASE64_SKIP;
+        for (auto c = 'A'; c <= 'Z'; c++)
+            table.values[quint8(c)] = c - 'A';
+        for (auto c = 'a'; c <= 'z'; c++)
+            table.values[quint8(c)] = c - 'a' + 26;
+        for (auto c = '0'; c <= '9'; c++)
+            table.values[quint8(c)] = c - '0' + 52;
+        table.values[quint8('+')] = table.values[quint8('-')] = 62;
+        table.values[quint8('/')] = table.values[quint8('_')] = 63;
+        table.values[quint8('=')] = BASE64_PADDING;
+        return table;
+    }
+
+    constexpr auto BASE64_TABLE = MakeBase64Table();
+
+    constexpr bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    constexpr bool IsNewline(char c)
+    {
+        return c == '\r' || c == '\n';
+    }
+
+    // Blank lines, and the lines some providers put before the links of a plain subscription.
+    bool IsCommentLine(QByteArrayView line)
+    {
+        const auto *begin = std::find_if_not(line.begin(), line.end(), IsSpace);
+        const QByteArrayView rest(begin, line.end() - begin);
+        return rest.isEmpty() || rest.startsWith('#') || rest.startsWith("REMARKS=") || rest.startsWith("STATUS=");
+    }
+
+    // Writes the bytes of an incomplete group, as if the trailing '=' were present.
+    uchar *FlushGroup(const quint8 *group, int size, uchar *out)
+    {
+        if (size >= 2)
+            *out++ = uchar(group[0] << 2 | group[1] >> 4);
+        if (size >= 3)
+            *out++ = uchar(group[1] << 4 | group[2] >> 2);
+        return out;
+    }
+
+#ifdef QV_BASE64_HAS_SSSE3
+    __attribute__((target("ssse3"))) inline __m128i InRange(__m128i c, char low, char high)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(char(low - 1))), _mm_cmplt_epi8(c, _mm_set1_epi8(char(high + 1))));
+    }
+
+    // Decodes blocks of 16 characters into 12 bytes, until a block has something other than the base64 alphabet,
+    // which is left for the scalar loop. Writes up to 4 bytes past the decoded data. Returns the characters consumed.
+    __attribute__((target("ssse3"))) qsizetype DecodeBase64BlocksSSSE3(const uchar *in, qsizetype size, uchar *out)
+    {
+        qsizetype consumed = 0;
+        for (; size - consumed >= 16; consumed += 16, out += 12)
+        {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+            const __m128i upper = InRange(c, 'A', 'Z');
+            const __m128i lower = InRange(c, 'a', 'z');
+            const __m128i digit = InRange(c, '0', '9');
+            const __m128i is62 = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('+')), _mm_cmpeq_epi8(c, _mm_set1_epi8('-')));
+            const __m128i is63 = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')), _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+
+            const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+            if (_mm_movemask_epi8(valid) != 0xffff)
+                break;
+
+            __m128i values = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+            values = _mm_or_si128(values, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+            values = _mm_or_si128(values, _mm_and_si128(digit, _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+            values = _mm_or_si128(values, _mm_and_si128(is62, _mm_set1_epi8(62)));
+            values = _mm_or_si128(values, _mm_and_si128(is63, _mm_set1_epi8(63)));
+
+            // Pairs of 6-bit values into 12 bits, pairs of those into 24 bits, then into big-endian byte order.
+            const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            const __m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            const __m128i bytes = _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), bytes);
+        }
+        return consumed;
+    }
+#endif
+} // namespace
+
+StreamingLinkDecoder::StreamingLinkDecoder(LineCallback callback) : callback(std::move(callback))
+{
+}
+
+void StreamingLinkDecoder::Feed(QByteArrayView chunk)
+{
+    if (mode == MODE_UNDECIDED)
+    {
+        undecided.append(chunk);
+        if (const auto decided = DetectMode(); decided != MODE_UNDECIDED)
+            Decide(decided);
+        return;
+    }
+
+    if (mode == MODE_PLAIN)
+        PushText(chunk);
+    else
+        DecodeBase64(chunk);
+}
+
+void StreamingLinkDecoder::Finish()
+{
+    // Whatever is left is the last line, a subscription made of comments alone is plain text.
+    if (mode == MODE_UNDECIDED && !undecided.isEmpty())
+        Decide(IsCommentLine(QByteArrayView(undecided).sliced(skippedSize)) ? MODE_PLAIN : MODE_BASE64);
+
+    if (mode == MODE_BASE64)
+        FlushBase64Group();
+
+    if (!pendingLine.isEmpty())
+        callback(pendingLine);
+    pendingLine.clear();
+    decoded.clear();
+}
+
+StreamingLinkDecoder::DecoderMode StreamingLinkDecoder::DetectMode()
+{
+    while (true)
+    {
+        const auto rest = QByteArrayView(undecided).sliced(skippedSize);
+        const auto *newline = std::find_if(rest.begin(), rest.end(), IsNewline);
+        const auto *windowEnd = rest.begin() + std::min<qsizetype>(newline - rest.begin(), MAX_UNDECIDED_SIZE);
+        if (std::search(rest.begin(), windowEnd, std::begin(SCHEME_SEPARATOR), std::end(SCHEME_SEPARATOR) - 1) != windowEnd)
+            return MODE_PLAIN;
+
+        if (newline == rest.end())
+            return rest.size() >= MAX_UNDECIDED_SIZE || skippedSize >= MAX_SKIPPED_SIZE ? MODE_BASE64 : MODE_UNDECIDED;
+
+        // A complete line without a scheme: base64 wrapped into lines has no comments in between.
+        if (!IsCommentLine(QByteArrayView(rest.begin(), newline - rest.begin())))
+            return MODE_BASE64;
+        skippedSize += newline - rest.begin() + 1;
+    }
+}
+
+void StreamingLinkDecoder::Decide(DecoderMode newMode)
+{
+    mode = newMode;
+    const auto replay = std::move(undecided);
+    undecided.clear();
+    if (mode == MODE_PLAIN)
+        PushText(replay);
+    else
+        // The skipped comments are text, decoding them as base64 would corrupt the first links.
+        DecodeBase64(QByteArrayView(replay).sliced(skippedSize));
+}
+
+void StreamingLinkDecoder::DecodeBase64(QByteArrayView chunk)
+{
+    // Every 4 characters decode to at most 3 bytes, plus the carried group, plus what the SIMD store may overwrite.
+    decoded.resize(chunk.size() / 4 * 3 + 16);
+
+    const auto *in = reinterpret_cast<const uchar *>(chunk.data());
+    const auto *const end = in + chunk.size();
+    auto *out = reinterpret_cast<uchar *>(decoded.data());
+
+#ifdef QV_BASE64_HAS_SSSE3
+    static const bool hasSSSE3 = __builtin_cpu_supports("ssse3");
+#endif
+
+    while (in < end)
+    {
+        if (groupSize == 0)
+        {
+#ifdef QV_BASE64_HAS_SSSE3
+            if (hasSSSE3 && end - in >= 16)
+            {
+                const auto consumed = DecodeBase64BlocksSSSE3(in, end - in, out);
+                in += consumed;
+                out += consumed / 4 * 3;
+            }
+#endif
+            // Whole groups without whitespace or padding, which is what most of the input is.
+            while (end - in >= 4)
+            {
+                const quint8 a = BASE64_TABLE.values[in[0]], b = BASE64_TABLE.values[in[1]];
+                const quint8 c = BASE64_TABLE.values[in[2]], d = BASE64_TABLE.values[in[3]];
+                if ((a | b | c | d) & 0x80)
+                    break;
+                out[0] = uchar(a << 2 | b >> 4);
+                out[1] = uchar(b << 4 | c >> 2);
+                out[2] = uchar(c << 6 | d);
+                in += 4;
+                out += 3;
+            }
+            if (in == end)
+                break;
+        }
+
+        const auto value = BASE64_TABLE.values[*in++];
+        if (value == BASE64_PADDING)
+        {
+            out = FlushGroup(group, groupSize, out);
+            groupSize = 0;
+        }
+        else if (value != BASE64_SKIP)
+        {
+            group[groupSize++] = value;
+            if (groupSize == 4)
+            {
+                out = FlushGroup(group, 3, out);
+                *out++ = uchar(group[2] << 6 | group[3]);
+                groupSize = 0;
+            }
+        }
+    }
+
+    PushText(QByteArrayView(decoded.constData(), reinterpret_cast<char *>(out) - decoded.data()));
+}
+
+void StreamingLinkDecoder::FlushBase64Group()
+{
+    uchar bytes[3];
+    const auto *end = FlushGroup(group, groupSize, bytes);
+    groupSize = 0;
+    PushText(QByteArrayView(bytes, end - bytes));
+}
+
+void StreamingLinkDecoder::PushText(QByteArrayView text)
+{
+    const auto *begin = text.begin();
+    while (true)
+    {
+        const auto *newline = std::find_if(begin, text.end(), [](char c) { return c == '\r' || c == '\n'; });
+        if (newline == text.end())
+        {
+            pendingLine.append(QByteArrayView(begin, newline - begin));
+            return;
+        }
+
+        // Complete lines are passed as views into the chunk, only lines spanning two chunks are copied.
+        const QByteArrayView line(begin, newline - begin);
+        if (!pendingLine.isEmpty())
+        {
+            pendingLine.append(line);
+            callback(pendingLine);
+            pendingLine.clear();
+        }
+        else if (!line.isEmpty())
+        {
+            callback(line);
+        }
+        begin = newline + 1;
+    }
+}
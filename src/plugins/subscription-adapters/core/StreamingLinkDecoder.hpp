@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <functional>
+
+// Decodes a subscription as it arrives, and hands out its links one line at a time.
+//
+// The payload is either plain text, or (URL-safe) base64 of it. Chunks are decoded in place,
+// only the undecoded tail of a base64 group and an incomplete line are kept between chunks,
+// so the memory used doesn't depend on the size of the subscription.
+class StreamingLinkDecoder
+{
+  public:
+    // The view is only valid during the call.
+    using LineCallback = std::function<void(QByteArrayView line)>;
+
+    explicit StreamingLinkDecoder(LineCallback callback);
+
+    void Feed(QByteArrayView chunk);
+    // Emits the last line, the decoder cannot be fed afterwards.
+    void Finish();
+
+    bool IsBase64() const
+    {
+        return mode == MODE_BASE64;
+    }
+
+  private:
+    enum DecoderMode
+    {
+        MODE_UNDECIDED,
+        MODE_PLAIN,
+        MODE_BASE64
+    };
+
+    DecoderMode DetectMode();
+    void Decide(DecoderMode newMode);
+    void DecodeBase64(QByteArrayView chunk);
+    void FlushBase64Group();
+    void PushText(QByteArrayView text);
+
+    LineCallback callback;
+    DecoderMode mode = MODE_UNDECIDED;
+
+    // Everything seen before the mode is known. That is the leading comments, bounded by MAX_SKIPPED_SIZE,
+    // and the chunk holding the start of the first link.
+    QByteArray undecided;
+    // The size of the leading comments and blank lines in undecided.
+    qsizetype skippedSize = 0;
+
+    // 6-bit values of an incomplete base64 group.
+    quint8 group[4];
+    int groupSize = 0;
+
+    QByteArray decoded;
+    QByteArray pendingLine;
+};
@@ -1,73 +1,99 @@
 #include "SubscriptionAdapter.hpp"
 
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
-#include <QUrl>
-#include <QUrlQuery>
-
-const inline QStringList SplitLines(const QString &_string)
-{
-    return _string.split(QRegularExpression("[\r\n]"), Qt::SkipEmptyParts);
-}
+#include "JsonPullReader.hpp"
+#include "StreamingLinkDecoder.hpp"
 
-QString SafeBase64Decode(QString string)
-{
-    QByteArray ba = string.replace(QChar('-'), QChar('+')).replace(QChar('_'), QChar('/')).toUtf8();
-    return QByteArray::fromBase64(ba, QByteArray::Base64Option::OmitTrailingEquals);
-}
-
-QString SafeBase64Encode(const QString &string)
-{
-    QString base64 = string.toUtf8().toBase64();
-    return base64.replace(QChar('+'), QChar('-')).replace(QChar('/'), QChar('_'));
-}
+#include <QUrl>
 
 // Simple Base64 Decoder
 SubscriptionDecodeResult SimpleBase64Decoder::DecodeData(const QByteArray &data) const
 {
-    auto source = QString::fromUtf8(data).trimmed();
-    const auto resultList = source.contains("://") ? source : SafeBase64Decode(source);
-    //
     SubscriptionDecodeResult result;
-    result.links = SplitLines(resultList);
+    StreamingLinkDecoder decoder([&result](QByteArrayView line) { result.links << QString::fromUtf8(line); });
+    // Fed in slices, so the decoding buffer stays small however large the subscription is.
+    constexpr qsizetype chunkSize = 64 * 1024;
+    for (qsizetype offset = 0; offset < data.size(); offset += chunkSize)
+        decoder.Feed(QByteArrayView(data).sliced(offset, std::min(chunkSize, data.size() - offset)));
+    decoder.Finish();
     return result;
 }
 
 // OOCv1 Decoder
+namespace
+{
+    const QStringList SERVER_FIELDS{ "server", "server_port", "password", "method", "plugin", "plugin_opts", "remarks" };
+
+    // Reads a string or a number as a string, server_port is found as both. Other values are skipped.
+    std::optional<QString> ReadScalar(JsonPullReader &reader)
+    {
+        switch (reader.PeekType())
+        {
+            case JsonPullReader::TYPE_STRING: return reader.ReadString();
+            case JsonPullReader::TYPE_NUMBER:
+                if (const auto number = reader.ReadNumber(); number)
+                    return QString::number(qint64(*number));
+                return std::nullopt;
+            default: reader.SkipValue(); return std::nullopt;
+        }
+    }
+
+    // ss://Y2hhY2hhMjAtaWV0Zi1wb2x5MTMwNTpwYXNz@host:1234/?plugin=plugin%3Bopt#sssip003
+    QString ServerToSIP002(const QHash<QString, QString> &server)
+    {
+        const auto userInfo = (server.value("method") + ":" + server.value("password")).toUtf8().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+        const auto host = server.value("server");
+        auto link = "ss://" + QString::fromLatin1(userInfo) + "@" + (host.contains(':') ? "[" + host + "]" : host) + ":" + server.value("server_port");
+        if (const auto plugin = server.value("plugin"); !plugin.isEmpty())
+        {
+            const auto options = server.value("plugin_opts");
+            link += "/?plugin=" + QString::fromLatin1(QUrl::toPercentEncoding(options.isEmpty() ? plugin : plugin + ";" + options));
+        }
+        return link + "#" + QString::fromLatin1(QUrl::toPercentEncoding(server.value("remarks")));
+    }
+} // namespace
+
 SubscriptionDecodeResult OOCv1Decoder::DecodeData(const QByteArray &data) const
 {
-    const auto root = QJsonDocument::fromJson(data).object();
-    //
-    const auto version = root["version"].toInt();
-    const auto username = root["username"].toString();
-    const auto user_uuid = root["user_uuid"].toString();
-    const auto servers = root["servers"].toArray();
+    // The document is walked with a pull reader, only the fields of one server are held at a time. The version may
+    // come after the servers, the links are only returned once it has been checked.
+    JsonPullReader reader{ data };
+    SubscriptionDecodeResult result;
+    auto version = 0;
 
-    if (version == 1)
+    QString key;
+    reader.BeginObject();
+    while (reader.NextKey(key))
     {
-        // ss://Y2hhY2hhMjAtaWV0Zi1wb2x5MTMwNTpwYXNzQGhvc3Q6MTIzNA/?plugin=plugin%3Bopt#sssip003
-        SubscriptionDecodeResult result;
-        for (const auto &servVal : servers)
+        if (key == "version")
         {
-            const auto serverObj = servVal.toObject();
-#define GetVal(x) const auto x = serverObj[#x].toString()
-            GetVal(server);
-            GetVal(password);
-            GetVal(method);
-            GetVal(plugin);
-            GetVal(plugin_opts);
-            GetVal(remarks);
-            GetVal(id);
-#undef GetVal
-            const auto server_port = serverObj["server_port"].toInt();
-            bool isSIP003 = !plugin.isEmpty();
-            const auto userInfo = SafeBase64Encode(method + ":" + password);
-#pragma message("TODO OOCv1")
-            // ...
+            version = int(reader.ReadNumber().value_or(0));
+            continue;
+        }
+        if (key != "servers")
+        {
+            reader.SkipValue();
+            continue;
+        }
+
+        reader.BeginArray();
+        while (reader.NextElement())
+        {
+            QHash<QString, QString> server;
+            QString field;
+            reader.BeginObject();
+            while (reader.NextKey(field))
+            {
+                if (!SERVER_FIELDS.contains(field))
+                    reader.SkipValue();
+                else if (const auto value = ReadScalar(reader); value)
+                    server[field] = *value;
+            }
+            if (!server.value("server").isEmpty() && !server.value("server_port").isEmpty() && !server.value("method").isEmpty())
+                result.links << ServerToSIP002(server);
         }
-        return result;
     }
-    return {};
+
+    if (reader.HasError() || version != 1)
+        return {};
+    return result;
 }
@@ -6,6 +6,10 @@ add_library(${SUBSCRIPTION_PLUGIN_TARGET} SHARED
     ${CMAKE_CURRENT_LIST_DIR}/BuiltinSubscriptionAdapter.hpp
     ${CMAKE_CURRENT_LIST_DIR}/core/SubscriptionAdapter.cpp
     ${CMAKE_CURRENT_LIST_DIR}/core/SubscriptionAdapter.hpp
+    ${CMAKE_CURRENT_LIST_DIR}/core/JsonPullReader.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/core/JsonPullReader.hpp
+    ${CMAKE_CURRENT_LIST_DIR}/core/StreamingLinkDecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/core/StreamingLinkDecoder.hpp
     )
 
 target_include_directories(${SUBSCRIPTION_PLUGIN_TARGET} PRIVATE ${CMAKE_CURRENT_LIST_DIR})
@@ -3,6 +3,9 @@
 #include "QvPlugin/Utils/BindableProps.hpp"
 #include "QvPlugin/Utils/JsonConversion.hpp"
 
+#include <QJsonArray>
+#include <algorithm>
+
 #ifndef QV2RAY_DEFAULT_VCORE_PATH
 #define QV2RAY_DEFAULT_VCORE_PATH ""
 #endif
@@ -18,10 +21,35 @@ struct BrowserForwarderConfig
     QJS_JSON(P(listenAddr, listenPort))
 };
 
+// Only emitted for profiles with leastPing balancers, or with a subjectSelector, and never without subjects: that would
+// probe every outbound, continuously.
 struct ObservatoryConfig
 {
+    Bindable<QString> probeURL{ QStringLiteral("https://www.google.com/generate_204") };
+    // Seconds, lower values are raised to MIN_PROBE_INTERVAL.
+    Bindable<int> probeInterval{ 60 };
+    // Probes all members at once instead of one after another.
+    Bindable<bool> enableConcurrency{ false };
+    // Outbound tag prefixes to probe besides the members of the leastPing balancers.
     QStringList subjectSelector;
-    QJS_JSON(F(subjectSelector))
+    static constexpr auto MIN_PROBE_INTERVAL = 10;
+    QJS_JSON(P(probeURL, probeInterval, enableConcurrency), F(subjectSelector))
+
+    // The observatory of a profile whose leastPing balancers select these prefixes, empty if there is nothing to probe.
+    QJsonObject Generate(const QStringList &balancerSelectors) const
+    {
+        QStringList subjects;
+        for (const auto &prefix : balancerSelectors + subjectSelector)
+            if (!prefix.isEmpty() && !subjects.contains(prefix))
+                subjects << prefix;
+        if (subjects.isEmpty())
+            return {};
+
+        return QJsonObject{ { QStringLiteral("subjectSelector"), QJsonArray::fromStringList(subjects) },
+                            { QStringLiteral("probeURL"), *probeURL },
+                            { QStringLiteral("probeInterval"), QString::number(std::max(*probeInterval, MIN_PROBE_INTERVAL)) + QStringLiteral("s") },
+                            { QStringLiteral("enableConcurrency"), *enableConcurrency } };
+    }
 };
 
 struct V2RayCorePluginSettings
@@ -42,9 +70,12 @@ struct V2RayCorePluginSettings
 
     Bindable<bool> APIEnabled{ true };
     Bindable<int> APIPort{ 15480 };
+    // Lets the plugin pick balancer targets from its own latency tests and traffic statistics, needs the API. Off by
+    // default, it overrides the strategy chosen for each balancer.
+    Bindable<bool> BalancerTuningEnabled{ false };
 
     BrowserForwarderConfig BrowserForwarderSettings;
     ObservatoryConfig ObservatorySettings;
 
-    QJS_JSON(P(LogLevel, CorePath, AssetsPath, APIEnabled, APIPort, OutboundMark), F(BrowserForwarderSettings, ObservatorySettings))
+    QJS_JSON(P(LogLevel, CorePath, AssetsPath, APIEnabled, APIPort, BalancerTuningEnabled, OutboundMark), F(BrowserForwarderSettings, ObservatorySettings))
 };
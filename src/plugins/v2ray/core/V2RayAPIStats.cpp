@@ -2,6 +2,7 @@
 
 #include "BuiltinV2RayCorePlugin.hpp"
 
+#include <QElapsedTimer>
 #include <QStringBuilder>
 #include <QThread>
 
@@ -42,8 +43,10 @@ APIWorker::APIWorker()
     workThread->start();
 }
 
-void APIWorker::StartAPI(const QMap<QString, QString> &tagProtocolPair)
+void APIWorker::StartAPI(const QMap<QString, QString> &tagProtocolPair, const QMap<QString, QList<BalancerTuner::Member>> &tunedBalancers)
 {
+    this->tunedBalancers = tunedBalancers;
+
     // Config API
     tagProtocolConfig.clear();
     for (auto it = tagProtocolPair.constKeyValueBegin(); it != tagProtocolPair.constKeyValueEnd(); it++)
@@ -85,6 +88,11 @@ void APIWorker::process()
         QThread::msleep(1000);
         bool dialed = false;
         int apiFailCounter = 0;
+        BalancerTuner tuner;
+        tuner.SetBalancers(tunedBalancers);
+        // The first round waits a few seconds for the kernel to listen.
+        int secondsSinceTune = QV2RAY_API_BALANCER_TUNE_INTERVAL - 5;
+        QElapsedTimer sampleTimer;
 
         while (running)
         {
@@ -95,6 +103,7 @@ void APIWorker::process()
                 QvPluginLog(QStringLiteral("gRPC Version: ") + QString::fromStdString(grpc::Version()));
                 grpc_channel = grpc::CreateChannel(channelAddress.toStdString(), grpc::InsecureChannelCredentials());
                 stats_service_stub = v2ray::core::app::stats::command::StatsService::NewStub(grpc_channel);
+                routing_service_stub = v2ray::core::app::router::command::RoutingService::NewStub(grpc_channel);
                 dialed = true;
 #endif
             }
@@ -113,6 +122,14 @@ void APIWorker::process()
                 continue;
             }
 
+            // The values are reset on each read, they were counted since the previous one. That is a second unless a round
+            // of the tuner or failed calls held the worker up.
+            qint64 sampleMsecs = 0;
+            if (sampleTimer.isValid())
+                sampleMsecs = sampleTimer.restart();
+            else
+                sampleTimer.start();
+
             StatisticsObject statsResult;
             bool hasError = false;
             for (const auto &[tag, statType] : tagProtocolConfig)
@@ -120,6 +137,7 @@ void APIWorker::process()
                 const auto value_up = CallStatsAPIByName(QStringLiteral("outbound>>>") + tag + QStringLiteral(">>>traffic>>>uplink"));
                 const auto value_down = CallStatsAPIByName(QStringLiteral("outbound>>>") + tag + QStringLiteral(">>>traffic>>>downlink"));
                 hasError = hasError || value_up == Qv2ray_GRPC_ERROR_RETCODE || value_down == Qv2ray_GRPC_ERROR_RETCODE;
+                tuner.AddTraffic(tag, std::max(value_up, 0LL) + std::max(value_down, 0LL), sampleMsecs);
                 if (statType == StatisticsObject::PROXY)
                 {
                     statsResult.proxyUp += std::max(value_up, 0LL);
@@ -134,6 +152,21 @@ void APIWorker::process()
             apiFailCounter = hasError ? apiFailCounter + 1 : 0;
             // Changed: Removed isrunning check here
             emit OnAPIDataReady(statsResult);
+
+            if (!tuner.IsEmpty() && ++secondsSinceTune >= QV2RAY_API_BALANCER_TUNE_INTERVAL)
+            {
+                secondsSinceTune = 0;
+                const auto changes = tuner.Update();
+                for (auto it = changes.constBegin(); it != changes.constEnd(); it++)
+                {
+                    if (!CallOverrideBalancerTarget(it.key(), it.value()))
+                    {
+                        QvPluginLog(QStringLiteral("V2Ray core cannot override balancer targets, balancer tuning stopped."));
+                        tuner.SetBalancers({});
+                        break;
+                    }
+                }
+            }
             QThread::msleep(1000);
         } // end while running
     }     // end while started
@@ -164,3 +197,23 @@ qint64 APIWorker::CallStatsAPIByName(const QString &name)
     return 0;
 #endif
 }
+
+bool APIWorker::CallOverrideBalancerTarget(const QString &balancer, const QString &target)
+{
+#ifndef QV2RAY_NO_GRPC
+    ClientContext context;
+    v2ray::core::app::router::command::OverrideBalancerTargetRequest request;
+    v2ray::core::app::router::command::OverrideBalancerTargetResponse response;
+    request.set_balancertag(balancer.toStdString());
+    request.set_target(target.toStdString());
+
+    const auto status = routing_service_stub->OverrideBalancerTarget(&context, request, &response);
+    if (!status.ok())
+    {
+        QvPluginLog(QStringLiteral("API call returns:") + QString::number(status.error_code()) + QStringLiteral(":") + QString::fromStdString(status.error_message()));
+        return status.error_code() != grpc::StatusCode::UNIMPLEMENTED;
+    }
+    QvPluginLog(QStringLiteral("Balancer ") + balancer + QStringLiteral(" now targets ") + target);
+#endif
+    return true;
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "QvPlugin/Common/CommonTypes.hpp"
+#include "V2RayBalancerTuner.hpp"
 
 #ifndef QV2RAY_NO_GRPC
+#include "v2ray/app/router/command/command.grpc.pb.h"
 #include "v2ray/app/stats/command/command.grpc.pb.h"
 
 #include <grpc++/grpc++.h>
@@ -13,6 +15,8 @@
 
 // Check 10 times before telling user that API has failed.
 constexpr auto QV2RAY_API_CALL_FAILEDCHECK_THRESHOLD = 30;
+// Seconds between two rounds of BalancerTuner.
+constexpr auto QV2RAY_API_BALANCER_TUNE_INTERVAL = 60;
 
 typedef std::map<QString, StatisticsObject::StatisticsType> QvAPITagProtocolConfig;
 
@@ -22,7 +26,8 @@ class APIWorker : public QObject
   public:
     APIWorker();
     ~APIWorker();
-    void StartAPI(const QMap<QString, QString> &tagProtocolPair);
+    // Balancers given here get their targets from BalancerTuner.
+    void StartAPI(const QMap<QString, QString> &tagProtocolPair, const QMap<QString, QList<BalancerTuner::Member>> &tunedBalancers = {});
     void StopAPI();
 
   signals:
@@ -34,7 +39,9 @@ class APIWorker : public QObject
 
   private:
     qint64 CallStatsAPIByName(const QString &name);
+    bool CallOverrideBalancerTarget(const QString &balancer, const QString &target);
     QvAPITagProtocolConfig tagProtocolConfig;
+    QMap<QString, QList<BalancerTuner::Member>> tunedBalancers;
     QThread *workThread;
 
     bool started = false;
@@ -42,5 +49,6 @@ class APIWorker : public QObject
 #ifndef QV2RAY_NO_GRPC
     std::shared_ptr<::grpc::Channel> grpc_channel;
     std::unique_ptr<::v2ray::core::app::stats::command::StatsService::Stub> stats_service_stub;
+    std::unique_ptr<::v2ray::core::app::router::command::RoutingService::Stub> routing_service_stub;
 #endif
 };
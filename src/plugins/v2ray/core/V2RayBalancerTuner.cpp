@@ -0,0 +1,184 @@
+#include "V2RayBalancerTuner.hpp"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonObject>
+#include <QNetworkProxy>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+QMap<QString, QList<BalancerTuner::Member>> BalancerTuner::FindBalancers(const QJsonArray &balancers, const QJsonArray &outbounds)
+{
+    // Members of a balancer are the outbounds whose tag starts with one of its selectors.
+    QMap<QString, QList<Member>> result;
+    for (const auto &item : balancers)
+    {
+        const auto balancer = item.toObject();
+        if (balancer[QStringLiteral("strategy")].toObject()[QStringLiteral("type")].toString() == QStringLiteral("leastPing"))
+            continue;
+        const auto selectors = balancer[QStringLiteral("selector")].toArray();
+        QList<Member> members;
+        for (const auto &outboundItem : outbounds)
+        {
+            const auto outbound = outboundItem.toObject();
+            const auto tag = outbound[QStringLiteral("tag")].toString();
+            const auto selected = std::any_of(selectors.begin(), selectors.end(), [&tag](const QJsonValue &prefix) { return tag.startsWith(prefix.toString()); });
+            if (tag.isEmpty() || !selected)
+                continue;
+            // VMess and VLESS list their servers in vnext, the other protocols in servers.
+            const auto settings = outbound[QStringLiteral("settings")].toObject();
+            const auto servers = settings.contains(QStringLiteral("vnext")) ? settings[QStringLiteral("vnext")].toArray() : settings[QStringLiteral("servers")].toArray();
+            const auto server = servers.at(0).toObject();
+            members << Member{ tag, server[QStringLiteral("address")].toString(), server[QStringLiteral("port")].toInt() };
+        }
+        if (members.size() > 1)
+            result[balancer[QStringLiteral("tag")].toString()] = members;
+    }
+    return result;
+}
+
+void BalancerTuner::SetBalancers(const QMap<QString, QList<Member>> &balancers)
+{
+    this->balancers = balancers;
+    members.clear();
+    targets.clear();
+    // Traffic counts from the start, before the first probe.
+    for (const auto &balancer : balancers)
+        for (const auto &member : balancer)
+            members.insert(member.tag, {});
+}
+
+void BalancerTuner::AddTraffic(const QString &tag, qint64 bytes, qint64 msecs)
+{
+    const auto it = members.find(tag);
+    if (it == members.end() || msecs <= 0)
+        return;
+    // A longer interval, such as the one stalled by probeLatencies, is a sample of its average rate rather than of a
+    // single second.
+    const auto rate = bytes * 1000.0 / msecs;
+    it->throughput *= std::pow(0.5, msecs / 1000.0 / THROUGHPUT_HALF_LIFE_SECS);
+    if (rate >= MIN_THROUGHPUT_SAMPLE)
+        it->throughput = std::max(it->throughput, rate);
+}
+
+QMap<QString, QString> BalancerTuner::Update()
+{
+    probeLatencies();
+
+    QMap<QString, QString> changes;
+    for (auto it = balancers.constBegin(); it != balancers.constEnd(); it++)
+    {
+        // Members that never carried enough traffic are assumed to be as fast as the typical one.
+        QList<double> throughputs;
+        for (const auto &member : *it)
+            if (members[member.tag].throughput > 0)
+                throughputs << members[member.tag].throughput;
+        std::sort(throughputs.begin(), throughputs.end());
+        const auto defaultThroughput = throughputs.isEmpty() ? 0 : throughputs[throughputs.size() / 2];
+
+        QString best;
+        auto bestScore = std::numeric_limits<double>::infinity();
+        for (const auto &member : *it)
+        {
+            if (const auto s = score(member.tag, defaultThroughput); s < bestScore)
+            {
+                best = member.tag;
+                bestScore = s;
+            }
+        }
+
+        const auto current = targets.value(it.key());
+        if (best.isEmpty() || best == current)
+            continue;
+        if (!current.isEmpty() && bestScore * (1 + SWITCH_THRESHOLD) >= score(current, defaultThroughput))
+            continue;
+
+        targets[it.key()] = best;
+        changes[it.key()] = best;
+    }
+    return changes;
+}
+
+void BalancerTuner::probeLatencies()
+{
+    struct Probe
+    {
+        QString tag;
+        std::unique_ptr<QTcpSocket> socket;
+        QElapsedTimer timer;
+        bool finished = false;
+    };
+
+    std::vector<Probe> probes;
+    for (const auto &balancer : balancers)
+        for (const auto &member : balancer)
+            if (!member.address.isEmpty() && member.port > 0)
+                probes.push_back({ member.tag, std::make_unique<QTcpSocket>(), {}, false });
+
+    // All handshakes run at the same time, on a local event loop, so that the whole round takes one timeout at worst.
+    QEventLoop loop;
+    auto pending = probes.size();
+    const auto finish = [&](Probe &probe, bool success)
+    {
+        if (probe.finished)
+            return;
+        probe.finished = true;
+        auto &stats = members[probe.tag];
+        // Handshakes with servers nearby take less than a millisecond.
+        const auto latency = probe.timer.nsecsElapsed() / 1e6;
+        if (!stats.probed)
+        {
+            stats.probed = true;
+            stats.latency = success ? latency : 0;
+            stats.successRate = success ? 1 : 0;
+        }
+        else
+        {
+            if (success)
+                stats.latency = stats.latency == 0 ? latency : stats.latency + EWMA_WEIGHT * (latency - stats.latency);
+            stats.successRate += EWMA_WEIGHT * ((success ? 1 : 0) - stats.successRate);
+        }
+        probe.socket->abort();
+        if (--pending == 0)
+            loop.quit();
+    };
+
+    auto index = 0;
+    for (const auto &balancer : balancers)
+    {
+        for (const auto &member : balancer)
+        {
+            if (member.address.isEmpty() || member.port <= 0)
+                continue;
+            auto &probe = probes[index++];
+            // The latency to the server itself, not to whatever proxy the system would use.
+            probe.socket->setProxy(QNetworkProxy::NoProxy);
+            QObject::connect(probe.socket.get(), &QTcpSocket::connected, &loop, [&finish, &probe]() { finish(probe, true); });
+            QObject::connect(probe.socket.get(), &QTcpSocket::errorOccurred, &loop, [&finish, &probe]() { finish(probe, false); });
+            probe.timer.start();
+            probe.socket->connectToHost(member.address, member.port);
+        }
+    }
+
+    if (pending == 0)
+        return;
+    QTimer::singleShot(PROBE_TIMEOUT_MSECS, &loop, &QEventLoop::quit);
+    loop.exec();
+    for (auto &probe : probes)
+        finish(probe, false);
+}
+
+double BalancerTuner::score(const QString &tag, double defaultThroughput) const
+{
+    const auto it = members.constFind(tag);
+    if (it == members.constEnd() || it->successRate == 0)
+        return std::numeric_limits<double>::infinity();
+    const auto throughput = it->throughput > 0 ? it->throughput : defaultThroughput;
+    const auto transfer = throughput > 0 ? REFERENCE_BYTES * 1000.0 / throughput : 0;
+    return (it->latency + transfer) / it->successRate;
+}
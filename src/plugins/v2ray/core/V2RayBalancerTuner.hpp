@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+// Picks the target of each balancer from what the plugin measures itself, instead of the observatory of the kernel.
+//
+// The latency of every member is a TCP handshake with its server, tested on each Update. Its throughput is the fastest
+// rate it carried between two reads of the statistics, slowly forgotten since throughput can only be seen on the member
+// currently in use.
+// Members are scored as the expected time to fetch REFERENCE_BYTES through them, and a balancer only moves to another
+// member once that one scores SWITCH_THRESHOLD better than its current target.
+//
+// Not thread safe, it is only used on the thread of APIWorker.
+class BalancerTuner
+{
+  public:
+    struct Member
+    {
+        QString tag;
+        QString address;
+        int port = 0;
+    };
+
+    static constexpr auto PROBE_TIMEOUT_MSECS = 2000;
+    static constexpr auto EWMA_WEIGHT = 0.3;
+    static constexpr auto SWITCH_THRESHOLD = 0.2;
+    // Quieter seconds say more about the demand than about the member.
+    static constexpr auto MIN_THROUGHPUT_SAMPLE = 64 * 1024;
+    static constexpr auto THROUGHPUT_HALF_LIFE_SECS = 600;
+    static constexpr auto REFERENCE_BYTES = 1024 * 1024;
+
+    // The balancers of a generated configuration that can be tuned: those with more than one member, except the leastPing
+    // ones which the observatory already tunes.
+    static QMap<QString, QList<Member>> FindBalancers(const QJsonArray &balancers, const QJsonArray &outbounds);
+    // Balancer tags to their members, which also forgets all measures.
+    void SetBalancers(const QMap<QString, QList<Member>> &balancers);
+    bool IsEmpty() const
+    {
+        return balancers.isEmpty();
+    }
+    // Called about once per second for each member, with the bytes it carried during the last msecs.
+    void AddTraffic(const QString &tag, qint64 bytes, qint64 msecs);
+    // Tests the latency of all members, blocking for at most PROBE_TIMEOUT_MSECS, then returns the balancers whose
+    // target should change, with their new target.
+    QMap<QString, QString> Update();
+
+  private:
+    struct MemberStats
+    {
+        double latency = 0;
+        double successRate = 0;
+        bool probed = false;
+        // Bytes per second.
+        double throughput = 0;
+    };
+
+    void probeLatencies();
+    // Milliseconds, lower is better.
+    double score(const QString &tag, double defaultThroughput) const;
+
+    QMap<QString, QList<Member>> balancers;
+    QHash<QString, MemberStats> members;
+    // The target last pushed to each balancer.
+    QHash<QString, QString> targets;
+};
@@ -53,8 +53,9 @@ bool V2RayKernel::PrepareConfigurations()
         return false;
     }
 
+    const auto root = QJsonDocument::fromJson(config).object();
     tagProtocolMap.clear();
-    for (const auto &item : QJsonDocument::fromJson(config).object()[QStringLiteral("outbounds")].toArray())
+    for (const auto &item : root[QStringLiteral("outbounds")].toArray())
     {
         const auto tag = item.toObject()[QStringLiteral("tag")].toString();
 
@@ -66,6 +67,9 @@ bool V2RayKernel::PrepareConfigurations()
         tagProtocolMap[tag] = item.toObject()[QStringLiteral("protocol")].toString();
     }
 
+    balancerMembers = BalancerTuner::FindBalancers(root[QStringLiteral("routing")].toObject()[QStringLiteral("balancers")].toArray(),
+                                                   root[QStringLiteral("outbounds")].toArray());
+
     return true;
 }
 
@@ -99,7 +103,7 @@ void V2RayKernel::Start()
     else
     {
         QvPluginLog(QStringLiteral("Starting API"));
-        apiWorker->StartAPI(tagProtocolMap);
+        apiWorker->StartAPI(tagProtocolMap, settings.BalancerTuningEnabled ? balancerMembers : QMap<QString, QList<BalancerTuner::Member>>{});
         apiEnabled = true;
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "QvPlugin/Handlers/KernelHandler.hpp"
+#include "V2RayBalancerTuner.hpp"
 
 class QProcess;
 class APIWorker;
@@ -40,6 +41,7 @@ class V2RayKernel : public Qv2rayPlugin::Kernel::PluginKernel
     bool apiEnabled;
     bool kernelStarted = false;
     QMap<QString, QString> tagProtocolMap;
+    QMap<QString, QList<BalancerTuner::Member>> balancerMembers;
     QString configFilePath;
 };
 
@@ -2,6 +2,7 @@
 
 #include "BuiltinV2RayCorePlugin.hpp"
 #include "QvPlugin/Utils/QJsonIO.hpp"
+#include "V2RayBalancerTuner.hpp"
 #include "V2RayModels.hpp"
 
 #include <QJsonDocument>
@@ -64,10 +65,15 @@ QByteArray V2RayProfileGenerator::Generate()
         if (!settings.BrowserForwarderSettings.listenAddr->isEmpty())
             rootconf[QStringLiteral("browserForwarder")] = settings.BrowserForwarderSettings.toJson();
 
-#pragma message("TODO: empty observatory causing high CPU usage.")
-
-    //    if (!rootconf.contains(QStringLiteral("observatory")) || rootconf.value(QStringLiteral("observatory")).toObject().isEmpty())
-    //        rootconf[QStringLiteral("observatory")] = settings.ObservatorySettings.toJson();
+    // An observatory without subjects probes every outbound, continuously, so it is only added when there are subjects:
+    // the members of the leastPing balancers and the ones selected in the settings.
+    if (!rootconf.contains(QStringLiteral("observatory")) || rootconf.value(QStringLiteral("observatory")).toObject().isEmpty())
+    {
+        if (const auto observatory = settings.ObservatorySettings.Generate(observedSelectors); !observatory.isEmpty())
+            rootconf[QStringLiteral("observatory")] = observatory;
+        else
+            rootconf.remove(QStringLiteral("observatory"));
+    }
 
     if (settings.APIEnabled)
     {
@@ -97,11 +103,14 @@ QByteArray V2RayProfileGenerator::Generate()
 
         //
         // API
-        rootconf[QStringLiteral("api")] = QJsonObject{ { QStringLiteral("tag"), QString::fromUtf8(DEFAULT_API_TAG) },
-                                                       { QStringLiteral("services"), QJsonArray{ QStringLiteral("ReflectionService"), //
-                                                                                                 QStringLiteral("HandlerService"),    //
-                                                                                                 QStringLiteral("LoggerService"),     //
-                                                                                                 QStringLiteral("StatsService") } } };
+        QJsonArray services{ QStringLiteral("ReflectionService"), //
+                             QStringLiteral("HandlerService"),    //
+                             QStringLiteral("LoggerService"),     //
+                             QStringLiteral("StatsService") };
+        // Only the balancer tuner needs the routing service, it moves the targets of the balancers.
+        if (settings.BalancerTuningEnabled && !BalancerTuner::FindBalancers(balancers, outbounds).isEmpty())
+            services << QStringLiteral("RoutingService");
+        rootconf[QStringLiteral("api")] = QJsonObject{ { QStringLiteral("tag"), QString::fromUtf8(DEFAULT_API_TAG) }, { QStringLiteral("services"), services } };
     }
 
     if (!rules.isEmpty())
@@ -278,6 +287,13 @@ void V2RayProfileGenerator::ProcessBalancerConfig(const OutboundObject &out)
     root[QStringLiteral("selector")] = out.balancerSettings.selectorSettings;
     root[QStringLiteral("strategy")] = QJsonObject{ { QStringLiteral("type"), out.balancerSettings.selectorType } };
     balancers << root;
+
+    if (out.balancerSettings.selectorType == QStringLiteral("leastPing"))
+    {
+        for (const auto &selector : root[QStringLiteral("selector")].toArray())
+            if (const auto prefix = selector.toString(); !prefix.isEmpty() && !observedSelectors.contains(prefix))
+                observedSelectors << prefix;
+    }
 }
 
 QJsonObject V2RayProfileGenerator::GenerateStreamSettings(const IOStreamSettings &stream)
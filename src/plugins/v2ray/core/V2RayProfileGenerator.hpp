@@ -52,6 +52,8 @@ class V2RayProfileGenerator
     QJsonArray outbounds;
     QJsonArray rules;
     QJsonArray balancers;
+    // Selectors of the leastPing balancers, the subjects of the observatory.
+    QStringList observedSelectors;
 };
 
 #ifdef QV2RAY_V2RAY_PLUGIN_USE_PROTOBUF
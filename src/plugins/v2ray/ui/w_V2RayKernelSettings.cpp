@@ -13,8 +13,12 @@ V2RayKernelSettings::V2RayKernelSettings(QWidget *parent) : Qv2rayPlugin::Gui::P
     settings.APIEnabled.ReadWriteBind(enableAPI, "checked", &QCheckBox::toggled);
     settings.APIPort.ReadWriteBind(statsPortBox, "value", &QSpinBox::valueChanged);
     settings.AssetsPath.ReadWriteBind(vCoreAssetsPathTxt, "text", &QLineEdit::textEdited);
+    settings.BalancerTuningEnabled.ReadWriteBind(balancerTuningCB, "checked", &QCheckBox::toggled);
     settings.CorePath.ReadWriteBind(vCorePathTxt, "text", &QLineEdit::textEdited);
     settings.LogLevel.ReadWriteBind(logLevelComboBox, "currentIndex", &QComboBox::currentIndexChanged);
+    settings.ObservatorySettings.enableConcurrency.ReadWriteBind(observatoryConcurrencyCB, "checked", &QCheckBox::toggled);
+    settings.ObservatorySettings.probeInterval.ReadWriteBind(observatoryIntervalSB, "value", &QSpinBox::valueChanged);
+    settings.ObservatorySettings.probeURL.ReadWriteBind(observatoryURLTxt, "text", &QLineEdit::textEdited);
     settings.OutboundMark.ReadWriteBind(somarkSB, "value", &QSpinBox::valueChanged);
 }
 
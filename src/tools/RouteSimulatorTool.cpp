@@ -0,0 +1,51 @@
+#include "Qv2rayBase/Common/Utils.hpp"
+#include "RouteSimulator/RouteSimulator.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <iostream>
+
+using namespace Qv2ray::components::RouteSimulator;
+
+// qv2ray-route-simulator [--geosite <file>] [--geoip <file>] <config.json> <requests.txt> <output.tsv>
+//
+// Predicts the outbound of every request in requests.txt for the routing rules of a v2ray configuration file, so that
+// a change to the rules can be checked, for example in CI, without starting the kernel.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("qv2ray-route-simulator"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("Predicts the outbound chosen by v2ray for each request, without starting the kernel."));
+    parser.addHelpOption();
+    QCommandLineOption geositeOption(QStringLiteral("geosite"), QObject::tr("Path of geosite.dat, used by geosite: rules."), QStringLiteral("file"));
+    QCommandLineOption geoipOption(QStringLiteral("geoip"), QObject::tr("Path of geoip.dat, used by geoip: rules."), QStringLiteral("file"));
+    parser.addOption(geositeOption);
+    parser.addOption(geoipOption);
+    parser.addPositionalArgument(QStringLiteral("config"), QObject::tr("The v2ray configuration file."));
+    parser.addPositionalArgument(QStringLiteral("requests"), QObject::tr("One request per line: <domain|ip>[:port] [network=] [inbound=] [protocol=] [ip=]"));
+    parser.addPositionalArgument(QStringLiteral("output"), QObject::tr("Receives \"<request>\\t<rule index>\\t<outbound>\" for each request."));
+    parser.process(app);
+
+    const auto args = parser.positionalArguments();
+    if (args.size() != 3)
+        parser.showHelp(1);
+
+    const auto config = JsonFromString(ReadFile(args[0]));
+    if (config.isEmpty())
+    {
+        std::cerr << "Cannot read the configuration file: " << args[0].toStdString() << std::endl;
+        return 1;
+    }
+
+    const RouteSimulator simulator(RouteSimulator::ProfileFromV2RayConfig(config), parser.value(geositeOption), parser.value(geoipOption));
+    const auto summary = simulator.SimulateFile(args[1], args[2]);
+    if (!summary)
+        return 1;
+
+    std::cout << "requests: " << summary->requests << ", unmatched: " << summary->unmatched << ", rules evaluated: " << summary->rulesEvaluated << std::endl;
+    for (auto i = 0; i < summary->ruleHits.size(); i++)
+        std::cout << "rule " << i << ": " << summary->ruleHits[i] << std::endl;
+    return 0;
+}
@@ -77,16 +77,6 @@ namespace Qv2ray::ui
         pColor->setStrength(factor);
         return ApplyEffectToImage(pixmap, pColor, 0);
     }
-
-    inline void FastAppendTextDocument(const QString &message, QTextDocument *doc)
-    {
-        QTextCursor cursor(doc);
-        cursor.movePosition(QTextCursor::End);
-        cursor.beginEditBlock();
-        cursor.insertBlock();
-        cursor.insertText(message);
-        cursor.endEditBlock();
-    }
 } // namespace Qv2ray::ui
 
 using namespace Qv2ray::ui;
@@ -79,6 +79,11 @@ namespace Qv2ray::ui::widgets
     {
     }
 
+    void AutoCompleteTextEdit::SetSourceStrings(const QStringList &sourceStrings)
+    {
+        qobject_cast<QStringListModel *>(c->model())->setStringList(sourceStrings);
+    }
+
     void AutoCompleteTextEdit::insertCompletion(const QString &completion)
     {
         QTextCursor tc = textCursor();
@@ -64,6 +64,7 @@ namespace Qv2ray::ui::widgets
       public:
         AutoCompleteTextEdit(const QString &prefix, const QStringList &sourceStrings, QWidget *parent = nullptr);
         ~AutoCompleteTextEdit();
+        void SetSourceStrings(const QStringList &sourceStrings);
 
       protected:
         void keyPressEvent(QKeyEvent *e) override;
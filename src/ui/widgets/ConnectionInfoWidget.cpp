@@ -1,5 +1,6 @@
 #include "ConnectionInfoWidget.hpp"
 
+#include "LatencyScheduler/LatencyScheduler.hpp"
 #include "Qv2rayBase/Common/ProfileHelpers.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Profile/KernelManager.hpp"
@@ -223,10 +224,10 @@ void ConnectionInfoWidget::on_latencyBtn_clicked()
 {
     if (!connectionId.isNull())
     {
-        QvBaselib->ProfileManager()->StartLatencyTest(connectionId, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
+        LatencyScheduler->Enqueue(QList{ connectionId }, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
     }
     else
     {
-        QvBaselib->ProfileManager()->StartLatencyTest(groupId, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
+        LatencyScheduler->Enqueue(groupId, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
     }
 }
@@ -0,0 +1,100 @@
+#include "ConnectionItemDelegate.hpp"
+
+#include "ConnectionModelHelper/ConnectionModelHelper.hpp"
+
+#include <QApplication>
+#include <QLineEdit>
+#include <QPainter>
+
+constexpr auto ITEM_MARGIN = 4;
+constexpr auto ITEM_SPACING = 8;
+
+ConnectionItemDelegate::ConnectionItemDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+}
+
+QFont ConnectionItemDelegate::nameFont(const QFont &base, bool isGroup) const
+{
+    auto font = base;
+    font.setPointSize(11);
+    font.setBold(isGroup);
+    return font;
+}
+
+QFont ConnectionItemDelegate::detailFont(const QFont &base) const
+{
+    auto font = base;
+    font.setPointSize(9);
+    return font;
+}
+
+QRect ConnectionItemDelegate::nameLineRect(const QStyleOptionViewItem &option, const QFont &font) const
+{
+    const auto contentRect = option.rect.adjusted(ITEM_MARGIN, ITEM_MARGIN, -ITEM_MARGIN, -ITEM_MARGIN);
+    return { contentRect.left(), contentRect.top(), contentRect.width(), QFontMetrics(font).height() };
+}
+
+void ConnectionItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // Background, selection and focus are left to the style, only the texts are painted here.
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    opt.text.clear();
+    opt.icon = {};
+    const auto style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+    const auto isGroup = index.data(ROLE_IS_GROUP).toBool();
+    const auto topFont = nameFont(opt.font, isGroup);
+    const auto bottomFont = detailFont(opt.font);
+    const auto topRect = nameLineRect(opt, topFont);
+    const auto colorGroup = opt.state & QStyle::State_Enabled ? QPalette::Normal : QPalette::Disabled;
+    const auto colorRole = opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text;
+
+    painter->save();
+    painter->setPen(opt.palette.color(colorGroup, colorRole));
+
+    const auto statusText = index.data(ROLE_STATUS_TEXT).toString();
+    painter->setFont(opt.font);
+    const auto statusWidth = painter->fontMetrics().horizontalAdvance(statusText);
+    painter->drawText(topRect, Qt::AlignRight | Qt::AlignVCenter, statusText);
+
+    painter->setFont(topFont);
+    const auto nameWidth = std::max(0, topRect.width() - statusWidth - ITEM_SPACING);
+    const auto name = painter->fontMetrics().elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, nameWidth);
+    painter->drawText(QRect{ topRect.topLeft(), QSize{ nameWidth, topRect.height() } }, Qt::AlignLeft | Qt::AlignVCenter, name);
+
+    if (!isGroup)
+    {
+        painter->setFont(bottomFont);
+        const QRect bottomRect{ topRect.left(), topRect.bottom() + ITEM_MARGIN, topRect.width(), painter->fontMetrics().height() };
+        const auto usageText = index.data(ROLE_USAGE_TEXT).toString();
+        const auto usageWidth = painter->fontMetrics().horizontalAdvance(usageText);
+        painter->drawText(bottomRect, Qt::AlignRight | Qt::AlignVCenter, usageText);
+        const auto detailWidth = std::max(0, bottomRect.width() - usageWidth - ITEM_SPACING);
+        const auto detailText = painter->fontMetrics().elidedText(index.data(ROLE_DETAIL_TEXT).toString(), Qt::ElideRight, detailWidth);
+        painter->drawText(QRect{ bottomRect.topLeft(), QSize{ detailWidth, bottomRect.height() } }, Qt::AlignLeft | Qt::AlignVCenter, detailText);
+    }
+    painter->restore();
+}
+
+QSize ConnectionItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    // Groups get the same height as connections, so that the view can use uniform row heights.
+    const auto height = QFontMetrics(nameFont(option.font, true)).height() + QFontMetrics(detailFont(option.font)).height() + 3 * ITEM_MARGIN;
+    return { option.rect.width(), height };
+}
+
+void ConnectionItemDelegate::updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    editor->setFont(nameFont(option.font, index.data(ROLE_IS_GROUP).toBool()));
+    editor->setGeometry(nameLineRect(option, editor->font()));
+}
+
+void ConnectionItemDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+    const auto lineEdit = qobject_cast<QLineEdit *>(editor);
+    if (!lineEdit || lineEdit->text().trimmed().isEmpty())
+        return;
+    model->setData(index, lineEdit->text(), Qt::EditRole);
+}
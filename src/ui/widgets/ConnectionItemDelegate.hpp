@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+
+// Paints a row of the connection list: the name and the status on the first line, the protocol and the data usage on the
+// second line for connections. Nothing is kept per row, the texts come from the model roles.
+class ConnectionItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+  public:
+    explicit ConnectionItemDelegate(QObject *parent = nullptr);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    void updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const override;
+
+  private:
+    QFont nameFont(const QFont &base, bool isGroup) const;
+    QFont detailFont(const QFont &base) const;
+    QRect nameLineRect(const QStyleOptionViewItem &option, const QFont &font) const;
+};
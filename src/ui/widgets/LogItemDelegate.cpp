@@ -0,0 +1,46 @@
+#include "LogItemDelegate.hpp"
+
+#include "LogHighlighter/LogHighlighter.hpp"
+
+#include <QPainter>
+#include <QTextLayout>
+
+constexpr auto LINE_MARGIN = 2;
+
+LogItemDelegate::LogItemDelegate(const Qv2ray::components::LogHighlighter::LogHighlighter *highlighter, QObject *parent)
+    : QStyledItemDelegate(parent), highlighter(highlighter)
+{
+}
+
+void LogItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const auto text = index.data().toString();
+    const auto selected = option.state & QStyle::State_Selected;
+
+    painter->save();
+    if (selected)
+        painter->fillRect(option.rect, option.palette.highlight());
+
+    QTextLayout layout(text, option.font, painter->device());
+    QTextOption textOption;
+    textOption.setWrapMode(QTextOption::NoWrap);
+    layout.setTextOption(textOption);
+    // Selected lines keep the plain colors of the selection, so that they stay readable.
+    if (!selected && highlighter)
+        layout.setFormats(highlighter->Highlight(text));
+    layout.beginLayout();
+    auto line = layout.createLine();
+    if (line.isValid())
+        line.setPosition({ 0, 0 });
+    layout.endLayout();
+
+    painter->setPen(option.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+    const auto top = option.rect.top() + (option.rect.height() - (line.isValid() ? line.height() : 0)) / 2;
+    layout.draw(painter, QPointF(option.rect.left() + LINE_MARGIN, top));
+    painter->restore();
+}
+
+QSize LogItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    return { option.fontMetrics.horizontalAdvance(index.data().toString()) + 2 * LINE_MARGIN, option.fontMetrics.height() + LINE_MARGIN };
+}
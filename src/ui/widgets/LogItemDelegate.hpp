@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+
+namespace Qv2ray::components::LogHighlighter
+{
+    class LogHighlighter;
+}
+
+// Paints a line of a log, without wrapping, in the formats of the highlighter.
+class LogItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+  public:
+    explicit LogItemDelegate(const Qv2ray::components::LogHighlighter::LogHighlighter *highlighter, QObject *parent = nullptr);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+  private:
+    const Qv2ray::components::LogHighlighter::LogHighlighter *highlighter;
+};
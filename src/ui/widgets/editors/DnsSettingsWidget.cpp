@@ -5,6 +5,8 @@
 #include "ui/WidgetUIBase.hpp"
 #include "ui/widgets/AutoCompleteTextEdit.hpp"
 
+#include <QFutureWatcher>
+
 #define CHECK_DISABLE_MOVE_BTN                                                                                                                                           \
     if (serversListbox->count() <= 1)                                                                                                                                    \
     {                                                                                                                                                                    \
@@ -36,11 +38,23 @@ DnsSettingsWidget::DnsSettingsWidget(QWidget *parent) : QWidget(parent)
     setupUi(this);
     QvMessageBusConnect();
     //
-    auto sourceStringsIP = GeositeReader::ReadGeoSiteFromFile(GlobalConfig->behaviorConfig->GeoIPPath);
-    auto sourceStringsDomain = GeositeReader::ReadGeoSiteFromFile(GlobalConfig->behaviorConfig->GeoSitePath);
+    domainListTxt = new AutoCompleteTextEdit("geosite", {}, this);
+    ipListTxt = new AutoCompleteTextEdit("geoip", {}, this);
+    //
+    const auto domainWatcher = new QFutureWatcher<QStringList>(this);
+    connect(domainWatcher, &QFutureWatcher<QStringList>::finished, this, [this, domainWatcher] {
+        domainListTxt->SetSourceStrings(domainWatcher->result());
+        domainWatcher->deleteLater();
+    });
+    domainWatcher->setFuture(GeositeReader::ReadGeoSiteFromFileAsync(GlobalConfig->behaviorConfig->GeoSitePath));
+    //
+    const auto ipWatcher = new QFutureWatcher<QStringList>(this);
+    connect(ipWatcher, &QFutureWatcher<QStringList>::finished, this, [this, ipWatcher] {
+        ipListTxt->SetSourceStrings(ipWatcher->result());
+        ipWatcher->deleteLater();
+    });
+    ipWatcher->setFuture(GeositeReader::ReadGeoSiteFromFileAsync(GlobalConfig->behaviorConfig->GeoIPPath));
     //
-    domainListTxt = new AutoCompleteTextEdit("geosite", sourceStringsDomain, this);
-    ipListTxt = new AutoCompleteTextEdit("geoip", sourceStringsIP, this);
     connect(domainListTxt, &AutoCompleteTextEdit::textChanged,
             [&]() { (*dns.servers)[currentServerIndex].domains = SplitLines(domainListTxt->toPlainText()); });
     connect(ipListTxt, &AutoCompleteTextEdit::textChanged,
@@ -5,6 +5,7 @@
 #include "ui/WidgetUIBase.hpp"
 
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QInputDialog>
 
 #define QV_MODULE_NAME "RouteSettingsMatrix"
@@ -27,15 +28,34 @@ RouteSettingsMatrixWidget::RouteSettingsMatrixWidget(QWidget *parent) : QWidget(
 
     builtInSchemeBtn->setMenu(builtInSchemesMenu);
 
-    const auto sourceStringsDomain = GeositeReader::ReadGeoSiteFromFile(GlobalConfig->behaviorConfig->GeoSitePath);
-    directDomainTxt = new AutoCompleteTextEdit(QStringLiteral("geosite"), sourceStringsDomain, this);
-    proxyDomainTxt = new AutoCompleteTextEdit(QStringLiteral("geosite"), sourceStringsDomain, this);
-    blockDomainTxt = new AutoCompleteTextEdit(QStringLiteral("geosite"), sourceStringsDomain, this);
-
-    const auto sourceStringsIP = GeositeReader::ReadGeoSiteFromFile(GlobalConfig->behaviorConfig->GeoIPPath);
-    directIPTxt = new AutoCompleteTextEdit(QStringLiteral("geoip"), sourceStringsIP, this);
-    proxyIPTxt = new AutoCompleteTextEdit(QStringLiteral("geoip"), sourceStringsIP, this);
-    blockIPTxt = new AutoCompleteTextEdit(QStringLiteral("geoip"), sourceStringsIP, this);
+    directDomainTxt = new AutoCompleteTextEdit(QStringLiteral("geosite"), {}, this);
+    proxyDomainTxt = new AutoCompleteTextEdit(QStringLiteral("geosite"), {}, this);
+    blockDomainTxt = new AutoCompleteTextEdit(QStringLiteral("geosite"), {}, this);
+
+    directIPTxt = new AutoCompleteTextEdit(QStringLiteral("geoip"), {}, this);
+    proxyIPTxt = new AutoCompleteTextEdit(QStringLiteral("geoip"), {}, this);
+    blockIPTxt = new AutoCompleteTextEdit(QStringLiteral("geoip"), {}, this);
+
+    // The geo files are loaded in the background, completions are filled in once they are ready.
+    const auto domainWatcher = new QFutureWatcher<QStringList>(this);
+    connect(domainWatcher, &QFutureWatcher<QStringList>::finished, this, [this, domainWatcher] {
+        const auto sourceStringsDomain = domainWatcher->result();
+        directDomainTxt->SetSourceStrings(sourceStringsDomain);
+        proxyDomainTxt->SetSourceStrings(sourceStringsDomain);
+        blockDomainTxt->SetSourceStrings(sourceStringsDomain);
+        domainWatcher->deleteLater();
+    });
+    domainWatcher->setFuture(GeositeReader::ReadGeoSiteFromFileAsync(GlobalConfig->behaviorConfig->GeoSitePath));
+
+    const auto ipWatcher = new QFutureWatcher<QStringList>(this);
+    connect(ipWatcher, &QFutureWatcher<QStringList>::finished, this, [this, ipWatcher] {
+        const auto sourceStringsIP = ipWatcher->result();
+        directIPTxt->SetSourceStrings(sourceStringsIP);
+        proxyIPTxt->SetSourceStrings(sourceStringsIP);
+        blockIPTxt->SetSourceStrings(sourceStringsIP);
+        ipWatcher->deleteLater();
+    });
+    ipWatcher->setFuture(GeositeReader::ReadGeoSiteFromFileAsync(GlobalConfig->behaviorConfig->GeoIPPath));
 
     directTxtLayout->addWidget(directDomainTxt, 0, 0);
     proxyTxtLayout->addWidget(proxyDomainTxt, 0, 0);
@@ -1,10 +1,12 @@
 #include "w_GroupManager.hpp"
 
+#include "KeywordFilter/KeywordFilter.hpp"
 #include "Qv2rayBase/Common/ProfileHelpers.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Plugin/PluginAPIHost.hpp"
 #include "Qv2rayBase/Plugin/PluginManagerCore.hpp"
 #include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "SubscriptionUpdater/SubscriptionUpdater.hpp"
 #include "ui/widgets/editors/DnsSettingsWidget.hpp"
 #include "ui/widgets/editors/RouteSettingsMatrix.hpp"
 
@@ -61,9 +63,39 @@ GroupManager::GroupManager(QWidget *parent) : QvDialog("GroupManager", parent)
     connectionListRCMenu->addMenu(connectionListRCMenu_MoveToMenu);
     connectionListRCMenu->addMenu(connectionListRCMenu_LinkToMenu);
 
+    filterPreviewTimer.setSingleShot(true);
+    filterPreviewTimer.setInterval(150);
+    connect(&filterPreviewTimer, &QTimer::timeout, this, &GroupManager::updateFilterPreview);
+
     connect(exportConnectionAction, &QAction::triggered, this, &GroupManager::onRCMExportConnectionTriggered);
     connect(deleteConnectionAction, &QAction::triggered, this, &GroupManager::onRCMDeleteConnectionTriggered);
-    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnConnectionLinkedWithGroup, [this] { reloadConnectionsList(currentGroupId); });
+    connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnConnectionLinkedWithGroup,
+            [this]
+            {
+                if (!SubscriptionUpdater->IsUpdating(currentGroupId))
+                    reloadConnectionsList(currentGroupId);
+            });
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnGroupUpdateFinished, this,
+            [this](const GroupId &id)
+            {
+                if (id == currentGroupId)
+                    on_groupList_itemClicked(groupList->currentItem());
+            });
+    // Scheduled updates of other groups may finish while this one is being updated.
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnSubscriptionUpdated, this,
+            [this](const GroupId &id)
+            {
+                if (id == currentGroupId)
+                    setEnabled(true);
+            });
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnSubscriptionUpdateFailed, this,
+            [this](const GroupId &id, const QString &error)
+            {
+                if (id != currentGroupId)
+                    return;
+                setEnabled(true);
+                QvBaselib->Warn(tr("Update Subscription"), error);
+            });
     connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnGroupCreated, this, &GroupManager::reloadGroupRCMActions);
     connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnGroupDeleted, this, &GroupManager::reloadGroupRCMActions);
     connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnGroupRenamed, this, &GroupManager::reloadGroupRCMActions);
@@ -181,13 +213,15 @@ void GroupManager::reloadConnectionsList(const GroupId &group)
         return;
     connectionsTable->clearContents();
     connectionsTable->model()->removeRows(0, connectionsTable->rowCount());
+    filterPreviewNames.clear();
     const auto &connections = QvBaselib->ProfileManager()->GetConnections(group);
     for (auto i = 0; i < connections.count(); i++)
     {
         const auto &conn = connections.at(i);
         connectionsTable->insertRow(i);
         //
-        auto displayNameItem = new QTableWidgetItem(GetDisplayName(conn));
+        filterPreviewNames << GetDisplayName(conn);
+        auto displayNameItem = new QTableWidgetItem(filterPreviewNames.last());
         displayNameItem->setData(Qt::UserRole, conn.toString());
         auto typeItem = new QTableWidgetItem(GetConnectionProtocolDescription(conn));
         //
@@ -206,6 +240,25 @@ void GroupManager::reloadConnectionsList(const GroupId &group)
         connectionsTable->setItem(i, 3, groupsItem);
     }
     connectionsTable->resizeColumnsToContents();
+    filterPreviewTimer.start();
+}
+
+void GroupManager::updateFilterPreview()
+{
+    if (currentGroupId.isNull())
+        return;
+    const KeywordFilter filter{ QvBaselib->ProfileManager()->GetGroupObject(currentGroupId).subscription_config };
+    const auto countMatched = [&filter](const QStringList &names) { return std::count_if(names.cbegin(), names.cend(), [&filter](const QString &name) { return filter.Accepts(name); }); };
+
+    // The connections of the group were already filtered by the last update, the links filtered out are only known
+    // to the updater, and only if the group was updated since the application started.
+    const auto decodedNames = SubscriptionUpdater->LastDecodedNames(currentGroupId);
+    if (!decodedNames.isEmpty())
+        filterPreviewLabel->setText(tr("%1 of the %2 link(s) in the last update match the filters.").arg(countMatched(decodedNames)).arg(decodedNames.size()));
+    else
+        filterPreviewLabel->setText(tr("%1 of the %2 connection(s) currently in this group match the filters, update the subscription to preview all of its links.")
+                                        .arg(countMatched(filterPreviewNames))
+                                        .arg(filterPreviewNames.size()));
 }
 
 void GroupManager::onRCMActionTriggered_Copy()
@@ -293,10 +346,7 @@ void GroupManager::on_updateButton_clicked()
     if (QvBaselib->Ask(tr("Update Subscription"), tr("Would you like to update the subscription?")) == Qv2rayBase::MessageOpt::Yes)
     {
         this->setEnabled(false);
-        qApp->processEvents();
-        QvBaselib->ProfileManager()->UpdateSubscription(currentGroupId);
-        this->setEnabled(true);
-        on_groupList_itemClicked(groupList->currentItem());
+        SubscriptionUpdater->UpdateSubscription(currentGroupId);
     }
 }
 
@@ -419,6 +469,7 @@ void GroupManager::on_IncludeRelation_currentTextChanged(const QString &)
     auto subscription = QvBaselib->ProfileManager()->GetGroupObject(currentGroupId).subscription_config;
     subscription.includeRelation = (SubscriptionConfigObject::SubscriptionFilterRelation) IncludeRelation->currentIndex();
     QvBaselib->ProfileManager()->SetSubscriptionData(currentGroupId, subscription);
+    filterPreviewTimer.start();
 }
 
 void GroupManager::on_ExcludeRelation_currentTextChanged(const QString &)
@@ -426,6 +477,7 @@ void GroupManager::on_ExcludeRelation_currentTextChanged(const QString &)
     auto subscription = QvBaselib->ProfileManager()->GetGroupObject(currentGroupId).subscription_config;
     subscription.excludeRelation = (SubscriptionConfigObject::SubscriptionFilterRelation) ExcludeRelation->currentIndex();
     QvBaselib->ProfileManager()->SetSubscriptionData(currentGroupId, subscription);
+    filterPreviewTimer.start();
 }
 
 void GroupManager::on_IncludeKeywords_textChanged()
@@ -434,6 +486,7 @@ void GroupManager::on_IncludeKeywords_textChanged()
     auto subscription = QvBaselib->ProfileManager()->GetGroupObject(currentGroupId).subscription_config;
     subscription.includeKeywords = keywords;
     QvBaselib->ProfileManager()->SetSubscriptionData(currentGroupId, subscription);
+    filterPreviewTimer.start();
 }
 
 void GroupManager::on_ExcludeKeywords_textChanged()
@@ -442,6 +495,7 @@ void GroupManager::on_ExcludeKeywords_textChanged()
     auto subscription = QvBaselib->ProfileManager()->GetGroupObject(currentGroupId).subscription_config;
     subscription.excludeKeywords = keywords;
     QvBaselib->ProfileManager()->SetSubscriptionData(currentGroupId, subscription);
+    filterPreviewTimer.start();
 }
 
 void GroupManager::on_groupList_currentItemChanged(QListWidgetItem *current, QListWidgetItem *priv)
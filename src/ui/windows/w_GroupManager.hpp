@@ -6,6 +6,7 @@
 #include "ui_w_GroupManager.h"
 
 #include <QMenu>
+#include <QTimer>
 
 class DnsSettingsWidget;
 class RouteSettingsMatrixWidget;
@@ -63,6 +64,7 @@ class GroupManager
   private:
     virtual void updateColorScheme() override;
     void reloadConnectionsList(const GroupId &group);
+    void updateFilterPreview();
     void onRCMActionTriggered_Move();
     void onRCMActionTriggered_Copy();
     void onRCMActionTriggered_Link();
@@ -79,6 +81,9 @@ class GroupManager
     QMenu *connectionListRCMenu_CopyToMenu = new QMenu(tr("Copy to..."));
     QMenu *connectionListRCMenu_MoveToMenu = new QMenu(tr("Move to..."));
     QMenu *connectionListRCMenu_LinkToMenu = new QMenu(tr("Link to..."));
+    // Restarted on each change of the filters, so that the preview is only computed once typing pauses.
+    QTimer filterPreviewTimer;
+    QStringList filterPreviewNames;
     bool isUpdateInProgress = false;
     GroupId currentGroupId;
     ConnectionId currentConnectionId;
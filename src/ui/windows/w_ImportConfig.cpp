@@ -2,7 +2,6 @@
 
 #include "Qv2rayBase/Common/ProfileHelpers.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
-#include "Qv2rayBase/Plugin/PluginAPIHost.hpp"
 #include "Qv2rayBase/Profile/ProfileManager.hpp"
 #include "ui/windows/editors/w_JsonEditor.hpp"
 
@@ -27,6 +26,20 @@ ImportConfigWindow::ImportConfigWindow(QWidget *parent) : QvDialog("ImportWindow
     groupCombo->setCurrentIndex(defaultItemIndex);
     qrCodeTab->setVisible(false);
     tabWidget->removeTab(1);
+    importProgressBar->setVisible(false);
+
+    deserializer = new BatchLinkDeserializer(this);
+    connect(deserializer, &BatchLinkDeserializer::OnLinksDeserialized, this, &ImportConfigWindow::onLinksDeserialized);
+    connect(deserializer, &BatchLinkDeserializer::OnProgress, importProgressBar, &QProgressBar::setValue);
+    connect(deserializer, &BatchLinkDeserializer::OnFinished, this,
+            [this](bool cancelled)
+            {
+                importProgressBar->setVisible(false);
+                beginImportBtn->setEnabled(true);
+                linkTxt->setReadOnly(false);
+                if (!cancelled)
+                    accept();
+            });
 }
 
 void ImportConfigWindow::processCommands(QString command, QStringList commands, QMap<QString, QString> args)
@@ -73,38 +86,24 @@ void ImportConfigWindow::on_beginImportBtn_clicked()
     {
         case LINK_PAGE:
         {
-            auto linkList = SplitLines(linkTxt->toPlainText());
-            linkTxt->clear();
-            QvLog() << linkList.count() << "entries found.";
-
-            while (!linkList.isEmpty())
+            QStringList links;
+            for (const auto &line : SplitLines(linkTxt->toPlainText()))
             {
-                const auto link = linkList.takeFirst().trimmed();
-                if (link.isEmpty() || link.startsWith("#") || link.startsWith("//"))
-                    continue;
-
-                QString errMessage;
-
-                const auto optConf = QvBaselib->PluginAPIHost()->Outbound_Deserialize(link);
-
-                if (!optConf)
-                {
-                    linkTxt->appendPlainText(link + NEWLINE);
-                    continue;
-                }
-
-                auto name = aliasPrefix + optConf->first;
-                const auto outbound = optConf->second;
-
-                if (name.isEmpty())
-                {
-                    auto [protocol, host, port] = GetOutboundInfo(outbound);
-                    name = protocol + "/" + host + ":" + port + "-" + GenerateRandomString(5);
-                }
-
-                connections.insert(name, ProfileContent{ outbound });
+                const auto link = line.trimmed();
+                if (!link.isEmpty() && !link.startsWith("#") && !link.startsWith("//"))
+                    links << link;
             }
-            break;
+            QvLog() << links.count() << "entries found.";
+
+            // Links that cannot be deserialized are put back, the dialog is accepted once all of them are processed.
+            linkTxt->clear();
+            linkTxt->setReadOnly(true);
+            beginImportBtn->setEnabled(false);
+            importProgressBar->setRange(0, links.count());
+            importProgressBar->setValue(0);
+            importProgressBar->setVisible(true);
+            deserializer->Start(links);
+            return;
         }
         case MANUAL_PAGE:
         {
@@ -118,8 +117,34 @@ void ImportConfigWindow::on_beginImportBtn_clicked()
     accept();
 }
 
+void ImportConfigWindow::onLinksDeserialized(const QList<DeserializedLink> &results)
+{
+    const auto aliasPrefix = nameTxt->text();
+    for (const auto &result : results)
+    {
+        if (!result.outbound)
+        {
+            QvLog() << "Failed to import link" << result.index << ":" << result.error;
+            linkTxt->appendPlainText(result.link + NEWLINE);
+            continue;
+        }
+
+        auto name = aliasPrefix + result.outbound->first;
+        const auto outbound = result.outbound->second;
+
+        if (name.isEmpty())
+        {
+            auto [protocol, host, port] = GetOutboundInfo(outbound);
+            name = protocol + "/" + host + ":" + port + "-" + GenerateRandomString(5);
+        }
+
+        connections.insert(name, ProfileContent{ outbound });
+    }
+}
+
 void ImportConfigWindow::on_cancelImportBtn_clicked()
 {
+    deserializer->Cancel();
     reject();
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "LinkDeserializer/LinkDeserializer.hpp"
 #include "ui/WidgetUIBase.hpp"
 #include "ui_w_ImportConfig.h"
 
@@ -22,10 +23,13 @@ class ImportConfigWindow
     void on_beginImportBtn_clicked();
     void on_cancelImportBtn_clicked();
     void on_jsonEditBtn_clicked();
+    void onLinksDeserialized(const QList<DeserializedLink> &results);
 
   private:
     void updateColorScheme() override{};
 
+    BatchLinkDeserializer *deserializer;
+
     // Use hash here since the order is not important.
     GroupId selectedGroup = DefaultGroupId;
     QMultiMap<QString, ProfileContent> connections;
@@ -1,13 +1,18 @@
 #include "w_MainWindow.hpp"
 
+#include "AutoFailover/AutoFailover.hpp"
 #include "GuiPluginHost/GuiPluginHost.hpp"
 #include "Qv2rayApplication.hpp"
 #include "Qv2rayBase/Common/ProfileHelpers.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Profile/KernelManager.hpp"
 #include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "LatencyScheduler/LatencyScheduler.hpp"
+#include "SubscriptionUpdater/SubscriptionUpdater.hpp"
+#include "UpdateScheduler/UpdateScheduler.hpp"
 #include "ui/WidgetUIBase.hpp"
 #include "ui/widgets/ConnectionInfoWidget.hpp"
+#include "ui/widgets/LogItemDelegate.hpp"
 #include "ui/windows/editors/w_JsonEditor.hpp"
 #include "ui/windows/editors/w_OutboundEditor.hpp"
 #include "ui/windows/editors/w_RoutesEditor.hpp"
@@ -18,18 +23,19 @@
 #include "ui/windows/w_PreferencesWindow.hpp"
 
 #include <QClipboard>
+#include <QHeaderView>
 #include <QInputDialog>
 #include <QScrollBar>
 
 #define QV_MODULE_NAME "MainWindow"
 
-#define CheckCurrentWidget                                                                                                                                               \
-    auto widget = GetIndexWidget(connectionTreeView->currentIndex());                                                                                                    \
-    if (widget == nullptr)                                                                                                                                               \
+#define CheckCurrentIdentifier                                                                                                                                           \
+    const auto identifier = GetIndexIdentifier(connectionTreeView->currentIndex());                                                                                      \
+    if (identifier.groupId.isNull())                                                                                                                                     \
         return;
 
-#define GetIndexWidget(item) (qobject_cast<ConnectionItemWidget *>(connectionTreeView->indexWidget(item)))
-#define NumericString(i) (QString("%1").arg(i, 30, 10, QLatin1Char('0')))
+#define GetIndexIdentifier(item) (modelHelper->GetIdentifier(item))
+#define IsConnectionIdentifier(id) (!(id).connectionId.isNull())
 
 constexpr auto BUTTON_PROP_PLUGIN_MAINWIDGETITEM_INDEX = "plugin_list_index";
 
@@ -96,8 +102,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     infoWidget = new ConnectionInfoWidget(this);
     connectionInfoLayout->addWidget(infoWidget);
 
-    masterLogBrowser->setDocument(vCoreLogDocument);
-    vCoreLogHighlighter = new LogHighlighter::LogHighlighter(masterLogBrowser->document());
+    vCoreLogModel = new LogListModel(GlobalConfig->appearanceConfig->MaximizeLogLines, this);
+    qvLogModel = new LogListModel(GlobalConfig->appearanceConfig->MaximizeLogLines, this);
+    masterLogBrowser->setItemDelegate(new LogItemDelegate(&vCoreLogHighlighter, masterLogBrowser));
+    masterLogBrowser->header()->setStretchLastSection(false);
+    SetLogModel(vCoreLogModel);
 
     // For charts
     speedChartWidget = new SpeedWidget(this);
@@ -122,12 +131,27 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     connect(QvBaselib->KernelManager(), &Qv2rayBase::Profile::KernelManager::OnConnected, this, &MainWindow::OnConnected);
     connect(QvBaselib->KernelManager(), &Qv2rayBase::Profile::KernelManager::OnDisconnected, this, &MainWindow::OnDisconnected);
     connect(QvBaselib->KernelManager(), &Qv2rayBase::Profile::KernelManager::OnStatsDataAvailable, this, &MainWindow::OnStatsAvailable);
+    statsLabelsUpdate = UpdateScheduler->AddUpdate(this, [this]() { UpdateStatsLabels(); });
+    // The tray icon is the only thing left to see while the window is hidden.
+    trayToolTipUpdate = UpdateScheduler->AddUpdate(this, [this]() { UpdateTrayToolTip(); }, true);
     connect(QvBaselib->KernelManager(), &Qv2rayBase::Profile::KernelManager::OnKernelLogAvailable, this, &MainWindow::OnKernelLogAvailable);
     connect(QvBaselib->ProfileManager(), &Qv2rayBase::Profile::ProfileManager::OnSubscriptionAsyncUpdateFinished,
             [](const GroupId &gid)
             {
                 QvApp->ShowTrayMessage(tr("Subscription \"%1\" has been updated").arg(GetDisplayName(gid))); //
             });
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnGroupUpdateStarted, modelHelper, &ConnectionListHelper::BeginGroupUpdate);
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnGroupUpdateFinished, modelHelper, &ConnectionListHelper::EndGroupUpdate);
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnSubscriptionUpdated,
+            [](const GroupId &gid)
+            {
+                QvApp->ShowTrayMessage(tr("Subscription \"%1\" has been updated").arg(GetDisplayName(gid))); //
+            });
+    connect(SubscriptionUpdater, &QvSubscriptionUpdater::QvSubscriptionUpdater::OnSubscriptionUpdateFailed,
+            [](const GroupId &gid, const QString &error)
+            {
+                QvApp->ShowTrayMessage(tr("Failed to update subscription \"%1\": %2").arg(GetDisplayName(gid), error)); //
+            });
 
     connect(infoWidget, &ConnectionInfoWidget::OnEditRequested, this, &MainWindow::OnEditRequested);
     connect(infoWidget, &ConnectionInfoWidget::OnJsonEditRequested, this, &MainWindow::OnEditJsonRequested);
@@ -189,11 +213,20 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     logRCM_Menu->addSeparator();
     logRCM_Menu->addAction(action_RCM_SwitchCoreLog);
     logRCM_Menu->addAction(action_RCM_SwitchQv2rayLog);
-    connect(masterLogBrowser, &QTextBrowser::customContextMenuRequested, [this](const QPoint &) { logRCM_Menu->popup(QCursor::pos()); });
-    connect(action_RCM_SwitchCoreLog, &QAction::triggered, [this] { masterLogBrowser->setDocument(vCoreLogDocument); });
-    connect(action_RCM_SwitchQv2rayLog, &QAction::triggered, [this] { masterLogBrowser->setDocument(qvLogDocument); });
+    connect(masterLogBrowser, &QTreeView::customContextMenuRequested, [this](const QPoint &) { logRCM_Menu->popup(QCursor::pos()); });
+    connect(action_RCM_SwitchCoreLog, &QAction::triggered, [this] { SetLogModel(vCoreLogModel); });
+    connect(action_RCM_SwitchQv2rayLog, &QAction::triggered, [this] { SetLogModel(qvLogModel); });
     connect(action_RCM_CopyRecentLogs, &QAction::triggered, this, &MainWindow::Action_CopyRecentLogs);
-    connect(action_RCM_CopySelected, &QAction::triggered, masterLogBrowser, &QTextBrowser::copy);
+    connect(action_RCM_CopySelected, &QAction::triggered, this,
+            [this]()
+            {
+                auto rows = masterLogBrowser->selectionModel()->selectedRows();
+                std::sort(rows.begin(), rows.end());
+                QStringList lines;
+                for (const auto &row : rows)
+                    lines << row.data().toString();
+                qApp->clipboard()->setText(lines.join(NEWLINE));
+            });
     //
     speedChartWidget->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(speedChartWidget, &QWidget::customContextMenuRequested, [this](const QPoint &) { graphWidgetMenu->popup(QCursor::pos()); });
@@ -203,8 +236,6 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
         auto font = masterLogBrowser->font();
         font.setPointSize(9);
         masterLogBrowser->setFont(font);
-        qvLogDocument->setDefaultFont(font);
-        vCoreLogDocument->setDefaultFont(font);
     }
     //
     // Globally invokable signals.
@@ -223,6 +254,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     connectionListRCM_Menu->addSeparator();
 
     connectionListRCM_Menu->addAction(action_RCM_TestLatency);
+    connectionListRCM_Menu->addAction(action_RCM_CancelLatencyTests);
 
     connectionListRCM_Menu->addSeparator();
     connectionListRCM_Menu->addAction(action_RCM_SetAutoConnection);
@@ -242,6 +274,14 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     connect(action_RCM_EditJson, &QAction::triggered, this, &MainWindow::Action_EditJson);
     connect(action_RCM_EditComplex, &QAction::triggered, this, &MainWindow::Action_EditComplex);
     connect(action_RCM_TestLatency, &QAction::triggered, this, &MainWindow::Action_TestLatency);
+    connect(action_RCM_CancelLatencyTests, &QAction::triggered, this, &MainWindow::Action_CancelLatencyTests);
+    // Tests of the rows scrolled to run before the others.
+    connect(connectionTreeView->verticalScrollBar(), &QScrollBar::valueChanged, this,
+            [this]()
+            {
+                if (LatencyScheduler->QueuedCount() > 0)
+                    LatencyScheduler->Prioritize(modelHelper->GetVisibleConnections());
+            });
     connect(action_RCM_RenameConnection, &QAction::triggered, this, &MainWindow::Action_RenameConnection);
     connect(action_RCM_DuplicateConnection, &QAction::triggered, this, &MainWindow::Action_DuplicateConnection);
     connect(action_RCM_ResetStats, &QAction::triggered, this, &MainWindow::Action_ResetStats);
@@ -367,7 +407,7 @@ void MainWindow::timerEvent(QTimerEvent *event)
         //        auto log = ReadLog().trimmed();
         //        if (!log.isEmpty())
         //        {
-        //            FastAppendTextDocument(NEWLINE + log, qvLogDocument);
+        //            qvLogModel->Append(log);
         //        }
     }
 }
@@ -376,13 +416,13 @@ void MainWindow::keyPressEvent(QKeyEvent *e)
 {
     if (focusWidget() == connectionTreeView)
     {
-        CheckCurrentWidget;
+        CheckCurrentIdentifier;
         if (e->key() == Qt::Key_Enter || e->key() == Qt::Key_Return)
         {
             // If pressed enter or return on connectionListWidget. Try to connect to the selected connection.
-            if (widget->IsConnection())
+            if (IsConnectionIdentifier(identifier))
             {
-                widget->BeginConnection();
+                QvBaselib->ProfileManager()->StartConnection(identifier);
             }
             else
             {
@@ -391,7 +431,7 @@ void MainWindow::keyPressEvent(QKeyEvent *e)
         }
         else if (e->key() == Qt::Key_F2)
         {
-            widget->BeginRename();
+            Action_RenameConnection();
         }
         else if (e->key() == Qt::Key_Delete)
         {
@@ -401,11 +441,9 @@ void MainWindow::keyPressEvent(QKeyEvent *e)
 
     if (e->key() == Qt::Key_Escape)
     {
-        auto widget = GetIndexWidget(connectionTreeView->currentIndex());
-        // Check if this key was accpted by the ConnectionItemWidget
-        if (widget && widget->IsRenaming())
+        // The rename editor closes itself on Escape.
+        if (connectionTreeView->state() == QAbstractItemView::EditingState)
         {
-            widget->CancelRename();
             return;
         }
         else if (this->isActiveWindow())
@@ -434,7 +472,7 @@ void MainWindow::keyReleaseEvent(QKeyEvent *e)
     {
         if (focusWidget() == connectionTreeView)
         {
-            CheckCurrentWidget;
+            CheckCurrentIdentifier;
             on_connectionTreeView_clicked(connectionTreeView->currentIndex());
         }
     }
@@ -448,14 +486,27 @@ void MainWindow::changeEvent(QEvent *e)
             tray_action_ToggleVisibility->setText(tr("Show"));
         else
             tray_action_ToggleVisibility->setText(tr("Hide"));
+        UpdateScheduler->SetSuspended(isHidden() || isMinimized());
     }
 }
 
+void MainWindow::showEvent(QShowEvent *e)
+{
+    QMainWindow::showEvent(e);
+    UpdateScheduler->SetSuspended(isMinimized());
+}
+
+void MainWindow::hideEvent(QHideEvent *e)
+{
+    QMainWindow::hideEvent(e);
+    UpdateScheduler->SetSuspended(true);
+}
+
 void MainWindow::Action_Start()
 {
-    CheckCurrentWidget;
-    if (widget->IsConnection())
-        widget->BeginConnection();
+    CheckCurrentIdentifier;
+    if (IsConnectionIdentifier(identifier))
+        QvBaselib->ProfileManager()->StartConnection(identifier);
 }
 
 MainWindow::~MainWindow()
@@ -490,7 +541,7 @@ void MainWindow::Action_Exit()
 
 void MainWindow::on_clearlogButton_clicked()
 {
-    masterLogBrowser->document()->clear();
+    static_cast<LogListModel *>(masterLogBrowser->model())->Clear();
 }
 void MainWindow::on_connectionTreeView_customContextMenuRequested(const QPoint &pos)
 {
@@ -500,7 +551,7 @@ void MainWindow::on_connectionTreeView_customContextMenuRequested(const QPoint &
     const auto item = connectionTreeView->indexAt(connectionTreeView->mapFromGlobal(_pos));
     if (item.isValid())
     {
-        bool isConnection = GetIndexWidget(item)->IsConnection();
+        bool isConnection = IsConnectionIdentifier(GetIndexIdentifier(item));
         // Disable connection-specific settings.
         action_RCM_Start->setEnabled(isConnection);
         action_RCM_SetAutoConnection->setEnabled(isConnection);
@@ -510,6 +561,7 @@ void MainWindow::on_connectionTreeView_customContextMenuRequested(const QPoint &
         action_RCM_RenameConnection->setEnabled(isConnection);
         action_RCM_DuplicateConnection->setEnabled(isConnection);
         action_RCM_UpdateSubscription->setEnabled(!isConnection);
+        action_RCM_CancelLatencyTests->setEnabled(LatencyScheduler->QueuedCount() > 0 || LatencyScheduler->OverdueCount() > 0);
         connectionListRCM_Menu->popup(_pos);
     }
 }
@@ -521,12 +573,11 @@ void MainWindow::Action_DeleteConnections()
 
     for (const auto &item : connectionTreeView->selectionModel()->selectedIndexes())
     {
-        const auto widget = GetIndexWidget(item);
-        if (!widget)
+        const auto identifier = GetIndexIdentifier(item);
+        if (identifier.groupId.isNull())
             continue;
 
-        const auto identifier = widget->Identifier();
-        if (widget->IsConnection())
+        if (IsConnectionIdentifier(identifier))
         {
             // Simply add the connection id
             connlist.append(identifier);
@@ -564,10 +615,10 @@ void MainWindow::on_importConfigButton_clicked()
 
 void MainWindow::Action_EditComplex()
 {
-    CheckCurrentWidget;
-    if (widget->IsConnection())
+    CheckCurrentIdentifier;
+    if (IsConnectionIdentifier(identifier))
     {
-        const auto id = widget->Identifier();
+        const auto id = identifier;
         ProfileContent root = QvBaselib->ProfileManager()->GetConnection(id.connectionId);
         bool isChanged = false;
         //
@@ -597,6 +648,7 @@ void MainWindow::OnDisconnected(const ProfileId &id)
     tray_SystemProxyMenu->setEnabled(false);
     lastConnected = id;
     locateBtn->setEnabled(false);
+    AutoFailover->Stop();
     if (!GlobalConfig->behaviorConfig->QuietMode)
     {
         QvApp->ShowTrayMessage(tr("Disconnected from: ") + GetDisplayName(id.connectionId));
@@ -634,6 +686,10 @@ void MainWindow::OnConnected(const ProfileId &id)
     GlobalConfig->appearanceConfig->RecentConnections->removeAll(id);
     GlobalConfig->appearanceConfig->RecentConnections->push_front(id);
     ReloadRecentConnectionList();
+    // Connecting to another group by hand leaves the fastest connection mode until the next start.
+    if (GlobalConfig->behaviorConfig->AutoConnectBehavior == Qv2rayBehaviorConfig::AUTOCONNECT_FASTEST &&
+        GlobalConfig->behaviorConfig->AutoConnectProfileId->groupId == id.groupId)
+        AutoFailover->Start(id.groupId, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
 #pragma message("TODO Move To Command Plugin")
     //    if (GlobalConfig.inboundConfig->systemProxySettings->setSystemProxy)
     //    {
@@ -659,49 +715,65 @@ void MainWindow::OnStatsAvailable(const ProfileId &id, const StatisticsObject &d
     pointData[SpeedWidget::OUTBOUND_DIRECT_UP] = data.directUp;
     pointData[SpeedWidget::OUTBOUND_DIRECT_DOWN] = data.directDown;
 
+    // The chart keeps every point, it only repaints when visible anyway.
     speedChartWidget->AddPointData(pointData);
-    auto totalSpeedUp = FormatBytes(data.proxyUp) + "/s";
-    auto totalSpeedDown = FormatBytes(data.proxyDown) + "/s";
 
-    const auto &[totalUp, totalDown] = GetConnectionUsageAmount(id.connectionId, StatisticsObject::PROXY);
-    auto totalDataUp = FormatBytes(totalUp);
-    auto totalDataDown = FormatBytes(totalDown);
-    //
-    netspeedLabel->setText(totalSpeedUp + NEWLINE + totalSpeedDown);
-    dataamountLabel->setText(totalDataUp + NEWLINE + totalDataDown);
-    //
+    latestStatsId = id;
+    latestStats = data;
+    UpdateScheduler->MarkDirty(statsLabelsUpdate);
+    UpdateScheduler->MarkDirty(trayToolTipUpdate);
+}
+
+void MainWindow::UpdateStatsLabels()
+{
+    // The connection may have been stopped since, which already reset the labels.
+    if (!QvBaselib->ProfileManager()->IsConnected(latestStatsId))
+        return;
+
+    const auto &[totalUp, totalDown] = GetConnectionUsageAmount(latestStatsId.connectionId, StatisticsObject::PROXY);
+    netspeedLabel->setText(FormatBytes(latestStats.proxyUp) + "/s" + NEWLINE + FormatBytes(latestStats.proxyDown) + "/s");
+    dataamountLabel->setText(FormatBytes(totalUp) + NEWLINE + FormatBytes(totalDown));
+}
+
+void MainWindow::UpdateTrayToolTip()
+{
+    if (!QvBaselib->ProfileManager()->IsConnected(latestStatsId))
+        return;
+
     qvAppTrayIcon->setToolTip(QString("Qv2ray %1\n"
                                       "Connected: %2\n"
                                       "Up: %3 Down: %4")
                                   .arg(QV2RAY_VERSION_STRING)
-                                  .arg(GetDisplayName(id.connectionId))
-                                  .arg(totalSpeedUp)
-                                  .arg(totalSpeedDown));
+                                  .arg(GetDisplayName(latestStatsId.connectionId))
+                                  .arg(FormatBytes(latestStats.proxyUp) + "/s")
+                                  .arg(FormatBytes(latestStats.proxyDown) + "/s"));
 }
 
 void MainWindow::OnKernelLogAvailable(const ProfileId &id, const QString &log)
 {
     Q_UNUSED(id);
-    FastAppendTextDocument(log.trimmed(), vCoreLogDocument);
-
-    // From https://gist.github.com/jemyzhang/7130092
-    const auto maxLines = GlobalConfig->appearanceConfig->MaximizeLogLines;
-    auto block = vCoreLogDocument->begin();
+    vCoreLogModel->SetCapacity(GlobalConfig->appearanceConfig->MaximizeLogLines);
+    vCoreLogModel->Append(log.trimmed());
+}
 
-    while (block.isValid())
-    {
-        if (vCoreLogDocument->blockCount() > maxLines)
-        {
-            QTextCursor cursor(block);
-            block = block.next();
-            cursor.select(QTextCursor::BlockUnderCursor);
-            cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-            cursor.removeSelectedText();
-            continue;
-        }
+void MainWindow::SetLogModel(LogListModel *model)
+{
+    if (const auto previous = masterLogBrowser->model())
+        disconnect(previous, nullptr, this, nullptr);
+    masterLogBrowser->setModel(model);
+    connect(model, &LogListModel::rowsInserted, this, &MainWindow::OnLogRowsInserted);
+    // Lines aren't wrapped, the column is as wide as the longest one for the horizontal scroll bar to reach it.
+    const auto resizeColumn = [this](qsizetype length)
+    { masterLogBrowser->header()->resizeSection(0, int(length + 1) * masterLogBrowser->fontMetrics().horizontalAdvance(u'M')); };
+    connect(model, &LogListModel::OnLongestLineChanged, this, resizeColumn);
+    resizeColumn(model->LongestLine());
+    masterLogBrowser->scrollToBottom();
+}
 
-        break;
-    }
+void MainWindow::OnLogRowsInserted()
+{
+    if (qvLogAutoScoll)
+        masterLogBrowser->scrollToBottom();
 }
 
 void MainWindow::OnEditRequested(const ConnectionId &id)
@@ -763,8 +835,9 @@ void MainWindow::on_locateBtn_clicked()
 
 void MainWindow::Action_RenameConnection()
 {
-    CheckCurrentWidget;
-    widget->BeginRename();
+    CheckCurrentIdentifier;
+    if (IsConnectionIdentifier(identifier))
+        connectionTreeView->edit(connectionTreeView->currentIndex());
 }
 
 void MainWindow::Action_DuplicateConnection()
@@ -773,10 +846,10 @@ void MainWindow::Action_DuplicateConnection()
 
     for (const auto &item : connectionTreeView->selectionModel()->selectedIndexes())
     {
-        auto widget = GetIndexWidget(item);
-        if (widget->IsConnection())
+        const auto identifier = GetIndexIdentifier(item);
+        if (IsConnectionIdentifier(identifier))
         {
-            connlist.append(widget->Identifier());
+            connlist.append(identifier);
         }
     }
 
@@ -797,14 +870,14 @@ void MainWindow::Action_DuplicateConnection()
 
 void MainWindow::Action_Edit()
 {
-    CheckCurrentWidget;
-    OnEditRequested(widget->Identifier().connectionId);
+    CheckCurrentIdentifier;
+    OnEditRequested(identifier.connectionId);
 }
 
 void MainWindow::Action_EditJson()
 {
-    CheckCurrentWidget;
-    OnEditJsonRequested(widget->Identifier().connectionId);
+    CheckCurrentIdentifier;
+    OnEditJsonRequested(identifier.connectionId);
 }
 
 void MainWindow::on_chartVisibilityBtn_clicked()
@@ -822,21 +895,12 @@ void MainWindow::on_clearChartBtn_clicked()
     speedChartWidget->Clear();
 }
 
-void MainWindow::on_masterLogBrowser_textChanged()
-{
-    if (!qvLogAutoScoll)
-        return;
-    auto bar = masterLogBrowser->verticalScrollBar();
-    bar->setValue(bar->maximum());
-}
-
 void MainWindow::Action_SetAutoConnection()
 {
     const auto current = connectionTreeView->currentIndex();
     if (current.isValid())
     {
-        const auto widget = GetIndexWidget(current);
-        const auto identifier = widget->Identifier();
+        const auto identifier = GetIndexIdentifier(current);
         GlobalConfig->behaviorConfig->AutoConnectProfileId = identifier;
         GlobalConfig->behaviorConfig->AutoConnectBehavior = Qv2rayBehaviorConfig::AUTOCONNECT_FIXED;
         if (!GlobalConfig->behaviorConfig->QuietMode)
@@ -852,50 +916,58 @@ void MainWindow::Action_ResetStats()
     auto current = connectionTreeView->currentIndex();
     if (current.isValid())
     {
-        auto widget = GetIndexWidget(current);
-        if (widget)
+        const auto identifier = GetIndexIdentifier(current);
+        if (!identifier.groupId.isNull())
         {
-            if (widget->IsConnection())
-                QvBaselib->ProfileManager()->ClearConnectionUsage(widget->Identifier());
+            if (IsConnectionIdentifier(identifier))
+                QvBaselib->ProfileManager()->ClearConnectionUsage(identifier);
             else
-                QvBaselib->ProfileManager()->ClearGroupUsage(widget->Identifier().groupId);
+                QvBaselib->ProfileManager()->ClearGroupUsage(identifier.groupId);
         }
     }
 }
 
 void MainWindow::Action_UpdateSubscription()
 {
-    auto current = connectionTreeView->currentIndex();
-    if (current.isValid())
+    // The updater queues the groups, at most a few of them are fetched at the same time.
+    for (const auto &current : connectionTreeView->selectionModel()->selectedIndexes())
     {
-        auto widget = GetIndexWidget(current);
-        if (widget)
-        {
-            if (widget->IsConnection())
-                return;
-            const auto gid = widget->Identifier().groupId;
-            if (QvBaselib->ProfileManager()->GetGroupObject(gid).subscription_config.isSubscription)
-                QvBaselib->ProfileManager()->UpdateSubscriptionAsync(gid);
-            else
-                QvBaselib->Info(tr("Update Subscription"), tr("Selected group is not a subscription"));
-        }
+        if (!current.isValid())
+            continue;
+        const auto identifier = GetIndexIdentifier(current);
+        if (identifier.groupId.isNull() || IsConnectionIdentifier(identifier))
+            continue;
+        const auto gid = identifier.groupId;
+        if (QvBaselib->ProfileManager()->GetGroupObject(gid).subscription_config.isSubscription)
+            SubscriptionUpdater->UpdateSubscription(gid);
+        else
+            QvBaselib->Info(tr("Update Subscription"), tr("Selected group is not a subscription"));
     }
 }
 
 void MainWindow::Action_TestLatency()
 {
+    const auto engine = GlobalConfig->behaviorConfig->DefaultLatencyTestEngine;
+    QList<ConnectionId> connections;
     for (const auto &current : connectionTreeView->selectionModel()->selectedIndexes())
     {
         if (!current.isValid())
             continue;
-        const auto widget = GetIndexWidget(current);
-        if (!widget)
+        const auto identifier = GetIndexIdentifier(current);
+        if (identifier.groupId.isNull())
             continue;
-        if (widget->IsConnection())
-            QvBaselib->ProfileManager()->StartLatencyTest(widget->Identifier().connectionId, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
+        if (IsConnectionIdentifier(identifier))
+            connections << identifier.connectionId;
         else
-            QvBaselib->ProfileManager()->StartLatencyTest(widget->Identifier().groupId, GlobalConfig->behaviorConfig->DefaultLatencyTestEngine);
+            connections << QvBaselib->ProfileManager()->GetConnections(identifier.groupId);
     }
+    LatencyScheduler->Enqueue(connections, engine);
+    LatencyScheduler->Prioritize(modelHelper->GetVisibleConnections());
+}
+
+void MainWindow::Action_CancelLatencyTests()
+{
+    LatencyScheduler->CancelQueued();
 }
 
 void MainWindow::Action_CopyGraphAsImage()
@@ -918,7 +990,7 @@ void MainWindow::on_newConnectionBtn_clicked()
     {
         const auto alias = w.GetFriendlyName();
         const auto item = connectionTreeView->currentIndex();
-        const auto id = item.isValid() ? GetIndexWidget(item)->Identifier().groupId : DefaultGroupId;
+        const auto id = item.isValid() ? GetIndexIdentifier(item).groupId : DefaultGroupId;
         QvBaselib->ProfileManager()->CreateConnection(root, alias, id);
     }
 }
@@ -930,7 +1002,7 @@ void MainWindow::on_newComplexConnectionBtn_clicked()
     if (w.result() == QDialog::Accepted)
     {
         const auto item = connectionTreeView->currentIndex();
-        const auto id = item.isValid() ? GetIndexWidget(item)->Identifier().groupId : DefaultGroupId;
+        const auto id = item.isValid() ? GetIndexIdentifier(item).groupId : DefaultGroupId;
         QvBaselib->ProfileManager()->CreateConnection(root, QStringLiteral("New Connection"), id);
     }
 }
@@ -942,36 +1014,26 @@ void MainWindow::on_collapseGroupsBtn_clicked()
 
 void MainWindow::Action_CopyRecentLogs()
 {
-    const auto lines = SplitLines(masterLogBrowser->document()->toPlainText());
     bool accepted = false;
     const auto line = QInputDialog::getInt(this, tr("Copy latest logs"), tr("Number of lines of logs to copy"), 20, 0, 2500, 1, &accepted);
     if (!accepted)
         return;
-    const auto totalLinesCount = lines.count();
-    const auto linesToCopy = std::min((int) totalLinesCount, line);
-    QStringList result;
-    for (auto i = totalLinesCount - linesToCopy; i < totalLinesCount; i++)
-    {
-        result.append(lines[i]);
-    }
-    qApp->clipboard()->setText(result.join(NEWLINE));
+    qApp->clipboard()->setText(static_cast<LogListModel *>(masterLogBrowser->model())->Tail(line).join(NEWLINE));
 }
 
 void MainWindow::on_connectionTreeView_doubleClicked(const QModelIndex &index)
 {
-    const auto widget = GetIndexWidget(index);
-    if (widget == nullptr)
-        return;
-    if (widget->IsConnection())
-        widget->BeginConnection();
+    const auto identifier = GetIndexIdentifier(index);
+    if (IsConnectionIdentifier(identifier))
+        QvBaselib->ProfileManager()->StartConnection(identifier);
 }
 
 void MainWindow::on_connectionTreeView_clicked(const QModelIndex &index)
 {
-    const auto widget = GetIndexWidget(index);
-    if (widget == nullptr)
+    const auto identifier = GetIndexIdentifier(index);
+    if (identifier.groupId.isNull())
         return;
-    infoWidget->ShowDetails(widget->Identifier());
+    infoWidget->ShowDetails(identifier);
 }
 
 void MainWindow::on_preferencesBtn_clicked()
@@ -2,11 +2,11 @@
 #include "ConnectionModelHelper/ConnectionModelHelper.hpp"
 #include "QvPlugin/Gui/QvGUIPluginInterface.hpp"
 #include "LogHighlighter/LogHighlighter.hpp"
+#include "LogListModel/LogListModel.hpp"
 #include "MessageBus/MessageBus.hpp"
 #include "SpeedWidget/SpeedWidget.hpp"
 #include "ui/WidgetUIBase.hpp"
 #include "ui/widgets/ConnectionInfoWidget.hpp"
-#include "ui/widgets/ConnectionItemWidget.hpp"
 #include "ui_w_MainWindow.h"
 
 #include <QMainWindow>
@@ -49,7 +49,6 @@ class MainWindow
     void on_chartVisibilityBtn_clicked();
     void on_logVisibilityBtn_clicked();
     void on_clearChartBtn_clicked();
-    void on_masterLogBrowser_textChanged();
     //
     void on_pluginsBtn_clicked();
     void on_collapseGroupsBtn_clicked();
@@ -71,6 +70,7 @@ class MainWindow
     void Action_EditComplex();
     void Action_UpdateSubscription();
     void Action_TestLatency();
+    void Action_CancelLatencyTests();
     //    void Action_TestRealLatency();
     void Action_RenameConnection();
     void Action_DeleteConnections();
@@ -87,6 +87,8 @@ class MainWindow
     void OnDisconnected(const ProfileId &id);
     //
     void OnStatsAvailable(const ProfileId &id, const StatisticsObject &speed);
+    void UpdateStatsLabels();
+    void UpdateTrayToolTip();
     void OnKernelLogAvailable(const ProfileId &id, const QString &log);
     //
     void SortConnectionList(ConnectionInfoRole byCol, bool asending);
@@ -105,11 +107,18 @@ class MainWindow
     void keyReleaseEvent(QKeyEvent *e) override;
     void closeEvent(QCloseEvent *) override;
     void changeEvent(QEvent *e) override;
+    void showEvent(QShowEvent *e) override;
+    void hideEvent(QHideEvent *e) override;
 
   private:
     // Charts
     SpeedWidget *speedChartWidget;
-    LogHighlighter::LogHighlighter *vCoreLogHighlighter;
+    // Only the latest stats are shown, by the next flush of UpdateScheduler.
+    ProfileId latestStatsId;
+    StatisticsObject latestStats;
+    int statsLabelsUpdate;
+    int trayToolTipUpdate;
+    LogHighlighter::LogHighlighter vCoreLogHighlighter;
     ConnectionInfoWidget *infoWidget;
     //
     // Declare Actions
@@ -141,6 +150,7 @@ class MainWindow
     DECL_ACTION(connectionListRCM_Menu, action_RCM_RenameConnection);
     DECL_ACTION(connectionListRCM_Menu, action_RCM_DuplicateConnection);
     DECL_ACTION(connectionListRCM_Menu, action_RCM_TestLatency);
+    DECL_ACTION(connectionListRCM_Menu, action_RCM_CancelLatencyTests);
     DECL_ACTION(connectionListRCM_Menu, action_RCM_ResetStats);
     DECL_ACTION(connectionListRCM_Menu, action_RCM_DeleteConnection);
     DECL_ACTION(sortMenu, sortAction_SortByName_Asc);
@@ -156,8 +166,10 @@ class MainWindow
     DECL_ACTION(logRCM_Menu, action_RCM_CopyRecentLogs);
 #undef DECL_ACTION
 
-    QTextDocument *vCoreLogDocument = new QTextDocument(this);
-    QTextDocument *qvLogDocument = new QTextDocument(this);
+    LogListModel *vCoreLogModel;
+    LogListModel *qvLogModel;
+    void SetLogModel(LogListModel *model);
+    void OnLogRowsInserted();
     //
     int qvLogTimerId = -1;
     bool qvLogAutoScoll = true;
@@ -1,8 +1,10 @@
+#include "AutoFailover/AutoFailover.hpp"
 #include "ProxyConfigurator/ProxyConfigurator.hpp"
 #include "Qv2rayApplication.hpp"
 #include "Qv2rayBase/Common/Utils.hpp"
 #include "Qv2rayBase/Profile/KernelManager.hpp"
 #include "Qv2rayBase/Profile/ProfileManager.hpp"
+#include "SubscriptionUpdater/SubscriptionUpdater.hpp"
 #include "ui/WidgetUIBase.hpp"
 #include "w_MainWindow.hpp"
 
@@ -119,6 +121,17 @@ bool MainWindow::StartAutoConnectionEntry()
         case Qv2rayBehaviorConfig::AUTOCONNECT_NONE: return false;
         case Qv2rayBehaviorConfig::AUTOCONNECT_FIXED: return QvBaselib->ProfileManager()->StartConnection(GlobalConfig->behaviorConfig->AutoConnectProfileId);
         case Qv2rayBehaviorConfig::AUTOCONNECT_LAST_CONNECTED: return QvBaselib->ProfileManager()->StartConnection(GlobalConfig->behaviorConfig->LastConnectedId);
+        case Qv2rayBehaviorConfig::AUTOCONNECT_FASTEST:
+        {
+            // Without any history yet, the last connection is as good a start as any, AutoFailover moves on once the
+            // tests of the group have finished.
+            const auto group = GlobalConfig->behaviorConfig->AutoConnectProfileId->groupId;
+            const auto &lastConnected = GlobalConfig->behaviorConfig->LastConnectedId;
+            const auto connection = AutoFailover->PickConnection(group, lastConnected->groupId == group ? lastConnected->connectionId : ConnectionId{});
+            if (connection.isNull())
+                return false;
+            return QvBaselib->ProfileManager()->StartConnection({ connection, group });
+        }
     }
     Q_UNREACHABLE();
 }
@@ -128,22 +141,12 @@ void MainWindow::CheckSubscriptionsUpdate()
     QList<std::pair<QString, GroupId>> updateList;
     QStringList updateNamesList;
 
-    for (const auto &entry : QvBaselib->ProfileManager()->GetGroups())
+    for (const auto &entry : SubscriptionUpdater->DueSubscriptions())
     {
         const auto info = QvBaselib->ProfileManager()->GetGroupObject(entry);
-        if (!info.subscription_config.isSubscription)
-            continue;
-        //
-        // The update is ignored.
-        if (info.subscription_config.updateInterval == 0.0f)
-            continue;
-
-        if (info.updated + 24h <= system_clock::now())
-        {
-            updateList << std::pair{ info.name, entry };
-            updateNamesList << info.name;
-            QvLog() << QString("Subscription update \"%1\": L=%2 R=%3").arg(info.name).arg(TimeToString(info.updated)).arg(info.subscription_config.updateInterval);
-        }
+        updateList << std::pair{ info.name, entry };
+        updateNamesList << info.name;
+        QvLog() << QString("Subscription update \"%1\": L=%2 R=%3").arg(info.name).arg(TimeToString(info.updated)).arg(info.subscription_config.updateInterval);
     }
 
     if (!updateList.isEmpty())
@@ -160,20 +163,27 @@ void MainWindow::CheckSubscriptionsUpdate()
             if (result == Qv2rayBase::MessageOpt::Yes)
             {
                 QvLog() << "Updating subscription:" << name;
-                QvBaselib->ProfileManager()->UpdateSubscriptionAsync(id);
+                SubscriptionUpdater->UpdateSubscription(id, false);
             }
             else if (result == Qv2rayBase::MessageOpt::Ignore)
             {
                 QvLog() << "Ignored subscription update:" << name;
                 QvBaselib->ProfileManager()->IgnoreSubscriptionUpdate(id);
             }
+            else
+            {
+                // Not asked again by the scheduler.
+                SubscriptionUpdater->Postpone(id);
+            }
         }
     }
+    SubscriptionUpdater->StartScheduler();
 }
 
 void MainWindow::updateColorScheme()
 {
-    vCoreLogHighlighter->loadRules(StyleManager->isDarkMode());
+    vCoreLogHighlighter.loadRules(StyleManager->isDarkMode());
+    masterLogBrowser->viewport()->update();
     qvAppTrayIcon->setIcon(QvBaselib->KernelManager()->CurrentConnection().isNull() ? Q_TRAYICON("tray") : Q_TRAYICON("tray-connected"));
     //
     importConfigButton->setIcon(QIcon(STYLE_RESX("add")));
@@ -223,6 +233,7 @@ void MainWindow::UpdateActionTranslations()
     action_RCM_Edit->setText(tr("Edit"));
     action_RCM_DuplicateConnection->setText(tr("Duplicate to the Same Group"));
     action_RCM_TestLatency->setText(tr("Test Latency"));
+    action_RCM_CancelLatencyTests->setText(tr("Cancel Queued Latency Tests"));
     action_RCM_ResetStats->setText(tr("Clear Usage Data"));
     action_RCM_DeleteConnection->setText(tr("Delete Connection"));
     //
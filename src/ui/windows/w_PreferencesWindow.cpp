@@ -163,8 +163,9 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QvDialog(QStringLiteral(
             noAutoConnectRB->setChecked(newval == Qv2rayBehaviorConfig::AUTOCONNECT_NONE);
             lastConnectedRB->setChecked(newval == Qv2rayBehaviorConfig::AUTOCONNECT_LAST_CONNECTED);
             fixedAutoConnectRB->setChecked(newval == Qv2rayBehaviorConfig::AUTOCONNECT_FIXED);
+            fastestAutoConnectRB->setChecked(newval == Qv2rayBehaviorConfig::AUTOCONNECT_FASTEST);
             autoStartConnCombo->setEnabled(newval == Qv2rayBehaviorConfig::AUTOCONNECT_FIXED);
-            autoStartSubsCombo->setEnabled(newval == Qv2rayBehaviorConfig::AUTOCONNECT_FIXED);
+            autoStartSubsCombo->setEnabled(newval == Qv2rayBehaviorConfig::AUTOCONNECT_FIXED || newval == Qv2rayBehaviorConfig::AUTOCONNECT_FASTEST);
         });
 
         if (AppConfig.behaviorConfig->AutoConnectProfileId->isNull())
@@ -289,6 +290,8 @@ void PreferencesWindow::on_autoStartSubsCombo_currentIndexChanged(int arg1)
     }
     else
     {
+        // The fastest connection mode only uses the group.
+        AppConfig.behaviorConfig->AutoConnectProfileId->groupId = GroupId(autoStartSubsCombo->currentData().toString());
         auto list = QvBaselib->ProfileManager()->GetConnections(GroupId(autoStartSubsCombo->currentData().toString()));
         autoStartConnCombo->clear();
 
@@ -450,6 +453,11 @@ void PreferencesWindow::on_fixedAutoConnectRB_clicked()
     AppConfig.behaviorConfig->AutoConnectBehavior = Qv2rayBehaviorConfig::AUTOCONNECT_FIXED;
 }
 
+void PreferencesWindow::on_fastestAutoConnectRB_clicked()
+{
+    AppConfig.behaviorConfig->AutoConnectBehavior = Qv2rayBehaviorConfig::AUTOCONNECT_FASTEST;
+}
+
 void PreferencesWindow::on_qvNetworkUATxt_editTextChanged(const QString &arg1)
 {
     BaselibConfig.network_config.ua = arg1;
@@ -48,6 +48,7 @@ class PreferencesWindow
     void on_autoStartSubsCombo_currentIndexChanged(int arg1);
     void on_buttonBox_accepted();
 
+    void on_fastestAutoConnectRB_clicked();
     void on_fixedAutoConnectRB_clicked();
 
     void on_lastConnectedRB_clicked();
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "QvPlugin/Handlers/OutboundHandler.hpp"
+
+namespace Legacy
+{
+    // BuiltinSerializer::Deserialize as it was when every scheme went through QUrl.
+    std::optional<std::pair<QString, IOConnectionSettings>> Deserialize(const QString &link);
+} // namespace Legacy
@@ -0,0 +1,138 @@
+#include "V2RayBalancerTuner.hpp"
+
+#include <QTcpServer>
+#include <QtTest>
+
+namespace
+{
+    constexpr auto MIB = 1024 * 1024;
+
+    // Local servers the latency probes can reach: handshakes take well under a millisecond, so the scores only differ
+    // by the throughput of the members.
+    class StandInServers
+    {
+      public:
+        ~StandInServers()
+        {
+            qDeleteAll(servers);
+        }
+
+        BalancerTuner::Member Listening(const QString &tag)
+        {
+            const auto server = new QTcpServer;
+            servers << server;
+            if (!server->listen(QHostAddress::LocalHost))
+                return {};
+            return { tag, QStringLiteral("127.0.0.1"), server->serverPort() };
+        }
+
+        // Connections to it are refused. Called after Listening, so that no listening server takes the port again.
+        BalancerTuner::Member Refusing(const QString &tag)
+        {
+            QTcpServer server;
+            if (!server.listen(QHostAddress::LocalHost))
+                return {};
+            const auto port = server.serverPort();
+            server.close();
+            return { tag, QStringLiteral("127.0.0.1"), port };
+        }
+
+      private:
+        QList<QTcpServer *> servers;
+    };
+
+    // A second of traffic at the given rate.
+    void AddSecond(BalancerTuner &tuner, const QString &tag, double mibPerSecond)
+    {
+        tuner.AddTraffic(tag, qint64(mibPerSecond * MIB), 1000);
+    }
+} // namespace
+
+class tst_BalancerTuner : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // Members without throughput are scored with the median throughput of their balancer: faster than the slow member
+    // here, since the two faster ones don't answer.
+    void medianThroughputDefault()
+    {
+        StandInServers servers;
+        BalancerTuner tuner;
+        tuner.SetBalancers({ { QStringLiteral("balancer"),
+                               { servers.Listening(QStringLiteral("untested")), servers.Listening(QStringLiteral("slow")),
+                                 servers.Refusing(QStringLiteral("down-1")), servers.Refusing(QStringLiteral("down-4")) } } });
+        AddSecond(tuner, QStringLiteral("slow"), 0.5);
+        AddSecond(tuner, QStringLiteral("down-1"), 1);
+        AddSecond(tuner, QStringLiteral("down-4"), 4);
+
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{ { QStringLiteral("balancer"), QStringLiteral("untested") } }));
+        // Nothing changed.
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{}));
+    }
+
+    // The target only moves to a member scoring at least SWITCH_THRESHOLD better.
+    void switchThreshold()
+    {
+        StandInServers servers;
+        BalancerTuner tuner;
+        tuner.SetBalancers({ { QStringLiteral("balancer"), { servers.Listening(QStringLiteral("a")), servers.Listening(QStringLiteral("b")) } } });
+        AddSecond(tuner, QStringLiteral("a"), 2);
+        AddSecond(tuner, QStringLiteral("b"), 1);
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{ { QStringLiteral("balancer"), QStringLiteral("a") } }));
+
+        // Better, but by less than the threshold.
+        AddSecond(tuner, QStringLiteral("b"), 2 * (1 + BalancerTuner::SWITCH_THRESHOLD / 2));
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{}));
+
+        AddSecond(tuner, QStringLiteral("b"), 2 * (1 + BalancerTuner::SWITCH_THRESHOLD * 2));
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{ { QStringLiteral("balancer"), QStringLiteral("b") } }));
+    }
+
+    // A member whose server never answers is never picked, however fast it once was.
+    void alwaysFailing()
+    {
+        StandInServers servers;
+        BalancerTuner tuner;
+        const auto alive = servers.Listening(QStringLiteral("alive"));
+        tuner.SetBalancers({ { QStringLiteral("mixed"), { servers.Refusing(QStringLiteral("dead")), alive } },
+                             { QStringLiteral("dead-only"), { servers.Refusing(QStringLiteral("dead-a")), servers.Refusing(QStringLiteral("dead-b")) } } });
+        AddSecond(tuner, QStringLiteral("dead"), 16);
+        AddSecond(tuner, QStringLiteral("alive"), 0.5);
+
+        for (auto i = 0; i < 3; i++)
+        {
+            const auto changes = tuner.Update();
+            if (i == 0)
+                QCOMPARE(changes, (QMap<QString, QString>{ { QStringLiteral("mixed"), QStringLiteral("alive") } }));
+            else
+                QCOMPARE(changes, (QMap<QString, QString>{}));
+        }
+    }
+
+    // Traffic is a rate over the interval it was read for, and old throughput fades with THROUGHPUT_HALF_LIFE_SECS.
+    void intervalWeightedTraffic()
+    {
+        StandInServers servers;
+        BalancerTuner tuner;
+        tuner.SetBalancers({ { QStringLiteral("balancer"), { servers.Listening(QStringLiteral("a")), servers.Listening(QStringLiteral("b")) } } });
+
+        // 4 MiB over two seconds is slower than 3 MiB over one.
+        tuner.AddTraffic(QStringLiteral("a"), 4 * MIB, 2000);
+        tuner.AddTraffic(QStringLiteral("b"), 3 * MIB, 1000);
+        // Ignored.
+        tuner.AddTraffic(QStringLiteral("a"), 64 * MIB, 0);
+        tuner.AddTraffic(QStringLiteral("unknown"), 64 * MIB, 1000);
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{ { QStringLiteral("balancer"), QStringLiteral("b") } }));
+
+        AddSecond(tuner, QStringLiteral("a"), 3 * (1 + BalancerTuner::SWITCH_THRESHOLD * 2));
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{ { QStringLiteral("balancer"), QStringLiteral("a") } }));
+
+        // Two half lives without traffic leave a with a quarter of its throughput, slower than b.
+        tuner.AddTraffic(QStringLiteral("a"), 0, 2 * BalancerTuner::THROUGHPUT_HALF_LIFE_SECS * 1000);
+        QCOMPARE(tuner.Update(), (QMap<QString, QString>{ { QStringLiteral("balancer"), QStringLiteral("b") } }));
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_BalancerTuner)
+#include "tst_BalancerTuner.moc"
@@ -0,0 +1,148 @@
+#include "SubscriptionUpdater/ConditionalRequest.hpp"
+
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtTest>
+
+using namespace Qv2ray::components::QvSubscriptionUpdater;
+
+namespace
+{
+    constexpr auto ETAG = "\"v1\"";
+    constexpr auto LAST_MODIFIED = "Tue, 19 Oct 2021 08:00:00 GMT";
+
+    // A subscription server answering 304 to requests carrying its current ETag, and the subscription otherwise.
+    class StubServer : public QTcpServer
+    {
+      public:
+        StubServer()
+        {
+            connect(this, &QTcpServer::newConnection, this,
+                    [this]
+                    {
+                        while (const auto socket = nextPendingConnection())
+                            connect(socket, &QTcpSocket::readyRead, this, [this, socket] { respond(socket); });
+                    });
+        }
+
+        QString Address() const
+        {
+            return QStringLiteral("http://127.0.0.1:%1/subscription").arg(serverPort());
+        }
+
+        // The headers of the last request, names in lower case.
+        QHash<QByteArray, QByteArray> lastHeaders;
+        int fullResponses = 0;
+
+      private:
+        void respond(QTcpSocket *socket)
+        {
+            auto &buffer = buffers[socket];
+            buffer += socket->readAll();
+            const auto end = buffer.indexOf("\r\n\r\n");
+            if (end < 0)
+                return;
+
+            lastHeaders.clear();
+            for (const auto &line : buffer.left(end).split('\n').mid(1))
+            {
+                const auto separator = line.indexOf(':');
+                if (separator > 0)
+                    lastHeaders.insert(line.left(separator).trimmed().toLower(), line.mid(separator + 1).trimmed());
+            }
+            buffers.remove(socket);
+
+            QByteArray response;
+            if (lastHeaders.value("if-none-match") == ETAG)
+            {
+                response = "HTTP/1.1 304 Not Modified\r\nConnection: close\r\n\r\n";
+            }
+            else
+            {
+                fullResponses++;
+                const QByteArray body = "ss://YWVzLTI1Ni1nY206cGFzc3dvcmQ@198.51.100.30:8388#SS\n";
+                response = "HTTP/1.1 200 OK\r\nConnection: close\r\nETag: " + QByteArray(ETAG) + "\r\nLast-Modified: " + LAST_MODIFIED +
+                           "\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+            }
+            socket->write(response);
+            socket->disconnectFromHost();
+        }
+
+        QHash<QTcpSocket *, QByteArray> buffers;
+    };
+
+    // Sends the request the way the updater does for a scheduled update, and waits for the reply.
+    QNetworkReply *Fetch(QNetworkAccessManager &manager, const QString &address, const CacheValidators &validators)
+    {
+        QNetworkRequest request{ QUrl{ address } };
+        SetConditionalHeaders(request, address, validators);
+        const auto reply = manager.get(request);
+        QSignalSpy finished(reply, &QNetworkReply::finished);
+        if (!reply->isFinished())
+            finished.wait(5000);
+        return reply;
+    }
+} // namespace
+
+class tst_ConditionalRequest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        manager.setProxy(QNetworkProxy::NoProxy);
+    }
+
+    void revalidation()
+    {
+        // The first update has nothing to send.
+        const auto first = Fetch(manager, server.Address(), {});
+        QVERIFY(first->isFinished());
+        QCOMPARE(first->error(), QNetworkReply::NoError);
+        QVERIFY(!IsNotModified(*first));
+        QVERIFY(!first->readAll().isEmpty());
+        QVERIFY(!server.lastHeaders.contains("if-none-match"));
+        QVERIFY(!server.lastHeaders.contains("if-modified-since"));
+
+        // The validators survive being stored and loaded again, as they do across restarts.
+        const auto received = CacheValidators::fromJson(ReceivedValidators(server.Address(), *first).toJson());
+        first->deleteLater();
+        QCOMPARE(received.address, server.Address());
+        QCOMPARE(received.etag, QByteArray(ETAG));
+        QCOMPARE(received.lastModified, QByteArray(LAST_MODIFIED));
+
+        // The next update sends them back, the unchanged subscription is not downloaded again.
+        const auto second = Fetch(manager, server.Address(), received);
+        QVERIFY(second->isFinished());
+        QCOMPARE(server.lastHeaders.value("if-none-match"), QByteArray(ETAG));
+        QCOMPARE(server.lastHeaders.value("if-modified-since"), QByteArray(LAST_MODIFIED));
+        QVERIFY(IsNotModified(*second));
+        QVERIFY(second->readAll().isEmpty());
+        QCOMPARE(server.fullResponses, 1);
+        second->deleteLater();
+    }
+
+    // Validators of another address are never sent, the subscription address may have been changed since.
+    void otherAddress()
+    {
+        const CacheValidators validators{ QStringLiteral("http://127.0.0.1:1/old"), ETAG, LAST_MODIFIED };
+        const auto reply = Fetch(manager, server.Address(), validators);
+        QVERIFY(reply->isFinished());
+        QVERIFY(!IsNotModified(*reply));
+        QVERIFY(!server.lastHeaders.contains("if-none-match"));
+        QVERIFY(!server.lastHeaders.contains("if-modified-since"));
+        reply->deleteLater();
+    }
+
+  private:
+    StubServer server;
+    QNetworkAccessManager manager;
+};
+
+QTEST_GUILESS_MAIN(tst_ConditionalRequest)
+#include "tst_ConditionalRequest.moc"
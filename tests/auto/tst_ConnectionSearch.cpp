@@ -0,0 +1,125 @@
+#include "ConnectionSearch/ConnectionSearch.hpp"
+
+#include <QtTest>
+
+namespace
+{
+    SearchDocument Connection(const char *id, const QString &name, const QString &host, const QString &protocol)
+    {
+        SearchDocument document;
+        document.connectionId = ConnectionId{ QString::fromLatin1(id) };
+        document.name = name;
+        document.host = host;
+        document.protocol = protocol;
+        return document;
+    }
+
+    SearchDocument Group(const char *id, const QString &name)
+    {
+        SearchDocument document;
+        document.groupId = GroupId{ QString::fromLatin1(id) };
+        document.name = name;
+        return document;
+    }
+
+    template<typename T>
+    QStringList SortedIds(const QSet<T> &ids)
+    {
+        QStringList result;
+        for (const auto &id : ids)
+            result << id.toString();
+        result.sort();
+        return result;
+    }
+
+    const ConnectionSearchIndex &Index()
+    {
+        static const ConnectionSearchIndex index({
+            Connection("tokyo", QStringLiteral("Tokyo 01"), QStringLiteral("jp1.example.com"), QStringLiteral("VMess")),
+            Connection("singapore", QStringLiteral("Singapore"), QStringLiteral("sg.example.net"), QStringLiteral("Trojan")),
+            Connection("moscow", QStringLiteral("Москва"), QStringLiteral("ru.example.org"), QStringLiteral("VLESS")),
+            Connection("zurich", QStringLiteral("Zürich"), QStringLiteral("ch.example.org"), QStringLiteral("Shadowsocks")),
+            Connection("athens", QStringLiteral("ΟΔΟΣ"), QStringLiteral("gr.example.org"), QStringLiteral("Shadowsocks")),
+            Group("tokyo-group", QStringLiteral("Tokyo servers")),
+        });
+        return index;
+    }
+} // namespace
+
+class tst_ConnectionSearch : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void emptyQuery_data()
+    {
+        QTest::addColumn<QString>("query");
+        QTest::newRow("empty") << QString();
+        QTest::newRow("spaces") << QStringLiteral("   ");
+        QTest::newRow("newlines") << QStringLiteral("\n\t ");
+    }
+    void emptyQuery()
+    {
+        QFETCH(QString, query);
+        const auto result = Index().Query(query);
+        QCOMPARE(result.query, query);
+        QVERIFY(result.matchesAll);
+        QVERIFY(result.connections.isEmpty());
+        QVERIFY(result.groups.isEmpty());
+    }
+
+    void query_data()
+    {
+        QTest::addColumn<QString>("query");
+        QTest::addColumn<QStringList>("connections");
+        QTest::addColumn<QStringList>("groups");
+
+        // Terms without any trigram are only looked up in the texts.
+        QTest::newRow("short term in a host") << QStringLiteral("jp") << QStringList{ "tokyo" } << QStringList{};
+        QTest::newRow("short term in a name") << QStringLiteral("01") << QStringList{ "tokyo" } << QStringList{};
+        QTest::newRow("short term without match") << QStringLiteral("xz") << QStringList{} << QStringList{};
+
+        QTest::newRow("connections and groups") << QStringLiteral("tokyo") << QStringList{ "tokyo" } << QStringList{ "tokyo-group" };
+        QTest::newRow("every term") << QStringLiteral("tokyo vmess") << QStringList{ "tokyo" } << QStringList{};
+        QTest::newRow("not every term") << QStringLiteral("tokyo trojan") << QStringList{} << QStringList{};
+        QTest::newRow("terms in any order") << QStringLiteral("shadowsocks  EXAMPLE") << QStringList{ "athens", "zurich" } << QStringList{};
+
+        QTest::newRow("host only") << QStringLiteral("sg.example") << QStringList{ "singapore" } << QStringList{};
+        QTest::newRow("host of several") << QStringLiteral("example.org") << QStringList{ "athens", "moscow", "zurich" } << QStringList{};
+        QTest::newRow("protocol only") << QStringLiteral("trojan") << QStringList{ "singapore" } << QStringList{};
+        QTest::newRow("protocol, case folded") << QStringLiteral("vless") << QStringList{ "moscow" } << QStringList{};
+
+        // "Tokyo 01\njp1.example.com\nvmess": neither the exact nor the fuzzy match spans two fields.
+        QTest::newRow("across name and host") << QStringLiteral("01jp") << QStringList{} << QStringList{};
+        QTest::newRow("across host and protocol") << QStringLiteral("comvm") << QStringList{} << QStringList{};
+        QTest::newRow("newline separates terms") << QStringLiteral("01\njp") << QStringList{ "tokyo" } << QStringList{};
+
+        QTest::newRow("fuzzy, missing character") << QStringLiteral("singapre") << QStringList{ "singapore" } << QStringList{};
+        QTest::newRow("fuzzy, half of the trigrams") << QStringLiteral("singaxxx") << QStringList{ "singapore" } << QStringList{};
+        QTest::newRow("fuzzy, less than half") << QStringLiteral("singxxxx") << QStringList{} << QStringList{};
+        QTest::newRow("fuzzy at FUZZY_MIN_LENGTH") << QStringLiteral("tokx") << QStringList{ "tokyo" } << QStringList{ "tokyo-group" };
+        QTest::newRow("not fuzzy below FUZZY_MIN_LENGTH") << QStringLiteral("okx") << QStringList{} << QStringList{};
+
+        QTest::newRow("cyrillic, lower case") << QStringLiteral("москва") << QStringList{ "moscow" } << QStringList{};
+        QTest::newRow("cyrillic, upper case") << QStringLiteral("МОСКВА") << QStringList{ "moscow" } << QStringList{};
+        QTest::newRow("diaeresis, upper case") << QStringLiteral("ZÜRICH") << QStringList{ "zurich" } << QStringList{};
+        QTest::newRow("without the diaeresis, fuzzy") << QStringLiteral("zurich") << QStringList{ "zurich" } << QStringList{};
+        QTest::newRow("greek, final sigma") << QStringLiteral("οδος") << QStringList{ "athens" } << QStringList{};
+        QTest::newRow("greek, upper case") << QStringLiteral("ΟΔΟΣ") << QStringList{ "athens" } << QStringList{};
+    }
+    void query()
+    {
+        QFETCH(QString, query);
+        QFETCH(QStringList, connections);
+        QFETCH(QStringList, groups);
+
+        const auto result = Index().Query(query);
+        QCOMPARE(result.query, query);
+        QVERIFY(!result.matchesAll);
+        QCOMPARE(SortedIds(result.connections), connections);
+        QCOMPARE(SortedIds(result.groups), groups);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_ConnectionSearch)
+#include "tst_ConnectionSearch.moc"
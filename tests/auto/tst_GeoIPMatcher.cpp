@@ -0,0 +1,319 @@
+#include "GeositeReader/GeoIPMatcher.hpp"
+#include "GeositeReader/GeositeReader.hpp"
+#include "ProtobufWriter.hpp"
+
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest>
+
+using namespace Qv2ray::components::GeositeReader;
+
+namespace
+{
+    struct Category
+    {
+        QByteArray name;
+        QStringList cidrs;
+        bool inverse = false;
+    };
+
+    // Overlapping and nested CIDRs within and across categories, the whole address spaces, single addresses on both
+    // ends of them, and an inverse_match entry.
+    const QList<Category> CATEGORIES{
+        { "a", { "10.0.0.0/8", "10.1.0.0/16", "2001:db8::/32" } },
+        { "b", { "10.1.2.0/24", "10.255.255.255/32", "192.168.0.0/16", "2001:db8:1::/48" } },
+        { "c", { "192.168.1.0/24", "192.168.0.0/17", "2001:db8::/33" } },
+        { "all", { "0.0.0.0/0", "::/0" } },
+        { "edges", { "0.0.0.0/32", "255.255.255.255/32", "::/128", "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff/128", "2001:db8::1/128" } },
+        { "notlocal", { "127.0.0.0/8", "::1/128", "fe80::/10" }, true },
+        { "empty", {} },
+    };
+
+    // message GeoIP { string country_code = 1; repeated CIDR cidr = 2; bool inverse_match = 3; }
+    QByteArray MakeGeoIPFile(const QList<Category> &categories)
+    {
+        QByteArray file;
+        for (const auto &category : categories)
+        {
+            QByteArray entry;
+            ProtobufWriter::AppendBytesField(entry, 1, category.name);
+            for (const auto &text : category.cidrs)
+            {
+                // message CIDR { bytes ip = 1; uint32 prefix = 2; }
+                const auto [address, prefix] = QHostAddress::parseSubnet(text);
+                QByteArray ip;
+                if (address.protocol() == QAbstractSocket::IPv4Protocol)
+                {
+                    const auto v4 = address.toIPv4Address();
+                    const char bytes[] = { char(v4 >> 24), char(v4 >> 16), char(v4 >> 8), char(v4) };
+                    ip = QByteArray(bytes, sizeof(bytes));
+                }
+                else
+                {
+                    const auto v6 = address.toIPv6Address();
+                    ip = QByteArray(reinterpret_cast<const char *>(v6.c), 16);
+                }
+                QByteArray cidr;
+                ProtobufWriter::AppendBytesField(cidr, 1, ip);
+                ProtobufWriter::AppendVarintField(cidr, 2, prefix);
+                ProtobufWriter::AppendBytesField(entry, 2, cidr);
+            }
+            if (category.inverse)
+                ProtobufWriter::AppendVarintField(entry, 3, 1);
+            ProtobufWriter::AppendBytesField(file, 1, entry);
+        }
+        return file;
+    }
+
+    // IPv4-mapped IPv6 addresses are looked up as IPv4 addresses, "::" is not 0.0.0.0.
+    QHostAddress Normalized(const QHostAddress &address)
+    {
+        const auto v6 = address.toIPv6Address();
+        const auto mapped = address.protocol() == QAbstractSocket::IPv6Protocol && std::all_of(v6.c, v6.c + 10, [](quint8 byte) { return byte == 0; }) &&
+                            v6.c[10] == 0xFF && v6.c[11] == 0xFF;
+        return mapped ? QHostAddress(qFromBigEndian<quint32>(v6.c + 12)) : address;
+    }
+
+    // What GeoIPMatcher does, written the obvious way: every CIDR of every category is checked.
+    QStringList NaiveMatch(const QList<Category> &categories, const QHostAddress &address)
+    {
+        const auto normalized = Normalized(address);
+        QStringList result;
+        for (const auto &category : categories)
+        {
+            const auto inside = std::any_of(category.cidrs.begin(), category.cidrs.end(),
+                                            [&normalized](const QString &cidr) { return normalized.isInSubnet(QHostAddress::parseSubnet(cidr)); });
+            if (inside != category.inverse)
+                result << QString::fromUtf8(category.name);
+        }
+        return result;
+    }
+
+    QHostAddress AddToIPv6(const QHostAddress &address, int delta)
+    {
+        auto v6 = address.toIPv6Address();
+        for (auto i = 15; i >= 0 && delta != 0; i--)
+        {
+            const auto sum = int(v6.c[i]) + delta;
+            v6.c[i] = quint8(sum & 0xFF);
+            delta = sum >> 8;
+        }
+        return QHostAddress(v6);
+    }
+
+    // The first and last address of every CIDR and their neighbours, where an off by one shows, and random addresses.
+    QList<QHostAddress> InterestingAddresses(const QList<Category> &categories)
+    {
+        QList<QHostAddress> addresses;
+        for (const auto &category : categories)
+        {
+            for (const auto &text : category.cidrs)
+            {
+                const auto [address, prefix] = QHostAddress::parseSubnet(text);
+                if (address.protocol() == QAbstractSocket::IPv4Protocol)
+                {
+                    const quint32 mask = prefix == 0 ? 0 : ~quint32(0) << (32 - prefix);
+                    const auto first = address.toIPv4Address() & mask, last = first | ~mask;
+                    for (const auto v4 : { first - 1, first, first + 1, last - 1, last, last + 1 })
+                    {
+                        addresses << QHostAddress(v4);
+                        addresses << QHostAddress(QStringLiteral("::ffff:") + QHostAddress(v4).toString());
+                    }
+                }
+                else
+                {
+                    auto last = address.toIPv6Address();
+                    for (auto bit = prefix; bit < 128; bit++)
+                        last.c[bit / 8] |= quint8(0x80 >> (bit % 8));
+                    for (const auto delta : { -1, 0, 1 })
+                    {
+                        addresses << AddToIPv6(address, delta);
+                        addresses << AddToIPv6(QHostAddress(last), delta);
+                    }
+                }
+            }
+        }
+
+        QRandomGenerator random(20211019);
+        for (auto i = 0; i < 2000; i++)
+        {
+            addresses << QHostAddress(random.generate());
+            Q_IPV6ADDR v6;
+            for (auto &byte : v6.c)
+                byte = quint8(random.bounded(256));
+            // Mostly inside of 2001:db8::/32, where the CIDRs are.
+            if (random.bounded(2))
+                std::copy_n("\x20\x01\x0d\xb8", 4, v6.c);
+            addresses << QHostAddress(v6);
+        }
+        return addresses;
+    }
+} // namespace
+
+class tst_GeoIPMatcher : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        // Keeps the compiled tables out of the user's cache directory.
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(dir.isValid());
+        path = dir.filePath(QStringLiteral("geoip.dat"));
+        writeSource(MakeGeoIPFile(CATEGORIES));
+    }
+
+    void cleanup()
+    {
+        QFile::remove(cachePath());
+    }
+
+    void matchesNaive()
+    {
+        const GeoIPMatcher matcher{ path };
+        QCOMPARE(matcher.CategoryCount(), int(CATEGORIES.size()));
+        for (const auto &address : InterestingAddresses(CATEGORIES))
+            QCOMPARE(matcher.Match(address), NaiveMatch(CATEGORIES, address));
+    }
+
+    void edges_data()
+    {
+        QTest::addColumn<QString>("address");
+        QTest::addColumn<QStringList>("expected");
+        QTest::newRow("nested, same category") << "10.1.0.1" << QStringList{ "a", "all", "notlocal" };
+        QTest::newRow("nested, across categories") << "10.1.2.3" << QStringList{ "a", "b", "all", "notlocal" };
+        QTest::newRow("/32 at the end of a /8") << "10.255.255.255" << QStringList{ "a", "b", "all", "notlocal" };
+        QTest::newRow("overlap") << "192.168.1.1" << QStringList{ "b", "c", "all", "notlocal" };
+        QTest::newRow("overlap, outside of the /17") << "192.168.200.1" << QStringList{ "b", "all", "notlocal" };
+        QTest::newRow("lowest IPv4") << "0.0.0.0" << QStringList{ "all", "edges", "notlocal" };
+        QTest::newRow("highest IPv4") << "255.255.255.255" << QStringList{ "all", "edges", "notlocal" };
+        QTest::newRow("inverse, inside") << "127.0.0.1" << QStringList{ "all" };
+        QTest::newRow("inverse, IPv6 inside") << "::1" << QStringList{ "all" };
+        QTest::newRow("inverse, link local") << "fe80::1" << QStringList{ "all" };
+        QTest::newRow("mapped IPv4") << "::ffff:10.1.2.3" << QStringList{ "a", "b", "all", "notlocal" };
+        QTest::newRow("mapped, inverse") << "::ffff:127.0.0.1" << QStringList{ "all" };
+        QTest::newRow("/128") << "2001:db8::1" << QStringList{ "a", "c", "all", "edges", "notlocal" };
+        QTest::newRow("/33 ends") << "2001:db8:8000::" << QStringList{ "a", "all", "notlocal" };
+        QTest::newRow("/48 across categories") << "2001:db8:1::5" << QStringList{ "a", "b", "c", "all", "notlocal" };
+        QTest::newRow("lowest IPv6") << "::" << QStringList{ "all", "edges", "notlocal" };
+        QTest::newRow("highest IPv6") << "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff" << QStringList{ "all", "edges", "notlocal" };
+        QTest::newRow("invalid") << "not an address" << QStringList{};
+    }
+    void edges()
+    {
+        QFETCH(QString, address);
+        QFETCH(QStringList, expected);
+        const GeoIPMatcher matcher{ path };
+        QCOMPARE(matcher.Match(address), expected);
+    }
+
+    // The second matcher maps the tables the first one has compiled.
+    void cached()
+    {
+        QByteArray compiled;
+        {
+            const GeoIPMatcher matcher{ path };
+            compiled = readCache();
+            QVERIFY(!compiled.isEmpty());
+        }
+        const GeoIPMatcher matcher{ path };
+        QCOMPARE(readCache(), compiled);
+        QCOMPARE(matcher.Match(QStringLiteral("10.1.2.3")), NaiveMatch(CATEGORIES, QHostAddress(QStringLiteral("10.1.2.3"))));
+    }
+
+    // Caches that can't be used are compiled again, and the matcher still answers from the source.
+    void invalidCache_data()
+    {
+        QTest::addColumn<int>("truncateTo");
+        QTest::addColumn<int>("corruptAt");
+        QTest::addColumn<QByteArray>("bytes");
+        QTest::newRow("empty") << 0 << -1 << QByteArray{};
+        QTest::newRow("header only") << 56 << -1 << QByteArray{};
+        QTest::newRow("truncated") << -8 << -1 << QByteArray{};
+        QTest::newRow("trailing bytes") << -1 << -1 << QByteArray(8, '\0');
+        QTest::newRow("magic") << -1 << 0 << QByteArray("XXXX");
+        QTest::newRow("version") << -1 << 4 << QByteArray("\xff\xff\xff\xff", 4);
+        // The last word of the file is the set of the last IPv6 interval.
+        QTest::newRow("set out of range") << -1 << -4 << QByteArray("\xff\xff\xff\x7f", 4);
+    }
+    void invalidCache()
+    {
+        QFETCH(int, truncateTo);
+        QFETCH(int, corruptAt);
+        QFETCH(QByteArray, bytes);
+
+        QByteArray compiled;
+        {
+            const GeoIPMatcher matcher{ path };
+            compiled = readCache();
+        }
+
+        auto broken = compiled;
+        if (truncateTo >= 0)
+            broken.truncate(truncateTo);
+        else if (truncateTo < -1)
+            broken.chop(-truncateTo);
+        if (corruptAt != -1)
+            broken.replace(corruptAt >= 0 ? corruptAt : broken.size() + corruptAt, bytes.size(), bytes);
+        else
+            broken.append(bytes);
+        writeCache(broken);
+
+        const GeoIPMatcher matcher{ path };
+        QCOMPARE(readCache(), compiled);
+        for (const auto &address : InterestingAddresses(CATEGORIES).mid(0, 200))
+            QCOMPARE(matcher.Match(address), NaiveMatch(CATEGORIES, address));
+    }
+
+    // A cache of another version of geoip.dat is not used.
+    void staleCache()
+    {
+        {
+            const GeoIPMatcher matcher{ path };
+        }
+
+        const QList<Category> changed{ { "other", { "10.0.0.0/8" } } };
+        writeSource(MakeGeoIPFile(changed));
+        {
+            const GeoIPMatcher matcher{ path };
+            QCOMPARE(matcher.CategoryCount(), 1);
+            QCOMPARE(matcher.Match(QStringLiteral("10.1.2.3")), QStringList{ "other" });
+        }
+        writeSource(MakeGeoIPFile(CATEGORIES));
+    }
+
+  private:
+    QString cachePath() const
+    {
+        return GetDataCacheFilePath(path, QStringLiteral(".geoip"));
+    }
+
+    QByteArray readCache() const
+    {
+        QFile file(cachePath());
+        return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray{};
+    }
+
+    void writeCache(const QByteArray &content) const
+    {
+        QFile file(cachePath());
+        QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+        file.write(content);
+    }
+
+    void writeSource(const QByteArray &content) const
+    {
+        QFile file(path);
+        QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+        file.write(content);
+    }
+
+    QTemporaryDir dir;
+    QString path;
+};
+
+QTEST_GUILESS_MAIN(tst_GeoIPMatcher)
+#include "tst_GeoIPMatcher.moc"
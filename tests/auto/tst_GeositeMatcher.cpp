@@ -0,0 +1,158 @@
+#include "GeositeReader/GeositeMatcher.hpp"
+#include "ProtobufWriter.hpp"
+
+#include <QTemporaryDir>
+#include <QtTest>
+#include <memory>
+
+using namespace Qv2ray::components::GeositeReader;
+
+namespace
+{
+    // Values of the Domain.Type enum in geosite.dat
+    enum DomainType
+    {
+        PLAIN = 0,
+        REGEX = 1,
+        DOMAIN = 2,
+        FULL = 3
+    };
+
+    struct Rule
+    {
+        DomainType type;
+        QByteArray value;
+        QList<QByteArray> attributes;
+    };
+
+    // message GeoSite { string country_code = 1; repeated Domain domain = 2; }
+    QByteArray GeoSite(const QByteArray &name, const QList<Rule> &rules)
+    {
+        QByteArray site;
+        ProtobufWriter::AppendBytesField(site, 1, name);
+        for (const auto &rule : rules)
+        {
+            // message Domain { Type type = 1; string value = 2; repeated Attribute attribute = 3; }
+            QByteArray domain;
+            ProtobufWriter::AppendVarintField(domain, 1, rule.type);
+            ProtobufWriter::AppendBytesField(domain, 2, rule.value);
+            for (const auto &key : rule.attributes)
+            {
+                // message Attribute { string key = 1; oneof typed_value { bool bool_value = 2; int64 int_value = 3; } }
+                QByteArray attribute;
+                ProtobufWriter::AppendBytesField(attribute, 1, key);
+                ProtobufWriter::AppendVarintField(attribute, 2, 1);
+                ProtobufWriter::AppendBytesField(domain, 3, attribute);
+            }
+            ProtobufWriter::AppendBytesField(site, 2, domain);
+        }
+        return site;
+    }
+
+    // Every type of rule, with and without attributes, and keywords overlapping each other.
+    QByteArray MakeGeositeFile()
+    {
+        QByteArray file;
+        const auto add = [&file](const QByteArray &name, const QList<Rule> &rules) { ProtobufWriter::AppendBytesField(file, 1, GeoSite(name, rules)); };
+        add("google", { { DOMAIN, "google.com", {} }, { FULL, "www.google.cn", { "cn" } }, { PLAIN, "gstatic", {} } });
+        add("apple", { { DOMAIN, "apple.com", { "cn" } }, { DOMAIN, "icloud.com", {} }, { FULL, "Apple.CN", {} } });
+        add("cn", { { DOMAIN, "cn", {} } });
+        add("category-ads", { { PLAIN, "doubleclick", { "ads" } }, { FULL, "ads.example.com", { "ads", "global" } }, { REGEX, "^ad[0-9]+\\.", { "ads" } } });
+        add("he", { { PLAIN, "he", {} } });
+        add("she", { { PLAIN, "she", {} } });
+        // '+' is outside of the alphabet of the keyword automaton.
+        add("plus", { { PLAIN, "a+b", {} } });
+        return file;
+    }
+} // namespace
+
+class tst_GeositeMatcher : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath(QStringLiteral("geosite.dat"));
+        QFile file(path);
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write(MakeGeositeFile());
+        file.close();
+
+        matcher = std::make_unique<GeositeMatcher>(path);
+        QCOMPARE(matcher->CategoryCount(), 7);
+    }
+
+    void match_data()
+    {
+        QTest::addColumn<QString>("domain");
+        QTest::addColumn<QStringList>("attributes");
+        QTest::addColumn<QStringList>("expected");
+
+        const auto none = QStringList{};
+        // Domain rules match the domain and its subdomains, on label boundaries only.
+        QTest::newRow("domain") << "google.com" << none << QStringList{ "google" };
+        QTest::newRow("domain, subdomain") << "mail.google.com" << none << QStringList{ "google" };
+        QTest::newRow("domain, not a label") << "notgoogle.com" << none << QStringList{};
+        QTest::newRow("domain, not a suffix") << "google.com.hk" << none << QStringList{};
+        QTest::newRow("domain, top level") << "example.cn" << none << QStringList{ "cn" };
+        QTest::newRow("domain, no dot") << "cn" << none << QStringList{ "cn" };
+        // Full rules match exactly.
+        QTest::newRow("full") << "www.google.cn" << none << QStringList{ "google", "cn" };
+        QTest::newRow("full, subdomain") << "a.www.google.cn" << none << QStringList{ "cn" };
+        QTest::newRow("full, parent") << "google.cn" << none << QStringList{ "cn" };
+        // Keywords match anywhere, overlapping ones included.
+        QTest::newRow("keyword") << "fonts.gstatic.com" << none << QStringList{ "google" };
+        QTest::newRow("keyword, inside a label") << "xgstaticx.net" << none << QStringList{ "google" };
+        QTest::newRow("keyword, overlapping") << "ushers.com" << none << QStringList{ "he", "she" };
+        QTest::newRow("keyword, outside of the alphabet") << "a+b.com" << none << QStringList{ "plus" };
+        // Regular expressions run on the lowercase domain.
+        QTest::newRow("regexp") << "ad12.example.org" << none << QStringList{ "category-ads" };
+        QTest::newRow("regexp, no match") << "bad12.example.org" << none << QStringList{};
+        // Domains and rules are compared in lowercase.
+        QTest::newRow("case, domain") << "WWW.Google.CN" << none << QStringList{ "google", "cn" };
+        QTest::newRow("case, rule") << "apple.cn" << none << QStringList{ "apple", "cn" };
+        QTest::newRow("case, keyword") << "X.DoubleClick.NET" << none << QStringList{ "category-ads" };
+        // With attributes, only the rules carrying all of them count.
+        QTest::newRow("attribute, full") << "www.google.cn" << QStringList{ "cn" } << QStringList{ "google" };
+        QTest::newRow("attribute, missing") << "mail.google.com" << QStringList{ "cn" } << QStringList{};
+        QTest::newRow("attribute, domain") << "www.apple.com" << QStringList{ "CN" } << QStringList{ "apple" };
+        QTest::newRow("attribute, other rule") << "icloud.com" << QStringList{ "cn" } << QStringList{};
+        QTest::newRow("attribute, keyword") << "x.doubleclick.net" << QStringList{ "ads" } << QStringList{ "category-ads" };
+        QTest::newRow("attribute, regexp") << "ad1.example.org" << QStringList{ "ads" } << QStringList{ "category-ads" };
+        QTest::newRow("attributes, all") << "ads.example.com" << QStringList{ "global", "ads" } << QStringList{ "category-ads" };
+        QTest::newRow("attributes, one of them") << "ads.example.com" << QStringList{ "ads" } << QStringList{ "category-ads" };
+        QTest::newRow("attributes, not all") << "apple.com" << QStringList{ "cn", "ads" } << QStringList{};
+    }
+    void match()
+    {
+        QFETCH(QString, domain);
+        QFETCH(QStringList, attributes);
+        QFETCH(QStringList, expected);
+        QCOMPARE(matcher->Match(domain, attributes), expected);
+    }
+
+    void matchBatch()
+    {
+        const QStringList domains{ "google.com", "www.google.cn", "ushers.com", "example.org" };
+        const auto results = matcher->MatchBatch(domains);
+        QCOMPARE(results.size(), domains.size());
+        for (auto i = 0; i < domains.size(); i++)
+            QCOMPARE(results[i], matcher->Match(domains[i]));
+    }
+
+    void missingFile()
+    {
+        const GeositeMatcher missing{ dir.filePath(QStringLiteral("missing.dat")) };
+        QCOMPARE(missing.CategoryCount(), 0);
+        QCOMPARE(missing.Match(QStringLiteral("google.com")), QStringList{});
+    }
+
+  private:
+    QTemporaryDir dir;
+    std::unique_ptr<GeositeMatcher> matcher;
+};
+
+QTEST_GUILESS_MAIN(tst_GeositeMatcher)
+#include "tst_GeositeMatcher.moc"
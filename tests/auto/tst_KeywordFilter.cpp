@@ -0,0 +1,109 @@
+#include "KeywordFilter/KeywordFilter.hpp"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+namespace
+{
+    using Relation = KeywordFilter::Relation;
+
+    // What KeywordFilter does, written the obvious way: one search per keyword.
+    bool NaiveAccepts(const QStringList &include, Relation includeRelation, const QStringList &exclude, Relation excludeRelation, const QString &name)
+    {
+        const auto folded = name.toCaseFolded();
+        const auto matches = [&folded](const QStringList &keywords, Relation relation, bool *empty)
+        {
+            QStringList found, missing;
+            for (const auto &keyword : keywords)
+            {
+                const auto key = keyword.trimmed().toCaseFolded();
+                if (key.isEmpty() || found.contains(key) || missing.contains(key))
+                    continue;
+                (folded.contains(key) ? found : missing) << key;
+            }
+            *empty = found.isEmpty() && missing.isEmpty();
+            return relation == SubscriptionConfigObject::RELATION_AND ? missing.isEmpty() : !found.isEmpty();
+        };
+
+        bool includeEmpty, excludeEmpty;
+        const auto included = matches(include, includeRelation, &includeEmpty);
+        const auto excluded = matches(exclude, excludeRelation, &excludeEmpty);
+        return (includeEmpty || included) && (excludeEmpty || !excluded);
+    }
+
+    // Short pieces sharing prefixes and letters that only match once case folded, so that random combinations of them
+    // find keywords inside, across and overlapping each other.
+    const QStringList TOKENS{
+        QStringLiteral("hk"),   QStringLiteral("HK"),   QStringLiteral("Hong Kong"), QStringLiteral("香港"), QStringLiteral("日本"),
+        QStringLiteral("jp"),   QStringLiteral("US"),   QStringLiteral("us-west"),   QStringLiteral("ΣΑ"),   QStringLiteral("σα"),
+        QStringLiteral("ς"),    QStringLiteral("Ä"),    QStringLiteral("ä"),         QStringLiteral("🇭🇰"), QStringLiteral(" "),
+        QStringLiteral("|"),    QStringLiteral("0"),    QStringLiteral("01"),        QStringLiteral("x"),
+    };
+
+    QString RandomText(QRandomGenerator &random, int maxTokens)
+    {
+        QString text;
+        for (auto i = random.bounded(maxTokens + 1); i > 0; i--)
+            text += TOKENS[random.bounded(TOKENS.size())];
+        return text;
+    }
+
+    QStringList RandomKeywords(QRandomGenerator &random)
+    {
+        QStringList keywords;
+        for (auto i = random.bounded(5); i > 0; i--)
+            keywords << RandomText(random, 2);
+        return keywords;
+    }
+
+    Relation RandomRelation(QRandomGenerator &random)
+    {
+        return random.bounded(2) ? SubscriptionConfigObject::RELATION_AND : SubscriptionConfigObject::RELATION_OR;
+    }
+} // namespace
+
+class tst_KeywordFilter : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void empty()
+    {
+        QVERIFY(KeywordFilter().Accepts(QStringLiteral("anything")));
+        QVERIFY(KeywordFilter({ QStringLiteral(" ") }, SubscriptionConfigObject::RELATION_AND, {}, SubscriptionConfigObject::RELATION_OR).IsEmpty());
+    }
+
+    // The automaton must agree with the naive filter on random keyword lists and names, the seed is fixed so that a
+    // failure can be reproduced.
+    void randomized()
+    {
+        QRandomGenerator random(20211019);
+        for (auto round = 0; round < 2000; round++)
+        {
+            const auto include = RandomKeywords(random);
+            const auto exclude = RandomKeywords(random);
+            const auto includeRelation = RandomRelation(random);
+            const auto excludeRelation = RandomRelation(random);
+            const KeywordFilter filter{ include, includeRelation, exclude, excludeRelation };
+
+            for (auto i = 0; i < 20; i++)
+            {
+                const auto name = RandomText(random, 6);
+                const auto expected = NaiveAccepts(include, includeRelation, exclude, excludeRelation, name);
+                if (filter.Accepts(name) != expected)
+                {
+                    const auto message = QStringLiteral("include %1 (%2), exclude %3 (%4), name \"%5\"")
+                                             .arg(include.join(QLatin1Char(',')))
+                                             .arg(int(includeRelation))
+                                             .arg(exclude.join(QLatin1Char(',')))
+                                             .arg(int(excludeRelation))
+                                             .arg(name);
+                    QFAIL(qPrintable(message));
+                }
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_KeywordFilter)
+#include "tst_KeywordFilter.moc"
@@ -0,0 +1,226 @@
+#include "AutoFailover/FailoverPolicy.hpp"
+#include "LatencyHistory/LatencyHistoryTable.hpp"
+
+#include <QJsonArray>
+#include <QtTest>
+
+using namespace Qv2ray::components::QvLatencyHistory;
+using namespace Qv2ray::components::QvAutoFailover;
+
+namespace
+{
+    constexpr auto HISTORY_SIZE = LatencyHistoryTable::HISTORY_SIZE;
+
+    ConnectionId Id(const char *name)
+    {
+        return ConnectionId{ QString::fromLatin1(name) };
+    }
+
+    void AddResults(LatencyHistoryTable &table, const ConnectionId &id, const QList<int> &results)
+    {
+        for (const auto result : results)
+            table.AddResult(id, result);
+    }
+
+    QList<int> Samples(const LatencyHistoryTable &table, const ConnectionId &id)
+    {
+        QList<int> samples;
+        for (const auto &sample : table.ToJson()[id.toString()].toObject()[QStringLiteral("samples")].toArray())
+            samples << sample.toInt();
+        return samples;
+    }
+
+    LatencyStats MakeStats(int samples, double successRate, int consecutiveFailures)
+    {
+        LatencyStats stats;
+        stats.samples = samples;
+        stats.successRate = successRate;
+        stats.consecutiveFailures = consecutiveFailures;
+        return stats;
+    }
+} // namespace
+
+class tst_LatencyHistory : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // Only the last HISTORY_SIZE results count, older ones are overwritten in order.
+    void ringWrapAround()
+    {
+        LatencyHistoryTable table;
+        const auto id = Id("wrap");
+        AddResults(table, id, { -1, LATENCY_TEST_VALUE_ERROR, -1, -1 });
+        QCOMPARE(table.Stats(id).consecutiveFailures, 4);
+        QCOMPARE(table.Score(id), std::numeric_limits<double>::infinity());
+
+        QList<int> expected;
+        for (auto i = 0; i < HISTORY_SIZE; i++)
+        {
+            table.AddResult(id, 100 + i);
+            expected << 100 + i;
+        }
+        auto stats = table.Stats(id);
+        QCOMPARE(stats.samples, HISTORY_SIZE);
+        QCOMPARE(stats.successRate, 1.0);
+        QCOMPARE(stats.consecutiveFailures, 0);
+        QCOMPARE(Samples(table, id), expected);
+
+        AddResults(table, id, { 200, -1, -1, -1 });
+        expected = expected.mid(4) << 200 << 0xFFFF << 0xFFFF << 0xFFFF;
+        stats = table.Stats(id);
+        QCOMPARE(stats.samples, HISTORY_SIZE);
+        QCOMPARE(stats.successRate, double(HISTORY_SIZE - 3) / HISTORY_SIZE);
+        QCOMPARE(stats.consecutiveFailures, 3);
+        QCOMPARE(Samples(table, id), expected);
+
+        // Latencies that don't fit are clamped below the failure marker.
+        table.AddResult(id, 100000);
+        QCOMPARE(Samples(table, id).last(), 0xFFFE);
+        QCOMPARE(table.Stats(id).consecutiveFailures, 0);
+    }
+
+    void ewmaAndJitter()
+    {
+        LatencyHistoryTable table;
+        const auto id = Id("ewma");
+
+        table.AddResult(id, -1);
+        table.AddResult(id, 100);
+        // The first success sets the average, without jitter.
+        QCOMPARE(table.Stats(id).average, 100.0);
+        QCOMPARE(table.Stats(id).jitter, 0.0);
+
+        table.AddResult(id, 200);
+        QCOMPARE(table.Stats(id).average, 125.0);
+        QCOMPARE(table.Stats(id).jitter, 25.0);
+
+        // Failures leave the averages alone, the jitter is taken against the last success.
+        table.AddResult(id, LATENCY_TEST_VALUE_ERROR);
+        QCOMPARE(table.Stats(id).average, 125.0);
+        table.AddResult(id, 100);
+        const auto stats = table.Stats(id);
+        QCOMPARE(stats.average, 118.75);
+        QCOMPARE(stats.jitter, 43.75);
+        QCOMPARE(stats.successRate, 3.0 / 5);
+        QCOMPARE(table.Score(id), (118.75 + LatencyHistoryTable::JITTER_WEIGHT * 43.75) / (3.0 / 5));
+    }
+
+    // What is saved loads into the same stats, and results added afterwards land in the same place of the ring.
+    void saveLoadRoundTrip()
+    {
+        LatencyHistoryTable table;
+        AddResults(table, Id("short"), { 80, -1, 90 });
+        QList<int> results;
+        for (auto i = 0; i < HISTORY_SIZE + 5; i++)
+            results << (i % 4 == 3 ? -1 : 50 + i * 7);
+        AddResults(table, Id("wrapped"), results);
+        AddResults(table, Id("failing"), { -1, -1 });
+
+        LatencyHistoryTable loaded;
+        loaded.LoadJson(table.ToJson());
+        QCOMPARE(loaded.ToJson(), table.ToJson());
+
+        for (const auto &id : table.Connections())
+        {
+            AddResults(table, id, { 70, -1 });
+            AddResults(loaded, id, { 70, -1 });
+            const auto expected = table.Stats(id);
+            const auto actual = loaded.Stats(id);
+            QCOMPARE(actual.samples, expected.samples);
+            QCOMPARE(actual.successRate, expected.successRate);
+            QCOMPARE(actual.consecutiveFailures, expected.consecutiveFailures);
+            QCOMPARE(actual.average, expected.average);
+            QCOMPARE(actual.jitter, expected.jitter);
+            QCOMPARE(Samples(loaded, id), Samples(table, id));
+        }
+
+        LatencyHistoryTable empty;
+        empty.LoadJson({});
+        QVERIFY(empty.Connections().isEmpty());
+    }
+
+    void bestConnection()
+    {
+        LatencyHistoryTable table;
+        AddResults(table, Id("steady"), { 100, 100, 100, 100 });
+        // Faster, but failing half of the time: 40 / 0.5.
+        AddResults(table, Id("flaky"), { 40, -1 });
+        AddResults(table, Id("dead"), { -1, -1, -1 });
+
+        QCOMPARE(table.BestConnection({ Id("steady"), Id("flaky"), Id("dead"), Id("untested") }), Id("flaky"));
+        QCOMPARE(table.BestConnection({ Id("steady"), Id("dead") }), Id("steady"));
+        QVERIFY(table.BestConnection({ Id("dead"), Id("untested") }).isNull());
+        QVERIFY(table.BestConnection({}).isNull());
+
+        // 45 on average with 15 of jitter, the jitter counts twice.
+        AddResults(table, Id("jittery"), { 30, 90 });
+        QCOMPARE(table.Score(Id("jittery")), 75.0);
+        QCOMPARE(table.BestConnection({ Id("steady"), Id("flaky"), Id("jittery") }), Id("jittery"));
+    }
+
+    void failing_data()
+    {
+        QTest::addColumn<QList<int>>("results");
+        QTest::addColumn<bool>("failing");
+
+        QList<int> healthy;
+        for (auto i = 0; i < HISTORY_SIZE; i++)
+            healthy << 100;
+        QTest::newRow("healthy") << healthy << false;
+        QTest::newRow("one failure") << (QList<int>(healthy) << -1) << false;
+        QTest::newRow("two failures in a row") << (QList<int>(healthy) << -1 << -1) << true;
+        QTest::newRow("recovered") << (QList<int>(healthy) << -1 << -1 << 100) << false;
+        QTest::newRow("alternating") << QList<int>{ 100, -1, -1, 100, -1, 100, -1, -1, 100, -1, 100 } << true;
+        QTest::newRow("untested") << QList<int>{} << false;
+    }
+    // Two failed tests in a row are enough, whatever the history before them.
+    void failing()
+    {
+        QFETCH(QList<int>, results);
+        QFETCH(bool, failing);
+
+        LatencyHistoryTable table;
+        AddResults(table, Id("current"), results);
+        QCOMPARE(FailoverPolicy::IsFailing(table.Stats(Id("current"))), failing);
+    }
+
+    void shouldSwitch_data()
+    {
+        using namespace FailoverPolicy;
+        QTest::addColumn<int>("consecutiveFailures");
+        QTest::addColumn<double>("successRate");
+        QTest::addColumn<double>("currentScore");
+        QTest::addColumn<double>("bestScore");
+        QTest::addColumn<qint64>("sinceSwitch");
+        QTest::addColumn<bool>("expected");
+
+        const auto within = 100 / (1 + SWITCH_THRESHOLD) + 1;
+        const auto beyond = 100 / (1 + SWITCH_THRESHOLD) - 1;
+        QTest::newRow("better within the threshold") << 0 << 1.0 << 100.0 << within << qint64(-1) << false;
+        QTest::newRow("better beyond the threshold") << 0 << 1.0 << 100.0 << beyond << qint64(-1) << true;
+        QTest::newRow("failing, best barely better") << MAX_CONSECUTIVE_FAILURES << 0.9 << 100.0 << 99.0 << qint64(-1) << true;
+        QTest::newRow("low success rate") << 0 << MIN_SUCCESS_RATE - 0.1 << 100.0 << 99.0 << qint64(-1) << true;
+        QTest::newRow("beyond, switched just now") << 0 << 1.0 << 100.0 << beyond << qint64(0) << false;
+        QTest::newRow("beyond, switched recently") << 0 << 1.0 << 100.0 << beyond << qint64(MIN_SWITCH_INTERVAL_MSECS - 1) << false;
+        QTest::newRow("failing, switched recently") << MAX_CONSECUTIVE_FAILURES << 0.5 << 200.0 << 50.0 << qint64(MIN_SWITCH_INTERVAL_MSECS - 1) << false;
+        QTest::newRow("beyond, interval over") << 0 << 1.0 << 100.0 << beyond << qint64(MIN_SWITCH_INTERVAL_MSECS) << true;
+        QTest::newRow("within, interval over") << 0 << 1.0 << 100.0 << within << qint64(MIN_SWITCH_INTERVAL_MSECS) << false;
+    }
+    // The hysteresis and the minimum switch interval.
+    void shouldSwitch()
+    {
+        QFETCH(int, consecutiveFailures);
+        QFETCH(double, successRate);
+        QFETCH(double, currentScore);
+        QFETCH(double, bestScore);
+        QFETCH(qint64, sinceSwitch);
+        QFETCH(bool, expected);
+
+        const auto stats = MakeStats(HISTORY_SIZE, successRate, consecutiveFailures);
+        QCOMPARE(FailoverPolicy::ShouldSwitch(stats, currentScore, bestScore, sinceSwitch), expected);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_LatencyHistory)
+#include "tst_LatencyHistory.moc"
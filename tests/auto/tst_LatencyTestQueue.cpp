@@ -0,0 +1,223 @@
+#include "LatencyScheduler/LatencyTestQueue.hpp"
+
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtTest>
+
+using namespace Qv2ray::components::QvLatencyScheduler;
+
+namespace
+{
+    // The engine gives up between the queue timeout and the queue deadline, so that the hanging servers make tests
+    // overdue while their sockets are still open, but the engine still reports before the queue abandons them.
+    constexpr auto QUEUE_TIMEOUT_MSECS = 200;
+    constexpr auto ENGINE_TIMEOUT_MSECS = 500;
+
+    // A server answering every line with one, or one accepting connections and never answering.
+    class StandInServer : public QTcpServer
+    {
+      public:
+        explicit StandInServer(bool answers)
+        {
+            connect(this, &QTcpServer::newConnection, this,
+                    [this, answers]
+                    {
+                        while (const auto socket = nextPendingConnection())
+                            if (answers)
+                                connect(socket, &QTcpSocket::readyRead, socket, [socket] { socket->write(socket->readAll()); });
+                    });
+        }
+    };
+
+    // A latency engine connecting to the server of the test and waiting for its answer, giving up after
+    // ENGINE_TIMEOUT_MSECS. It keeps track of the sockets it has open.
+    class StandInEngine : public QObject
+    {
+      public:
+        explicit StandInEngine(const QHash<QString, quint16> &ports) : ports(ports)
+        {
+        }
+
+        void Start(const LatencyTest &test)
+        {
+            const auto socket = new QTcpSocket(this);
+            sockets.insert(socket, test);
+            open++;
+            openPerHost[test.host]++;
+            peakOpen = std::max(peakOpen, open);
+            peakOpenPerHost = std::max(peakOpenPerHost, openPerHost[test.host]);
+
+            const auto finish = [this, socket]
+            {
+                if (!sockets.contains(socket))
+                    return;
+                const auto test = sockets.take(socket);
+                open--;
+                openPerHost[test.host]--;
+                finished++;
+                socket->abort();
+                socket->deleteLater();
+                queue->Finish(test.id);
+            };
+            connect(socket, &QTcpSocket::connected, socket, [socket] { socket->write("ping\n"); });
+            connect(socket, &QTcpSocket::readyRead, socket, finish);
+            connect(socket, &QTcpSocket::errorOccurred, socket, [this, finish]
+                    {
+                        errors++;
+                        finish();
+                    });
+            QTimer::singleShot(ENGINE_TIMEOUT_MSECS, socket, finish);
+            socket->connectToHost(QHostAddress::LocalHost, ports[test.host]);
+        }
+
+        LatencyTestQueue *queue = nullptr;
+        int open = 0, peakOpen = 0, peakOpenPerHost = 0, finished = 0, errors = 0;
+
+      private:
+        const QHash<QString, quint16> ports;
+        QHash<QString, int> openPerHost;
+        QHash<QTcpSocket *, LatencyTest> sockets;
+    };
+
+    LatencyTest MakeTest(const QString &host, int index)
+    {
+        LatencyTest test;
+        test.id = ConnectionId{ QStringLiteral("%1-%2").arg(host).arg(index) };
+        test.host = host;
+        return test;
+    }
+} // namespace
+
+class tst_LatencyTestQueue : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // Enough answering servers to reach the global limit, and servers that never answer: the sockets open at the same
+    // time must stay within the limits, also once the tests of the hanging servers are overdue.
+    void limits()
+    {
+        QList<StandInServer *> servers;
+        QHash<QString, quint16> ports;
+        QList<LatencyTest> tests;
+        for (auto i = 0; i < 13; i++)
+        {
+            const auto answers = i < 10;
+            const auto server = new StandInServer(answers);
+            servers << server;
+            QVERIFY(server->listen(QHostAddress::LocalHost));
+
+            const auto host = QStringLiteral("%1-%2").arg(answers ? QStringLiteral("answering") : QStringLiteral("hanging")).arg(i);
+            ports.insert(host, server->serverPort());
+            for (auto j = 0; j < (answers ? 4 : 3); j++)
+                tests << MakeTest(host, j);
+        }
+
+        StandInEngine engine{ ports };
+        LatencyTestQueue queue{ [&engine](const LatencyTest &test) { engine.Start(test); }, QUEUE_TIMEOUT_MSECS };
+        engine.queue = &queue;
+        QSignalSpy overdue(&queue, &LatencyTestQueue::OnTestOverdue);
+
+        queue.Enqueue(tests);
+        QCOMPARE(queue.RunningCount(), LatencyTestQueue::MAX_RUNNING_TESTS);
+        QCOMPARE(engine.open, LatencyTestQueue::MAX_RUNNING_TESTS);
+
+        QTRY_COMPARE_WITH_TIMEOUT(engine.finished, tests.size(), 20000);
+        QCOMPARE(engine.errors, 0);
+        QCOMPARE(engine.peakOpen, LatencyTestQueue::MAX_RUNNING_TESTS);
+        QCOMPARE(engine.peakOpenPerHost, LatencyTestQueue::MAX_RUNNING_TESTS_PER_HOST);
+        QCOMPARE(queue.RunningCount(), 0);
+        QCOMPARE(queue.QueuedCount(), 0);
+
+        // Only the tests of the hanging servers are late, and each is reported once.
+        QCOMPARE(overdue.count(), 9);
+        for (const auto &arguments : overdue)
+            QVERIFY(arguments.first().value<ConnectionId>().toString().startsWith(QStringLiteral("hanging")));
+
+        qDeleteAll(servers);
+    }
+
+    void prioritizeAndCancel()
+    {
+        QList<ConnectionId> started;
+        LatencyTestQueue queue{ [&started](const LatencyTest &test) { started << test.id; } };
+
+        QList<LatencyTest> tests;
+        for (auto i = 0; i < 20; i++)
+            tests << MakeTest(QStringLiteral("host-%1").arg(i), 0);
+        queue.Enqueue(tests);
+        QCOMPARE(started.size(), LatencyTestQueue::MAX_RUNNING_TESTS);
+
+        // Already queued or running, skipped.
+        queue.Enqueue({ tests[0], tests[19] });
+        QCOMPARE(queue.QueuedCount(), 4);
+
+        queue.Prioritize({ tests[19].id });
+        queue.Finish(tests[0].id);
+        QCOMPARE(started.last(), tests[19].id);
+
+        queue.CancelQueued();
+        QCOMPARE(queue.QueuedCount(), 0);
+        queue.Finish(tests[1].id);
+        QCOMPARE(started.size(), LatencyTestQueue::MAX_RUNNING_TESTS + 1);
+        QCOMPARE(queue.RunningCount(), LatencyTestQueue::MAX_RUNNING_TESTS - 1);
+    }
+
+    // An engine that never reports, like an unknown engine or a hung probe: its tests are abandoned at the deadline, and
+    // the queue still runs every test.
+    void silentEngine()
+    {
+        QList<ConnectionId> started;
+        LatencyTestQueue queue{ [&started](const LatencyTest &test) { started << test.id; }, QUEUE_TIMEOUT_MSECS };
+        QSignalSpy overdue(&queue, &LatencyTestQueue::OnTestOverdue);
+        QSignalSpy abandoned(&queue, &LatencyTestQueue::OnTestAbandoned);
+
+        QList<LatencyTest> tests;
+        for (auto i = 0; i < 40; i++)
+            tests << MakeTest(QStringLiteral("host-%1").arg(i % 5), i);
+        queue.Enqueue(tests);
+        QCOMPARE(queue.RunningCount(), 5 * LatencyTestQueue::MAX_RUNNING_TESTS_PER_HOST);
+
+        QTRY_COMPARE_WITH_TIMEOUT(abandoned.count(), tests.size(), 20000);
+        QCOMPARE(started.size(), tests.size());
+        QCOMPARE(queue.RunningCount(), 0);
+        QCOMPARE(queue.QueuedCount(), 0);
+        QVERIFY(overdue.count() <= tests.size());
+
+        // A result arriving after the test was abandoned is ignored.
+        queue.Finish(tests.first().id);
+        QCOMPARE(queue.RunningCount(), 0);
+
+        // The same connections can be tested again.
+        queue.Enqueue({ tests.first() });
+        QCOMPARE(queue.RunningCount(), 1);
+    }
+
+    // Cancelling drops the overdue running tests along with the queued ones, and leaves the others running.
+    void cancelOverdue()
+    {
+        LatencyTestQueue queue{ [](const LatencyTest &) {}, QUEUE_TIMEOUT_MSECS };
+        QSignalSpy abandoned(&queue, &LatencyTestQueue::OnTestAbandoned);
+
+        QList<LatencyTest> tests;
+        for (auto i = 0; i < 20; i++)
+            tests << MakeTest(QStringLiteral("host-%1").arg(i), 0);
+        queue.Enqueue(tests);
+        QTRY_COMPARE_WITH_TIMEOUT(queue.OverdueCount(), qsizetype(LatencyTestQueue::MAX_RUNNING_TESTS), 2000);
+        QCOMPARE(abandoned.count(), 0);
+
+        // Started after the others turned overdue, so not overdue yet.
+        queue.Finish(tests[0].id);
+        QCOMPARE(queue.OverdueCount(), qsizetype(LatencyTestQueue::MAX_RUNNING_TESTS - 1));
+
+        queue.CancelQueued();
+        QCOMPARE(abandoned.count(), LatencyTestQueue::MAX_RUNNING_TESTS - 1);
+        QCOMPARE(queue.QueuedCount(), 0);
+        QCOMPARE(queue.RunningCount(), 1);
+        QCOMPARE(queue.OverdueCount(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_LatencyTestQueue)
+#include "tst_LatencyTestQueue.moc"
@@ -0,0 +1,198 @@
+#include "LogHighlighter/LogHighlighter.hpp"
+#include "ReferenceLogHighlighter.hpp"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+using Qv2ray::components::LogHighlighter::LogHighlighter;
+
+namespace
+{
+    // Pieces of log lines, and pieces on the edges of the old rules: partial tokens, separators, octets and groups out of
+    // range, letters outside of ASCII and spaces \s did not match.
+    const QStringList TOKENS{
+        QStringLiteral("tcp"),        QStringLiteral("udp"),           QStringLiteral("failed"),       QStringLiteral(" accepted "),
+        QStringLiteral(" rejected "), QStringLiteral("accepted"),      QStringLiteral("rejected"),     QStringLiteral(" "),
+        QStringLiteral("\t"),         QStringLiteral("/"),             QStringLiteral(":"),            QStringLiteral("::"),
+        QStringLiteral("."),          QStringLiteral("["),             QStringLiteral("]"),            QStringLiteral("]:"),
+        QStringLiteral(" ["),         QStringLiteral("] "),            QStringLiteral("%"),            QStringLiteral("-"),
+        QStringLiteral("_"),          QStringLiteral("0"),             QStringLiteral("1"),            QStringLiteral("25"),
+        QStringLiteral("255"),        QStringLiteral("256"),           QStringLiteral("00"),           QStringLiteral("010"),
+        QStringLiteral("1.2.3.4"),    QStringLiteral("10.0.0.1"),      QStringLiteral("a"),            QStringLiteral("ff"),
+        QStringLiteral("fe80"),       QStringLiteral("::1"),           QStringLiteral("com"),          QStringLiteral("example"),
+        QStringLiteral("xn--p1ai"),   QStringLiteral("2021/10/19"),    QStringLiteral("12:34:56"),     QStringLiteral("2021"),
+        QStringLiteral("12"),         QStringLiteral("[debug]"),       QStringLiteral("[Info]"),       QStringLiteral("[Warning]"),
+        QStringLiteral("[API]"),      QStringLiteral("[QV2RAY]"),      QStringLiteral("app/dispatcher"), QStringLiteral("v2ray.com/core"),
+        QStringLiteral("%eth0"),      QStringLiteral("]:443"),         QStringLiteral("65535"),        QStringLiteral("[2001:db8::1]"),
+        QStringLiteral("[::ffff:1.2.3.4]"), QString(QChar(0x00A0)), QString(QChar(0x2003)), QStringLiteral("İ"),
+        QString(63, QLatin1Char('a')),
+    };
+
+    QString Pick(QRandomGenerator &random, const QStringList &pieces)
+    {
+        return pieces[random.bounded(pieces.size())];
+    }
+
+    // Bracketed IPv6 addresses with a port: groups of any length and count around an optional ::, sometimes ending with
+    // an IPv4 address, sometimes with a zone.
+    QString RandomIPv6(QRandomGenerator &random)
+    {
+        const auto groups = [&random](int count)
+        {
+            QStringList groups;
+            for (auto i = 0; i < count; i++)
+                groups << Pick(random, { QStringLiteral("a1"), QStringLiteral("ffff"), QStringLiteral("0"), QStringLiteral("12345"), QStringLiteral("g1") });
+            return groups.join(QLatin1Char(':'));
+        };
+
+        const auto left = random.bounded(9), right = random.bounded(9);
+        auto address = groups(left);
+        if (random.bounded(4))
+            address += QStringLiteral("::");
+        else if (left && right)
+            address += QLatin1Char(':');
+        address += groups(right);
+        if (!random.bounded(3))
+        {
+            if (!address.isEmpty() && !address.endsWith(QLatin1Char(':')))
+                address += QLatin1Char(':');
+            address += Pick(random, { QStringLiteral("1.2.3.4"), QStringLiteral("1.02.3.4"), QStringLiteral("255.255.255.255"), QStringLiteral("256.1.1.1") });
+        }
+        return Pick(random, { QStringLiteral("["), QStringLiteral("[ "), QStringLiteral("x["), QStringLiteral("[[") }) + address +
+               Pick(random, { QStringLiteral("]:80"), QStringLiteral("]:"), QStringLiteral("] :1"), QStringLiteral("%eth0]:8080"), QStringLiteral("%a]b]:1"),
+                              QStringLiteral("%]:2"), QStringLiteral("]"), QStringLiteral(" ]:7"), QStringLiteral("%x ]:5 ]:6") });
+    }
+
+    // Domains with a port: labels too long, with hyphens on their edges, empty, or TLDs too short and too long.
+    QString RandomDomain(QRandomGenerator &random)
+    {
+        const QStringList labels{ QStringLiteral("a"),        QStringLiteral("a-b"),         QStringLiteral("-a"),          QStringLiteral("a-"),
+                                  QStringLiteral("1"),        QStringLiteral("xn--p1ai"),    QStringLiteral("com"),         QStringLiteral("museum"),
+                                  QStringLiteral("abcdefg"),  QString(63, QLatin1Char('a')), QString(64, QLatin1Char('b')), QStringLiteral("_x") };
+        QString domain;
+        for (auto i = random.bounded(1, 6); i > 0; i--)
+        {
+            domain += Pick(random, labels);
+            if (i > 1)
+                domain += random.bounded(8) ? QStringLiteral(".") : QStringLiteral("..");
+        }
+        return Pick(random, { QString{}, QStringLiteral(" "), QStringLiteral("-"), QStringLiteral("x_"), QStringLiteral(".") }) + domain +
+               Pick(random, { QStringLiteral(":443"), QStringLiteral("/:80"), QStringLiteral(":"), QStringLiteral(":99999x"), QStringLiteral("/x:1"), QString{} });
+    }
+
+    // IPv4 addresses with a port: octets out of range, with leading zeros, too many or too few of them.
+    QString RandomIPv4(QRandomGenerator &random)
+    {
+        const QStringList octets{ QStringLiteral("0"),   QStringLiteral("00"),  QStringLiteral("000"), QStringLiteral("1"),   QStringLiteral("01"),
+                                  QStringLiteral("123"), QStringLiteral("199"), QStringLiteral("249"), QStringLiteral("255"), QStringLiteral("256"),
+                                  QStringLiteral("300"), QStringLiteral("1234"), QString{} };
+        QString address = random.bounded(4) ? QString{} : QStringLiteral("9");
+        for (auto i = random.bounded(3, 6); i > 0; i--)
+        {
+            address += Pick(random, octets);
+            if (i > 1)
+                address += random.bounded(10) ? QStringLiteral(".") : QStringLiteral(":");
+        }
+        return address + Pick(random, { QStringLiteral(":80"), QStringLiteral(":"), QStringLiteral(":065535x"), QString{}, QStringLiteral(".1:2") });
+    }
+
+    QString RandomLine(QRandomGenerator &random)
+    {
+        QString line;
+        for (auto i = random.bounded(1, 4); i > 0; i--)
+        {
+            switch (random.bounded(4))
+            {
+                case 0: line += RandomIPv6(random); break;
+                case 1: line += RandomDomain(random); break;
+                case 2: line += RandomIPv4(random); break;
+                default:
+                    for (auto j = random.bounded(1, 7); j > 0; j--)
+                        line += Pick(random, TOKENS);
+            }
+            if (random.bounded(2))
+                line += QLatin1Char(' ');
+        }
+        return line;
+    }
+
+    // One letter per character, A for the first kind, '.' outside of tokens, so that a failure shows where they differ.
+    QString Describe(const QVector<qint8> &kinds)
+    {
+        QString description;
+        for (const auto kind : kinds)
+            description += kind == LogHighlighter::TOKEN_NONE ? QLatin1Char('.') : QLatin1Char(char('A' + kind));
+        return description;
+    }
+} // namespace
+
+// LogHighlighter::Classify must find the tokens the regular expressions it replaced found, character by character.
+class tst_LogHighlighter : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void corpus_data()
+    {
+        const auto lines = ReferenceLogHighlighter::LoadCorpus();
+        QVERIFY2(!lines.isEmpty(), "tests/data/log-highlighter/v2ray.log is missing.");
+
+        QTest::addColumn<QString>("line");
+        for (auto i = 0; i < lines.size(); i++)
+            QTest::addRow("line %d", i + 1) << lines[i];
+    }
+    void corpus()
+    {
+        QFETCH(QString, line);
+        QCOMPARE(Describe(LogHighlighter::Classify(line)), Describe(ReferenceLogHighlighter::Classify(line)));
+    }
+
+    // The old rules produced formats from the real lines too, not only from the edges.
+    void corpusHasTokens()
+    {
+        auto kinds = 0;
+        for (const auto &line : ReferenceLogHighlighter::LoadCorpus())
+            for (const auto kind : ReferenceLogHighlighter::Classify(line))
+                kinds |= kind == LogHighlighter::TOKEN_NONE ? 0 : 1 << kind;
+        QCOMPARE(kinds, (1 << LogHighlighter::TOKEN_KIND_COUNT) - 1);
+    }
+
+    // The seed is fixed so that a failure can be reproduced.
+    void randomized()
+    {
+        QRandomGenerator random(20211019);
+        for (auto round = 0; round < 20000; round++)
+        {
+            const auto line = RandomLine(random);
+            const auto expected = Describe(ReferenceLogHighlighter::Classify(line));
+            const auto actual = Describe(LogHighlighter::Classify(line));
+            if (actual != expected)
+                qWarning().noquote() << "Line:" << line;
+            QCOMPARE(actual, expected);
+        }
+    }
+
+    void highlight()
+    {
+        LogHighlighter highlighter;
+        highlighter.loadRules(false);
+        const auto line = QStringLiteral("2021/10/19 08:00:02 127.0.0.1:52416 accepted tcp:www.google.com:443 [proxy]");
+        const auto kinds = ReferenceLogHighlighter::Classify(line);
+
+        // Ranges are contiguous runs of one kind, and cover every character inside of a token.
+        auto covered = 0;
+        for (const auto &range : highlighter.Highlight(line))
+        {
+            QVERIFY(range.length > 0);
+            const auto kind = kinds[range.start];
+            QVERIFY(kind != LogHighlighter::TOKEN_NONE);
+            for (auto i = range.start; i < range.start + range.length; i++)
+                QCOMPARE(kinds[i], kind);
+            covered += range.length;
+        }
+        QCOMPARE(covered, int(std::count_if(kinds.begin(), kinds.end(), [](qint8 kind) { return kind != LogHighlighter::TOKEN_NONE; })));
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_LogHighlighter)
+#include "tst_LogHighlighter.moc"
@@ -0,0 +1,51 @@
+#include "SubscriptionAdapter.hpp"
+#include "TestAssets.hpp"
+
+#include <QtTest>
+
+namespace
+{
+    QByteArray ReadData(const QString &name)
+    {
+        QFile file(TestDataPath(name));
+        return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray{};
+    }
+} // namespace
+
+class tst_OOCv1Decoder : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // The version of the fixture comes after its servers, servers without a port or a method are skipped.
+    void fixture()
+    {
+        const auto data = ReadData(QStringLiteral("ooc-v1/subscription.json"));
+        QVERIFY(!data.isEmpty());
+        const auto expected = QString::fromUtf8(ReadData(QStringLiteral("ooc-v1/expected.txt"))).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+        QVERIFY(!expected.isEmpty());
+
+        QCOMPARE(OOCv1Decoder().DecodeData(data).links, expected);
+    }
+
+    void rejected_data()
+    {
+        QTest::addColumn<QByteArray>("data");
+
+        const auto fixture = ReadData(QStringLiteral("ooc-v1/subscription.json"));
+        QTest::newRow("other version") << QByteArray(fixture).replace("\"version\": 1", "\"version\": 2");
+        QTest::newRow("no version") << QByteArray(fixture).replace("\"version\": 1", "\"v\": 1");
+        QTest::newRow("truncated") << fixture.left(fixture.size() / 2);
+        QTest::newRow("trailing comma") << QByteArray(fixture).replace("\"group\": \"Main\"", "\"group\": \"Main\",");
+        QTest::newRow("not an object") << QByteArray("[{\"version\": 1}]");
+        QTest::newRow("empty") << QByteArray();
+    }
+    void rejected()
+    {
+        QFETCH(QByteArray, data);
+        QVERIFY(OOCv1Decoder().DecodeData(data).links.isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_OOCv1Decoder)
+#include "tst_OOCv1Decoder.moc"
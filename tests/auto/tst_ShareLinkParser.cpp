@@ -0,0 +1,123 @@
+#include "LegacyShareLinks.hpp"
+#include "OutboundHandler.hpp"
+#include "ShareLinkParser.hpp"
+#include "TestAssets.hpp"
+
+#include <QJsonDocument>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QtTest>
+
+namespace
+{
+    QStringList LoadCorpus()
+    {
+        QFile file(TestDataPath(QStringLiteral("share-links/links.txt")));
+        if (!file.open(QFile::ReadOnly))
+            return {};
+
+        QStringList links;
+        for (const auto &line : QString::fromUtf8(file.readAll()).split(QLatin1Char('\n')))
+        {
+            const auto link = line.trimmed();
+            if (!link.isEmpty() && !link.startsWith(QLatin1Char('#')))
+                links << link;
+        }
+        return links;
+    }
+
+    QList<std::pair<QString, QString>> QueryItems(const ShareLink &link)
+    {
+        QList<std::pair<QString, QString>> items;
+        for (const auto &item : link.query.split(QLatin1Char('&'), Qt::SkipEmptyParts))
+        {
+            const auto separator = item.indexOf(QLatin1Char('='));
+            const auto key = separator < 0 ? item : item.first(separator);
+            items << std::make_pair(ShareLink::PercentDecoded(key), link.QueryItemValue(key));
+        }
+        return items;
+    }
+
+    QList<std::pair<QString, QString>> QueryItems(const QUrl &url)
+    {
+        QList<std::pair<QString, QString>> items;
+        for (const auto &[key, value] : QUrlQuery(url).queryItems(QUrl::FullyDecoded))
+            items << std::make_pair(key, value);
+        return items;
+    }
+} // namespace
+
+class tst_ShareLinkParser : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        QVERIFY2(!LoadCorpus().isEmpty(), "share-links/links.txt is missing");
+    }
+
+    // ShareLink must split every link of the corpus the way QUrl does.
+    void components_data()
+    {
+        QTest::addColumn<QString>("link");
+        for (const auto &link : LoadCorpus())
+            QTest::newRow(qPrintable(link.left(48))) << link;
+    }
+    void components()
+    {
+        QFETCH(QString, link);
+
+        const QUrl url(link);
+        QVERIFY(url.isValid());
+
+        const auto parsed = ShareLink::Parse(link);
+        QVERIFY(parsed);
+
+        QCOMPARE(parsed->scheme.toString(), url.scheme());
+        // QUrl lowercases the host, ShareLink leaves it as it was written.
+        QCOMPARE(parsed->host.toString().toLower(), url.host());
+        QCOMPARE(parsed->port, url.port());
+        QCOMPARE(ShareLink::PercentDecoded(parsed->userName), url.userName(QUrl::FullyDecoded));
+        QCOMPARE(ShareLink::PercentDecoded(parsed->password), url.password(QUrl::FullyDecoded));
+        QCOMPARE(ShareLink::PercentDecoded(parsed->path), url.path(QUrl::FullyDecoded));
+        QCOMPARE(ShareLink::PercentDecoded(parsed->fragment), url.fragment(QUrl::FullyDecoded));
+        QCOMPARE(QueryItems(*parsed), QueryItems(url));
+    }
+
+    void invalid_data()
+    {
+        QTest::addColumn<QString>("link");
+        QTest::newRow("no scheme") << QStringLiteral("example.com:443");
+        QTest::newRow("unmatched bracket") << QStringLiteral("vless://id@[2001:db8::1:443");
+        QTest::newRow("port out of range") << QStringLiteral("socks://198.51.100.1:99999");
+        QTest::newRow("port not a number") << QStringLiteral("http://example.com:80a");
+    }
+    void invalid()
+    {
+        QFETCH(QString, link);
+        QVERIFY(!ShareLink::Parse(link));
+    }
+
+    // The deserializers built on ShareLink must give the same connections as the QUrl based ones they replaced.
+    void deserializers_data()
+    {
+        components_data();
+    }
+    void deserializers()
+    {
+        QFETCH(QString, link);
+
+        const auto expected = Legacy::Deserialize(link);
+        QVERIFY(expected);
+
+        const auto actual = BuiltinSerializer().Deserialize(link);
+        QVERIFY(actual);
+
+        QCOMPARE(actual->first, expected->first);
+        QCOMPARE(QJsonDocument(actual->second.toJson()).toJson(), QJsonDocument(expected->second.toJson()).toJson());
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_ShareLinkParser)
+#include "tst_ShareLinkParser.moc"
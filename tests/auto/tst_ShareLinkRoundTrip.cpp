@@ -0,0 +1,203 @@
+#include "OutboundHandler.hpp"
+#include "ShareLinkCorpus.hpp"
+#include "TestAssets.hpp"
+
+#include <QJsonDocument>
+#include <QtTest>
+
+namespace
+{
+    QString Get(const QJsonValue &value, const QString &defaultValue = {})
+    {
+        return value.toString().isEmpty() ? defaultValue : value.toString();
+    }
+
+    QString Join(const QJsonValue &value)
+    {
+        QStringList items;
+        for (const auto &item : value.toArray())
+            if (!item.toString().isEmpty())
+                items << item.toString();
+        return items.join(QLatin1Char(','));
+    }
+
+    // What a share link of the connection carries, with the defaults of each scheme filled in. A connection read back from
+    // the link has more settings, those the deserializers fill in on their own are left out.
+    QJsonObject Summary(const IOConnectionSettings &connection)
+    {
+        const QJsonObject settings = connection.protocolSettings;
+        const QJsonObject stream = connection.streamSettings;
+        const auto &protocol = connection.protocol;
+
+        QJsonObject summary{ { "protocol", protocol }, { "address", connection.address }, { "port", connection.port.from } };
+        if (protocol == QStringLiteral("shadowsocks"))
+        {
+            summary[QStringLiteral("method")] = Get(settings[QStringLiteral("method")]);
+            summary[QStringLiteral("password")] = Get(settings[QStringLiteral("password")]);
+            return summary;
+        }
+        if (protocol == QStringLiteral("http") || protocol == QStringLiteral("socks"))
+        {
+            summary[QStringLiteral("user")] = Get(settings[QStringLiteral("user")]);
+            summary[QStringLiteral("pass")] = Get(settings[QStringLiteral("pass")]);
+            return summary;
+        }
+
+        const auto vmess = protocol == QStringLiteral("vmess");
+        const auto network = Get(stream[QStringLiteral("network")], QStringLiteral("tcp"));
+        const auto security = Get(stream[QStringLiteral("security")], QStringLiteral("none"));
+        summary[QStringLiteral("id")] = Get(settings[QStringLiteral("id")]);
+        summary[QStringLiteral("network")] = network;
+        summary[QStringLiteral("security")] = security;
+        if (vmess)
+            summary[QStringLiteral("alterId")] = settings[QStringLiteral("alterId")].toInt();
+        else
+            summary[QStringLiteral("encryption")] = Get(settings[QStringLiteral("encryption")], QStringLiteral("none"));
+        if (security == QStringLiteral("xtls"))
+            summary[QStringLiteral("flow")] = Get(settings[QStringLiteral("flow")]);
+
+        if (network == QStringLiteral("tcp") && vmess)
+        {
+            summary[QStringLiteral("header")] = Get(QJsonIO::GetValue(stream, { "tcpSettings", "header", "type" }), QStringLiteral("none"));
+        }
+        else if (network == QStringLiteral("kcp"))
+        {
+            summary[QStringLiteral("seed")] = Get(QJsonIO::GetValue(stream, { "kcpSettings", "seed" }));
+            summary[QStringLiteral("header")] = Get(QJsonIO::GetValue(stream, { "kcpSettings", "header", "type" }), QStringLiteral("none"));
+        }
+        else if (network == QStringLiteral("ws"))
+        {
+            summary[QStringLiteral("path")] = Get(QJsonIO::GetValue(stream, { "wsSettings", "path" }), QStringLiteral("/"));
+            summary[QStringLiteral("host")] = Get(QJsonIO::GetValue(stream, { "wsSettings", "headers", "Host" }));
+        }
+        else if (network == QStringLiteral("http"))
+        {
+            summary[QStringLiteral("path")] = Get(QJsonIO::GetValue(stream, { "httpSettings", "path" }), QStringLiteral("/"));
+            // VMess links only carry the first host.
+            const auto hosts = Join(QJsonIO::GetValue(stream, { "httpSettings", "host" }));
+            summary[QStringLiteral("host")] = vmess ? hosts.section(QLatin1Char(','), 0, 0) : hosts;
+        }
+        else if (network == QStringLiteral("quic"))
+        {
+            const auto quicSecurity = Get(QJsonIO::GetValue(stream, { "quicSettings", "security" }), QStringLiteral("none"));
+            summary[QStringLiteral("quicSecurity")] = quicSecurity;
+            // VLESS links only carry the key and the header when the traffic is encrypted.
+            if (vmess || quicSecurity != QStringLiteral("none"))
+            {
+                summary[QStringLiteral("key")] = Get(QJsonIO::GetValue(stream, { "quicSettings", "key" }));
+                summary[QStringLiteral("header")] = Get(QJsonIO::GetValue(stream, { "quicSettings", "header", "type" }), QStringLiteral("none"));
+            }
+        }
+        else if (network == QStringLiteral("grpc"))
+        {
+            summary[QStringLiteral("serviceName")] = Get(QJsonIO::GetValue(stream, { "grpcSettings", "serviceName" }), QStringLiteral("GunService"));
+        }
+
+        if (security != QStringLiteral("none"))
+        {
+            const auto tlsKey = security == QStringLiteral("xtls") ? QStringLiteral("xtlsSettings") : QStringLiteral("tlsSettings");
+            summary[QStringLiteral("serverName")] = Get(QJsonIO::GetValue(stream, { tlsKey, "serverName" }));
+            if (!vmess)
+                summary[QStringLiteral("alpn")] = Join(QJsonIO::GetValue(stream, { tlsKey, "alpn" }));
+        }
+        return summary;
+    }
+
+    struct GoldenLink
+    {
+        QString link;
+        QJsonObject expected;
+        QString exported;
+    };
+
+    QList<GoldenLink> LoadGoldenLinks()
+    {
+        QFile file(TestDataPath(QStringLiteral("share-links/golden.tsv")));
+        if (!file.open(QFile::ReadOnly))
+            return {};
+
+        QList<GoldenLink> links;
+        for (const auto &line : QString::fromUtf8(file.readAll()).split(QLatin1Char('\n')))
+        {
+            if (line.trimmed().isEmpty() || line.startsWith(QLatin1Char('#')))
+                continue;
+            const auto columns = line.split(QLatin1Char('\t'));
+            if (columns.size() != 3)
+                return {};
+            links << GoldenLink{ columns[0], QJsonDocument::fromJson(columns[1].toUtf8()).object(), columns[2].trimmed() };
+        }
+        return links;
+    }
+} // namespace
+
+class tst_ShareLinkRoundTrip : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // For every generated connection: the link reads back into the same name and settings, and the connection read back
+    // gives the same link again.
+    void roundTrip_data()
+    {
+        QTest::addColumn<int>("index");
+        for (auto index = 0; index < corpus.size(); index++)
+            QTest::newRow(qPrintable(corpus[index].label)) << index;
+    }
+    void roundTrip()
+    {
+        QFETCH(int, index);
+        const auto &[label, name, connection] = corpus[index];
+
+        const BuiltinSerializer serializer;
+        const auto link = serializer.Serialize(name, connection);
+        QVERIFY(link);
+        QVERIFY2(link->startsWith(connection.protocol == QStringLiteral("shadowsocks") ? QStringLiteral("ss://") : connection.protocol + "://"), qPrintable(*link));
+
+        const auto decoded = serializer.Deserialize(*link);
+        QVERIFY2(decoded, qPrintable(*link));
+        QCOMPARE(decoded->first, name);
+        QCOMPARE(QJsonDocument(Summary(decoded->second)).toJson(), QJsonDocument(Summary(connection)).toJson());
+
+        QCOMPARE(serializer.Serialize(decoded->first, decoded->second).value_or(QString{}), *link);
+    }
+
+    // Links written by other clients: each reads into the expected name and settings, and exports to the pinned link.
+    void golden_data()
+    {
+        const auto links = LoadGoldenLinks();
+        QVERIFY2(!links.isEmpty(), "share-links/golden.tsv is missing or malformed");
+
+        QTest::addColumn<QString>("link");
+        QTest::addColumn<QJsonObject>("expected");
+        QTest::addColumn<QString>("exported");
+        for (const auto &[link, expected, exported] : links)
+            QTest::newRow(qPrintable(link.left(48))) << link << expected << exported;
+    }
+    void golden()
+    {
+        QFETCH(QString, link);
+        QFETCH(QJsonObject, expected);
+        QFETCH(QString, exported);
+
+        const BuiltinSerializer serializer;
+        const auto decoded = serializer.Deserialize(link);
+        QVERIFY(decoded);
+
+        auto summary = Summary(decoded->second);
+        summary[QStringLiteral("name")] = decoded->first;
+        QCOMPARE(QJsonDocument(summary).toJson(), QJsonDocument(expected).toJson());
+
+        QCOMPARE(serializer.Serialize(decoded->first, decoded->second).value_or(QString{}), exported);
+        // The exported link is read back the same, whatever the other client left out or added.
+        const auto reread = serializer.Deserialize(exported);
+        QVERIFY(reread);
+        QCOMPARE(reread->first, decoded->first);
+        QCOMPARE(QJsonDocument(Summary(reread->second)).toJson(), QJsonDocument(Summary(decoded->second)).toJson());
+    }
+
+  private:
+    const QList<ShareLinkCorpus::Case> corpus = ShareLinkCorpus::Generate();
+};
+
+QTEST_GUILESS_MAIN(tst_ShareLinkRoundTrip)
+#include "tst_ShareLinkRoundTrip.moc"
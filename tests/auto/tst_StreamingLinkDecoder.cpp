@@ -0,0 +1,74 @@
+#include "plugins/subscription-adapters/core/StreamingLinkDecoder.hpp"
+
+#include <QtTest>
+
+namespace
+{
+    // Feeds the payload in chunks of chunkSize bytes, to check that nothing depends on where a chunk ends.
+    QStringList Decode(const QByteArray &payload, qsizetype chunkSize, bool *isBase64 = nullptr)
+    {
+        QStringList lines;
+        StreamingLinkDecoder decoder([&lines](QByteArrayView line) { lines << QString::fromUtf8(line.toByteArray()); });
+        for (qsizetype i = 0; i < payload.size(); i += chunkSize)
+            decoder.Feed(QByteArrayView(payload).sliced(i, std::min(chunkSize, payload.size() - i)));
+        decoder.Finish();
+        if (isBase64)
+            *isBase64 = decoder.IsBase64();
+        return lines;
+    }
+
+    const QStringList LINKS{
+        QStringLiteral("ss://YWVzLTI1Ni1nY206cGFzcw@example.com:8388#first"),
+        QStringLiteral("vmess://eyJhZGQiOiJleGFtcGxlLm9yZyJ9"),
+        QStringLiteral("trojan://password@example.net:443?sni=example.net#third"),
+    };
+} // namespace
+
+class tst_StreamingLinkDecoder : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void decode_data()
+    {
+        QTest::addColumn<QByteArray>("payload");
+        QTest::addColumn<bool>("base64");
+        QTest::addColumn<QStringList>("expected");
+
+        const auto plain = LINKS.join(QLatin1Char('\n')).toUtf8();
+        const auto base64 = plain.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+
+        QTest::newRow("plain") << plain << false << LINKS;
+        QTest::newRow("plain, CRLF") << LINKS.join(QStringLiteral("\r\n")).toUtf8() << false << LINKS;
+        QTest::newRow("plain, leading blank lines") << QByteArray("\n  \r\n") + plain << false << LINKS;
+        QTest::newRow("plain, comments") << QByteArray("#!MANAGED-CONFIG https://example.com/sub\nREMARKS=Provider\nSTATUS=10GB left\n") + plain << false
+                                         << QStringList{ QStringLiteral("#!MANAGED-CONFIG https://example.com/sub"), QStringLiteral("REMARKS=Provider"),
+                                                         QStringLiteral("STATUS=10GB left") } +
+                                                LINKS;
+        QTest::newRow("plain, long first link") << QByteArray("vless://") + QByteArray(1000, 'a') + "@example.com:443" << false
+                                                << QStringList{ QStringLiteral("vless://") + QString(1000, QLatin1Char('a')) + QStringLiteral("@example.com:443") };
+        QTest::newRow("plain, comments only") << QByteArray("# nothing yet\n\n") << false << QStringList{ QStringLiteral("# nothing yet") };
+
+        QTest::newRow("base64") << base64 << true << LINKS;
+        QTest::newRow("base64, standard alphabet") << plain.toBase64() << true << LINKS;
+        QTest::newRow("base64, wrapped") << plain.toBase64().insert(76, '\n').insert(153, '\n') << true << LINKS;
+        QTest::newRow("base64, leading blank lines") << QByteArray("\r\n\r\n") + base64 << true << LINKS;
+        QTest::newRow("base64, comments") << QByteArray("# Provider\nREMARKS=Provider\n") + base64 << true << LINKS;
+    }
+    void decode()
+    {
+        QFETCH(QByteArray, payload);
+        QFETCH(bool, base64);
+        QFETCH(QStringList, expected);
+
+        for (const auto chunkSize : { qsizetype(1), qsizetype(3), qsizetype(17), qsizetype(255), payload.size() })
+        {
+            bool isBase64 = false;
+            QCOMPARE(Decode(payload, chunkSize, &isBase64), expected);
+            QCOMPARE(isBase64, base64);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_StreamingLinkDecoder)
+#include "tst_StreamingLinkDecoder.moc"
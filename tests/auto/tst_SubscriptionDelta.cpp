@@ -0,0 +1,106 @@
+#include "SubscriptionUpdater/SubscriptionDelta.hpp"
+
+#include <QtTest>
+
+using namespace Qv2ray::components::QvSubscriptionUpdater;
+
+namespace
+{
+    // The version stands for the content: it is the name of the only outbound, and the hash.
+    SubscriptionEntry Entry(const QString &name, const QString &version)
+    {
+        OutboundObject outbound;
+        outbound.name = version;
+        SubscriptionEntry entry;
+        entry.name = name;
+        entry.content.outbounds << outbound;
+        entry.hash = version.toUtf8();
+        return entry;
+    }
+
+    // "id/name/version" for existing connections, "name/version" for new entries.
+    QList<std::pair<ConnectionId, SubscriptionEntry>> Existing(const QStringList &connections)
+    {
+        QList<std::pair<ConnectionId, SubscriptionEntry>> existing;
+        for (const auto &connection : connections)
+        {
+            const auto parts = connection.split(QLatin1Char('/'));
+            existing << std::pair{ ConnectionId{ parts[0] }, Entry(parts[1], parts[2]) };
+        }
+        return existing;
+    }
+
+    QList<SubscriptionEntry> Entries(const QStringList &entries)
+    {
+        QList<SubscriptionEntry> result;
+        for (const auto &entry : entries)
+        {
+            const auto parts = entry.split(QLatin1Char('/'));
+            result << Entry(parts[0], parts[1]);
+        }
+        return result;
+    }
+
+    QStringList Describe(const SubscriptionDelta &delta)
+    {
+        QStringList lines;
+        for (const auto &id : delta.kept)
+            lines << QStringLiteral("kept ") + id.toString();
+        for (const auto &[id, name] : delta.renamed)
+            lines << QStringLiteral("renamed %1 %2").arg(id.toString(), name);
+        for (const auto &[id, content] : delta.updated)
+            lines << QStringLiteral("updated %1 %2").arg(id.toString(), content.outbounds.first().name);
+        for (const auto &entry : delta.added)
+            lines << QStringLiteral("added %1 %2").arg(entry.name, entry.content.outbounds.first().name);
+        for (const auto &id : delta.removed)
+            lines << QStringLiteral("removed ") + id.toString();
+        return lines;
+    }
+} // namespace
+
+class tst_SubscriptionDelta : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void computeDelta_data()
+    {
+        QTest::addColumn<QStringList>("existing");
+        QTest::addColumn<QStringList>("entries");
+        QTest::addColumn<QStringList>("expected");
+
+        QTest::newRow("unchanged") << QStringList{ "a/A/1", "b/B/2" } << QStringList{ "B/2", "A/1" } << QStringList{ "kept b", "kept a" };
+        QTest::newRow("kept, renamed, updated, added and removed")
+            << QStringList{ "a/A/1", "b/B/2", "c/C/3", "d/D/4" } << QStringList{ "A/1", "B2/2", "C/3x", "E/5" }
+            << QStringList{ "kept a", "kept b", "renamed b B2", "updated c 3x", "added E 5", "removed d" };
+        // Pairing by content goes first, a name only pairs what is left.
+        QTest::newRow("swapped names") << QStringList{ "a/A/1", "b/B/2" } << QStringList{ "B/1", "A/2" }
+                                       << QStringList{ "kept a", "kept b", "renamed a B", "renamed b A" };
+        QTest::newRow("renamed and changed") << QStringList{ "a/A/1" } << QStringList{ "B/2" } << QStringList{ "added B 2", "removed a" };
+
+        // Each existing connection is paired at most once, in the order of the lists.
+        QTest::newRow("duplicate hashes, more new") << QStringList{ "a/A/1", "b/A2/1" } << QStringList{ "X/1", "Y/1", "Z/1" }
+                                                    << QStringList{ "kept a", "kept b", "renamed a X", "renamed b Y", "added Z 1" };
+        QTest::newRow("duplicate hashes, fewer new") << QStringList{ "a/A/1", "b/A2/1" } << QStringList{ "A2/1" }
+                                                     << QStringList{ "kept a", "renamed a A2", "removed b" };
+        QTest::newRow("duplicate names, more new") << QStringList{ "a/N/1", "b/N/2" } << QStringList{ "N/3", "N/4", "N/5" }
+                                                   << QStringList{ "updated a 3", "updated b 4", "added N 5" };
+        QTest::newRow("duplicate names, one kept") << QStringList{ "a/N/1", "b/N/2" } << QStringList{ "N/9", "N/2" }
+                                                   << QStringList{ "kept b", "updated a 9" };
+        QTest::newRow("duplicate names, fewer new") << QStringList{ "a/N/1", "b/N/2" } << QStringList{ "N/3" } << QStringList{ "updated a 3", "removed b" };
+
+        QTest::newRow("empty new list") << QStringList{ "a/A/1", "b/B/2" } << QStringList{} << QStringList{ "removed a", "removed b" };
+        QTest::newRow("no existing connection") << QStringList{} << QStringList{ "A/1", "A/1" } << QStringList{ "added A 1", "added A 1" };
+        QTest::newRow("both empty") << QStringList{} << QStringList{} << QStringList{};
+    }
+    void computeDelta()
+    {
+        QFETCH(QStringList, existing);
+        QFETCH(QStringList, entries);
+        QFETCH(QStringList, expected);
+        QCOMPARE(Describe(ComputeDelta(Existing(existing), Entries(entries))), expected);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_SubscriptionDelta)
+#include "tst_SubscriptionDelta.moc"
@@ -0,0 +1,174 @@
+#include "GeositeReader/GeositeReader.hpp"
+#include "GeositeReader/picoproto.h"
+#include "ReferenceFieldScanner.hpp"
+#include "TestAssets.hpp"
+
+#include <QFile>
+#include <QStandardPaths>
+#include <QtTest>
+
+using namespace Qv2ray::components::GeositeReader;
+
+namespace
+{
+    // ReadGeoSiteFromFile before the field scanner: the whole file is read and parsed into a picoproto::Message tree.
+    QStringList ReadWithMessageTree(const QString &filepath)
+    {
+        QFile f(filepath);
+        if (!f.open(QFile::OpenModeFlag::ReadOnly))
+            return {};
+        auto content = f.readAll();
+        f.close();
+
+        QStringList list;
+        picoproto::Message root;
+        root.ParseFromBytes(reinterpret_cast<uint8_t *>(content.data()), content.size());
+        for (const auto &entry : root.GetMessageArray(1))
+            list << QString::fromStdString(entry->GetString(1));
+        list.sort();
+        return list;
+    }
+
+    // Both walk the entries of a data file down to their domains or CIDRs, which is where nearly all of its varints
+    // are, and sum up what they have read so that the results can be compared.
+    quint64 ScanVarints(const uint8_t *data, size_t size, int depth = 0)
+    {
+        quint64 sum = 0;
+        picoproto::FieldScanner scanner(data, size);
+        while (scanner.Next())
+        {
+            sum += scanner.GetFieldNumber() + scanner.GetValue();
+            const auto [payload, payloadSize] = scanner.GetBytes();
+            if (payload && (depth == 0 || (depth == 1 && scanner.GetFieldNumber() == 2)))
+                sum += ScanVarints(payload, payloadSize, depth + 1);
+        }
+        return sum;
+    }
+
+    quint64 ScanVarintsReference(const uint8_t *data, size_t size, int depth = 0)
+    {
+        quint64 sum = 0;
+        std::vector<ReferenceFieldScanner::Field> fields;
+        ReferenceFieldScanner::Scan(data, size, &fields);
+        for (const auto &field : fields)
+        {
+            sum += field.number + field.value;
+            if (field.wireType == picoproto::WIRETYPE_LENGTH_DELIMITED && (depth == 0 || (depth == 1 && field.number == 2)))
+                sum += ScanVarintsReference(data + field.offset, field.size, depth + 1);
+        }
+        return sum;
+    }
+
+    QByteArray ReadAsset(const QString &path)
+    {
+        QFile f(path);
+        return f.open(QFile::OpenModeFlag::ReadOnly) ? f.readAll() : QByteArray{};
+    }
+} // namespace
+
+class bench_GeositeReader : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        // Keeps the sidecar indexes out of the user's cache directory.
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
+    void sameCategories_data()
+    {
+        addDataFiles();
+    }
+    void sameCategories()
+    {
+        QFETCH(QString, file);
+        QV2RAY_REQUIRE_ASSET(path, file);
+        QCOMPARE(ReadGeoSiteFromFile(path, false), ReadWithMessageTree(path));
+    }
+
+    void messageTree_data()
+    {
+        addDataFiles();
+    }
+    void messageTree()
+    {
+        QFETCH(QString, file);
+        QV2RAY_REQUIRE_ASSET(path, file);
+        QBENCHMARK
+        {
+            ReadWithMessageTree(path);
+        }
+    }
+
+    // Scans the file and writes its sidecar index every time, the in-memory and on-disk caches are bypassed.
+    void fieldScanner_data()
+    {
+        addDataFiles();
+    }
+    void fieldScanner()
+    {
+        QFETCH(QString, file);
+        QV2RAY_REQUIRE_ASSET(path, file);
+        QBENCHMARK
+        {
+            ReadGeoSiteFromFile(path, false);
+        }
+    }
+
+    void sameVarints_data()
+    {
+        addDataFiles();
+    }
+    void sameVarints()
+    {
+        QFETCH(QString, file);
+        QV2RAY_REQUIRE_ASSET(path, file);
+        const auto content = ReadAsset(path);
+        const auto data = reinterpret_cast<const uint8_t *>(content.constData());
+        QCOMPARE(ScanVarints(data, content.size()), ScanVarintsReference(data, content.size()));
+    }
+
+    // The word at a time varint decoder of FieldScanner, against the byte by byte one, on the whole file.
+    void varintsFieldScanner_data()
+    {
+        addDataFiles();
+    }
+    void varintsFieldScanner()
+    {
+        QFETCH(QString, file);
+        QV2RAY_REQUIRE_ASSET(path, file);
+        const auto content = ReadAsset(path);
+        QBENCHMARK
+        {
+            ScanVarints(reinterpret_cast<const uint8_t *>(content.constData()), content.size());
+        }
+    }
+
+    void varintsReference_data()
+    {
+        addDataFiles();
+    }
+    void varintsReference()
+    {
+        QFETCH(QString, file);
+        QV2RAY_REQUIRE_ASSET(path, file);
+        const auto content = ReadAsset(path);
+        QBENCHMARK
+        {
+            ScanVarintsReference(reinterpret_cast<const uint8_t *>(content.constData()), content.size());
+        }
+    }
+
+  private:
+    void addDataFiles()
+    {
+        QTest::addColumn<QString>("file");
+        QTest::newRow("geosite") << QStringLiteral("geosite.dat");
+        QTest::newRow("geoip") << QStringLiteral("geoip.dat");
+    }
+};
+
+QTEST_GUILESS_MAIN(bench_GeositeReader)
+#include "bench_GeositeReader.moc"
@@ -0,0 +1,150 @@
+#include "SettingsModels.hpp"
+#include "TestAssets.hpp"
+
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <unistd.h>
+
+namespace
+{
+    // Two rounds of probes at MIN_PROBE_INTERVAL, and the start of the core.
+    constexpr auto RUN_MSECS = 25000;
+    constexpr auto OTHER_OUTBOUNDS = 32;
+
+    // The probe URL of the observatory, answering every request with 204.
+    class ProbeServer : public QTcpServer
+    {
+      public:
+        ProbeServer()
+        {
+            connect(this, &QTcpServer::newConnection, this,
+                    [this]
+                    {
+                        while (const auto socket = nextPendingConnection())
+                            connect(socket, &QTcpSocket::readyRead, socket,
+                                    [this, socket]
+                                    {
+                                        if (!socket->readAll().contains("\r\n\r\n"))
+                                            return;
+                                        requests++;
+                                        socket->write("HTTP/1.1 204 No Content\r\nContent-Length: 0\r\n\r\n");
+                                    });
+                    });
+        }
+
+        int requests = 0;
+    };
+
+    // A profile with a leastPing balancer of two outbounds among many others, and the observatory of the row.
+    QJsonObject MakeProfile(const QJsonObject &observatory)
+    {
+        QJsonArray outbounds;
+        for (const auto &tag : { QStringLiteral("observed-a"), QStringLiteral("observed-b") })
+            outbounds << QJsonObject{ { "tag", tag }, { "protocol", "freedom" } };
+        for (auto i = 0; i < OTHER_OUTBOUNDS; i++)
+            outbounds << QJsonObject{ { "tag", QStringLiteral("other-%1").arg(i) }, { "protocol", "freedom" } };
+
+        const QJsonObject balancer{ { "tag", "balancer" }, { "selector", QJsonArray{ "observed-" } }, { "strategy", QJsonObject{ { "type", "leastPing" } } } };
+        QJsonObject profile{ { "log", QJsonObject{ { "loglevel", "warning" } } },
+                             { "outbounds", outbounds },
+                             { "routing", QJsonObject{ { "balancers", QJsonArray{ balancer } } } } };
+        if (!observatory.isEmpty())
+            profile[QStringLiteral("observatory")] = observatory;
+        return profile;
+    }
+
+    // User and system time of the process so far, in clock ticks, -1 if unknown.
+    qint64 CpuTicks(qint64 pid)
+    {
+        QFile stat(QStringLiteral("/proc/%1/stat").arg(pid));
+        if (!stat.open(QFile::ReadOnly))
+            return -1;
+        // The name of the process, in parentheses, may contain spaces. utime and stime are the 14th and 15th fields.
+        const auto content = stat.readAll();
+        const auto fields = content.mid(content.lastIndexOf(')') + 2).split(' ');
+        return fields.size() > 12 ? fields[11].toLongLong() + fields[12].toLongLong() : -1;
+    }
+} // namespace
+
+// Runs the v2ray core of $QV2RAY_TEST_ASSETS with the observatory the plugin generates for a leastPing balancer, with
+// none, and with one without subjects, which probes every outbound. The CPU time the core used is the result, in ticks
+// of the system clock, so that a change making the core busier shows up.
+class bench_KernelCpu : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        if (!QFile::exists(QStringLiteral("/proc/self/stat")))
+            QSKIP("Reading the CPU time of the core needs /proc.");
+    }
+
+    void observatory_data()
+    {
+        ObservatoryConfig settings;
+        settings.probeURL = QStringLiteral("http://127.0.0.1:%1/generate_204").arg(server.serverPort());
+        settings.probeInterval = ObservatoryConfig::MIN_PROBE_INTERVAL;
+
+        auto unbounded = settings.Generate({ QStringLiteral("observed-") });
+        unbounded[QStringLiteral("subjectSelector")] = QJsonArray{};
+
+        QTest::addColumn<QJsonObject>("observatory");
+        QTest::newRow("none") << QJsonObject{};
+        QTest::newRow("generated") << settings.Generate({ QStringLiteral("observed-") });
+        QTest::newRow("unbounded") << unbounded;
+    }
+    void observatory()
+    {
+        QV2RAY_REQUIRE_ASSET(core, QStringLiteral("v2ray"));
+        QFETCH(QJsonObject, observatory);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QFile config(dir.filePath(QStringLiteral("config.json")));
+        QVERIFY(config.open(QFile::WriteOnly));
+        config.write(QJsonDocument(MakeProfile(observatory)).toJson());
+        config.close();
+
+        const auto requestsBefore = server.requests;
+        QProcess process;
+        process.setProcessChannelMode(QProcess::ForwardedChannels);
+        process.start(core, { QStringLiteral("-config"), config.fileName() });
+        QVERIFY(process.waitForStarted());
+
+        // Waits on the event loop, the probe server has to answer meanwhile.
+        QTest::qWait(RUN_MSECS);
+        QCOMPARE(process.state(), QProcess::Running);
+        const auto ticks = CpuTicks(process.processId());
+        process.terminate();
+        if (!process.waitForFinished(5000))
+            process.kill();
+
+        QVERIFY(ticks >= 0);
+        if (!observatory.isEmpty())
+            QVERIFY2(server.requests > requestsBefore, "The observatory never probed.");
+        results.insert(QString::fromUtf8(QTest::currentDataTag()), ticks);
+        QTest::setBenchmarkResult(ticks, QTest::CPUTicks);
+    }
+
+    // The observatory the plugin generates must never cost more than one probing every outbound.
+    void generatedIsBounded()
+    {
+        if (results.size() < 3)
+            QSKIP("The core has not been run.");
+        qInfo() << "CPU ticks:" << results << "clock ticks per second:" << sysconf(_SC_CLK_TCK);
+        QVERIFY(results[QStringLiteral("generated")] <= results[QStringLiteral("unbounded")]);
+    }
+
+  private:
+    ProbeServer server;
+    QHash<QString, qint64> results;
+};
+
+QTEST_GUILESS_MAIN(bench_KernelCpu)
+#include "bench_KernelCpu.moc"
@@ -0,0 +1,79 @@
+#include "LogHighlighter/LogHighlighter.hpp"
+#include "ReferenceLogHighlighter.hpp"
+
+#include <QtTest>
+
+using Qv2ray::components::LogHighlighter::LogHighlighter;
+
+// The regular expressions LogHighlighter ran before, one per kind of token, against the lexer replacing them, over the
+// lines of tests/data/log-highlighter/v2ray.log. Both give the same tokens, tst_LogHighlighter checks that.
+class bench_LogHighlighter : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        QVERIFY2(!corpus.isEmpty(), "tests/data/log-highlighter/v2ray.log is missing.");
+        highlighter.loadRules(false);
+    }
+
+    void reference_data()
+    {
+        addLines();
+    }
+    void reference()
+    {
+        QFETCH(QStringList, lines);
+        QBENCHMARK
+        {
+            for (const auto &line : lines)
+                ReferenceLogHighlighter::Classify(line);
+        }
+    }
+
+    void classify_data()
+    {
+        addLines();
+    }
+    void classify()
+    {
+        QFETCH(QStringList, lines);
+        QBENCHMARK
+        {
+            for (const auto &line : lines)
+                LogHighlighter::Classify(line);
+        }
+    }
+
+    // What LogItemDelegate pays per line, the format ranges included.
+    void highlight_data()
+    {
+        addLines();
+    }
+    void highlight()
+    {
+        QFETCH(QStringList, lines);
+        QBENCHMARK
+        {
+            for (const auto &line : lines)
+                highlighter.Highlight(line);
+        }
+    }
+
+  private:
+    // The lines as the log view shows them, and all of them in one line, where running every rule over the whole line
+    // costs the most.
+    void addLines()
+    {
+        QTest::addColumn<QStringList>("lines");
+        QTest::newRow("lines") << corpus;
+        QTest::newRow("one line") << QStringList{ corpus.join(QLatin1Char(' ')) };
+    }
+
+    const QStringList corpus = ReferenceLogHighlighter::LoadCorpus();
+    LogHighlighter highlighter;
+};
+
+QTEST_GUILESS_MAIN(bench_LogHighlighter)
+#include "bench_LogHighlighter.moc"
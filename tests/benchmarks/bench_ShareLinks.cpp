@@ -0,0 +1,171 @@
+#include "OutboundHandler.hpp"
+#include "ShareLinkCorpus.hpp"
+
+#include <QElapsedTimer>
+#include <QtTest>
+#include <atomic>
+
+#ifdef __GLIBC__
+// Counts the allocations of the whole process, the link codecs are the only thing running while allocationsPerLink
+// reads the counter. glibc exports its allocator under these names so that it can be wrapped like this.
+namespace
+{
+    std::atomic<quint64> allocations{ 0 };
+} // namespace
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *pointer, size_t size);
+
+    void *malloc(size_t size) noexcept
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size) noexcept
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *pointer, size_t size) noexcept
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(pointer, size);
+    }
+}
+#endif
+
+namespace
+{
+    using Cases = QList<ShareLinkCorpus::Case>;
+
+    QString SchemeOf(const ShareLinkCorpus::Case &c)
+    {
+        return c.label.section(QLatin1Char('/'), 0, 0);
+    }
+
+    // Every link of the corpus, the way a subscription hands them out.
+    QStringList LinksOf(const Cases &cases)
+    {
+        const BuiltinSerializer serializer;
+        QStringList links;
+        for (const auto &c : cases)
+            links << serializer.Serialize(c.name, c.connection).value_or(QString{});
+        return links;
+    }
+} // namespace
+
+class bench_ShareLinks : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase()
+    {
+        for (const auto &link : LinksOf(corpus))
+            QVERIFY(!link.isEmpty());
+    }
+
+    void serialize_data()
+    {
+        addSchemes();
+    }
+    void serialize()
+    {
+        QFETCH(QString, scheme);
+        const auto cases = casesOf(scheme);
+        const BuiltinSerializer serializer;
+        QBENCHMARK
+        {
+            for (const auto &c : cases)
+                serializer.Serialize(c.name, c.connection);
+        }
+    }
+
+    void deserialize_data()
+    {
+        addSchemes();
+    }
+    void deserialize()
+    {
+        QFETCH(QString, scheme);
+        const auto links = LinksOf(casesOf(scheme));
+        const BuiltinSerializer serializer;
+        QBENCHMARK
+        {
+            for (const auto &link : links)
+                serializer.Deserialize(link);
+        }
+    }
+
+    // The whole corpus read back, reported in links per second rather than in time per iteration.
+    void linksPerSecond()
+    {
+        const auto links = LinksOf(corpus);
+        const BuiltinSerializer serializer;
+
+        qint64 decoded = 0;
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < 1000)
+        {
+            for (const auto &link : links)
+                decoded += serializer.Deserialize(link).has_value();
+        }
+        QCOMPARE(decoded % links.size(), 0);
+        QTest::setBenchmarkResult(decoded * 1e9 / timer.nsecsElapsed(), QTest::Events);
+    }
+
+    void allocationsPerLink_data()
+    {
+        addSchemes();
+    }
+    void allocationsPerLink()
+    {
+#ifdef __GLIBC__
+        QFETCH(QString, scheme);
+        const auto links = LinksOf(casesOf(scheme));
+        const BuiltinSerializer serializer;
+        // Once before counting, so that what is allocated on first use only is left out.
+        for (const auto &link : links)
+            serializer.Deserialize(link);
+
+        const auto before = allocations.load();
+        for (const auto &link : links)
+            serializer.Deserialize(link);
+        QTest::setBenchmarkResult(qreal(allocations.load() - before) / links.size(), QTest::Events);
+#else
+        QSKIP("Counting allocations needs glibc");
+#endif
+    }
+
+  private:
+    void addSchemes()
+    {
+        QTest::addColumn<QString>("scheme");
+        QStringList schemes;
+        for (const auto &c : corpus)
+            if (!schemes.contains(SchemeOf(c)))
+                schemes << SchemeOf(c);
+        for (const auto &scheme : schemes)
+            QTest::newRow(qPrintable(scheme)) << scheme;
+    }
+
+    Cases casesOf(const QString &scheme) const
+    {
+        Cases cases;
+        for (const auto &c : corpus)
+            if (SchemeOf(c) == scheme)
+                cases << c;
+        return cases;
+    }
+
+    const Cases corpus = ShareLinkCorpus::Generate();
+};
+
+QTEST_GUILESS_MAIN(bench_ShareLinks)
+#include "bench_ShareLinks.moc"
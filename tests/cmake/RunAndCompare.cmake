@@ -0,0 +1,13 @@
+# cmake -DCOMMAND=<command;args> -DOUTPUT=<file> -DEXPECTED=<file> -P RunAndCompare.cmake
+#
+# Runs a command that writes OUTPUT, and fails unless OUTPUT is identical to EXPECTED.
+execute_process(COMMAND ${COMMAND} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${COMMAND} failed: ${result}")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${EXPECTED} RESULT_VARIABLE different)
+if(different)
+    file(READ ${OUTPUT} actual)
+    message(FATAL_ERROR "${OUTPUT} differs from ${EXPECTED}:\n${actual}")
+endif()
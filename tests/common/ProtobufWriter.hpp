@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QByteArray>
+
+// Just enough of the protobuf wire format to write geosite.dat and geoip.dat fixtures.
+namespace ProtobufWriter
+{
+    inline void AppendVarint(QByteArray &out, quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.append(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.append(char(value));
+    }
+
+    inline void AppendVarintField(QByteArray &out, quint32 number, quint64 value)
+    {
+        AppendVarint(out, quint64(number) << 3);
+        AppendVarint(out, value);
+    }
+
+    inline void AppendBytesField(QByteArray &out, quint32 number, const QByteArray &bytes)
+    {
+        AppendVarint(out, (quint64(number) << 3) | 2);
+        AppendVarint(out, bytes.size());
+        out.append(bytes);
+    }
+} // namespace ProtobufWriter
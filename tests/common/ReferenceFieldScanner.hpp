@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// A byte by byte protobuf field scanner, as simple as it gets. picoproto::FieldScanner decodes varints a word at a time,
+// this is what it is compared against, in the fuzzer for correctness and in the benchmarks for speed.
+namespace ReferenceFieldScanner
+{
+    struct Field
+    {
+        uint32_t number;
+        uint32_t wireType;
+        uint64_t value;
+        size_t offset;
+        size_t size;
+
+        bool operator==(const Field &other) const
+        {
+            return number == other.number && wireType == other.wireType && value == other.value && offset == other.offset && size == other.size;
+        }
+    };
+
+    inline bool ReadVarInt(const uint8_t *bytes, size_t size, size_t *position, uint64_t *result)
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && *position < size; shift += 7)
+        {
+            const uint8_t byte = bytes[(*position)++];
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (byte < 128)
+            {
+                *result = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Appends the top level fields of the buffer, returns false if it is malformed. The fields before the malformed
+    // one are still appended, as FieldScanner hands them out before it fails.
+    inline bool Scan(const uint8_t *bytes, size_t size, std::vector<Field> *fields)
+    {
+        size_t position = 0;
+        while (position < size)
+        {
+            uint64_t key;
+            if (!ReadVarInt(bytes, size, &position, &key))
+                return false;
+
+            Field field{ static_cast<uint32_t>(key >> 3), static_cast<uint32_t>(key & 0x07), 0, 0, 0 };
+            switch (field.wireType)
+            {
+                case 0:
+                    if (!ReadVarInt(bytes, size, &position, &field.value))
+                        return false;
+                    break;
+                case 1:
+                    if (size - position < 8)
+                        return false;
+                    memcpy(&field.value, bytes + position, 8);
+                    position += 8;
+                    break;
+                case 5:
+                {
+                    if (size - position < 4)
+                        return false;
+                    uint32_t fixed;
+                    memcpy(&fixed, bytes + position, 4);
+                    field.value = fixed;
+                    position += 4;
+                    break;
+                }
+                case 2:
+                {
+                    uint64_t length;
+                    if (!ReadVarInt(bytes, size, &position, &length) || length > size - position)
+                        return false;
+                    field.offset = position;
+                    field.size = static_cast<size_t>(length);
+                    position += field.size;
+                    break;
+                }
+                default: return false;
+            }
+            fields->push_back(field);
+        }
+        return true;
+    }
+} // namespace ReferenceFieldScanner
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "LogHighlighter/LogHighlighter.hpp"
+#include "TestAssets.hpp"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// The regular expressions LogHighlighter ran before it had a lexer, one per kind of token, each over the whole line.
+// LogHighlighter::Classify is compared against them in tst_LogHighlighter for correctness and in bench_LogHighlighter
+// for speed.
+namespace ReferenceLogHighlighter
+{
+#define REGEX_IPV6_ADDR                                                                                                                                                  \
+    R"(\[\s*((([0-9A-Fa-f]{1,4}:){7}([0-9A-Fa-f]{1,4}|:))|(([0-9A-Fa-f]{1,4}:){6}(:[0-9A-Fa-f]{1,4}|((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3})|:))|(([0-9A-Fa-f]{1,4}:){5}(((:[0-9A-Fa-f]{1,4}){1,2})|:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3})|:))|(([0-9A-Fa-f]{1,4}:){4}(((:[0-9A-Fa-f]{1,4}){1,3})|((:[0-9A-Fa-f]{1,4})?:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(([0-9A-Fa-f]{1,4}:){3}(((:[0-9A-Fa-f]{1,4}){1,4})|((:[0-9A-Fa-f]{1,4}){0,2}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(([0-9A-Fa-f]{1,4}:){2}(((:[0-9A-Fa-f]{1,4}){1,5})|((:[0-9A-Fa-f]{1,4}){0,3}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(([0-9A-Fa-f]{1,4}:){1}(((:[0-9A-Fa-f]{1,4}){1,6})|((:[0-9A-Fa-f]{1,4}){0,4}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:))|(:(((:[0-9A-Fa-f]{1,4}){1,7})|((:[0-9A-Fa-f]{1,4}){0,5}:((25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(\.(25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3}))|:)))(%.+)?\s*\])"
+#define REGEX_IPV4_ADDR R"((\d{1,2}|1\d\d|2[0-4]\d|25[0-5])\.(\d{1,2}|1\d\d|2[0-4]\d|25[0-5])\.(\d{1,2}|1\d\d|2[0-4]\d|25[0-5])\.(\d{1,2}|1\d\d|2[0-4]\d|25[0-5]))"
+#define REGEX_PORT_NUMBER R"(([0-9]|[1-9]\d{1,3}|[1-5]\d{4}|6[0-5]{2}[0-3][0-5])*)"
+#define TO_EOL "(([\\s\\S]*)|([\\d\\D]*)|([\\w\\W]*))$"
+
+    using Kind = Qv2ray::components::LogHighlighter::LogHighlighter::TokenKind;
+    using Rules = std::vector<std::pair<QRegularExpression, Kind>>;
+
+    // In the order they were applied, a later match overwrote the format of an earlier one.
+    inline const Rules &GetRules()
+    {
+        using LH = Qv2ray::components::LogHighlighter::LogHighlighter;
+        static const Rules rules = []
+        {
+            const auto extended = QRegularExpression::ExtendedPatternSyntaxOption;
+            Rules rules;
+            rules.emplace_back(QRegularExpression(QStringLiteral("tcp")), LH::TOKEN_TCPUDP);
+            rules.emplace_back(QRegularExpression(QStringLiteral("udp")), LH::TOKEN_TCPUDP);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\d\\d\\d\\d/\\d\\d/\\d\\d")), LH::TOKEN_DATE);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\d\\d:\\d\\d:\\d\\d")), LH::TOKEN_TIME);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\[[Dd]ebug\\]" TO_EOL)), LH::TOKEN_DEBUG);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\[[Ii]nfo\\]" TO_EOL)), LH::TOKEN_INFO);
+            rules.emplace_back(QRegularExpression(QStringLiteral(REGEX_IPV4_ADDR ":" REGEX_PORT_NUMBER), extended), LH::TOKEN_IPHOST);
+            rules.emplace_back(QRegularExpression(QStringLiteral(REGEX_IPV6_ADDR ":" REGEX_PORT_NUMBER), extended), LH::TOKEN_IPHOST);
+            rules.emplace_back(QRegularExpression(QStringLiteral("([a-zA-Z0-9]([a-zA-Z0-9\\-]{0,61}[a-zA-Z0-9])?\\.)+[a-zA-Z]{2,6}(/|):" REGEX_PORT_NUMBER), extended),
+                               LH::TOKEN_IPHOST);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\saccepted\\s")), LH::TOKEN_ACCEPTED);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\srejected\\s" TO_EOL)), LH::TOKEN_REJECTED);
+            rules.emplace_back(QRegularExpression(QStringLiteral(R"( (\w+\/)+\w+: )")), LH::TOKEN_COMPONENT);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\[[Ww]arning\\]" TO_EOL)), LH::TOKEN_WARNING);
+            rules.emplace_back(QRegularExpression(QStringLiteral("failed")), LH::TOKEN_FAILED);
+            rules.emplace_back(QRegularExpression(QStringLiteral("\\[[A-Z]*\\]:")), LH::TOKEN_APPLOG);
+            rules.emplace_back(QRegularExpression(QStringLiteral(R"( \[\w+\] )")), LH::TOKEN_APPDEBUG);
+            return rules;
+        }();
+        return rules;
+    }
+
+#undef REGEX_IPV6_ADDR
+#undef REGEX_IPV4_ADDR
+#undef REGEX_PORT_NUMBER
+#undef TO_EOL
+
+    // The kind of each character of the line, as the old highlightBlock left it.
+    inline QVector<qint8> Classify(const QString &text)
+    {
+        QVector<qint8> kinds(text.size(), Qv2ray::components::LogHighlighter::LogHighlighter::TOKEN_NONE);
+        for (const auto &[pattern, kind] : GetRules())
+        {
+            auto matches = pattern.globalMatch(text);
+            while (matches.hasNext())
+            {
+                const auto match = matches.next();
+                std::fill(kinds.begin() + match.capturedStart(), kinds.begin() + match.capturedEnd(), kind);
+            }
+        }
+        return kinds;
+    }
+
+    // The lines of tests/data/log-highlighter/v2ray.log, without the comments.
+    inline QStringList LoadCorpus()
+    {
+        QFile file(TestDataPath(QStringLiteral("log-highlighter/v2ray.log")));
+        if (!file.open(QFile::ReadOnly))
+            return {};
+
+        QStringList lines;
+        for (const auto &line : QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts))
+        {
+            if (!line.startsWith(QStringLiteral("# ")))
+                lines << line;
+        }
+        return lines;
+    }
+} // namespace ReferenceLogHighlighter
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "QvPlugin/Handlers/OutboundHandler.hpp"
+#include "QvPlugin/Utils/QJsonIO.hpp"
+
+#include <QJsonArray>
+
+// Connections for every protocol, transport and TLS combination the builtin share links support, with the hosts and
+// names subscriptions hand out. Used by the round-trip tests of the link codecs and by their benchmarks.
+//
+// Values that go into links unescaped by QUrlQuery (the query of VMess links) avoid '%', '&' and '+', which it would
+// read back differently. Names start and end with a letter, the VMess deserializer trims them.
+namespace ShareLinkCorpus
+{
+    struct Case
+    {
+        // protocol/transport/security/host, for the test rows.
+        QString label;
+        QString name;
+        IOConnectionSettings connection;
+    };
+
+    inline const QStringList HOSTS{ QStringLiteral("example.com"), QStringLiteral("198.51.100.7"), QStringLiteral("2001:db8::7") };
+    inline const QStringList NAMES{
+        QString{},
+        QStringLiteral("Plain"),
+        QStringLiteral("US West 01 & more"),
+        QStringLiteral("香港 01 🇭🇰 Hong Kong"),
+        QStringLiteral("100% #1 ?a=b/c"),
+    };
+
+    inline IOConnectionSettings MakeConnection(const QString &protocol, const QString &host, int port, const QJsonObject &settings, const QJsonObject &stream = {})
+    {
+        IOConnectionSettings connection;
+        connection.protocol = protocol;
+        connection.address = host;
+        connection.port = port;
+        connection.protocolSettings = IOProtocolSettings{ settings };
+        connection.streamSettings = IOStreamSettings{ stream };
+        return connection;
+    }
+
+    // The transport settings of network, as both VLESS and VMess store them.
+    inline QJsonObject MakeStream(const QString &network, const QString &security, bool vmess)
+    {
+        QJsonObject stream{ { "network", network }, { "security", security } };
+        if (network == QStringLiteral("tcp"))
+        {
+            if (vmess)
+                QJsonIO::SetValue(stream, QStringLiteral("http"), { "tcpSettings", "header", "type" });
+        }
+        else if (network == QStringLiteral("kcp"))
+        {
+            QJsonIO::SetValue(stream, QStringLiteral("s3cr3t seed"), { "kcpSettings", "seed" });
+            QJsonIO::SetValue(stream, QStringLiteral("wechat-video"), { "kcpSettings", "header", "type" });
+        }
+        else if (network == QStringLiteral("ws"))
+        {
+            QJsonIO::SetValue(stream, vmess ? QStringLiteral("/ray?ed=2048") : QStringLiteral("/ws path?ed=2048&x=ü"), { "wsSettings", "path" });
+            QJsonIO::SetValue(stream, QStringLiteral("cdn.example.com"), { "wsSettings", "headers", "Host" });
+        }
+        else if (network == QStringLiteral("http"))
+        {
+            QJsonIO::SetValue(stream, QStringLiteral("/h2"), { "httpSettings", "path" });
+            QJsonIO::SetValue(stream, vmess ? QJsonArray{ "a.example.com" } : QJsonArray{ "a.example.com", "b.example.com" }, { "httpSettings", "host" });
+        }
+        else if (network == QStringLiteral("quic"))
+        {
+            QJsonIO::SetValue(stream, QStringLiteral("aes-128-gcm"), { "quicSettings", "security" });
+            QJsonIO::SetValue(stream, QStringLiteral("k3y"), { "quicSettings", "key" });
+            QJsonIO::SetValue(stream, QStringLiteral("srtp"), { "quicSettings", "header", "type" });
+        }
+        else if (network == QStringLiteral("grpc"))
+        {
+            QJsonIO::SetValue(stream, QStringLiteral("my service"), { "grpcSettings", "serviceName" });
+        }
+
+        if (security != QStringLiteral("none"))
+        {
+            const auto tlsKey = security == QStringLiteral("xtls") ? QStringLiteral("xtlsSettings") : QStringLiteral("tlsSettings");
+            QJsonIO::SetValue(stream, QStringLiteral("sni.example.org"), { tlsKey, QStringLiteral("serverName") });
+            if (!vmess)
+                QJsonIO::SetValue(stream, QJsonArray{ "h2", "http/1.1" }, { tlsKey, QStringLiteral("alpn") });
+        }
+        return stream;
+    }
+
+    inline QList<Case> Generate()
+    {
+        QList<Case> cases;
+        // Every combination once, the names are rotated through so that each is used with every protocol.
+        auto nameIndex = 0;
+        const auto add = [&cases, &nameIndex](const QString &label, const IOConnectionSettings &connection)
+        { cases << Case{ label, NAMES[nameIndex++ % NAMES.size()], connection }; };
+
+        for (const auto &host : HOSTS)
+        {
+            for (const auto &network : QStringList{ "tcp", "kcp", "ws", "http", "quic", "grpc" })
+            {
+                for (const auto &security : QStringList{ "none", "tls", "xtls" })
+                {
+                    QJsonObject settings{ { "id", "b831381d-6324-4d53-ad4f-8cda48b30811" }, { "encryption", "none" } };
+                    if (security == QStringLiteral("xtls"))
+                        settings[QStringLiteral("flow")] = QStringLiteral("xtls-rprx-direct");
+                    add(QStringLiteral("vless/%1/%2/%3").arg(network, security, host),
+                        MakeConnection(QStringLiteral("vless"), host, 443, settings, MakeStream(network, security, false)));
+                }
+            }
+
+            for (const auto &network : QStringList{ "tcp", "kcp", "ws", "http", "quic" })
+            {
+                for (const auto &security : QStringList{ "none", "tls" })
+                {
+                    const QJsonObject settings{ { "id", "7a6f1b0a-8a3c-4d6e-9f7b-3c2d1e0f9a8b" }, { "alterId", 4 }, { "security", "auto" } };
+                    add(QStringLiteral("vmess/%1/%2/%3").arg(network, security, host),
+                        MakeConnection(QStringLiteral("vmess"), host, 10086, settings, MakeStream(network, security, true)));
+                }
+            }
+
+            for (const auto &method : QStringList{ "aes-256-gcm", "chacha20-ietf-poly1305", "2022-blake3-aes-128-gcm" })
+            {
+                const QJsonObject settings{ { "method", method }, { "password", QStringLiteral("p@ss:wörd/+=") } };
+                add(QStringLiteral("shadowsocks/%1/%2").arg(method, host), MakeConnection(QStringLiteral("shadowsocks"), host, 8388, settings));
+            }
+
+            for (const auto &protocol : QStringList{ "http", "socks" })
+            {
+                add(QStringLiteral("%1/anonymous/%2").arg(protocol, host), MakeConnection(protocol, host, 1080, {}));
+                const QJsonObject settings{ { "user", "user@corp" }, { "pass", "p@ss:w%rd" } };
+                add(QStringLiteral("%1/credentials/%2").arg(protocol, host), MakeConnection(protocol, host, 65535, settings));
+            }
+        }
+        return cases;
+    }
+} // namespace ShareLinkCorpus
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QDir>
+#include <QFileInfo>
+#include <QString>
+#include <QtTest>
+
+// Fixtures committed under tests/data.
+inline QString TestDataPath(const QString &name)
+{
+    return QDir(QStringLiteral(QV2RAY_TEST_DATA_DIR)).filePath(name);
+}
+
+// Real v2ray assets, from the directory in $QV2RAY_TEST_ASSETS, empty if it isn't there.
+inline QString TestAssetPath(const QString &name)
+{
+    const auto dir = qEnvironmentVariable("QV2RAY_TEST_ASSETS");
+    if (dir.isEmpty())
+        return {};
+    const QFileInfo info(QDir(dir), name);
+    return info.isFile() ? info.absoluteFilePath() : QString{};
+}
+
+#define QV2RAY_REQUIRE_ASSET(variable, name)                                                                                                                            \
+    const auto variable = TestAssetPath(name);                                                                                                                           \
+    if (variable.isEmpty())                                                                                                                                              \
+    QSKIP("Set QV2RAY_TEST_ASSETS to a directory containing the v2ray assets.")
@@ -0,0 +1,44 @@
+#include "GeositeReader/picoproto.h"
+#include "ReferenceFieldScanner.hpp"
+
+#include <cstdlib>
+
+// FieldScanner must hand out the same fields as the byte by byte reference, fail on the same inputs, and never read
+// outside of the buffer, which the sanitizers check. Length-delimited payloads are scanned again as nested messages.
+namespace
+{
+    void CheckScan(const uint8_t *data, size_t size, int depth)
+    {
+        std::vector<ReferenceFieldScanner::Field> expected;
+        const bool expectedOk = ReferenceFieldScanner::Scan(data, size, &expected);
+
+        picoproto::FieldScanner scanner(data, size);
+        size_t index = 0;
+        while (scanner.Next())
+        {
+            if (index >= expected.size())
+                abort();
+
+            const auto [payload, payloadSize] = scanner.GetBytes();
+            const ReferenceFieldScanner::Field actual{ scanner.GetFieldNumber(), static_cast<uint32_t>(scanner.GetWireType()), scanner.GetValue(),
+                                                       scanner.GetPayloadOffset(), payloadSize };
+            if (!(actual == expected[index]))
+                abort();
+            if (payload && payload != data + actual.offset)
+                abort();
+
+            if (payload && depth < 4)
+                CheckScan(payload, payloadSize, depth + 1);
+            index++;
+        }
+
+        if (index != expected.size() || scanner.Failed() == expectedOk)
+            abort();
+    }
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    CheckScan(data, size, 0);
+    return 0;
+}
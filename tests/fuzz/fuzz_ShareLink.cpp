@@ -0,0 +1,35 @@
+#include "OutboundHandler.hpp"
+#include "ShareLinkParser.hpp"
+
+#include <cstdlib>
+
+// Built once per scheme, QV2RAY_FUZZ_SCHEME is put in front of the input so that every run reaches the deserializer of
+// that scheme. The tokenizer must hand out views inside of the link and a valid port, and nothing may touch memory
+// outside of the input, which the sanitizers check. Connections read from a link are serialized and read again, to
+// cover the serializers as well.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const auto link = QStringLiteral(QV2RAY_FUZZ_SCHEME "://") + QString::fromUtf8(reinterpret_cast<const char *>(data), qsizetype(size));
+    const auto begin = link.constData();
+    const auto end = begin + link.size();
+
+    if (const auto parsed = ShareLink::Parse(link))
+    {
+        for (const auto view : { parsed->scheme, parsed->userInfo, parsed->userName, parsed->password, parsed->host, parsed->path, parsed->query, parsed->fragment })
+            if (!view.isNull() && (view.data() < begin || view.data() + view.size() > end))
+                abort();
+        if (parsed->port < -1 || parsed->port > 65535)
+            abort();
+        ShareLink::PercentDecoded(parsed->userInfo);
+        ShareLink::PercentDecoded(parsed->fragment);
+        parsed->QueryItemValue(u"type");
+    }
+
+    const BuiltinSerializer serializer;
+    const auto decoded = serializer.Deserialize(link);
+    if (!decoded)
+        return 0;
+    if (const auto serialized = serializer.Serialize(decoded->first, decoded->second); serialized && !serialized->isEmpty())
+        serializer.Deserialize(*serialized);
+    return 0;
+}